@@ -0,0 +1,475 @@
+/*
+ * ggit-async.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggit-async.h"
+#include "ggit-error.h"
+
+/* Maximum number of threads running asynchronous operations at once */
+#define GGIT_ASYNC_MAX_THREADS 8
+
+/* A function run by several threads at once, see _ggit_async_run_parallel() */
+typedef struct
+{
+	GThreadFunc func;
+	gpointer data;
+
+	GMutex mutex;
+	GCond cond;
+	gint ref_count;
+
+	/* Helpers that started and did not finish yet */
+	guint running;
+
+	/* Set once the calling thread is done, helpers that did not start
+	 * by then are skipped */
+	gboolean done;
+} Parallel;
+
+typedef struct
+{
+	GTask *task;
+	GTaskThreadFunc func;
+
+	Parallel *parallel;
+} AsyncJob;
+
+/* The state of the operation running on the current worker thread. libgit2
+ * invokes its callbacks on the thread that runs the operation, so the
+ * callback wrappers below find the cancellable and the original callbacks
+ * through this thread private context.
+ */
+typedef struct
+{
+	GCancellable *cancellable;
+
+	git_transfer_progress_cb transfer_progress;
+
+	git_checkout_notify_cb checkout_notify;
+	guint checkout_notify_flags;
+
+	git_diff_notify_cb diff_notify;
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	git_diff_progress_cb diff_progress;
+#endif
+} AsyncContext;
+
+static GThreadPool *pool = NULL;
+static GPrivate current_context = G_PRIVATE_INIT (NULL);
+
+static void
+parallel_unref (Parallel *parallel)
+{
+	if (g_atomic_int_dec_and_test (&parallel->ref_count))
+	{
+		g_mutex_clear (&parallel->mutex);
+		g_cond_clear (&parallel->cond);
+		g_slice_free (Parallel, parallel);
+	}
+}
+
+static void
+parallel_worker (Parallel *parallel)
+{
+	gboolean run;
+
+	g_mutex_lock (&parallel->mutex);
+
+	run = !parallel->done;
+
+	if (run)
+	{
+		parallel->running++;
+	}
+
+	g_mutex_unlock (&parallel->mutex);
+
+	if (run)
+	{
+		parallel->func (parallel->data);
+
+		g_mutex_lock (&parallel->mutex);
+		parallel->running--;
+		g_cond_signal (&parallel->cond);
+		g_mutex_unlock (&parallel->mutex);
+	}
+
+	parallel_unref (parallel);
+}
+
+static void
+async_worker (gpointer data,
+              gpointer user_data)
+{
+	AsyncJob *job = data;
+	AsyncContext context = { 0 };
+
+	if (job->parallel != NULL)
+	{
+		parallel_worker (job->parallel);
+		g_slice_free (AsyncJob, job);
+		return;
+	}
+
+	context.cancellable = g_task_get_cancellable (job->task);
+	g_private_set (&current_context, &context);
+
+	if (!g_task_return_error_if_cancelled (job->task))
+	{
+		job->func (job->task,
+		           g_task_get_source_object (job->task),
+		           g_task_get_task_data (job->task),
+		           context.cancellable);
+	}
+
+	g_private_set (&current_context, NULL);
+
+	g_object_unref (job->task);
+	g_slice_free (AsyncJob, job);
+}
+
+/* Creates the shared worker pool on first use */
+static GThreadPool *
+get_pool (void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter (&initialized))
+	{
+		guint max_threads;
+
+		max_threads = CLAMP (g_get_num_processors (), 2, GGIT_ASYNC_MAX_THREADS);
+		pool = g_thread_pool_new (async_worker, NULL, max_threads, FALSE, NULL);
+
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return pool;
+}
+
+/*
+ * _ggit_async_run:
+ * @task: a #GTask.
+ * @func: the function running the operation.
+ *
+ * Runs @func on the shared, bounded libgit2-glib worker pool. Like
+ * g_task_run_in_thread(), @func must return a result on @task, which is then
+ * reported on the main context @task was created in. If @task is cancelled
+ * before @func got to run, @func is skipped and the task returns
+ * %G_IO_ERROR_CANCELLED.
+ */
+void
+_ggit_async_run (GTask           *task,
+                 GTaskThreadFunc  func)
+{
+	AsyncJob *job;
+
+	g_return_if_fail (G_IS_TASK (task));
+	g_return_if_fail (func != NULL);
+
+	job = g_slice_new0 (AsyncJob);
+	job->task = g_object_ref (task);
+	job->func = func;
+
+	g_thread_pool_push (get_pool (), job, NULL);
+}
+
+/*
+ * _ggit_async_run_parallel:
+ * @func: the function to run.
+ * @data: the data passed to @func.
+ * @n_threads: the number of threads that should run @func.
+ *
+ * Runs @func on the calling thread and on up to @n_threads - 1 threads of
+ * the shared worker pool at the same time, and returns once all of them
+ * returned. @func should take its work from a queue shared through @data,
+ * as it is not known how many threads end up running it: helpers that did
+ * not get a pool thread by the time the calling thread is done are skipped,
+ * so that a busy pool, or a call from one of its own threads, does not
+ * block the caller. Without thread support in libgit2, @func only runs on
+ * the calling thread.
+ */
+void
+_ggit_async_run_parallel (GThreadFunc func,
+                          gpointer    data,
+                          guint       n_threads)
+{
+	Parallel *parallel;
+	guint i;
+
+	g_return_if_fail (func != NULL);
+
+	if (n_threads <= 1 || !(git_libgit2_features () & GIT_FEATURE_THREADS))
+	{
+		func (data);
+		return;
+	}
+
+	parallel = g_slice_new0 (Parallel);
+	parallel->func = func;
+	parallel->data = data;
+	parallel->ref_count = 1;
+	g_mutex_init (&parallel->mutex);
+	g_cond_init (&parallel->cond);
+
+	for (i = 1; i < MIN (n_threads, GGIT_ASYNC_MAX_THREADS); i++)
+	{
+		AsyncJob *job;
+
+		job = g_slice_new0 (AsyncJob);
+		job->parallel = parallel;
+
+		g_atomic_int_inc (&parallel->ref_count);
+		g_thread_pool_push (get_pool (), job, NULL);
+	}
+
+	func (data);
+
+	g_mutex_lock (&parallel->mutex);
+
+	parallel->done = TRUE;
+
+	while (parallel->running > 0)
+	{
+		g_cond_wait (&parallel->cond, &parallel->mutex);
+	}
+
+	g_mutex_unlock (&parallel->mutex);
+
+	parallel_unref (parallel);
+}
+
+/*
+ * _ggit_async_return_error:
+ * @task: a #GTask.
+ * @err: the libgit2 error code.
+ *
+ * Returns the error of a failed libgit2 call on @task. If the call failed
+ * because the operation was cancelled, %G_IO_ERROR_CANCELLED is returned
+ * instead.
+ */
+void
+_ggit_async_return_error (GTask *task,
+                          gint   err)
+{
+	GError *error = NULL;
+
+	if (g_task_return_error_if_cancelled (task))
+	{
+		return;
+	}
+
+	_ggit_error_set (&error, err);
+	g_task_return_error (task, error);
+}
+
+/*
+ * _ggit_async_is_cancelled:
+ *
+ * Checks whether the operation running on the current worker thread has been
+ * cancelled. Always returns %FALSE when not called from a worker thread.
+ */
+gboolean
+_ggit_async_is_cancelled (void)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+
+	return context != NULL && g_cancellable_is_cancelled (context->cancellable);
+}
+
+static gint
+transfer_progress_wrapper (const git_transfer_progress *stats,
+                           gpointer                     payload)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+
+	if (g_cancellable_is_cancelled (context->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	if (context->transfer_progress != NULL)
+	{
+		return context->transfer_progress (stats, payload);
+	}
+
+	return 0;
+}
+
+/*
+ * _ggit_async_wrap_remote_callbacks:
+ * @callbacks: the native remote callbacks used by the operation.
+ *
+ * Hooks the transfer progress callback of @callbacks so that the transfer
+ * is aborted as soon as the current operation gets cancelled. Must be called
+ * from the worker thread running the operation.
+ */
+void
+_ggit_async_wrap_remote_callbacks (git_remote_callbacks *callbacks)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+	g_return_if_fail (context != NULL);
+
+	context->transfer_progress = callbacks->transfer_progress;
+	callbacks->transfer_progress = transfer_progress_wrapper;
+}
+
+static gint
+checkout_notify_wrapper (git_checkout_notify_t  why,
+                         const gchar           *path,
+                         const git_diff_file   *baseline,
+                         const git_diff_file   *target,
+                         const git_diff_file   *workdir,
+                         gpointer               payload)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+
+	if (g_cancellable_is_cancelled (context->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	if (context->checkout_notify != NULL &&
+	    (why & context->checkout_notify_flags) != 0)
+	{
+		return context->checkout_notify (why,
+		                                 path,
+		                                 baseline,
+		                                 target,
+		                                 workdir,
+		                                 payload);
+	}
+
+	return 0;
+}
+
+/*
+ * _ggit_async_wrap_checkout_options:
+ * @options: the native checkout options used by the operation.
+ *
+ * Hooks the notify callback of @options so that the checkout is aborted
+ * before the next file gets written once the current operation has been
+ * cancelled. The original notify callback is still invoked for the
+ * notifications it asked for. Must be called from the worker thread running
+ * the operation.
+ */
+void
+_ggit_async_wrap_checkout_options (git_checkout_options *options)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+	g_return_if_fail (context != NULL);
+
+	context->checkout_notify = options->notify_cb;
+	context->checkout_notify_flags = options->notify_cb != NULL ? options->notify_flags : 0;
+
+	options->notify_cb = checkout_notify_wrapper;
+	options->notify_flags |= GIT_CHECKOUT_NOTIFY_CONFLICT |
+	                         GIT_CHECKOUT_NOTIFY_UPDATED;
+}
+
+static gint
+diff_notify_wrapper (const git_diff       *diff_so_far,
+                     const git_diff_delta *delta_to_add,
+                     const gchar          *matched_pathspec,
+                     gpointer              payload)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+
+	if (g_cancellable_is_cancelled (context->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	if (context->diff_notify != NULL)
+	{
+		return context->diff_notify (diff_so_far,
+		                             delta_to_add,
+		                             matched_pathspec,
+		                             payload);
+	}
+
+	return 0;
+}
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+static gint
+diff_progress_wrapper (const git_diff *diff_so_far,
+                       const gchar    *old_path,
+                       const gchar    *new_path,
+                       gpointer        payload)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+
+	if (g_cancellable_is_cancelled (context->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	if (context->diff_progress != NULL)
+	{
+		return context->diff_progress (diff_so_far,
+		                               old_path,
+		                               new_path,
+		                               payload);
+	}
+
+	return 0;
+}
+#endif
+
+/*
+ * _ggit_async_wrap_diff_options:
+ * @options: the native diff options used by the operation.
+ *
+ * Hooks the notify (and, when available, progress) callbacks of @options
+ * so that generating the diff is aborted once the current operation has been
+ * cancelled. Must be called from the worker thread running the operation.
+ */
+void
+_ggit_async_wrap_diff_options (git_diff_options *options)
+{
+	AsyncContext *context;
+
+	context = g_private_get (&current_context);
+	g_return_if_fail (context != NULL);
+
+	context->diff_notify = options->notify_cb;
+	options->notify_cb = diff_notify_wrapper;
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	context->diff_progress = options->progress_cb;
+	options->progress_cb = diff_progress_wrapper;
+#endif
+}
+
+/* ex:set ts=8 noet: */
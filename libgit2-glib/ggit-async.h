@@ -0,0 +1,51 @@
+/*
+ * ggit-async.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_ASYNC_H__
+#define __GGIT_ASYNC_H__
+
+#include <gio/gio.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+void     _ggit_async_run                   (GTask                *task,
+                                            GTaskThreadFunc       func);
+
+void     _ggit_async_run_parallel          (GThreadFunc           func,
+                                            gpointer              data,
+                                            guint                 n_threads);
+
+void     _ggit_async_return_error          (GTask                *task,
+                                            gint                  err);
+
+gboolean _ggit_async_is_cancelled          (void);
+
+void     _ggit_async_wrap_remote_callbacks (git_remote_callbacks *callbacks);
+
+void     _ggit_async_wrap_checkout_options (git_checkout_options *options);
+
+void     _ggit_async_wrap_diff_options     (git_diff_options     *options);
+
+G_END_DECLS
+
+#endif /* __GGIT_ASYNC_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,511 @@
+/*
+ * ggit-attribute-cache.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "ggit-attribute-cache.h"
+
+/* Caches the results of git_attr_get() by (flags, name, path).
+ *
+ * The attributes of a path depend on the .gitattributes files of all its
+ * parent directories, both in the working directory and in the index, and on
+ * $GIT_DIR/info/attributes. Every directory gets a stamp describing its
+ * .gitattributes file. Stamps are checked at most once per validation epoch
+ * and when a stamp changed, only the cached values of paths below that
+ * directory are dropped.
+ */
+
+/* Cached values are dropped all at once when reaching this many entries */
+#define MAX_ENTRIES (1 << 17)
+
+#define KEY_SEPARATOR '\x1f'
+
+typedef struct
+{
+	gboolean exists;
+	gint64 mtime;
+	gint64 ctime;
+	gint64 size;
+	guint64 inode;
+
+	/* Set when the file was modified in the second the stamp was taken,
+	 * a later rewrite could keep the same stat data.
+	 */
+	gboolean racy;
+
+	gboolean hashed;
+	git_oid content_id;
+} FileStamp;
+
+typedef struct
+{
+	guint epoch;
+
+	FileStamp file;
+
+	gboolean in_index;
+	git_oid index_id;
+} DirStamp;
+
+struct _GgitAttributeCache
+{
+	/* key (flags, name, path) -> interned value */
+	GHashTable *entries;
+
+	/* directory -> DirStamp */
+	GHashTable *dirs;
+
+	FileStamp info_attributes;
+	guint info_attributes_epoch;
+
+	GString *key;
+	GString *dir;
+
+	guint epoch;
+
+	guint64 hits;
+	guint64 misses;
+};
+
+static void
+dir_stamp_free (DirStamp *stamp)
+{
+	g_slice_free (DirStamp, stamp);
+}
+
+GgitAttributeCache *
+_ggit_attribute_cache_new (void)
+{
+	GgitAttributeCache *cache;
+
+	cache = g_slice_new0 (GgitAttributeCache);
+
+	cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                        g_free, NULL);
+
+	cache->dirs = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                     g_free,
+	                                     (GDestroyNotify)dir_stamp_free);
+
+	cache->key = g_string_new (NULL);
+	cache->dir = g_string_new (NULL);
+
+	cache->epoch = 1;
+
+	return cache;
+}
+
+void
+_ggit_attribute_cache_free (GgitAttributeCache *cache)
+{
+	if (cache == NULL)
+	{
+		return;
+	}
+
+	g_hash_table_destroy (cache->entries);
+	g_hash_table_destroy (cache->dirs);
+
+	g_string_free (cache->key, TRUE);
+	g_string_free (cache->dir, TRUE);
+
+	g_slice_free (GgitAttributeCache, cache);
+}
+
+void
+_ggit_attribute_cache_clear (GgitAttributeCache *cache)
+{
+	g_hash_table_remove_all (cache->entries);
+	g_hash_table_remove_all (cache->dirs);
+
+	cache->info_attributes_epoch = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+}
+
+/*
+ * _ggit_attribute_cache_revalidate:
+ * @cache: a #GgitAttributeCache.
+ *
+ * Starts a new validation epoch: the attribute files involved in the
+ * following lookups are checked again for changes (once each).
+ */
+void
+_ggit_attribute_cache_revalidate (GgitAttributeCache *cache)
+{
+	if (++cache->epoch == 0)
+	{
+		/* 0 means never validated */
+		cache->epoch = 1;
+	}
+}
+
+void
+_ggit_attribute_cache_get_stats (GgitAttributeCache *cache,
+                                 guint64            *hits,
+                                 guint64            *misses)
+{
+	if (hits != NULL)
+	{
+		*hits = cache->hits;
+	}
+
+	if (misses != NULL)
+	{
+		*misses = cache->misses;
+	}
+}
+
+static gint64
+stat_time_ns (time_t sec,
+              glong  nsec)
+{
+	return (gint64)sec * G_GINT64_CONSTANT (1000000000) + nsec;
+}
+
+/*
+ * Reads the stamp of @filename. When the file was modified in the current
+ * second, or @previous was, the stat data alone cannot tell a rewrite
+ * apart, so the contents are hashed too.
+ */
+static void
+file_stamp_read (const gchar     *filename,
+                 const FileStamp *previous,
+                 FileStamp       *stamp)
+{
+	GStatBuf buf;
+
+	memset (stamp, 0, sizeof (FileStamp));
+
+	if (filename == NULL || g_stat (filename, &buf) != 0)
+	{
+		return;
+	}
+
+	stamp->exists = TRUE;
+
+#ifdef __linux__
+	stamp->mtime = stat_time_ns (buf.st_mtime, buf.st_mtim.tv_nsec);
+	stamp->ctime = stat_time_ns (buf.st_ctime, buf.st_ctim.tv_nsec);
+#else
+	stamp->mtime = stat_time_ns (buf.st_mtime, 0);
+	stamp->ctime = stat_time_ns (buf.st_ctime, 0);
+#endif
+
+	stamp->size = buf.st_size;
+	stamp->inode = buf.st_ino;
+
+	stamp->racy = buf.st_mtime >= g_get_real_time () / G_USEC_PER_SEC;
+
+	if (stamp->racy || (previous != NULL && previous->racy))
+	{
+		stamp->hashed = git_odb_hashfile (&stamp->content_id,
+		                                  filename,
+		                                  GIT_OBJ_BLOB) == GIT_OK;
+	}
+}
+
+static gboolean
+file_stamp_equal (const FileStamp *a,
+                  const FileStamp *b)
+{
+	if (a->exists != b->exists ||
+	    a->mtime != b->mtime ||
+	    a->ctime != b->ctime ||
+	    a->size != b->size ||
+	    a->inode != b->inode)
+	{
+		return FALSE;
+	}
+
+	if (a->racy)
+	{
+		/* a is the older stamp, b was hashed because of it */
+		return a->hashed && b->hashed &&
+		       git_oid_equal (&a->content_id, &b->content_id);
+	}
+
+	return TRUE;
+}
+
+static void
+dir_stamp_read (git_repository *repository,
+                const gchar    *dir,
+                const DirStamp *previous,
+                DirStamp       *stamp)
+{
+	const gchar *workdir;
+	gchar *relpath;
+	git_index *index;
+
+	memset (stamp, 0, sizeof (DirStamp));
+
+	if (*dir == '\0')
+	{
+		relpath = g_strdup (".gitattributes");
+	}
+	else
+	{
+		relpath = g_strconcat (dir, "/.gitattributes", NULL);
+	}
+
+	workdir = git_repository_workdir (repository);
+
+	if (workdir != NULL)
+	{
+		gchar *filename;
+
+		filename = g_build_filename (workdir, relpath, NULL);
+		file_stamp_read (filename,
+		                 previous != NULL ? &previous->file : NULL,
+		                 &stamp->file);
+		g_free (filename);
+	}
+
+	if (git_repository_index (&index, repository) == GIT_OK)
+	{
+		const git_index_entry *entry;
+
+		entry = git_index_get_bypath (index, relpath, 0);
+
+		if (entry != NULL)
+		{
+			stamp->in_index = TRUE;
+			git_oid_cpy (&stamp->index_id, &entry->id);
+		}
+
+		git_index_free (index);
+	}
+
+	g_free (relpath);
+}
+
+static gboolean
+dir_stamp_equal (const DirStamp *a,
+                 const DirStamp *b)
+{
+	if (!file_stamp_equal (&a->file, &b->file) || a->in_index != b->in_index)
+	{
+		return FALSE;
+	}
+
+	return !a->in_index || git_oid_equal (&a->index_id, &b->index_id);
+}
+
+static const gchar *
+key_get_path (const gchar *key)
+{
+	/* key is flags, name and path separated by KEY_SEPARATOR */
+	key = strchr (key, KEY_SEPARATOR);
+	key = strchr (key + 1, KEY_SEPARATOR);
+
+	return key + 1;
+}
+
+static gboolean
+entry_is_below_dir (gpointer key,
+                    gpointer value,
+                    gpointer user_data)
+{
+	const gchar *dir = user_data;
+	const gchar *path;
+	gsize len;
+
+	path = key_get_path (key);
+	len = strlen (dir);
+
+	return strncmp (path, dir, len) == 0 && path[len] == '/';
+}
+
+static void
+invalidate_dir (GgitAttributeCache *cache,
+                const gchar        *dir)
+{
+	if (*dir == '\0')
+	{
+		g_hash_table_remove_all (cache->entries);
+	}
+	else
+	{
+		g_hash_table_foreach_remove (cache->entries,
+		                             entry_is_below_dir,
+		                             (gpointer)dir);
+	}
+}
+
+static void
+validate_dir (GgitAttributeCache *cache,
+              git_repository     *repository,
+              const gchar        *dir)
+{
+	DirStamp *stamp;
+	DirStamp current;
+
+	stamp = g_hash_table_lookup (cache->dirs, dir);
+
+	if (stamp != NULL && stamp->epoch == cache->epoch)
+	{
+		return;
+	}
+
+	dir_stamp_read (repository, dir, stamp, &current);
+
+	if (stamp == NULL)
+	{
+		/* Nothing below dir can be cached before dir got a stamp */
+		stamp = g_slice_new (DirStamp);
+		g_hash_table_insert (cache->dirs, g_strdup (dir), stamp);
+	}
+	else if (!dir_stamp_equal (stamp, &current))
+	{
+		invalidate_dir (cache, dir);
+	}
+
+	*stamp = current;
+	stamp->epoch = cache->epoch;
+}
+
+static void
+validate_info_attributes (GgitAttributeCache *cache,
+                          git_repository     *repository)
+{
+	FileStamp current;
+	gchar *filename;
+
+	if (cache->info_attributes_epoch == cache->epoch)
+	{
+		return;
+	}
+
+	filename = g_build_filename (git_repository_path (repository),
+	                             "info",
+	                             "attributes",
+	                             NULL);
+
+	file_stamp_read (filename,
+	                 cache->info_attributes_epoch != 0 ? &cache->info_attributes : NULL,
+	                 &current);
+	g_free (filename);
+
+	if (cache->info_attributes_epoch != 0 &&
+	    !file_stamp_equal (&cache->info_attributes, &current))
+	{
+		g_hash_table_remove_all (cache->entries);
+	}
+
+	cache->info_attributes = current;
+	cache->info_attributes_epoch = cache->epoch;
+}
+
+static void
+validate_path (GgitAttributeCache *cache,
+               git_repository     *repository,
+               const gchar        *path)
+{
+	const gchar *sep;
+
+	validate_info_attributes (cache, repository);
+	validate_dir (cache, repository, "");
+
+	for (sep = strchr (path, '/'); sep != NULL; sep = strchr (sep + 1, '/'))
+	{
+		g_string_truncate (cache->dir, 0);
+		g_string_append_len (cache->dir, path, sep - path);
+
+		validate_dir (cache, repository, cache->dir->str);
+	}
+}
+
+/*
+ * _ggit_attribute_cache_get:
+ * @cache: a #GgitAttributeCache.
+ * @repository: the repository @cache belongs to.
+ * @flags: the git_attr_get() flags.
+ * @path: the path relative to the working directory.
+ * @name: the attribute name.
+ * @value: (out): return location for the attribute value.
+ *
+ * Looks up an attribute like git_attr_get(). The returned value stays valid
+ * for the lifetime of the process.
+ *
+ * Returns: a libgit2 error code.
+ */
+gint
+_ggit_attribute_cache_get (GgitAttributeCache  *cache,
+                           git_repository      *repository,
+                           guint32              flags,
+                           const gchar         *path,
+                           const gchar         *name,
+                           const gchar        **value)
+{
+	gchar flags_str[16];
+	gpointer cached;
+	const char *v;
+	gint ret;
+
+	validate_path (cache, repository, path);
+
+	g_snprintf (flags_str, sizeof (flags_str), "%x", flags);
+
+	g_string_assign (cache->key, flags_str);
+	g_string_append_c (cache->key, KEY_SEPARATOR);
+	g_string_append (cache->key, name);
+	g_string_append_c (cache->key, KEY_SEPARATOR);
+	g_string_append (cache->key, path);
+
+	if (g_hash_table_lookup_extended (cache->entries, cache->key->str, NULL, &cached))
+	{
+		cache->hits++;
+		*value = cached;
+
+		return GIT_OK;
+	}
+
+	ret = git_attr_get (&v, repository, flags, path, name);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	cache->misses++;
+
+	/* true, false and unspecified are static sentinels in libgit2, other
+	 * values are owned by libgit2's own attribute file cache.
+	 */
+	if (v != NULL && GIT_ATTR_HAS_VALUE (v))
+	{
+		v = g_intern_string (v);
+	}
+
+	if (g_hash_table_size (cache->entries) >= MAX_ENTRIES)
+	{
+		g_hash_table_remove_all (cache->entries);
+	}
+
+	g_hash_table_insert (cache->entries, g_strdup (cache->key->str), (gpointer)v);
+
+	*value = v;
+
+	return GIT_OK;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,54 @@
+/*
+ * ggit-attribute-cache.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_ATTRIBUTE_CACHE_H__
+#define __GGIT_ATTRIBUTE_CACHE_H__
+
+#include <glib.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GgitAttributeCache GgitAttributeCache;
+
+GgitAttributeCache *_ggit_attribute_cache_new        (void);
+
+void                _ggit_attribute_cache_free       (GgitAttributeCache  *cache);
+
+void                _ggit_attribute_cache_clear      (GgitAttributeCache  *cache);
+
+void                _ggit_attribute_cache_revalidate (GgitAttributeCache  *cache);
+
+gint                _ggit_attribute_cache_get        (GgitAttributeCache  *cache,
+                                                      git_repository      *repository,
+                                                      guint32              flags,
+                                                      const gchar         *path,
+                                                      const gchar         *name,
+                                                      const gchar        **value);
+
+void                _ggit_attribute_cache_get_stats  (GgitAttributeCache  *cache,
+                                                      guint64             *hits,
+                                                      guint64             *misses);
+
+G_END_DECLS
+
+#endif /* __GGIT_ATTRIBUTE_CACHE_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,276 @@
+/*
+ * ggit-blob-input-stream.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggit-blob-input-stream.h"
+#include "ggit-repository.h"
+#include "ggit-error.h"
+
+#include <git2.h>
+#include <string.h>
+
+/**
+ * GgitBlobInputStream:
+ *
+ * Reads the contents of a blob.
+ *
+ * When the object database can stream the blob, which is the case for
+ * loose objects, it is inflated while being read, so reading only a prefix
+ * of a large blob does not decompress the rest of it. Otherwise the blob
+ * is loaded once and read from memory without copying.
+ */
+
+typedef struct _GgitBlobInputStreamPrivate
+{
+	GgitRepository *repository;
+
+	git_odb *odb;
+	git_odb_stream *stream;
+
+	/* Used when the blob cannot be streamed */
+	GBytes *bytes;
+
+	guint64 size;
+	guint64 offset;
+} GgitBlobInputStreamPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GgitBlobInputStream, ggit_blob_input_stream, G_TYPE_INPUT_STREAM)
+
+static gssize
+ggit_blob_input_stream_read (GInputStream  *object,
+                             void          *buffer,
+                             gsize          count,
+                             GCancellable  *cancellable,
+                             GError       **error)
+{
+	GgitBlobInputStream *stream = GGIT_BLOB_INPUT_STREAM (object);
+	GgitBlobInputStreamPrivate *priv;
+	gsize remaining;
+	gint ret;
+
+	priv = ggit_blob_input_stream_get_instance_private (stream);
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	{
+		return -1;
+	}
+
+	remaining = priv->size - priv->offset;
+	count = MIN (count, remaining);
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	if (priv->bytes != NULL)
+	{
+		const guchar *data;
+
+		data = g_bytes_get_data (priv->bytes, NULL);
+		memcpy (buffer, data + priv->offset, count);
+	}
+	else
+	{
+		count = MIN (count, G_MAXINT);
+		ret = git_odb_stream_read (priv->stream, buffer, count);
+
+		if (ret < 0)
+		{
+			_ggit_error_set (error, ret);
+			return -1;
+		}
+
+		count = ret;
+	}
+
+	priv->offset += count;
+
+	return count;
+}
+
+static gssize
+ggit_blob_input_stream_skip (GInputStream  *object,
+                             gsize          count,
+                             GCancellable  *cancellable,
+                             GError       **error)
+{
+	GgitBlobInputStream *stream = GGIT_BLOB_INPUT_STREAM (object);
+	GgitBlobInputStreamPrivate *priv;
+
+	priv = ggit_blob_input_stream_get_instance_private (stream);
+
+	/* A streamed blob has to be inflated up to the new position anyway */
+	if (priv->bytes == NULL)
+	{
+		return G_INPUT_STREAM_CLASS (ggit_blob_input_stream_parent_class)->skip (object,
+		                                                                          count,
+		                                                                          cancellable,
+		                                                                          error);
+	}
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	{
+		return -1;
+	}
+
+	count = MIN (count, priv->size - priv->offset);
+	priv->offset += count;
+
+	return count;
+}
+
+static gboolean
+ggit_blob_input_stream_close (GInputStream  *object,
+                              GCancellable  *cancellable,
+                              GError       **error)
+{
+	GgitBlobInputStream *stream = GGIT_BLOB_INPUT_STREAM (object);
+	GgitBlobInputStreamPrivate *priv;
+
+	priv = ggit_blob_input_stream_get_instance_private (stream);
+
+	g_clear_pointer (&priv->stream, git_odb_stream_free);
+	g_clear_pointer (&priv->bytes, g_bytes_unref);
+
+	return TRUE;
+}
+
+static void
+ggit_blob_input_stream_finalize (GObject *object)
+{
+	GgitBlobInputStream *stream;
+	GgitBlobInputStreamPrivate *priv;
+
+	stream = GGIT_BLOB_INPUT_STREAM (object);
+	priv = ggit_blob_input_stream_get_instance_private (stream);
+
+	g_clear_pointer (&priv->stream, git_odb_stream_free);
+	g_clear_pointer (&priv->bytes, g_bytes_unref);
+	g_clear_pointer (&priv->odb, git_odb_free);
+	g_clear_object (&priv->repository);
+
+	G_OBJECT_CLASS (ggit_blob_input_stream_parent_class)->finalize (object);
+}
+
+static void
+ggit_blob_input_stream_class_init (GgitBlobInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+
+	object_class->finalize = ggit_blob_input_stream_finalize;
+
+	stream_class->read_fn = ggit_blob_input_stream_read;
+	stream_class->skip = ggit_blob_input_stream_skip;
+	stream_class->close_fn = ggit_blob_input_stream_close;
+}
+
+static void
+ggit_blob_input_stream_init (GgitBlobInputStream *stream)
+{
+}
+
+static void
+free_blob (gpointer blob)
+{
+	git_blob_free (blob);
+}
+
+GgitBlobInputStream *
+_ggit_blob_input_stream_new (GgitRepository  *repository,
+                             const git_oid   *oid,
+                             GError         **error)
+{
+	GgitBlobInputStream *stream;
+	GgitBlobInputStreamPrivate *priv;
+	git_repository *repo;
+	git_blob *blob;
+	gint ret;
+
+	repo = _ggit_native_get (repository);
+
+	stream = g_object_new (GGIT_TYPE_BLOB_INPUT_STREAM, NULL);
+	priv = ggit_blob_input_stream_get_instance_private (stream);
+
+	priv->repository = g_object_ref (repository);
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	if (git_repository_odb (&priv->odb, repo) == GIT_OK)
+	{
+		git_otype type;
+		size_t size;
+
+		/* Only some backends, such as the one for loose objects,
+		 * can stream; packed objects are read as a whole below. */
+		if (git_odb_open_rstream (&priv->stream, &size, &type, priv->odb, oid) == GIT_OK)
+		{
+			if (type == GIT_OBJ_BLOB)
+			{
+				priv->size = size;
+				return stream;
+			}
+
+			g_clear_pointer (&priv->stream, git_odb_stream_free);
+		}
+
+		git_error_clear ();
+	}
+#endif
+
+	ret = git_blob_lookup (&blob, repo, oid);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		g_object_unref (stream);
+
+		return NULL;
+	}
+
+	priv->size = git_blob_rawsize (blob);
+	priv->bytes = g_bytes_new_with_free_func (git_blob_rawcontent (blob),
+	                                          priv->size,
+	                                          free_blob,
+	                                          blob);
+
+	return stream;
+}
+
+/**
+ * ggit_blob_input_stream_get_size:
+ * @stream: a #GgitBlobInputStream.
+ *
+ * Gets the size of the blob, which is known before it is read.
+ *
+ * Returns: the size of the blob in bytes.
+ */
+guint64
+ggit_blob_input_stream_get_size (GgitBlobInputStream *stream)
+{
+	GgitBlobInputStreamPrivate *priv;
+
+	g_return_val_if_fail (GGIT_IS_BLOB_INPUT_STREAM (stream), 0);
+
+	priv = ggit_blob_input_stream_get_instance_private (stream);
+
+	return priv->size;
+}
+
+/* ex:set ts=8 noet: */
@@ -19,6 +19,7 @@
  */
 
 #include "ggit-blob-output-stream.h"
+#include "ggit-async.h"
 #include "ggit-repository.h"
 #include "ggit-oid.h"
 #include "ggit-error.h"
@@ -26,10 +27,17 @@
 #include <git2.h>
 #include <string.h>
 
+#define SPLICE_CHUNK_SIZE (64 * 1024)
+
 /**
  * GgitBlobOutputStream:
  *
  * Represents a blob stream object.
+ *
+ * When the size of the blob is known in advance, see
+ * ggit_repository_create_blob_with_size(), the contents are hashed and
+ * compressed as they are written, without keeping a temporary copy of the
+ * whole blob, as far as the object database allows it.
  */
 
 typedef struct _GgitBlobOutputStreamPrivate
@@ -38,6 +46,21 @@ typedef struct _GgitBlobOutputStreamPrivate
 
 	git_writestream *stream;
 	gboolean something_written;
+	gboolean closed;
+
+	/* Used when the size is known */
+	gint64 size;
+	git_odb *odb;
+	git_odb_stream *odb_stream;
+
+	guint64 bytes_written;
+
+	/* Progress from other threads is reported in the context the
+	 * stream was created in. */
+	GMainContext *context;
+	GThread *thread;
+	GMutex progress_mutex;
+	gboolean progress_pending;
 
 	gint ret;
 	GgitOId *oid;
@@ -48,9 +71,97 @@ G_DEFINE_TYPE_WITH_PRIVATE (GgitBlobOutputStream, ggit_blob_output_stream, G_TYP
 enum
 {
 	PROP_0,
-	PROP_REPOSITORY
+	PROP_REPOSITORY,
+	PROP_SIZE,
+	PROP_BYTES_WRITTEN
 };
 
+enum
+{
+	PROGRESS,
+	NUM_SIGNALS
+};
+
+static guint signals[NUM_SIGNALS] = { 0 };
+
+typedef struct
+{
+	gconstpointer buffer;
+	gsize count;
+} WriteData;
+
+typedef struct
+{
+	GInputStream *source;
+	GOutputStreamSpliceFlags flags;
+} SpliceData;
+
+static gboolean
+emit_progress (gpointer user_data)
+{
+	GgitBlobOutputStream *stream = GGIT_BLOB_OUTPUT_STREAM (user_data);
+	GgitBlobOutputStreamPrivate *priv;
+	guint64 bytes_written;
+
+	priv = ggit_blob_output_stream_get_instance_private (stream);
+
+	g_mutex_lock (&priv->progress_mutex);
+	priv->progress_pending = FALSE;
+	bytes_written = priv->bytes_written;
+	g_mutex_unlock (&priv->progress_mutex);
+
+	g_signal_emit (stream, signals[PROGRESS], 0, bytes_written);
+	g_object_notify (G_OBJECT (stream), "bytes-written");
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+add_bytes_written (GgitBlobOutputStream *stream,
+                   gsize                 count)
+{
+	GgitBlobOutputStreamPrivate *priv;
+	gboolean schedule = FALSE;
+	gboolean same_thread;
+
+	priv = ggit_blob_output_stream_get_instance_private (stream);
+	same_thread = g_thread_self () == priv->thread;
+
+	g_mutex_lock (&priv->progress_mutex);
+
+	priv->bytes_written += count;
+
+	if (same_thread)
+	{
+		priv->progress_pending = TRUE;
+	}
+	else if (!priv->progress_pending)
+	{
+		/* Writes of an async operation are coalesced */
+		priv->progress_pending = TRUE;
+		schedule = TRUE;
+	}
+
+	g_mutex_unlock (&priv->progress_mutex);
+
+	if (same_thread)
+	{
+		emit_progress (stream);
+	}
+	else if (schedule)
+	{
+		GSource *source;
+
+		source = g_idle_source_new ();
+		g_source_set_callback (source,
+		                       emit_progress,
+		                       g_object_ref (stream),
+		                       g_object_unref);
+		g_source_attach (source, priv->context);
+		g_source_unref (source);
+	}
+}
+
 static gboolean
 ggit_blob_output_stream_close (GOutputStream  *object,
                                GCancellable   *cancellable,
@@ -66,12 +177,30 @@ ggit_blob_output_stream_close (GOutputStream  *object,
 		return FALSE;
 	}
 
-	if (priv->ret != GIT_OK)
+	/* A splice closing the target cannot mark the stream as closed,
+	 * so it may get closed again. */
+	if (priv->ret != GIT_OK || priv->closed)
 	{
 		return TRUE;
 	}
 
-	if (priv->something_written)
+	priv->closed = TRUE;
+
+	if (priv->odb_stream != NULL)
+	{
+		git_oid oid;
+
+		priv->ret = git_odb_stream_finalize_write (&oid, priv->odb_stream);
+
+		if (priv->ret != GIT_OK)
+		{
+			_ggit_error_set (error, priv->ret);
+			return FALSE;
+		}
+
+		priv->oid = _ggit_oid_wrap (&oid);
+	}
+	else if (priv->something_written)
 	{
 		git_oid oid;
 
@@ -141,7 +270,22 @@ ggit_blob_output_stream_write (GOutputStream  *object,
 		return 0;
 	}
 
-	if (count > 0)
+	if (priv->odb_stream != NULL)
+	{
+		if (priv->bytes_written + count > (guint64)priv->size)
+		{
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+			             "Could not write more than the declared blob size");
+			return -1;
+		}
+
+		if (git_odb_stream_write (priv->odb_stream, buffer, count) == GIT_OK)
+		{
+			add_bytes_written (stream, count);
+			return count;
+		}
+	}
+	else if (count > 0)
 	{
 		gint ret = 0;
 
@@ -150,6 +294,7 @@ ggit_blob_output_stream_write (GOutputStream  *object,
 		if (ret == GIT_OK)
 		{
 			priv->something_written = TRUE;
+			add_bytes_written (stream, count);
 			return count;
 		}
 	}
@@ -160,6 +305,207 @@ ggit_blob_output_stream_write (GOutputStream  *object,
 	return -1;
 }
 
+static gssize
+ggit_blob_output_stream_splice (GOutputStream             *object,
+                                GInputStream              *source,
+                                GOutputStreamSpliceFlags   flags,
+                                GCancellable              *cancellable,
+                                GError                   **error)
+{
+	GOutputStreamClass *klass = G_OUTPUT_STREAM_GET_CLASS (object);
+	gchar *buffer;
+	gssize total = 0;
+	gboolean ok = TRUE;
+
+	/* Large chunks mean fewer calls into libgit2, and bound the memory
+	 * used however large the source is. */
+	buffer = g_malloc (SPLICE_CHUNK_SIZE);
+
+	while (ok)
+	{
+		gssize n_read;
+		gssize offset = 0;
+
+		n_read = g_input_stream_read (source, buffer, SPLICE_CHUNK_SIZE, cancellable, error);
+
+		if (n_read < 0)
+		{
+			ok = FALSE;
+			break;
+		}
+
+		if (n_read == 0)
+		{
+			break;
+		}
+
+		while (offset < n_read)
+		{
+			gssize n_written;
+
+			n_written = klass->write_fn (object, buffer + offset, n_read - offset, cancellable, error);
+
+			if (n_written < 0)
+			{
+				ok = FALSE;
+				break;
+			}
+
+			offset += n_written;
+		}
+
+		total += n_read;
+	}
+
+	g_free (buffer);
+
+	if (flags & G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE)
+	{
+		/* Don't care about errors in source here */
+		g_input_stream_close (source, cancellable, NULL);
+	}
+
+	if (flags & G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET)
+	{
+		/* But write errors on close are bad! */
+		if (!klass->close_fn (object, cancellable, ok ? error : NULL))
+		{
+			ok = FALSE;
+		}
+	}
+
+	return ok ? MIN (total, G_MAXSSIZE) : -1;
+}
+
+static void
+write_thread (GTask        *task,
+              gpointer      source_object,
+              gpointer      task_data,
+              GCancellable *cancellable)
+{
+	WriteData *data = task_data;
+	GError *error = NULL;
+	gssize ret;
+
+	ret = ggit_blob_output_stream_write (G_OUTPUT_STREAM (source_object),
+	                                     data->buffer,
+	                                     data->count,
+	                                     cancellable,
+	                                     &error);
+
+	if (ret < 0)
+	{
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_return_int (task, ret);
+	}
+}
+
+static void
+ggit_blob_output_stream_write_async (GOutputStream       *object,
+                                     const void          *buffer,
+                                     gsize                count,
+                                     int                  io_priority,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+	GTask *task;
+	WriteData *data;
+
+	data = g_new (WriteData, 1);
+	data->buffer = buffer;
+	data->count = count;
+
+	task = g_task_new (object, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_blob_output_stream_write_async);
+	g_task_set_priority (task, io_priority);
+	g_task_set_task_data (task, data, (GDestroyNotify)g_free);
+
+	_ggit_async_run (task, write_thread);
+	g_object_unref (task);
+}
+
+static gssize
+ggit_blob_output_stream_write_finish (GOutputStream  *object,
+                                      GAsyncResult   *result,
+                                      GError        **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, object), -1);
+
+	return g_task_propagate_int (G_TASK (result), error);
+}
+
+static void
+splice_data_free (SpliceData *data)
+{
+	g_object_unref (data->source);
+	g_slice_free (SpliceData, data);
+}
+
+static void
+splice_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+	SpliceData *data = task_data;
+	GError *error = NULL;
+	gssize ret;
+
+	ret = ggit_blob_output_stream_splice (G_OUTPUT_STREAM (source_object),
+	                                      data->source,
+	                                      data->flags,
+	                                      cancellable,
+	                                      &error);
+
+	if (ret < 0)
+	{
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_return_int (task, ret);
+	}
+}
+
+static void
+ggit_blob_output_stream_splice_async (GOutputStream            *object,
+                                      GInputStream             *source,
+                                      GOutputStreamSpliceFlags  flags,
+                                      int                       io_priority,
+                                      GCancellable             *cancellable,
+                                      GAsyncReadyCallback       callback,
+                                      gpointer                  user_data)
+{
+	GTask *task;
+	SpliceData *data;
+
+	data = g_slice_new (SpliceData);
+	data->source = g_object_ref (source);
+	data->flags = flags;
+
+	task = g_task_new (object, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_blob_output_stream_splice_async);
+	g_task_set_priority (task, io_priority);
+	g_task_set_task_data (task, data, (GDestroyNotify)splice_data_free);
+
+	_ggit_async_run (task, splice_thread);
+	g_object_unref (task);
+}
+
+static gssize
+ggit_blob_output_stream_splice_finish (GOutputStream  *object,
+                                       GAsyncResult   *result,
+                                       GError        **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, object), -1);
+
+	return g_task_propagate_int (G_TASK (result), error);
+}
+
 static void
 ggit_blob_output_stream_finalize (GObject *object)
 {
@@ -174,12 +520,17 @@ ggit_blob_output_stream_finalize (GObject *object)
 	{
 		ggit_oid_free (priv->oid);
 	}
-	else
+	else if (priv->stream != NULL)
 	{
 		/* NOTE: if we have an oid the stream is already freed */
 		priv->stream->free (priv->stream);
 	}
 
+	g_clear_pointer (&priv->odb_stream, git_odb_stream_free);
+	g_clear_pointer (&priv->odb, git_odb_free);
+	g_clear_pointer (&priv->context, g_main_context_unref);
+	g_mutex_clear (&priv->progress_mutex);
+
 	g_clear_object (&priv->repository);
 
 	G_OBJECT_CLASS (ggit_blob_output_stream_parent_class)->finalize (object);
@@ -202,6 +553,9 @@ ggit_blob_output_stream_set_property (GObject      *object,
 		g_clear_object (&priv->repository);
 		priv->repository = g_value_dup_object (value);
 		break;
+	case PROP_SIZE:
+		priv->size = g_value_get_int64 (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -214,8 +568,19 @@ ggit_blob_output_stream_get_property (GObject    *object,
                                       GValue     *value,
                                       GParamSpec *pspec)
 {
+	GgitBlobOutputStream *stream = GGIT_BLOB_OUTPUT_STREAM (object);
+	GgitBlobOutputStreamPrivate *priv;
+
+	priv = ggit_blob_output_stream_get_instance_private (stream);
+
 	switch (prop_id)
 	{
+	case PROP_SIZE:
+		g_value_set_int64 (value, priv->size);
+		break;
+	case PROP_BYTES_WRITTEN:
+		g_value_set_uint64 (value, ggit_blob_output_stream_get_bytes_written (stream));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -231,9 +596,28 @@ ggit_blob_output_stream_constructed (GObject *object)
 	stream = GGIT_BLOB_OUTPUT_STREAM (object);
 	priv = ggit_blob_output_stream_get_instance_private (stream);
 
-	priv->ret = git_blob_create_fromstream (&priv->stream,
-	                                        _ggit_native_get (priv->repository),
-	                                       NULL);
+	if (priv->size >= 0)
+	{
+		/* The loose object backend compresses straight to its
+		 * temporary file; backends without streaming support get
+		 * the whole blob in memory from libgit2. */
+		priv->ret = git_repository_odb (&priv->odb,
+		                                _ggit_native_get (priv->repository));
+
+		if (priv->ret == GIT_OK)
+		{
+			priv->ret = git_odb_open_wstream (&priv->odb_stream,
+			                                  priv->odb,
+			                                  priv->size,
+			                                  GIT_OBJ_BLOB);
+		}
+	}
+	else
+	{
+		priv->ret = git_blob_create_fromstream (&priv->stream,
+		                                        _ggit_native_get (priv->repository),
+		                                       NULL);
+	}
 
 	G_OBJECT_CLASS (ggit_blob_output_stream_parent_class)->constructed (object);
 }
@@ -252,6 +636,11 @@ ggit_blob_output_stream_class_init (GgitBlobOutputStreamClass *klass)
 	stream_class->write_fn = ggit_blob_output_stream_write;
 	stream_class->close_fn = ggit_blob_output_stream_close;
 	stream_class->flush = ggit_blob_output_stream_flush;
+	stream_class->splice = ggit_blob_output_stream_splice;
+	stream_class->write_async = ggit_blob_output_stream_write_async;
+	stream_class->write_finish = ggit_blob_output_stream_write_finish;
+	stream_class->splice_async = ggit_blob_output_stream_splice_async;
+	stream_class->splice_finish = ggit_blob_output_stream_splice_finish;
 
 	g_object_class_install_property (object_class,
 	                                 PROP_REPOSITORY,
@@ -262,11 +651,63 @@ ggit_blob_output_stream_class_init (GgitBlobOutputStreamClass *klass)
 	                                                      G_PARAM_WRITABLE |
 	                                                      G_PARAM_CONSTRUCT_ONLY |
 	                                                      G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_SIZE,
+	                                 g_param_spec_int64 ("size",
+	                                                     "Size",
+	                                                     "The declared size of the blob, or -1 if unknown",
+	                                                     -1,
+	                                                     G_MAXINT64,
+	                                                     -1,
+	                                                     G_PARAM_READWRITE |
+	                                                     G_PARAM_CONSTRUCT_ONLY |
+	                                                     G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_BYTES_WRITTEN,
+	                                 g_param_spec_uint64 ("bytes-written",
+	                                                      "Bytes written",
+	                                                      "The number of bytes hashed so far",
+	                                                      0,
+	                                                      G_MAXUINT64,
+	                                                      0,
+	                                                      G_PARAM_READABLE |
+	                                                      G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GgitBlobOutputStream::progress:
+	 * @stream: a #GgitBlobOutputStream.
+	 * @bytes_written: the number of bytes hashed so far.
+	 *
+	 * Emitted after contents were written to the blob. Writes done by
+	 * g_output_stream_write_async() or g_output_stream_splice_async()
+	 * are reported in the main context the stream was created in, and
+	 * may be coalesced.
+	 */
+	signals[PROGRESS] =
+		g_signal_new ("progress",
+		              G_TYPE_FROM_CLASS (klass),
+		              G_SIGNAL_RUN_LAST,
+		              0,
+		              NULL, NULL,
+		              NULL,
+		              G_TYPE_NONE,
+		              1,
+		              G_TYPE_UINT64);
 }
 
 static void
 ggit_blob_output_stream_init (GgitBlobOutputStream *stream)
 {
+	GgitBlobOutputStreamPrivate *priv;
+
+	priv = ggit_blob_output_stream_get_instance_private (stream);
+
+	priv->size = -1;
+	priv->context = g_main_context_ref_thread_default ();
+	priv->thread = g_thread_self ();
+	g_mutex_init (&priv->progress_mutex);
 }
 
 GgitBlobOutputStream *
@@ -277,6 +718,16 @@ _ggit_blob_output_stream_new (GgitRepository  *repository)
 	                     NULL);
 }
 
+GgitBlobOutputStream *
+_ggit_blob_output_stream_new_with_size (GgitRepository *repository,
+                                        guint64         size)
+{
+	return g_object_new (GGIT_TYPE_BLOB_OUTPUT_STREAM,
+	                     "repository", repository,
+	                     "size", (gint64)size,
+	                     NULL);
+}
+
 /**
  * ggit_blob_output_stream_get_id:
  * @stream: a #GgitBlobOutputStream.
@@ -308,4 +759,30 @@ ggit_blob_output_stream_get_id (GgitBlobOutputStream  *stream,
 	return ggit_oid_copy (priv->oid);
 }
 
+/**
+ * ggit_blob_output_stream_get_bytes_written:
+ * @stream: a #GgitBlobOutputStream.
+ *
+ * Gets the number of bytes written to the blob so far. This may be read
+ * from any thread while an asynchronous write or splice is running.
+ *
+ * Returns: the number of bytes written.
+ */
+guint64
+ggit_blob_output_stream_get_bytes_written (GgitBlobOutputStream *stream)
+{
+	GgitBlobOutputStreamPrivate *priv;
+	guint64 bytes_written;
+
+	g_return_val_if_fail (GGIT_IS_BLOB_OUTPUT_STREAM (stream), 0);
+
+	priv = ggit_blob_output_stream_get_instance_private (stream);
+
+	g_mutex_lock (&priv->progress_mutex);
+	bytes_written = priv->bytes_written;
+	g_mutex_unlock (&priv->progress_mutex);
+
+	return bytes_written;
+}
+
 /* ex:set ts=8 noet: */
@@ -46,9 +46,14 @@ struct _GgitBlobOutputStreamClass
 
 GgitBlobOutputStream *_ggit_blob_output_stream_new              (GgitRepository *repository);
 
+GgitBlobOutputStream *_ggit_blob_output_stream_new_with_size    (GgitRepository *repository,
+                                                                 guint64         size);
+
 GgitOId               *ggit_blob_output_stream_get_id           (GgitBlobOutputStream  *stream,
                                                                  GError               **error);
 
+guint64                ggit_blob_output_stream_get_bytes_written (GgitBlobOutputStream *stream);
+
 G_END_DECLS
 
 #endif /* __GGIT_BLOB_OUTPUT_STREAM_H__ */
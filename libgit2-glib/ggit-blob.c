@@ -96,6 +96,43 @@ ggit_blob_get_raw_content (GgitBlob *blob,
 	return (const guchar *)git_blob_rawcontent (b);
 }
 
+static void
+free_blob (gpointer blob)
+{
+	git_object_free (blob);
+}
+
+/**
+ * ggit_blob_get_content_bytes:
+ * @blob: a #GgitBlob.
+ *
+ * Gets the contents of @blob without copying them. Unlike
+ * ggit_blob_get_raw_content(), the returned bytes keep the underlying
+ * object alive and remain valid after @blob is released.
+ *
+ * Returns: (transfer full): the contents of @blob.
+ */
+GBytes *
+ggit_blob_get_content_bytes (GgitBlob *blob)
+{
+	git_blob *b;
+	git_object *dup;
+
+	g_return_val_if_fail (GGIT_IS_BLOB (blob), NULL);
+
+	b = _ggit_native_get (blob);
+
+	if (git_object_dup (&dup, (git_object *)b) != GIT_OK)
+	{
+		return g_bytes_new (git_blob_rawcontent (b), git_blob_rawsize (b));
+	}
+
+	return g_bytes_new_with_free_func (git_blob_rawcontent (b),
+	                                   git_blob_rawsize (b),
+	                                   free_blob,
+	                                   dup);
+}
+
 /**
  * ggit_blob_is_binary:
  * @blob: a #GgitBlob.
@@ -39,6 +39,8 @@ GgitBlob        *_ggit_blob_wrap             (git_blob *blob,
 const guchar     *ggit_blob_get_raw_content  (GgitBlob *blob,
                                               gsize    *length);
 
+GBytes           *ggit_blob_get_content_bytes (GgitBlob *blob);
+
 gboolean          ggit_blob_is_binary        (GgitBlob *blob);
 
 G_END_DECLS
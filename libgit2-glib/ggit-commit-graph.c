@@ -0,0 +1,1717 @@
+/*
+ * ggit-commit-graph.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <string.h>
+
+#include "ggit-commit-graph.h"
+#include "ggit-error.h"
+#include "ggit-oid.h"
+#include "ggit-oid-table.h"
+
+/* The layout of the file is git's commit-graph format, version 1 with
+ * SHA-1 ids, see Documentation/technical/commit-graph-format.txt in git.
+ */
+#define GRAPH_SIGNATURE 0x43475048 /* "CGPH" */
+#define GRAPH_VERSION 1
+#define GRAPH_HASH_SHA1 1
+
+#define CHUNK_OIDF 0x4f494446
+#define CHUNK_OIDL 0x4f49444c
+#define CHUNK_CDAT 0x43444154
+#define CHUNK_EDGE 0x45444745
+
+#define HEADER_SIZE 8
+#define CHUNK_ENTRY_SIZE 12
+#define FANOUT_SIZE (256 * 4)
+#define DATA_SIZE (GIT_OID_RAWSZ + 16)
+
+#define PARENT_NONE 0x70000000
+#define PARENT_EXTRA 0x80000000
+#define GENERATION_MAX 0x3fffffff
+#define TIME_MAX G_GINT64_CONSTANT (0x3ffffffff)
+
+/* Walk flags, one byte per commit of the graph */
+#define FLAG_ONE (1 << 0)
+#define FLAG_TWO (1 << 1)
+#define FLAG_BOTH (FLAG_ONE | FLAG_TWO)
+#define FLAG_QUEUED (1 << 2)
+#define FLAG_DONE (1 << 3)
+
+/**
+ * GgitCommitGraph:
+ *
+ * A memory mapped commit-graph file, an index of the commits of a
+ * repository storing the position of their parents, their tree, their
+ * commit time and their generation number. Graph queries such as
+ * ggit_repository_get_ahead_behind() use it instead of parsing commits
+ * from the object database when it is up to date.
+ */
+struct _GgitCommitGraph
+{
+	gint ref_count;
+
+	GMappedFile *file;
+
+	const guint8 *fanout;
+	const guint8 *ids;
+	const guint8 *data;
+	const guint8 *edges;
+	gsize n_edges;
+
+	guint32 n_commits;
+
+	/* Identity of the file, to notice when it is replaced */
+	guint64 dev;
+	guint64 ino;
+	gint64 mtime;
+	gint64 size;
+};
+
+typedef struct
+{
+	guint32 generation;
+	guint32 position;
+} QueueItem;
+
+/* A walk of the graph by decreasing generation. Since a commit always has
+ * a higher generation than its parents, a commit is only taken out of the
+ * queue once all its descendants in the walk have been.
+ */
+typedef struct
+{
+	GgitCommitGraph *graph;
+
+	guint8 *flags;
+	GArray *queue;
+	GArray *parents;
+
+	/* Number of queued commits reached from only one side */
+	guint n_single;
+
+	/* Number of queued commits reached from only the first side */
+	guint n_one;
+} GraphWalk;
+
+G_DEFINE_BOXED_TYPE (GgitCommitGraph, ggit_commit_graph,
+                     ggit_commit_graph_ref, ggit_commit_graph_unref)
+
+static inline guint32
+read_be32 (const guint8 *data)
+{
+	guint32 value;
+
+	memcpy (&value, data, sizeof (value));
+
+	return GUINT32_FROM_BE (value);
+}
+
+static inline guint64
+read_be64 (const guint8 *data)
+{
+	guint64 value;
+
+	memcpy (&value, data, sizeof (value));
+
+	return GUINT64_FROM_BE (value);
+}
+
+static void
+append_be32 (GByteArray *array,
+             guint32     value)
+{
+	value = GUINT32_TO_BE (value);
+	g_byte_array_append (array, (const guint8 *)&value, sizeof (value));
+}
+
+static void
+append_be64 (GByteArray *array,
+             guint64     value)
+{
+	value = GUINT64_TO_BE (value);
+	g_byte_array_append (array, (const guint8 *)&value, sizeof (value));
+}
+
+static gint64
+stat_mtime (const GStatBuf *st)
+{
+	gint64 mtime = (gint64)st->st_mtime * G_GINT64_CONSTANT (1000000000);
+
+#ifdef __linux__
+	mtime += st->st_mtim.tv_nsec;
+#endif
+
+	return mtime;
+}
+
+static gboolean
+parse_graph (GgitCommitGraph *graph)
+{
+	const guint8 *contents;
+	gsize size;
+	guint64 ids_size = 0;
+	guint64 data_size = 0;
+	guint64 edges_size = 0;
+	guint n_chunks;
+	guint i;
+
+	contents = (const guint8 *)g_mapped_file_get_contents (graph->file);
+	size = g_mapped_file_get_length (graph->file);
+
+	if (contents == NULL ||
+	    size < HEADER_SIZE + CHUNK_ENTRY_SIZE + GIT_OID_RAWSZ)
+	{
+		return FALSE;
+	}
+
+	if (read_be32 (contents) != GRAPH_SIGNATURE ||
+	    contents[4] != GRAPH_VERSION ||
+	    contents[5] != GRAPH_HASH_SHA1)
+	{
+		return FALSE;
+	}
+
+	/* Split graphs (a chain of graph files) are not supported */
+	if (contents[7] != 0)
+	{
+		return FALSE;
+	}
+
+	/* The chunk offsets end before the trailing checksum */
+	n_chunks = contents[6];
+	size -= GIT_OID_RAWSZ;
+
+	if (HEADER_SIZE + (n_chunks + 1) * CHUNK_ENTRY_SIZE > size)
+	{
+		return FALSE;
+	}
+
+	for (i = 0; i < n_chunks; i++)
+	{
+		const guint8 *entry = contents + HEADER_SIZE + i * CHUNK_ENTRY_SIZE;
+		guint64 offset;
+		guint64 end;
+
+		offset = read_be64 (entry + 4);
+		end = read_be64 (entry + CHUNK_ENTRY_SIZE + 4);
+
+		if (offset > end || end > size)
+		{
+			return FALSE;
+		}
+
+		switch (read_be32 (entry))
+		{
+		case CHUNK_OIDF:
+			if (end - offset != FANOUT_SIZE)
+			{
+				return FALSE;
+			}
+
+			graph->fanout = contents + offset;
+			break;
+		case CHUNK_OIDL:
+			graph->ids = contents + offset;
+			ids_size = end - offset;
+			break;
+		case CHUNK_CDAT:
+			graph->data = contents + offset;
+			data_size = end - offset;
+			break;
+		case CHUNK_EDGE:
+			graph->edges = contents + offset;
+			edges_size = end - offset;
+			break;
+		default:
+			/* Optional chunks of later versions of git */
+			break;
+		}
+	}
+
+	if (graph->fanout == NULL || graph->ids == NULL || graph->data == NULL)
+	{
+		return FALSE;
+	}
+
+	graph->n_commits = read_be32 (graph->fanout + 255 * 4);
+	graph->n_edges = edges_size / 4;
+
+	return ids_size == (guint64)graph->n_commits * GIT_OID_RAWSZ &&
+	       data_size == (guint64)graph->n_commits * DATA_SIZE;
+}
+
+/**
+ * _ggit_commit_graph_get_path:
+ * @repository: a #git_repository.
+ *
+ * Gets the path of the commit-graph file of @repository, which may not
+ * exist.
+ *
+ * Returns: (transfer full): the path of the file.
+ */
+gchar *
+_ggit_commit_graph_get_path (git_repository *repository)
+{
+	return g_build_filename (git_repository_path (repository),
+	                         "objects",
+	                         "info",
+	                         "commit-graph",
+	                         NULL);
+}
+
+/**
+ * _ggit_commit_graph_open:
+ * @path: the path of a commit-graph file.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Maps the commit-graph file at @path.
+ *
+ * Returns: (transfer full) (nullable): a #GgitCommitGraph or %NULL if the
+ * file does not exist or is not a supported commit-graph.
+ */
+GgitCommitGraph *
+_ggit_commit_graph_open (const gchar  *path,
+                         GError      **error)
+{
+	GgitCommitGraph *graph;
+	GMappedFile *file;
+	GStatBuf st;
+
+	if (g_stat (path, &st) != 0)
+	{
+		gint errsv = errno;
+
+		g_set_error (error,
+		             G_IO_ERROR,
+		             g_io_error_from_errno (errsv),
+		             "Could not open %s: %s",
+		             path,
+		             g_strerror (errsv));
+
+		return NULL;
+	}
+
+	file = g_mapped_file_new (path, FALSE, error);
+
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	graph = g_slice_new0 (GgitCommitGraph);
+	graph->ref_count = 1;
+	graph->file = file;
+
+	graph->dev = st.st_dev;
+	graph->ino = st.st_ino;
+	graph->mtime = stat_mtime (&st);
+	graph->size = st.st_size;
+
+	if (!parse_graph (graph))
+	{
+		g_set_error (error,
+		             G_IO_ERROR,
+		             G_IO_ERROR_INVALID_DATA,
+		             "Unsupported commit-graph file %s",
+		             path);
+
+		ggit_commit_graph_unref (graph);
+		return NULL;
+	}
+
+	return graph;
+}
+
+/**
+ * _ggit_commit_graph_is_current:
+ * @graph: a #GgitCommitGraph.
+ * @st: the current status of the file of @graph.
+ *
+ * Checks whether the file of @graph was replaced or modified since it was
+ * mapped.
+ *
+ * Returns: %TRUE if @graph is still the content of the file.
+ */
+gboolean
+_ggit_commit_graph_is_current (GgitCommitGraph *graph,
+                               const GStatBuf  *st)
+{
+	return graph->dev == (guint64)st->st_dev &&
+	       graph->ino == (guint64)st->st_ino &&
+	       graph->mtime == stat_mtime (st) &&
+	       graph->size == (gint64)st->st_size;
+}
+
+/**
+ * _ggit_commit_graph_get_checksum:
+ * @graph: a #GgitCommitGraph.
+ *
+ * Gets the trailing checksum of the file of @graph, which identifies its
+ * content.
+ *
+ * Returns: (transfer none): the 20 byte checksum.
+ */
+const guint8 *
+_ggit_commit_graph_get_checksum (GgitCommitGraph *graph)
+{
+	return (const guint8 *)g_mapped_file_get_contents (graph->file) +
+	       g_mapped_file_get_length (graph->file) - GIT_OID_RAWSZ;
+}
+
+/**
+ * ggit_commit_graph_ref:
+ * @graph: a #GgitCommitGraph.
+ *
+ * Atomically increments the reference count of @graph by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitCommitGraph.
+ */
+GgitCommitGraph *
+ggit_commit_graph_ref (GgitCommitGraph *graph)
+{
+	g_return_val_if_fail (graph != NULL, NULL);
+
+	g_atomic_int_inc (&graph->ref_count);
+
+	return graph;
+}
+
+/**
+ * ggit_commit_graph_unref:
+ * @graph: a #GgitCommitGraph.
+ *
+ * Atomically decrements the reference count of @graph by one.
+ * If the reference count drops to 0, @graph is freed.
+ */
+void
+ggit_commit_graph_unref (GgitCommitGraph *graph)
+{
+	g_return_if_fail (graph != NULL);
+
+	if (g_atomic_int_dec_and_test (&graph->ref_count))
+	{
+		g_mapped_file_unref (graph->file);
+		g_slice_free (GgitCommitGraph, graph);
+	}
+}
+
+/**
+ * _ggit_commit_graph_lookup:
+ * @graph: a #GgitCommitGraph.
+ * @id: a raw commit id.
+ * @position: (out): return location for the position of the commit.
+ *
+ * Finds the position of a commit from the fanout and a binary search.
+ *
+ * Returns: %TRUE if the commit is in @graph.
+ */
+gboolean
+_ggit_commit_graph_lookup (GgitCommitGraph *graph,
+                           const guint8    *id,
+                           guint32         *position)
+{
+	guint32 lo;
+	guint32 hi;
+
+	lo = id[0] == 0 ? 0 : read_be32 (graph->fanout + (id[0] - 1) * 4);
+	hi = read_be32 (graph->fanout + id[0] * 4);
+
+	if (lo > hi || hi > graph->n_commits)
+	{
+		return FALSE;
+	}
+
+	while (lo < hi)
+	{
+		guint32 mid = lo + (hi - lo) / 2;
+		gint cmp;
+
+		cmp = memcmp (id, graph->ids + (gsize)mid * GIT_OID_RAWSZ, GIT_OID_RAWSZ);
+
+		if (cmp == 0)
+		{
+			*position = mid;
+			return TRUE;
+		}
+
+		if (cmp < 0)
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid + 1;
+		}
+	}
+
+	return FALSE;
+}
+
+static inline const guint8 *
+commit_data (GgitCommitGraph *graph,
+             guint32          position)
+{
+	return graph->data + (gsize)position * DATA_SIZE;
+}
+
+static inline guint32
+commit_generation (GgitCommitGraph *graph,
+                   guint32          position)
+{
+	return read_be32 (commit_data (graph, position) + GIT_OID_RAWSZ + 8) >> 2;
+}
+
+/**
+ * _ggit_commit_graph_read_parents:
+ * @graph: a #GgitCommitGraph.
+ * @position: the position of a commit.
+ * @parents: a #GArray of #guint32.
+ *
+ * Fills @parents with the positions of the parents of a commit.
+ *
+ * Returns: %FALSE if the graph is corrupt.
+ */
+gboolean
+_ggit_commit_graph_read_parents (GgitCommitGraph *graph,
+                                 guint32          position,
+                                 GArray          *parents)
+{
+	const guint8 *data = commit_data (graph, position);
+	guint32 parent;
+
+	g_array_set_size (parents, 0);
+
+	parent = read_be32 (data + GIT_OID_RAWSZ);
+
+	if (parent == PARENT_NONE)
+	{
+		return TRUE;
+	}
+
+	if (parent >= graph->n_commits)
+	{
+		return FALSE;
+	}
+
+	g_array_append_val (parents, parent);
+
+	parent = read_be32 (data + GIT_OID_RAWSZ + 4);
+
+	if (parent == PARENT_NONE)
+	{
+		return TRUE;
+	}
+
+	if ((parent & PARENT_EXTRA) == 0)
+	{
+		if (parent >= graph->n_commits)
+		{
+			return FALSE;
+		}
+
+		g_array_append_val (parents, parent);
+		return TRUE;
+	}
+
+	/* Octopus merges list their other parents in the extra edges */
+	parent &= ~PARENT_EXTRA;
+
+	while (parent < graph->n_edges)
+	{
+		guint32 edge = read_be32 (graph->edges + (gsize)parent * 4);
+		guint32 position = edge & ~PARENT_EXTRA;
+
+		if (position >= graph->n_commits)
+		{
+			return FALSE;
+		}
+
+		g_array_append_val (parents, position);
+
+		if ((edge & PARENT_EXTRA) != 0)
+		{
+			return TRUE;
+		}
+
+		parent++;
+	}
+
+	return FALSE;
+}
+
+/**
+ * ggit_commit_graph_get_size:
+ * @graph: a #GgitCommitGraph.
+ *
+ * Gets the number of commits in @graph.
+ *
+ * Returns: the number of commits.
+ */
+guint
+ggit_commit_graph_get_size (GgitCommitGraph *graph)
+{
+	g_return_val_if_fail (graph != NULL, 0);
+
+	return graph->n_commits;
+}
+
+/**
+ * ggit_commit_graph_find:
+ * @graph: a #GgitCommitGraph.
+ * @oid: the id of a commit.
+ * @position: (out) (optional): return location for the position of the
+ *            commit.
+ *
+ * Finds the position of a commit in @graph. Commits are ordered by id.
+ *
+ * Returns: %TRUE if the commit is in @graph, %FALSE otherwise.
+ */
+gboolean
+ggit_commit_graph_find (GgitCommitGraph *graph,
+                        GgitOId         *oid,
+                        guint           *position)
+{
+	guint32 found;
+
+	g_return_val_if_fail (graph != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	if (!_ggit_commit_graph_lookup (graph, _ggit_oid_get_oid (oid)->id, &found))
+	{
+		return FALSE;
+	}
+
+	if (position != NULL)
+	{
+		*position = found;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_commit_graph_get_id:
+ * @graph: a #GgitCommitGraph.
+ * @position: the position of a commit.
+ *
+ * Gets the id of the commit at @position.
+ *
+ * Returns: (transfer full): the #GgitOId of the commit.
+ */
+GgitOId *
+ggit_commit_graph_get_id (GgitCommitGraph *graph,
+                          guint            position)
+{
+	g_return_val_if_fail (graph != NULL, NULL);
+	g_return_val_if_fail (position < graph->n_commits, NULL);
+
+	return ggit_oid_new_from_raw (graph->ids + (gsize)position * GIT_OID_RAWSZ);
+}
+
+/**
+ * ggit_commit_graph_get_tree_id:
+ * @graph: a #GgitCommitGraph.
+ * @position: the position of a commit.
+ *
+ * Gets the id of the tree of the commit at @position.
+ *
+ * Returns: (transfer full): the #GgitOId of the tree.
+ */
+GgitOId *
+ggit_commit_graph_get_tree_id (GgitCommitGraph *graph,
+                               guint            position)
+{
+	g_return_val_if_fail (graph != NULL, NULL);
+	g_return_val_if_fail (position < graph->n_commits, NULL);
+
+	return ggit_oid_new_from_raw (commit_data (graph, position));
+}
+
+/**
+ * ggit_commit_graph_get_parents:
+ * @graph: a #GgitCommitGraph.
+ * @position: the position of a commit.
+ * @n_parents: (out): return location for the number of parents.
+ *
+ * Gets the positions of the parents of the commit at @position, in the
+ * order of the parents.
+ *
+ * Returns: (transfer full) (array length=n_parents) (nullable): the
+ * positions of the parents or %NULL if the commit has no parents or the
+ * graph is corrupt.
+ */
+guint32 *
+ggit_commit_graph_get_parents (GgitCommitGraph *graph,
+                               guint            position,
+                               guint           *n_parents)
+{
+	GArray *parents;
+
+	g_return_val_if_fail (graph != NULL, NULL);
+	g_return_val_if_fail (position < graph->n_commits, NULL);
+	g_return_val_if_fail (n_parents != NULL, NULL);
+
+	parents = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	if (!_ggit_commit_graph_read_parents (graph, position, parents) || parents->len == 0)
+	{
+		*n_parents = 0;
+		g_array_free (parents, TRUE);
+
+		return NULL;
+	}
+
+	*n_parents = parents->len;
+
+	return (guint32 *)g_array_free (parents, FALSE);
+}
+
+/**
+ * ggit_commit_graph_get_generation:
+ * @graph: a #GgitCommitGraph.
+ * @position: the position of a commit.
+ *
+ * Gets the generation number of the commit at @position, which is 1 for a
+ * commit without parents and one more than the highest generation of its
+ * parents otherwise. A commit can only be reached from commits of a
+ * higher generation.
+ *
+ * Returns: the generation number, or 0 if it was not computed when the
+ * graph was written.
+ */
+guint32
+ggit_commit_graph_get_generation (GgitCommitGraph *graph,
+                                  guint            position)
+{
+	g_return_val_if_fail (graph != NULL, 0);
+	g_return_val_if_fail (position < graph->n_commits, 0);
+
+	return commit_generation (graph, position);
+}
+
+/**
+ * ggit_commit_graph_get_commit_time:
+ * @graph: a #GgitCommitGraph.
+ * @position: the position of a commit.
+ *
+ * Gets the commit time of the commit at @position.
+ *
+ * Returns: the commit time in seconds since the epoch.
+ */
+gint64
+ggit_commit_graph_get_commit_time (GgitCommitGraph *graph,
+                                   guint            position)
+{
+	const guint8 *data;
+
+	g_return_val_if_fail (graph != NULL, 0);
+	g_return_val_if_fail (position < graph->n_commits, 0);
+
+	data = commit_data (graph, position) + GIT_OID_RAWSZ + 8;
+
+	return ((gint64)(read_be32 (data) & 0x3) << 32) | read_be32 (data + 4);
+}
+
+static void
+graph_walk_init (GraphWalk       *walk,
+                 GgitCommitGraph *graph)
+{
+	walk->graph = graph;
+	walk->flags = g_new0 (guint8, graph->n_commits);
+	walk->queue = g_array_new (FALSE, FALSE, sizeof (QueueItem));
+	walk->parents = g_array_new (FALSE, FALSE, sizeof (guint32));
+	walk->n_single = 0;
+	walk->n_one = 0;
+}
+
+static void
+graph_walk_clear (GraphWalk *walk)
+{
+	g_free (walk->flags);
+	g_array_free (walk->queue, TRUE);
+	g_array_free (walk->parents, TRUE);
+}
+
+/* Adds @flags to a commit and queues it if it was not reached yet. Returns
+ * FALSE if the generation of the commit cannot be used to order the walk.
+ */
+static gboolean
+graph_walk_push (GraphWalk *walk,
+                 guint32    position,
+                 guint8     flags)
+{
+	QueueItem *items;
+	QueueItem item;
+	guint8 old = walk->flags[position];
+	guint i;
+
+	if ((old & FLAG_DONE) != 0)
+	{
+		return TRUE;
+	}
+
+	if ((old & FLAG_QUEUED) != 0)
+	{
+		if ((old & FLAG_BOTH) != FLAG_BOTH && ((old | flags) & FLAG_BOTH) == FLAG_BOTH)
+		{
+			walk->n_single--;
+		}
+
+		if ((old & FLAG_BOTH) == FLAG_ONE && ((old | flags) & FLAG_BOTH) != FLAG_ONE)
+		{
+			walk->n_one--;
+		}
+
+		walk->flags[position] = old | flags;
+		return TRUE;
+	}
+
+	item.generation = commit_generation (walk->graph, position);
+	item.position = position;
+
+	/* Commits written without generation, or past the maximum, do not
+	 * have a strictly higher generation than their parents */
+	if (item.generation == 0 || item.generation >= GENERATION_MAX)
+	{
+		return FALSE;
+	}
+
+	walk->flags[position] = flags | FLAG_QUEUED;
+
+	if ((flags & FLAG_BOTH) != FLAG_BOTH)
+	{
+		walk->n_single++;
+	}
+
+	if ((flags & FLAG_BOTH) == FLAG_ONE)
+	{
+		walk->n_one++;
+	}
+
+	/* Sift up in the max-heap */
+	g_array_append_val (walk->queue, item);
+	items = (QueueItem *)walk->queue->data;
+	i = walk->queue->len - 1;
+
+	while (i > 0 && items[(i - 1) / 2].generation < item.generation)
+	{
+		items[i] = items[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+
+	items[i] = item;
+
+	return TRUE;
+}
+
+static guint32
+graph_walk_pop (GraphWalk *walk,
+                guint8    *flags)
+{
+	QueueItem *items = (QueueItem *)walk->queue->data;
+	QueueItem last;
+	guint32 position;
+	guint n;
+	guint i = 0;
+
+	position = items[0].position;
+	last = items[walk->queue->len - 1];
+
+	g_array_set_size (walk->queue, walk->queue->len - 1);
+	n = walk->queue->len;
+
+	/* Sift the last item down from the root */
+	if (n > 0)
+	{
+		while (2 * i + 1 < n)
+		{
+			guint child = 2 * i + 1;
+
+			if (child + 1 < n && items[child + 1].generation > items[child].generation)
+			{
+				child++;
+			}
+
+			if (items[child].generation <= last.generation)
+			{
+				break;
+			}
+
+			items[i] = items[child];
+			i = child;
+		}
+
+		items[i] = last;
+	}
+
+	*flags = walk->flags[position] & FLAG_BOTH;
+	walk->flags[position] = *flags | FLAG_DONE;
+
+	if (*flags != FLAG_BOTH)
+	{
+		walk->n_single--;
+	}
+
+	if (*flags == FLAG_ONE)
+	{
+		walk->n_one--;
+	}
+
+	return position;
+}
+
+static gboolean
+graph_walk_push_parents (GraphWalk *walk,
+                         guint32    position,
+                         guint8     flags)
+{
+	guint i;
+
+	if (!_ggit_commit_graph_read_parents (walk->graph, position, walk->parents))
+	{
+		return FALSE;
+	}
+
+	for (i = 0; i < walk->parents->len; i++)
+	{
+		if (!graph_walk_push (walk, g_array_index (walk->parents, guint32, i), flags))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * _ggit_commit_graph_descendant_of:
+ * @graph: a #GgitCommitGraph.
+ * @commit: a commit id.
+ * @ancestor: a commit id.
+ * @result: (out): return location for whether @commit descends from
+ *          @ancestor.
+ *
+ * Checks whether @commit is a descendant of @ancestor, only walking the
+ * commits with a higher generation than @ancestor. A commit is not a
+ * descendant of itself.
+ *
+ * Returns: %FALSE if @graph cannot answer, because one of the commits is
+ * not in it or it has no generation numbers.
+ */
+gboolean
+_ggit_commit_graph_descendant_of (GgitCommitGraph *graph,
+                                  const git_oid   *commit,
+                                  const git_oid   *ancestor,
+                                  gboolean        *result)
+{
+	GArray *stack;
+	GArray *parents;
+	guint8 *seen;
+	guint32 position;
+	guint32 target;
+	guint32 min_generation;
+	gboolean ok = TRUE;
+
+	if (!_ggit_commit_graph_lookup (graph, commit->id, &position) ||
+	    !_ggit_commit_graph_lookup (graph, ancestor->id, &target))
+	{
+		return FALSE;
+	}
+
+	*result = FALSE;
+
+	if (position == target)
+	{
+		return TRUE;
+	}
+
+	min_generation = commit_generation (graph, target);
+
+	if (min_generation == 0 || min_generation >= GENERATION_MAX)
+	{
+		return FALSE;
+	}
+
+	seen = g_new0 (guint8, graph->n_commits);
+	stack = g_array_new (FALSE, FALSE, sizeof (guint32));
+	parents = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	seen[position] = 1;
+	g_array_append_val (stack, position);
+
+	while (stack->len > 0 && !*result)
+	{
+		guint i;
+
+		position = g_array_index (stack, guint32, stack->len - 1);
+		g_array_set_size (stack, stack->len - 1);
+
+		if (!_ggit_commit_graph_read_parents (graph, position, parents))
+		{
+			ok = FALSE;
+			break;
+		}
+
+		for (i = 0; i < parents->len; i++)
+		{
+			guint32 parent = g_array_index (parents, guint32, i);
+
+			if (parent == target)
+			{
+				*result = TRUE;
+				break;
+			}
+
+			/* The ancestor cannot be reached from a commit of the
+			 * same or a lower generation */
+			if (!seen[parent] && commit_generation (graph, parent) > min_generation)
+			{
+				seen[parent] = 1;
+				g_array_append_val (stack, parent);
+			}
+		}
+	}
+
+	g_free (seen);
+	g_array_free (stack, TRUE);
+	g_array_free (parents, TRUE);
+
+	return ok;
+}
+
+/**
+ * _ggit_commit_graph_ahead_behind:
+ * @graph: a #GgitCommitGraph.
+ * @local: a commit id.
+ * @upstream: a commit id.
+ * @ahead: (out): return location for the number of commits only reachable
+ *         from @local.
+ * @behind: (out): return location for the number of commits only
+ *          reachable from @upstream.
+ *
+ * Counts the commits reachable from one of @local and @upstream but not
+ * from the other. The walk stops as soon as all the queued commits are
+ * reachable from both.
+ *
+ * Returns: %FALSE if @graph cannot answer, because one of the commits is
+ * not in it or it has no generation numbers.
+ */
+gboolean
+_ggit_commit_graph_ahead_behind (GgitCommitGraph *graph,
+                                 const git_oid   *local,
+                                 const git_oid   *upstream,
+                                 gsize           *ahead,
+                                 gsize           *behind)
+{
+	GraphWalk walk;
+	guint32 one;
+	guint32 two;
+	gboolean ok;
+
+	if (!_ggit_commit_graph_lookup (graph, local->id, &one) ||
+	    !_ggit_commit_graph_lookup (graph, upstream->id, &two))
+	{
+		return FALSE;
+	}
+
+	*ahead = 0;
+	*behind = 0;
+
+	graph_walk_init (&walk, graph);
+
+	ok = graph_walk_push (&walk, one, FLAG_ONE) &&
+	     graph_walk_push (&walk, two, FLAG_TWO);
+
+	while (ok && walk.n_single > 0)
+	{
+		guint32 position;
+		guint8 flags;
+
+		position = graph_walk_pop (&walk, &flags);
+
+		if (flags == FLAG_ONE)
+		{
+			(*ahead)++;
+		}
+		else if (flags == FLAG_TWO)
+		{
+			(*behind)++;
+		}
+
+		ok = graph_walk_push_parents (&walk, position, flags);
+	}
+
+	graph_walk_clear (&walk);
+
+	return ok;
+}
+
+/**
+ * _ggit_commit_graph_merge_base:
+ * @graph: a #GgitCommitGraph.
+ * @one: a commit id.
+ * @two: a commit id.
+ * @base: (out): return location for the merge base.
+ * @found: (out): return location for whether there is a merge base.
+ *
+ * Finds a best common ancestor of @one and @two. Common ancestors are met
+ * by decreasing generation, so the first one found cannot be an ancestor
+ * of another one.
+ *
+ * Returns: %FALSE if @graph cannot answer, because one of the commits is
+ * not in it or it has no generation numbers.
+ */
+gboolean
+_ggit_commit_graph_merge_base (GgitCommitGraph *graph,
+                               const git_oid   *one,
+                               const git_oid   *two,
+                               git_oid         *base,
+                               gboolean        *found)
+{
+	GraphWalk walk;
+	guint32 first;
+	guint32 second;
+	gboolean ok;
+
+	if (!_ggit_commit_graph_lookup (graph, one->id, &first) ||
+	    !_ggit_commit_graph_lookup (graph, two->id, &second))
+	{
+		return FALSE;
+	}
+
+	*found = FALSE;
+
+	graph_walk_init (&walk, graph);
+
+	ok = graph_walk_push (&walk, first, FLAG_ONE) &&
+	     graph_walk_push (&walk, second, FLAG_TWO);
+
+	while (ok && walk.queue->len > 0)
+	{
+		guint32 position;
+		guint8 flags;
+
+		position = graph_walk_pop (&walk, &flags);
+
+		if (flags == FLAG_BOTH)
+		{
+			git_oid_fromraw (base, graph->ids + (gsize)position * GIT_OID_RAWSZ);
+			*found = TRUE;
+			break;
+		}
+
+		ok = graph_walk_push_parents (&walk, position, flags);
+	}
+
+	graph_walk_clear (&walk);
+
+	return ok;
+}
+
+/**
+ * _ggit_commit_graph_topo_walk:
+ * @graph: a #GgitCommitGraph.
+ * @pushed: (array length=n_pushed): the commits to start from.
+ * @n_pushed: the number of commits in @pushed.
+ * @hidden: (array length=n_hidden): the commits to hide, with their
+ *          ancestors.
+ * @n_hidden: the number of commits in @hidden.
+ * @ids: a #GArray of #git_oid to append the walked commits to.
+ *
+ * Walks the commits reachable from @pushed but not from @hidden in
+ * topological order, parents after all their children, like a revision
+ * walk with %GGIT_SORT_TOPOLOGICAL. Taking the commits by decreasing
+ * generation is such an order, and a commit only needs to be taken once
+ * all of its children in the walk have been. The walk stops once all the
+ * queued commits are hidden.
+ *
+ * Returns: %FALSE if @graph cannot answer, because one of the commits is
+ * not in it or it has no generation numbers.
+ */
+gboolean
+_ggit_commit_graph_topo_walk (GgitCommitGraph *graph,
+                              const git_oid   *pushed,
+                              guint            n_pushed,
+                              const git_oid   *hidden,
+                              guint            n_hidden,
+                              GArray          *ids)
+{
+	GraphWalk walk;
+	gboolean ok = TRUE;
+	guint i;
+
+	graph_walk_init (&walk, graph);
+
+	for (i = 0; ok && i < n_pushed + n_hidden; i++)
+	{
+		const git_oid *id = i < n_pushed ? &pushed[i] : &hidden[i - n_pushed];
+		guint32 position;
+
+		ok = _ggit_commit_graph_lookup (graph, id->id, &position) &&
+		     graph_walk_push (&walk, position, i < n_pushed ? FLAG_ONE : FLAG_TWO);
+	}
+
+	while (ok && walk.n_one > 0)
+	{
+		guint32 position;
+		guint8 flags;
+
+		position = graph_walk_pop (&walk, &flags);
+
+		if (flags == FLAG_ONE)
+		{
+			git_oid id;
+
+			git_oid_fromraw (&id, graph->ids + (gsize)position * GIT_OID_RAWSZ);
+			g_array_append_val (ids, id);
+		}
+
+		ok = graph_walk_push_parents (&walk, position, flags);
+	}
+
+	graph_walk_clear (&walk);
+
+	return ok;
+}
+
+typedef struct
+{
+	git_repository *repo;
+	GCancellable *cancellable;
+
+	/* Maps a commit id to its number + 1, in the order of discovery */
+	GgitOIdTable index;
+
+	GArray *ids;
+	GArray *trees;
+	GArray *times;
+	GArray *parent_offsets;
+	GArray *parent_ids;
+	GArray *pending;
+} GraphBuilder;
+
+static void
+graph_builder_add_tip (GraphBuilder  *builder,
+                       const git_oid *oid)
+{
+	if (_ggit_oid_table_lookup (&builder->index, oid->id) < 0)
+	{
+		g_array_append_vals (builder->pending, oid->id, 1);
+	}
+}
+
+static gint
+graph_builder_add_refs (GraphBuilder *builder)
+{
+	git_reference_iterator *iter;
+	git_reference *ref;
+	gint ret;
+
+	ret = git_reference_iterator_new (&iter, builder->repo);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	while ((ret = git_reference_next (&ref, iter)) == GIT_OK)
+	{
+		git_object *obj;
+
+		/* Refs to other objects, or dangling symbolic refs, have no
+		 * commits to add */
+		if (git_reference_peel (&obj, ref, GIT_OBJ_COMMIT) == GIT_OK)
+		{
+			graph_builder_add_tip (builder, git_object_id (obj));
+			git_object_free (obj);
+		}
+
+		git_reference_free (ref);
+	}
+
+	git_reference_iterator_free (iter);
+
+	if (ret != GIT_ITEROVER)
+	{
+		return ret;
+	}
+
+	/* A detached HEAD is not listed by the iterator */
+	if (git_reference_lookup (&ref, builder->repo, "HEAD") == GIT_OK)
+	{
+		git_object *obj;
+
+		if (git_reference_peel (&obj, ref, GIT_OBJ_COMMIT) == GIT_OK)
+		{
+			graph_builder_add_tip (builder, git_object_id (obj));
+			git_object_free (obj);
+		}
+
+		git_reference_free (ref);
+	}
+
+	return GIT_OK;
+}
+
+static gint
+graph_builder_walk (GraphBuilder *builder)
+{
+	guint n = 0;
+
+	while (builder->pending->len > 0)
+	{
+		git_oid oid;
+		git_commit *commit;
+		git_time_t commit_time;
+		gboolean added;
+		gsize slot;
+		guint32 offset;
+		guint n_parents;
+		guint i;
+		gint ret;
+
+		git_oid_fromraw (&oid, (const guint8 *)builder->pending->data +
+		                       (builder->pending->len - 1) * GIT_OID_RAWSZ);
+		g_array_set_size (builder->pending, builder->pending->len - 1);
+
+		slot = _ggit_oid_table_insert (&builder->index, oid.id, &added);
+
+		if (!added)
+		{
+			continue;
+		}
+
+		if (++n % 1024 == 0 && g_cancellable_is_cancelled (builder->cancellable))
+		{
+			return GIT_EUSER;
+		}
+
+		builder->index.values[slot] = GUINT_TO_POINTER (builder->ids->len + 1);
+
+		ret = git_commit_lookup (&commit, builder->repo, &oid);
+
+		if (ret != GIT_OK)
+		{
+			return ret;
+		}
+
+		/* The format keeps 34 bits of commit time */
+		commit_time = CLAMP (git_commit_time (commit), 0, TIME_MAX);
+
+		g_array_append_vals (builder->ids, oid.id, 1);
+		g_array_append_vals (builder->trees, git_commit_tree_id (commit)->id, 1);
+		g_array_append_val (builder->times, commit_time);
+
+		n_parents = git_commit_parentcount (commit);
+
+		for (i = 0; i < n_parents; i++)
+		{
+			const git_oid *parent = git_commit_parent_id (commit, i);
+
+			g_array_append_vals (builder->parent_ids, parent->id, 1);
+			graph_builder_add_tip (builder, parent);
+		}
+
+		offset = builder->parent_ids->len;
+		g_array_append_val (builder->parent_offsets, offset);
+
+		git_commit_free (commit);
+	}
+
+	return GIT_OK;
+}
+
+static gint
+compare_ids (gconstpointer a,
+             gconstpointer b,
+             gpointer      user_data)
+{
+	const guint8 *ids = user_data;
+
+	return memcmp (ids + *(const guint32 *)a * GIT_OID_RAWSZ,
+	               ids + *(const guint32 *)b * GIT_OID_RAWSZ,
+	               GIT_OID_RAWSZ);
+}
+
+/* Computes the generation of each commit without recursion, parents first */
+static guint32 *
+compute_generations (const guint32 *parent_offsets,
+                     const guint32 *parents,
+                     guint32        n_commits)
+{
+	guint32 *generations;
+	GArray *stack;
+	guint32 i;
+
+	generations = g_new0 (guint32, n_commits);
+	stack = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	for (i = 0; i < n_commits; i++)
+	{
+		if (generations[i] != 0)
+		{
+			continue;
+		}
+
+		g_array_append_val (stack, i);
+
+		while (stack->len > 0)
+		{
+			guint32 commit = g_array_index (stack, guint32, stack->len - 1);
+			guint32 generation = 0;
+			gboolean missing = FALSE;
+			guint32 p;
+
+			if (generations[commit] != 0)
+			{
+				g_array_set_size (stack, stack->len - 1);
+				continue;
+			}
+
+			for (p = parent_offsets[commit]; p < parent_offsets[commit + 1]; p++)
+			{
+				guint32 parent = parents[p];
+
+				if (generations[parent] == 0)
+				{
+					g_array_append_val (stack, parent);
+					missing = TRUE;
+				}
+				else
+				{
+					generation = MAX (generation, generations[parent]);
+				}
+			}
+
+			if (!missing)
+			{
+				generations[commit] = MIN (generation + 1, GENERATION_MAX);
+				g_array_set_size (stack, stack->len - 1);
+			}
+		}
+	}
+
+	g_array_free (stack, TRUE);
+
+	return generations;
+}
+
+static GByteArray *
+graph_builder_serialize (GraphBuilder *builder)
+{
+	const guint8 *ids = (const guint8 *)builder->ids->data;
+	const guint32 *parent_offsets = (const guint32 *)builder->parent_offsets->data;
+	guint32 n_commits = builder->ids->len;
+	guint32 *order;
+	guint32 *rank;
+	guint32 *parents;
+	guint32 *generations;
+	GByteArray *data;
+	GByteArray *out;
+	GArray *edges;
+	GChecksum *checksum;
+	guint8 header[4];
+	guint8 digest[GIT_OID_RAWSZ];
+	gsize digest_len = sizeof (digest);
+	guint64 offset;
+	guint n_chunks;
+	guint32 count;
+	guint32 i;
+
+	/* Commits are stored by id, parents by their stored position */
+	order = g_new (guint32, n_commits);
+
+	for (i = 0; i < n_commits; i++)
+	{
+		order[i] = i;
+	}
+
+	g_qsort_with_data (order, n_commits, sizeof (guint32), compare_ids, (gpointer)ids);
+
+	rank = g_new (guint32, n_commits);
+
+	for (i = 0; i < n_commits; i++)
+	{
+		rank[order[i]] = i;
+	}
+
+	parents = g_new (guint32, builder->parent_ids->len);
+
+	for (i = 0; i < builder->parent_ids->len; i++)
+	{
+		gssize slot;
+
+		slot = _ggit_oid_table_lookup (&builder->index,
+		                               (const guint8 *)builder->parent_ids->data +
+		                               (gsize)i * GIT_OID_RAWSZ);
+
+		parents[i] = GPOINTER_TO_UINT (builder->index.values[slot]) - 1;
+	}
+
+	generations = compute_generations (parent_offsets, parents, n_commits);
+
+	/* The commit data comes first, it gives the size of the extra edges */
+	data = g_byte_array_sized_new (n_commits * DATA_SIZE);
+	edges = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	for (i = 0; i < n_commits; i++)
+	{
+		guint32 commit = order[i];
+		guint32 first = parent_offsets[commit];
+		guint32 n_parents = parent_offsets[commit + 1] - first;
+		guint64 commit_time = g_array_index (builder->times, git_time_t, commit);
+		guint32 p;
+
+		g_byte_array_append (data,
+		                     (const guint8 *)builder->trees->data + (gsize)commit * GIT_OID_RAWSZ,
+		                     GIT_OID_RAWSZ);
+
+		append_be32 (data, n_parents > 0 ? rank[parents[first]] : PARENT_NONE);
+
+		if (n_parents <= 1)
+		{
+			append_be32 (data, PARENT_NONE);
+		}
+		else if (n_parents == 2)
+		{
+			append_be32 (data, rank[parents[first + 1]]);
+		}
+		else
+		{
+			append_be32 (data, PARENT_EXTRA | edges->len);
+
+			for (p = first + 1; p < first + n_parents; p++)
+			{
+				guint32 edge = rank[parents[p]];
+
+				if (p == first + n_parents - 1)
+				{
+					edge |= PARENT_EXTRA;
+				}
+
+				g_array_append_val (edges, edge);
+			}
+		}
+
+		append_be32 (data, (generations[commit] << 2) | (guint32)(commit_time >> 32));
+		append_be32 (data, (guint32)commit_time);
+	}
+
+	n_chunks = edges->len > 0 ? 4 : 3;
+	offset = HEADER_SIZE + (n_chunks + 1) * CHUNK_ENTRY_SIZE;
+
+	out = g_byte_array_sized_new (offset + FANOUT_SIZE + n_commits * GIT_OID_RAWSZ +
+	                              data->len + edges->len * 4 + GIT_OID_RAWSZ);
+
+	append_be32 (out, GRAPH_SIGNATURE);
+
+	header[0] = GRAPH_VERSION;
+	header[1] = GRAPH_HASH_SHA1;
+	header[2] = n_chunks;
+	header[3] = 0;
+	g_byte_array_append (out, header, sizeof (header));
+
+	/* Chunk lookup, terminated by the end offset of the last chunk */
+	append_be32 (out, CHUNK_OIDF);
+	append_be64 (out, offset);
+	offset += FANOUT_SIZE;
+
+	append_be32 (out, CHUNK_OIDL);
+	append_be64 (out, offset);
+	offset += (guint64)n_commits * GIT_OID_RAWSZ;
+
+	append_be32 (out, CHUNK_CDAT);
+	append_be64 (out, offset);
+	offset += data->len;
+
+	if (edges->len > 0)
+	{
+		append_be32 (out, CHUNK_EDGE);
+		append_be64 (out, offset);
+		offset += (guint64)edges->len * 4;
+	}
+
+	append_be32 (out, 0);
+	append_be64 (out, offset);
+
+	/* Number of commits whose id starts with a byte up to i */
+	count = 0;
+
+	for (i = 0; i < 256; i++)
+	{
+		while (count < n_commits && ids[(gsize)order[count] * GIT_OID_RAWSZ] == i)
+		{
+			count++;
+		}
+
+		append_be32 (out, count);
+	}
+
+	for (i = 0; i < n_commits; i++)
+	{
+		g_byte_array_append (out, ids + (gsize)order[i] * GIT_OID_RAWSZ, GIT_OID_RAWSZ);
+	}
+
+	g_byte_array_append (out, data->data, data->len);
+
+	for (i = 0; i < edges->len; i++)
+	{
+		append_be32 (out, g_array_index (edges, guint32, i));
+	}
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+	g_checksum_update (checksum, out->data, out->len);
+	g_checksum_get_digest (checksum, digest, &digest_len);
+	g_checksum_free (checksum);
+
+	g_byte_array_append (out, digest, sizeof (digest));
+
+	g_byte_array_unref (data);
+	g_array_free (edges, TRUE);
+	g_free (generations);
+	g_free (parents);
+	g_free (rank);
+	g_free (order);
+
+	return out;
+}
+
+static gboolean
+graph_builder_write (GraphBuilder  *builder,
+                     GError       **error)
+{
+	GByteArray *out;
+	gchar *path;
+	gchar *dir;
+	gboolean success;
+	gint ret;
+
+	ret = graph_builder_add_refs (builder);
+
+	if (ret == GIT_OK)
+	{
+		ret = graph_builder_walk (builder);
+	}
+
+	if (g_cancellable_set_error_if_cancelled (builder->cancellable, error))
+	{
+		return FALSE;
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	if (builder->ids->len >= PARENT_NONE)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_NOT_SUPPORTED,
+		                     "Too many commits for a commit-graph");
+
+		return FALSE;
+	}
+
+	path = _ggit_commit_graph_get_path (builder->repo);
+	dir = g_path_get_dirname (path);
+
+	if (g_mkdir_with_parents (dir, 0777) != 0)
+	{
+		gint errsv = errno;
+
+		g_set_error (error,
+		             G_IO_ERROR,
+		             g_io_error_from_errno (errsv),
+		             "Could not create %s: %s",
+		             dir,
+		             g_strerror (errsv));
+
+		g_free (dir);
+		g_free (path);
+
+		return FALSE;
+	}
+
+	out = graph_builder_serialize (builder);
+
+	/* Written to a temporary file and renamed, so readers keep mapping
+	 * the previous file meanwhile */
+	success = g_file_set_contents (path, (const gchar *)out->data, out->len, error);
+
+	g_byte_array_unref (out);
+	g_free (dir);
+	g_free (path);
+
+	return success;
+}
+
+/**
+ * _ggit_commit_graph_write:
+ * @repository: a #git_repository.
+ * @cancellable: (nullable): a #GCancellable, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes the commit-graph file of @repository with all the commits
+ * reachable from its references and HEAD, replacing the previous one.
+ *
+ * Returns: %TRUE if the file was written, %FALSE if there was an error.
+ */
+gboolean
+_ggit_commit_graph_write (git_repository  *repository,
+                          GCancellable    *cancellable,
+                          GError         **error)
+{
+	GraphBuilder builder = { 0 };
+	guint32 offset = 0;
+	gboolean success;
+
+	builder.repo = repository;
+	builder.cancellable = cancellable;
+
+	_ggit_oid_table_init (&builder.index, TRUE);
+
+	builder.ids = g_array_new (FALSE, FALSE, GIT_OID_RAWSZ);
+	builder.trees = g_array_new (FALSE, FALSE, GIT_OID_RAWSZ);
+	builder.times = g_array_new (FALSE, FALSE, sizeof (git_time_t));
+	builder.parent_offsets = g_array_new (FALSE, FALSE, sizeof (guint32));
+	builder.parent_ids = g_array_new (FALSE, FALSE, GIT_OID_RAWSZ);
+	builder.pending = g_array_new (FALSE, FALSE, GIT_OID_RAWSZ);
+
+	g_array_append_val (builder.parent_offsets, offset);
+
+	success = graph_builder_write (&builder, error);
+
+	g_array_free (builder.ids, TRUE);
+	g_array_free (builder.trees, TRUE);
+	g_array_free (builder.times, TRUE);
+	g_array_free (builder.parent_offsets, TRUE);
+	g_array_free (builder.parent_ids, TRUE);
+	g_array_free (builder.pending, TRUE);
+
+	_ggit_oid_table_clear (&builder.index, NULL);
+
+	return success;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,116 @@
+/*
+ * ggit-commit-graph.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __GGIT_COMMIT_GRAPH_H__
+#define __GGIT_COMMIT_GRAPH_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_COMMIT_GRAPH       (ggit_commit_graph_get_type ())
+#define GGIT_COMMIT_GRAPH(obj)       ((GgitCommitGraph *)obj)
+
+GType            ggit_commit_graph_get_type         (void) G_GNUC_CONST;
+
+GgitCommitGraph *ggit_commit_graph_ref              (GgitCommitGraph  *graph);
+void             ggit_commit_graph_unref            (GgitCommitGraph  *graph);
+
+guint            ggit_commit_graph_get_size         (GgitCommitGraph  *graph);
+
+gboolean         ggit_commit_graph_find             (GgitCommitGraph  *graph,
+                                                     GgitOId          *oid,
+                                                     guint            *position);
+
+GgitOId         *ggit_commit_graph_get_id           (GgitCommitGraph  *graph,
+                                                     guint             position);
+
+GgitOId         *ggit_commit_graph_get_tree_id      (GgitCommitGraph  *graph,
+                                                     guint             position);
+
+guint32         *ggit_commit_graph_get_parents      (GgitCommitGraph  *graph,
+                                                     guint             position,
+                                                     guint            *n_parents);
+
+guint32          ggit_commit_graph_get_generation   (GgitCommitGraph  *graph,
+                                                     guint             position);
+
+gint64           ggit_commit_graph_get_commit_time  (GgitCommitGraph  *graph,
+                                                     guint             position);
+
+gchar           *_ggit_commit_graph_get_path        (git_repository   *repository);
+
+GgitCommitGraph *_ggit_commit_graph_open            (const gchar      *path,
+                                                     GError          **error);
+
+gboolean         _ggit_commit_graph_is_current      (GgitCommitGraph  *graph,
+                                                     const GStatBuf   *st);
+
+const guint8    *_ggit_commit_graph_get_checksum    (GgitCommitGraph  *graph);
+
+gboolean         _ggit_commit_graph_lookup          (GgitCommitGraph  *graph,
+                                                     const guint8     *id,
+                                                     guint32          *position);
+
+gboolean         _ggit_commit_graph_read_parents    (GgitCommitGraph  *graph,
+                                                     guint32           position,
+                                                     GArray           *parents);
+
+gboolean         _ggit_commit_graph_write           (git_repository   *repository,
+                                                     GCancellable     *cancellable,
+                                                     GError          **error);
+
+gboolean         _ggit_commit_graph_descendant_of   (GgitCommitGraph  *graph,
+                                                     const git_oid    *commit,
+                                                     const git_oid    *ancestor,
+                                                     gboolean         *result);
+
+gboolean         _ggit_commit_graph_ahead_behind    (GgitCommitGraph  *graph,
+                                                     const git_oid    *local,
+                                                     const git_oid    *upstream,
+                                                     gsize            *ahead,
+                                                     gsize            *behind);
+
+gboolean         _ggit_commit_graph_merge_base      (GgitCommitGraph  *graph,
+                                                     const git_oid    *one,
+                                                     const git_oid    *two,
+                                                     git_oid          *base,
+                                                     gboolean         *found);
+
+gboolean         _ggit_commit_graph_topo_walk       (GgitCommitGraph  *graph,
+                                                     const git_oid    *pushed,
+                                                     guint             n_pushed,
+                                                     const git_oid    *hidden,
+                                                     guint             n_hidden,
+                                                     GArray           *ids);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitCommitGraph, ggit_commit_graph_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_COMMIT_GRAPH_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,972 @@
+/*
+ * ggit-commit-table.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+
+#include "ggit-commit-table.h"
+#include "ggit-convert.h"
+#include "ggit-error.h"
+#include "ggit-oid.h"
+#include "ggit-oid-table.h"
+#include "ggit-repository.h"
+#include "ggit-revision-walker.h"
+
+/**
+ * GgitCommitTable:
+ *
+ * The metadata of a list of commits, stored by column: the commit ids, the
+ * parents of each commit and the author, committer and subject of each
+ * commit. All strings are UTF-8 and live in a single string buffer, the
+ * string columns being offsets into that buffer. Loading a table does not
+ * create any object per commit, which makes it suitable for showing very
+ * long histories.
+ */
+struct _GgitCommitTable
+{
+	gint ref_count;
+
+	guint n_commits;
+	guint8 *ids;
+
+	/* The parents of commit i are parent_indices[parent_offsets[i]] up
+	 * to parent_indices[parent_offsets[i + 1]], -1 for a parent which
+	 * is not in the table.
+	 */
+	guint32 *parent_offsets;
+	gint32 *parent_indices;
+	guint8 *parent_ids;
+
+	guint32 *author_names;
+	guint32 *author_emails;
+	gint64 *author_times;
+	gint32 *author_offsets;
+
+	guint32 *committer_names;
+	guint32 *committer_emails;
+	gint64 *committer_times;
+	gint32 *committer_offsets;
+
+	guint32 *subjects;
+
+	gchar *strings;
+	gsize strings_size;
+
+	/* Maps a commit id to its index + 1 */
+	GgitOIdTable index;
+};
+
+G_DEFINE_BOXED_TYPE (GgitCommitTable, ggit_commit_table,
+                     ggit_commit_table_ref, ggit_commit_table_unref)
+
+static guint32
+append_string (GString     *strings,
+               const gchar *str,
+               gssize       size,
+               const gchar *encoding)
+{
+	gsize offset = strings->len;
+
+	if (str == NULL)
+	{
+		str = "";
+		size = 0;
+	}
+	else if (size < 0)
+	{
+		size = strlen (str);
+	}
+
+	/* Most commits are UTF-8, avoid converting them */
+	if ((encoding == NULL || g_ascii_strcasecmp (encoding, "UTF-8") == 0) &&
+	    g_utf8_validate (str, size, NULL))
+	{
+		g_string_append_len (strings, str, size);
+	}
+	else
+	{
+		gchar *converted;
+
+		converted = ggit_convert_utf8 (str, size, encoding);
+		g_string_append (strings, converted);
+		g_free (converted);
+	}
+
+	g_string_append_c (strings, '\0');
+
+	return (guint32)offset;
+}
+
+static gint
+load_commit (GgitCommitTable *table,
+             git_repository  *repo,
+             guint            index,
+             GString         *strings,
+             GArray          *parent_ids)
+{
+	git_oid oid;
+	git_commit *commit;
+	const git_signature *author;
+	const git_signature *committer;
+	const gchar *encoding;
+	const gchar *message;
+	const gchar *eol;
+	guint n_parents;
+	guint i;
+	gint ret;
+
+	git_oid_fromraw (&oid, table->ids + index * GIT_OID_RAWSZ);
+
+	ret = git_commit_lookup (&commit, repo, &oid);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	encoding = git_commit_message_encoding (commit);
+	author = git_commit_author (commit);
+	committer = git_commit_committer (commit);
+
+	table->author_names[index] = append_string (strings, author->name, -1, encoding);
+	table->author_emails[index] = append_string (strings, author->email, -1, encoding);
+	table->author_times[index] = author->when.time;
+	table->author_offsets[index] = author->when.offset;
+
+	table->committer_names[index] = append_string (strings, committer->name, -1, encoding);
+	table->committer_emails[index] = append_string (strings, committer->email, -1, encoding);
+	table->committer_times[index] = committer->when.time;
+	table->committer_offsets[index] = committer->when.offset;
+
+	/* The subject is the first line of the message */
+	message = git_commit_message (commit);
+	eol = message != NULL ? strchr (message, '\n') : NULL;
+
+	table->subjects[index] = append_string (strings,
+	                                        message,
+	                                        eol != NULL ? eol - message : -1,
+	                                        encoding);
+
+	n_parents = git_commit_parentcount (commit);
+
+	for (i = 0; i < n_parents; i++)
+	{
+		g_array_append_vals (parent_ids,
+		                     git_commit_parent_id (commit, i)->id,
+		                     GIT_OID_RAWSZ);
+	}
+
+	table->parent_offsets[index + 1] = table->parent_offsets[index] + n_parents;
+
+	git_commit_free (commit);
+
+	return GIT_OK;
+}
+
+/**
+ * ggit_commit_table_new:
+ * @repository: a #GgitRepository.
+ * @raw_ids: the packed 20 byte raw ids of the commits.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Loads the metadata of the commits in @raw_ids, in that order, into a new
+ * table. The commits are parsed one after the other without creating a
+ * #GgitCommit or #GgitSignature for any of them. The packed ids are in the
+ * format returned by ggit_revision_walker_collect().
+ *
+ * Returns: (transfer full) (nullable): a #GgitCommitTable or %NULL if
+ * there was an error.
+ */
+GgitCommitTable *
+ggit_commit_table_new (GgitRepository  *repository,
+                       GBytes          *raw_ids,
+                       GError         **error)
+{
+	GgitCommitTable *table;
+	git_repository *repo;
+	GString *strings;
+	GArray *parent_ids;
+	gconstpointer data;
+	gsize size;
+	guint n_parents;
+	guint i;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (raw_ids != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	data = g_bytes_get_data (raw_ids, &size);
+
+	if (size % GIT_OID_RAWSZ != 0 || size / GIT_OID_RAWSZ >= G_MAXINT32)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_INVALID_ARGUMENT,
+		                     "Invalid list of raw commit ids");
+
+		return NULL;
+	}
+
+	repo = _ggit_repository_get_repository (repository);
+
+	table = g_slice_new0 (GgitCommitTable);
+	table->ref_count = 1;
+
+	table->n_commits = size / GIT_OID_RAWSZ;
+	table->ids = g_malloc (size);
+	memcpy (table->ids, data, size);
+
+	table->parent_offsets = g_new0 (guint32, table->n_commits + 1);
+
+	table->author_names = g_new (guint32, table->n_commits);
+	table->author_emails = g_new (guint32, table->n_commits);
+	table->author_times = g_new (gint64, table->n_commits);
+	table->author_offsets = g_new (gint32, table->n_commits);
+
+	table->committer_names = g_new (guint32, table->n_commits);
+	table->committer_emails = g_new (guint32, table->n_commits);
+	table->committer_times = g_new (gint64, table->n_commits);
+	table->committer_offsets = g_new (gint32, table->n_commits);
+
+	table->subjects = g_new (guint32, table->n_commits);
+
+	_ggit_oid_table_init (&table->index, TRUE);
+	_ggit_oid_table_reserve (&table->index, table->n_commits);
+
+	/* Roughly a name, an email and a subject per commit */
+	strings = g_string_sized_new (table->n_commits * 64 + 1);
+	parent_ids = g_array_sized_new (FALSE, FALSE, 1, table->n_commits * GIT_OID_RAWSZ);
+
+	for (i = 0; i < table->n_commits; i++)
+	{
+		gboolean added;
+		gsize slot;
+		gint ret;
+
+		ret = load_commit (table, repo, i, strings, parent_ids);
+
+		if (ret == GIT_OK && strings->len > G_MAXUINT32)
+		{
+			ret = GIT_EBUFS;
+		}
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (error, ret);
+
+			g_string_free (strings, TRUE);
+			g_array_free (parent_ids, TRUE);
+			ggit_commit_table_unref (table);
+
+			return NULL;
+		}
+
+		/* Keep the first occurrence of a commit listed twice */
+		slot = _ggit_oid_table_insert (&table->index, table->ids + i * GIT_OID_RAWSZ, &added);
+
+		if (added)
+		{
+			table->index.values[slot] = GUINT_TO_POINTER (i + 1);
+		}
+	}
+
+	table->strings_size = strings->len;
+	table->strings = g_string_free (strings, FALSE);
+
+	n_parents = table->parent_offsets[table->n_commits];
+	table->parent_ids = (guint8 *)g_array_free (parent_ids, FALSE);
+	table->parent_indices = g_new (gint32, n_parents);
+
+	/* Resolve the parents once all the commits are known */
+	for (i = 0; i < n_parents; i++)
+	{
+		gssize slot;
+
+		slot = _ggit_oid_table_lookup (&table->index,
+		                               table->parent_ids + i * GIT_OID_RAWSZ);
+
+		table->parent_indices[i] = slot >= 0 ? GPOINTER_TO_INT (table->index.values[slot]) - 1
+		                                     : -1;
+	}
+
+	return table;
+}
+
+/**
+ * ggit_commit_table_new_from_revision_walker:
+ * @walker: a #GgitRevisionWalker.
+ * @max_commits: the maximum number of commits to load, or 0 to load all
+ *               the remaining commits of the walk.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Walks the next commits of @walker and loads their metadata into a new
+ * table, in the order of the walk. See ggit_commit_table_new().
+ *
+ * Returns: (transfer full) (nullable): a #GgitCommitTable or %NULL if
+ * there was an error.
+ */
+GgitCommitTable *
+ggit_commit_table_new_from_revision_walker (GgitRevisionWalker  *walker,
+                                            gsize                max_commits,
+                                            GError             **error)
+{
+	GgitCommitTable *table;
+	GBytes *raw_ids;
+
+	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	raw_ids = ggit_revision_walker_collect (walker, max_commits, error);
+
+	if (raw_ids == NULL)
+	{
+		return NULL;
+	}
+
+	table = ggit_commit_table_new (ggit_revision_walker_get_repository (walker),
+	                               raw_ids,
+	                               error);
+
+	g_bytes_unref (raw_ids);
+
+	return table;
+}
+
+/**
+ * ggit_commit_table_ref:
+ * @table: a #GgitCommitTable.
+ *
+ * Atomically increments the reference count of @table by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitCommitTable.
+ */
+GgitCommitTable *
+ggit_commit_table_ref (GgitCommitTable *table)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+
+	g_atomic_int_inc (&table->ref_count);
+
+	return table;
+}
+
+/**
+ * ggit_commit_table_unref:
+ * @table: a #GgitCommitTable.
+ *
+ * Atomically decrements the reference count of @table by one.
+ * If the reference count drops to 0, @table is freed.
+ */
+void
+ggit_commit_table_unref (GgitCommitTable *table)
+{
+	g_return_if_fail (table != NULL);
+
+	if (g_atomic_int_dec_and_test (&table->ref_count))
+	{
+		g_free (table->ids);
+
+		g_free (table->parent_offsets);
+		g_free (table->parent_indices);
+		g_free (table->parent_ids);
+
+		g_free (table->author_names);
+		g_free (table->author_emails);
+		g_free (table->author_times);
+		g_free (table->author_offsets);
+
+		g_free (table->committer_names);
+		g_free (table->committer_emails);
+		g_free (table->committer_times);
+		g_free (table->committer_offsets);
+
+		g_free (table->subjects);
+		g_free (table->strings);
+
+		_ggit_oid_table_clear (&table->index, NULL);
+
+		g_slice_free (GgitCommitTable, table);
+	}
+}
+
+/**
+ * ggit_commit_table_get_size:
+ * @table: a #GgitCommitTable.
+ *
+ * Gets the number of commits in @table.
+ *
+ * Returns: the number of commits.
+ */
+guint
+ggit_commit_table_get_size (GgitCommitTable *table)
+{
+	g_return_val_if_fail (table != NULL, 0);
+
+	return table->n_commits;
+}
+
+/**
+ * ggit_commit_table_find:
+ * @table: a #GgitCommitTable.
+ * @oid: a #GgitOId.
+ * @index: (out) (optional): return location for the index of the commit.
+ *
+ * Finds the index of the commit with id @oid. If the commit is listed more
+ * than once, its first index is returned.
+ *
+ * Returns: %TRUE if the commit is in @table, %FALSE otherwise.
+ */
+gboolean
+ggit_commit_table_find (GgitCommitTable *table,
+                        GgitOId         *oid,
+                        guint           *index)
+{
+	gssize slot;
+
+	g_return_val_if_fail (table != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	slot = _ggit_oid_table_lookup (&table->index, _ggit_oid_get_oid (oid)->id);
+
+	if (slot < 0)
+	{
+		return FALSE;
+	}
+
+	if (index != NULL)
+	{
+		*index = GPOINTER_TO_UINT (table->index.values[slot]) - 1;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_commit_table_get_id:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the id of a commit.
+ *
+ * Returns: (transfer full): the #GgitOId of the commit.
+ */
+GgitOId *
+ggit_commit_table_get_id (GgitCommitTable *table,
+                          guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return ggit_oid_new_from_raw (table->ids + index * GIT_OID_RAWSZ);
+}
+
+/**
+ * ggit_commit_table_get_raw_id:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the 20 byte raw id of a commit.
+ *
+ * Returns: (transfer none) (array fixed-size=20): the raw id of the commit.
+ */
+const guint8 *
+ggit_commit_table_get_raw_id (GgitCommitTable *table,
+                              guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return table->ids + index * GIT_OID_RAWSZ;
+}
+
+/**
+ * ggit_commit_table_get_parents:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ * @n_parents: (out): return location for the number of parents.
+ *
+ * Gets the indices of the parents of a commit in @table, in the order of
+ * the parents. A parent which is not in @table has index -1, its id can
+ * be retrieved with ggit_commit_table_get_parent_raw_id().
+ *
+ * Returns: (transfer none) (array length=n_parents): the parent indices.
+ */
+const gint32 *
+ggit_commit_table_get_parents (GgitCommitTable *table,
+                               guint            index,
+                               guint           *n_parents)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+	g_return_val_if_fail (n_parents != NULL, NULL);
+
+	*n_parents = table->parent_offsets[index + 1] - table->parent_offsets[index];
+
+	return table->parent_indices + table->parent_offsets[index];
+}
+
+/**
+ * ggit_commit_table_get_parent_raw_id:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ * @nth: the parent of the commit.
+ *
+ * Gets the 20 byte raw id of the @nth parent of a commit.
+ *
+ * Returns: (transfer none) (array fixed-size=20) (nullable): the raw id of
+ * the parent or %NULL if the commit has less than @nth + 1 parents.
+ */
+const guint8 *
+ggit_commit_table_get_parent_raw_id (GgitCommitTable *table,
+                                     guint            index,
+                                     guint            nth)
+{
+	guint32 parent;
+
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	parent = table->parent_offsets[index] + nth;
+
+	if (parent >= table->parent_offsets[index + 1])
+	{
+		return NULL;
+	}
+
+	return table->parent_ids + parent * GIT_OID_RAWSZ;
+}
+
+/**
+ * ggit_commit_table_get_author_name:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the name of the author of a commit.
+ *
+ * Returns: (transfer none): the author name, in UTF-8.
+ */
+const gchar *
+ggit_commit_table_get_author_name (GgitCommitTable *table,
+                                   guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return table->strings + table->author_names[index];
+}
+
+/**
+ * ggit_commit_table_get_author_email:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the email of the author of a commit.
+ *
+ * Returns: (transfer none): the author email, in UTF-8.
+ */
+const gchar *
+ggit_commit_table_get_author_email (GgitCommitTable *table,
+                                    guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return table->strings + table->author_emails[index];
+}
+
+/**
+ * ggit_commit_table_get_author_time:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the author time of a commit.
+ *
+ * Returns: the author time in seconds since the epoch.
+ */
+gint64
+ggit_commit_table_get_author_time (GgitCommitTable *table,
+                                   guint            index)
+{
+	g_return_val_if_fail (table != NULL, 0);
+	g_return_val_if_fail (index < table->n_commits, 0);
+
+	return table->author_times[index];
+}
+
+/**
+ * ggit_commit_table_get_author_utc_offset:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the timezone of the author time of a commit.
+ *
+ * Returns: the offset from UTC in minutes.
+ */
+gint
+ggit_commit_table_get_author_utc_offset (GgitCommitTable *table,
+                                         guint            index)
+{
+	g_return_val_if_fail (table != NULL, 0);
+	g_return_val_if_fail (index < table->n_commits, 0);
+
+	return table->author_offsets[index];
+}
+
+/**
+ * ggit_commit_table_get_committer_name:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the name of the committer of a commit.
+ *
+ * Returns: (transfer none): the committer name, in UTF-8.
+ */
+const gchar *
+ggit_commit_table_get_committer_name (GgitCommitTable *table,
+                                      guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return table->strings + table->committer_names[index];
+}
+
+/**
+ * ggit_commit_table_get_committer_email:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the email of the committer of a commit.
+ *
+ * Returns: (transfer none): the committer email, in UTF-8.
+ */
+const gchar *
+ggit_commit_table_get_committer_email (GgitCommitTable *table,
+                                       guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return table->strings + table->committer_emails[index];
+}
+
+/**
+ * ggit_commit_table_get_committer_time:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the commit time of a commit.
+ *
+ * Returns: the commit time in seconds since the epoch.
+ */
+gint64
+ggit_commit_table_get_committer_time (GgitCommitTable *table,
+                                      guint            index)
+{
+	g_return_val_if_fail (table != NULL, 0);
+	g_return_val_if_fail (index < table->n_commits, 0);
+
+	return table->committer_times[index];
+}
+
+/**
+ * ggit_commit_table_get_committer_utc_offset:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the timezone of the commit time of a commit.
+ *
+ * Returns: the offset from UTC in minutes.
+ */
+gint
+ggit_commit_table_get_committer_utc_offset (GgitCommitTable *table,
+                                            guint            index)
+{
+	g_return_val_if_fail (table != NULL, 0);
+	g_return_val_if_fail (index < table->n_commits, 0);
+
+	return table->committer_offsets[index];
+}
+
+/**
+ * ggit_commit_table_get_subject:
+ * @table: a #GgitCommitTable.
+ * @index: the index of the commit.
+ *
+ * Gets the subject of a commit, which is the first line of its message.
+ *
+ * Returns: (transfer none): the subject, in UTF-8.
+ */
+const gchar *
+ggit_commit_table_get_subject (GgitCommitTable *table,
+                               guint            index)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (index < table->n_commits, NULL);
+
+	return table->strings + table->subjects[index];
+}
+
+/**
+ * ggit_commit_table_get_raw_ids:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the packed 20 byte raw ids of all the commits, the id of commit i
+ * starting at byte i * 20.
+ *
+ * Returns: (transfer none): the raw ids.
+ */
+const guint8 *
+ggit_commit_table_get_raw_ids (GgitCommitTable *table,
+                               guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->ids;
+}
+
+/**
+ * ggit_commit_table_get_parent_offsets:
+ * @table: a #GgitCommitTable.
+ * @n_offsets: (out): return location for the number of offsets.
+ *
+ * Gets the offsets of the parents of all the commits into the array
+ * returned by ggit_commit_table_get_parent_indices(). The parents of commit
+ * i go from offset i up to, but not including, offset i + 1, so there is
+ * one more offset than there are commits.
+ *
+ * Returns: (transfer none) (array length=n_offsets): the parent offsets.
+ */
+const guint32 *
+ggit_commit_table_get_parent_offsets (GgitCommitTable *table,
+                                      guint           *n_offsets)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_offsets != NULL, NULL);
+
+	*n_offsets = table->n_commits + 1;
+
+	return table->parent_offsets;
+}
+
+/**
+ * ggit_commit_table_get_parent_indices:
+ * @table: a #GgitCommitTable.
+ * @n_parents: (out): return location for the number of parents.
+ *
+ * Gets the indices of the parents of all the commits, -1 for a parent which
+ * is not in @table. See ggit_commit_table_get_parent_offsets().
+ *
+ * Returns: (transfer none) (array length=n_parents): the parent indices.
+ */
+const gint32 *
+ggit_commit_table_get_parent_indices (GgitCommitTable *table,
+                                      guint           *n_parents)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_parents != NULL, NULL);
+
+	*n_parents = table->parent_offsets[table->n_commits];
+
+	return table->parent_indices;
+}
+
+/**
+ * ggit_commit_table_get_author_times:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the author times of all the commits, in seconds since the epoch.
+ *
+ * Returns: (transfer none) (array length=n_commits): the author times.
+ */
+const gint64 *
+ggit_commit_table_get_author_times (GgitCommitTable *table,
+                                    guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->author_times;
+}
+
+/**
+ * ggit_commit_table_get_committer_times:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the commit times of all the commits, in seconds since the epoch.
+ *
+ * Returns: (transfer none) (array length=n_commits): the commit times.
+ */
+const gint64 *
+ggit_commit_table_get_committer_times (GgitCommitTable *table,
+                                       guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->committer_times;
+}
+
+/**
+ * ggit_commit_table_get_strings:
+ * @table: a #GgitCommitTable.
+ * @size: (out): return location for the size of the buffer.
+ *
+ * Gets the buffer holding all the strings of @table. Each string is
+ * terminated by a nul byte and starts at the offset given by one of the
+ * string columns, such as ggit_commit_table_get_subject_offsets().
+ *
+ * Returns: (transfer none) (array length=size) (element-type guint8): the
+ * string buffer.
+ */
+const gchar *
+ggit_commit_table_get_strings (GgitCommitTable *table,
+                               gsize           *size)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (size != NULL, NULL);
+
+	*size = table->strings_size;
+
+	return table->strings;
+}
+
+/**
+ * ggit_commit_table_get_author_name_offsets:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the offsets of the author names of all the commits into the buffer
+ * returned by ggit_commit_table_get_strings().
+ *
+ * Returns: (transfer none) (array length=n_commits): the string offsets.
+ */
+const guint32 *
+ggit_commit_table_get_author_name_offsets (GgitCommitTable *table,
+                                           guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->author_names;
+}
+
+/**
+ * ggit_commit_table_get_author_email_offsets:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the offsets of the author emails of all the commits into the buffer
+ * returned by ggit_commit_table_get_strings().
+ *
+ * Returns: (transfer none) (array length=n_commits): the string offsets.
+ */
+const guint32 *
+ggit_commit_table_get_author_email_offsets (GgitCommitTable *table,
+                                            guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->author_emails;
+}
+
+/**
+ * ggit_commit_table_get_committer_name_offsets:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the offsets of the committer names of all the commits into the
+ * buffer returned by ggit_commit_table_get_strings().
+ *
+ * Returns: (transfer none) (array length=n_commits): the string offsets.
+ */
+const guint32 *
+ggit_commit_table_get_committer_name_offsets (GgitCommitTable *table,
+                                              guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->committer_names;
+}
+
+/**
+ * ggit_commit_table_get_committer_email_offsets:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the offsets of the committer emails of all the commits into the
+ * buffer returned by ggit_commit_table_get_strings().
+ *
+ * Returns: (transfer none) (array length=n_commits): the string offsets.
+ */
+const guint32 *
+ggit_commit_table_get_committer_email_offsets (GgitCommitTable *table,
+                                               guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->committer_emails;
+}
+
+/**
+ * ggit_commit_table_get_subject_offsets:
+ * @table: a #GgitCommitTable.
+ * @n_commits: (out): return location for the number of commits.
+ *
+ * Gets the offsets of the subjects of all the commits into the buffer
+ * returned by ggit_commit_table_get_strings().
+ *
+ * Returns: (transfer none) (array length=n_commits): the string offsets.
+ */
+const guint32 *
+ggit_commit_table_get_subject_offsets (GgitCommitTable *table,
+                                       guint           *n_commits)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (n_commits != NULL, NULL);
+
+	*n_commits = table->n_commits;
+
+	return table->subjects;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,134 @@
+/*
+ * ggit-commit-table.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __GGIT_COMMIT_TABLE_H__
+#define __GGIT_COMMIT_TABLE_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_COMMIT_TABLE       (ggit_commit_table_get_type ())
+#define GGIT_COMMIT_TABLE(obj)       ((GgitCommitTable *)obj)
+
+GType            ggit_commit_table_get_type                 (void) G_GNUC_CONST;
+
+GgitCommitTable *ggit_commit_table_new                      (GgitRepository      *repository,
+                                                             GBytes              *raw_ids,
+                                                             GError             **error);
+
+GgitCommitTable *ggit_commit_table_new_from_revision_walker (GgitRevisionWalker  *walker,
+                                                             gsize                max_commits,
+                                                             GError             **error);
+
+GgitCommitTable *ggit_commit_table_ref                      (GgitCommitTable     *table);
+void             ggit_commit_table_unref                    (GgitCommitTable     *table);
+
+guint            ggit_commit_table_get_size                 (GgitCommitTable     *table);
+
+gboolean         ggit_commit_table_find                     (GgitCommitTable     *table,
+                                                             GgitOId             *oid,
+                                                             guint               *index);
+
+GgitOId         *ggit_commit_table_get_id                   (GgitCommitTable     *table,
+                                                             guint                index);
+
+const guint8    *ggit_commit_table_get_raw_id               (GgitCommitTable     *table,
+                                                             guint                index);
+
+const gint32    *ggit_commit_table_get_parents              (GgitCommitTable     *table,
+                                                             guint                index,
+                                                             guint               *n_parents);
+
+const guint8    *ggit_commit_table_get_parent_raw_id        (GgitCommitTable     *table,
+                                                             guint                index,
+                                                             guint                nth);
+
+const gchar     *ggit_commit_table_get_author_name          (GgitCommitTable     *table,
+                                                             guint                index);
+
+const gchar     *ggit_commit_table_get_author_email         (GgitCommitTable     *table,
+                                                             guint                index);
+
+gint64           ggit_commit_table_get_author_time          (GgitCommitTable     *table,
+                                                             guint                index);
+
+gint             ggit_commit_table_get_author_utc_offset    (GgitCommitTable     *table,
+                                                             guint                index);
+
+const gchar     *ggit_commit_table_get_committer_name       (GgitCommitTable     *table,
+                                                             guint                index);
+
+const gchar     *ggit_commit_table_get_committer_email      (GgitCommitTable     *table,
+                                                             guint                index);
+
+gint64           ggit_commit_table_get_committer_time       (GgitCommitTable     *table,
+                                                             guint                index);
+
+gint             ggit_commit_table_get_committer_utc_offset (GgitCommitTable     *table,
+                                                             guint                index);
+
+const gchar     *ggit_commit_table_get_subject              (GgitCommitTable     *table,
+                                                             guint                index);
+
+const guint8    *ggit_commit_table_get_raw_ids              (GgitCommitTable     *table,
+                                                             guint               *n_commits);
+
+const guint32   *ggit_commit_table_get_parent_offsets       (GgitCommitTable     *table,
+                                                             guint               *n_offsets);
+
+const gint32    *ggit_commit_table_get_parent_indices       (GgitCommitTable     *table,
+                                                             guint               *n_parents);
+
+const gint64    *ggit_commit_table_get_author_times         (GgitCommitTable     *table,
+                                                             guint               *n_commits);
+
+const gint64    *ggit_commit_table_get_committer_times      (GgitCommitTable     *table,
+                                                             guint               *n_commits);
+
+const gchar     *ggit_commit_table_get_strings              (GgitCommitTable     *table,
+                                                             gsize               *size);
+
+const guint32   *ggit_commit_table_get_author_name_offsets  (GgitCommitTable     *table,
+                                                             guint               *n_commits);
+
+const guint32   *ggit_commit_table_get_author_email_offsets (GgitCommitTable     *table,
+                                                             guint               *n_commits);
+
+const guint32   *ggit_commit_table_get_committer_name_offsets (GgitCommitTable   *table,
+                                                               guint             *n_commits);
+
+const guint32   *ggit_commit_table_get_committer_email_offsets (GgitCommitTable  *table,
+                                                                guint            *n_commits);
+
+const guint32   *ggit_commit_table_get_subject_offsets      (GgitCommitTable     *table,
+                                                             guint               *n_commits);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitCommitTable, ggit_commit_table_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_COMMIT_TABLE_H__ */
+
+/* ex:set ts=8 noet: */
@@ -24,6 +24,13 @@
 #include "ggit-diff-line.h"
 #include "ggit-convert.h"
 
+enum
+{
+	CONTENT_OWNED,
+	CONTENT_BORROWED,
+	CONTENT_COPYING
+};
+
 struct _GgitDiffLine {
 	gint ref_count;
 
@@ -32,10 +39,19 @@ struct _GgitDiffLine {
 	gint new_lineno;
 	gint num_lines;
 	gint64 content_offset;
+
+	/* While borrowed, data points into the libgit2 buffer of the line
+	 * being reported, content is NULL and encoding is not owned. The
+	 * content state only changes atomically, see diff_line_materialize().
+	 */
+	const guint8 *data;
+	gsize size;
 	GBytes *content;
 
 	gchar *text;
 	gchar *encoding;
+
+	gint content_state;
 };
 
 G_DEFINE_BOXED_TYPE (GgitDiffLine, ggit_diff_line,
@@ -57,12 +73,103 @@ _ggit_diff_line_wrap (const git_diff_line *line,
 	gline->new_lineno = line->new_lineno;
 	gline->content_offset = line->content_offset;
 	gline->content = g_bytes_new (line->content, line->content_len);
+	gline->data = g_bytes_get_data (gline->content, &gline->size);
 	gline->encoding = g_strdup (encoding);
 	gline->text = NULL;
+	gline->content_state = CONTENT_OWNED;
 
 	return gline;
 }
 
+static void
+diff_line_clear (GgitDiffLine *line)
+{
+	if (g_atomic_int_get (&line->content_state) == CONTENT_OWNED)
+	{
+		g_bytes_unref (line->content);
+		g_free (line->encoding);
+	}
+
+	line->content = NULL;
+	line->encoding = NULL;
+
+	g_clear_pointer (&line->text, g_free);
+}
+
+/* Copies the borrowed content exactly once, also when several threads
+ * reference the line at the same time.
+ */
+static void
+diff_line_materialize (GgitDiffLine *line)
+{
+	if (g_atomic_int_compare_and_exchange (&line->content_state,
+	                                       CONTENT_BORROWED,
+	                                       CONTENT_COPYING))
+	{
+		line->content = g_bytes_new (line->data, line->size);
+		line->data = g_bytes_get_data (line->content, NULL);
+		line->encoding = g_strdup (line->encoding);
+
+		g_atomic_int_set (&line->content_state, CONTENT_OWNED);
+		return;
+	}
+
+	while (g_atomic_int_get (&line->content_state) == CONTENT_COPYING)
+	{
+		g_thread_yield ();
+	}
+}
+
+/*
+ * _ggit_diff_line_borrow:
+ * @cursor: (allow-none): the line returned by the previous call, or %NULL.
+ * @line: a git_diff_line.
+ * @encoding: (allow-none): the encoding of the line content.
+ *
+ * Wraps @line without copying its content. The returned #GgitDiffLine is
+ * only valid as long as @line and @encoding are, unless it is referenced
+ * with ggit_diff_line_ref(), which copies the content into the line.
+ *
+ * Passing the previously returned line as @cursor reuses it when nobody
+ * else holds a reference to it. The caller owns one reference to the
+ * returned line, drop it with ggit_diff_line_unref() after the last call.
+ *
+ * Returns: (transfer full): a #GgitDiffLine.
+ */
+GgitDiffLine *
+_ggit_diff_line_borrow (GgitDiffLine        *cursor,
+                        const git_diff_line *line,
+                        const gchar         *encoding)
+{
+	g_return_val_if_fail (line != NULL, NULL);
+
+	if (cursor != NULL && g_atomic_int_get (&cursor->ref_count) == 1)
+	{
+		diff_line_clear (cursor);
+	}
+	else
+	{
+		if (cursor != NULL)
+		{
+			ggit_diff_line_unref (cursor);
+		}
+
+		cursor = g_slice_new0 (GgitDiffLine);
+		cursor->ref_count = 1;
+	}
+
+	cursor->origin = (GgitDiffLineType)line->origin;
+	cursor->old_lineno = line->old_lineno;
+	cursor->new_lineno = line->new_lineno;
+	cursor->content_offset = line->content_offset;
+	cursor->data = (const guint8 *)line->content;
+	cursor->size = line->content_len;
+	cursor->encoding = (gchar *)encoding;
+	g_atomic_int_set (&cursor->content_state, CONTENT_BORROWED);
+
+	return cursor;
+}
+
 /**
  * ggit_diff_line_ref:
  * @line: a #GgitDiffLine.
@@ -70,6 +177,10 @@ _ggit_diff_line_wrap (const git_diff_line *line,
  * Atomically increments the reference count of @line by one.
  * This function is MT-safe and may be called from any thread.
  *
+ * Lines passed to a #GgitDiffLineCallback only borrow their content for
+ * the duration of the callback. Referencing such a line from within the
+ * callback copies the content, so that the line stays valid afterwards.
+ *
  * Returns: (transfer none) (nullable): a #GgitDiffLine or %NULL.
  **/
 GgitDiffLine *
@@ -77,6 +188,11 @@ ggit_diff_line_ref (GgitDiffLine *line)
 {
 	g_return_val_if_fail (line != NULL, NULL);
 
+	if (g_atomic_int_get (&line->content_state) != CONTENT_OWNED)
+	{
+		diff_line_materialize (line);
+	}
+
 	g_atomic_int_inc (&line->ref_count);
 
 	return line;
@@ -96,8 +212,7 @@ ggit_diff_line_unref (GgitDiffLine *line)
 
 	if (g_atomic_int_dec_and_test (&line->ref_count))
 	{
-		g_bytes_unref (line->content);
-		g_free (line->text);
+		diff_line_clear (line);
 		g_slice_free (GgitDiffLine, line);
 	}
 }
@@ -183,10 +298,10 @@ ggit_diff_line_get_content (GgitDiffLine *line,
 
 	if (length)
 	{
-		*length = g_bytes_get_size (line->content);
+		*length = line->size;
 	}
 
-	return g_bytes_get_data (line->content, NULL);
+	return line->data;
 }
 
 /**
@@ -205,12 +320,8 @@ ggit_diff_line_get_text (GgitDiffLine *line)
 
 	if (line->text == NULL)
 	{
-		const gchar *content;
-		gsize content_len;
-
-		content = g_bytes_get_data (line->content, &content_len);
-		line->text = ggit_convert_utf8 (content,
-		                                content_len,
+		line->text = ggit_convert_utf8 ((const gchar *)line->data,
+		                                line->size,
 		                                line->encoding);
 	}
 
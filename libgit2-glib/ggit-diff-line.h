@@ -35,6 +35,10 @@ GType             ggit_diff_line_get_type           (void) G_GNUC_CONST;
 GgitDiffLine     *_ggit_diff_line_wrap              (const git_diff_line *line,
                                                      const gchar         *encoding);
 
+GgitDiffLine     *_ggit_diff_line_borrow            (GgitDiffLine        *cursor,
+                                                     const git_diff_line *line,
+                                                     const gchar         *encoding);
+
 GgitDiffLine     *ggit_diff_line_ref                (GgitDiffLine        *line);
 void              ggit_diff_line_unref              (GgitDiffLine        *line);
 
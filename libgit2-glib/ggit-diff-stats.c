@@ -0,0 +1,695 @@
+/*
+ * ggit-diff-stats.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ggit-diff-stats.h"
+#include "ggit-async.h"
+#include "ggit-diff.h"
+#include "ggit-error.h"
+
+/* Number of consecutive deltas a worker takes at once */
+#define SHARD_SIZE 16
+
+/**
+ * GgitDiffStats:
+ *
+ * The number of inserted and deleted lines of each file in a diff, and
+ * their totals, as shown by `git diff --stat`. Only the numbers are kept,
+ * no lines or hunks.
+ */
+struct _GgitDiffStats
+{
+	gint ref_count;
+
+	guint n_files;
+	gchar **paths;
+	guint8 *statuses;
+	gboolean *binary;
+	gsize *insertions;
+	gsize *deletions;
+
+	gsize files_changed;
+	gsize total_insertions;
+	gsize total_deletions;
+};
+
+typedef struct
+{
+	GgitDiffStats *stats;
+	GgitDiff *diff;
+	git_diff *gdiff;
+	GCancellable *cancellable;
+
+	gint next;
+	gint stop;
+
+	GMutex lock;
+	GError *error;
+} StatsState;
+
+/* Where the callbacks count the lines */
+typedef struct
+{
+	GgitDiffStats *stats;
+	GCancellable *cancellable;
+	guint index;
+
+	/* Set when iterating over all of @diff, to find the index of the
+	 * delta passed to the file callback */
+	git_diff *diff;
+} CountData;
+
+G_DEFINE_BOXED_TYPE (GgitDiffStats, ggit_diff_stats,
+                     ggit_diff_stats_ref, ggit_diff_stats_unref)
+
+static gint
+count_file_cb (const git_diff_delta *delta,
+               gfloat                progress,
+               gpointer              payload)
+{
+	CountData *data = payload;
+
+	if (g_cancellable_is_cancelled (data->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	/* git_diff_foreach() goes through the deltas in order, skipping
+	 * the unmodified ones */
+	if (data->diff != NULL)
+	{
+		while (data->index < data->stats->n_files &&
+		       git_diff_get_delta (data->diff, data->index) != delta)
+		{
+			data->index++;
+		}
+
+		g_return_val_if_fail (data->index < data->stats->n_files, GIT_EUSER);
+	}
+
+	return GIT_OK;
+}
+
+static gint
+count_binary_cb (const git_diff_delta  *delta,
+                 const git_diff_binary *binary,
+                 gpointer               payload)
+{
+	CountData *data = payload;
+
+	data->stats->binary[data->index] = TRUE;
+
+	return GIT_OK;
+}
+
+static gint
+count_line_cb (const git_diff_delta *delta,
+               const git_diff_hunk  *hunk,
+               const git_diff_line  *line,
+               gpointer              payload)
+{
+	CountData *data = payload;
+
+	if (line->origin == GIT_DIFF_LINE_ADDITION)
+	{
+		data->stats->insertions[data->index]++;
+	}
+	else if (line->origin == GIT_DIFF_LINE_DELETION)
+	{
+		data->stats->deletions[data->index]++;
+	}
+
+	return GIT_OK;
+}
+
+static void
+set_file (GgitDiffStats  *stats,
+          git_diff       *diff,
+          guint           index)
+{
+	const git_diff_delta *delta;
+
+	delta = git_diff_get_delta (diff, index);
+
+	stats->paths[index] = g_strdup (delta->new_file.path != NULL ? delta->new_file.path
+	                                                              : delta->old_file.path);
+	stats->statuses[index] = delta->status;
+}
+
+/* Looks up the blob of one side of a delta, if it has one */
+static gint
+lookup_side_blob (git_blob            **blob,
+                  git_repository       *repo,
+                  const git_diff_file  *file)
+{
+	*blob = NULL;
+
+	if (git_oid_iszero (&file->id))
+	{
+		return GIT_OK;
+	}
+
+	return git_blob_lookup (blob, repo, &file->id);
+}
+
+/* The contents libgit2 diffs for a submodule, whose commit is not in the
+ * repository */
+static gchar *
+gitlink_contents (const git_diff_file *file)
+{
+	gchar sha[GIT_OID_HEXSZ + 1];
+
+	git_oid_tostr (sha, sizeof (sha), &file->id);
+
+	return g_strdup_printf ("Subproject commit %s\n", sha);
+}
+
+/* Diffs the blobs of a delta on its own, in @repo. Submodule sides are
+ * not looked up, they are diffed as their "Subproject commit" line. */
+static gint
+count_file (GgitDiffStats          *stats,
+            git_diff               *diff,
+            guint                   index,
+            git_repository         *repo,
+            const git_diff_options *options,
+            GCancellable           *cancellable)
+{
+	const git_diff_delta *delta;
+	CountData data = { 0 };
+	git_blob *blob = NULL; /* the old blob, or the one next to a submodule */
+	git_blob *new_blob = NULL;
+	gboolean old_gitlink;
+	gboolean new_gitlink;
+	gint ret;
+
+	set_file (stats, diff, index);
+	delta = git_diff_get_delta (diff, index);
+
+	if (delta->status == GIT_DELTA_UNMODIFIED)
+	{
+		return GIT_OK;
+	}
+
+	data.stats = stats;
+	data.cancellable = cancellable;
+	data.index = index;
+
+	old_gitlink = delta->old_file.mode == GIT_FILEMODE_COMMIT;
+	new_gitlink = delta->new_file.mode == GIT_FILEMODE_COMMIT;
+
+	if (old_gitlink && new_gitlink)
+	{
+		/* A single line on each side */
+		if (!git_oid_equal (&delta->old_file.id, &delta->new_file.id))
+		{
+			stats->insertions[index] = 1;
+			stats->deletions[index] = 1;
+		}
+
+		return GIT_OK;
+	}
+	else if (old_gitlink || new_gitlink)
+	{
+		const git_diff_file *blob_file;
+		const git_diff_file *gitlink_file;
+		git_diff_options gitlink_options = GIT_DIFF_OPTIONS_INIT;
+		gchar *contents;
+
+		blob_file = old_gitlink ? &delta->new_file : &delta->old_file;
+		gitlink_file = old_gitlink ? &delta->old_file : &delta->new_file;
+
+		ret = lookup_side_blob (&blob, repo, blob_file);
+
+		if (ret != GIT_OK)
+		{
+			return ret;
+		}
+
+		if (options != NULL)
+		{
+			gitlink_options = *options;
+		}
+
+		/* The blob is always the old side here, swap them back when
+		 * it is the new one */
+		if (old_gitlink)
+		{
+			gitlink_options.flags |= GIT_DIFF_REVERSE;
+		}
+
+		contents = gitlink_contents (gitlink_file);
+
+		ret = git_diff_blob_to_buffer (blob, blob_file->path,
+		                               contents, strlen (contents),
+		                               gitlink_file->path,
+		                               &gitlink_options,
+		                               count_file_cb,
+		                               count_binary_cb,
+		                               NULL,
+		                               count_line_cb,
+		                               &data);
+
+		g_free (contents);
+	}
+	else
+	{
+		ret = lookup_side_blob (&blob, repo, &delta->old_file);
+
+		if (ret == GIT_OK)
+		{
+			ret = lookup_side_blob (&new_blob, repo, &delta->new_file);
+		}
+
+		if (ret == GIT_OK)
+		{
+			ret = git_diff_blobs (blob, delta->old_file.path,
+			                      new_blob, delta->new_file.path,
+			                      options,
+			                      count_file_cb,
+			                      count_binary_cb,
+			                      NULL,
+			                      count_line_cb,
+			                      &data);
+		}
+	}
+
+	if (blob != NULL)
+	{
+		git_blob_free (blob);
+	}
+
+	if (new_blob != NULL)
+	{
+		git_blob_free (new_blob);
+	}
+
+	return ret;
+}
+
+static void
+stats_set_error (StatsState *state,
+                 gint        ret)
+{
+	/* The libgit2 error is per thread, get it here */
+	g_mutex_lock (&state->lock);
+
+	if (state->error == NULL && !g_cancellable_is_cancelled (state->cancellable))
+	{
+		_ggit_error_set (&state->error, ret);
+	}
+
+	g_mutex_unlock (&state->lock);
+
+	g_atomic_int_set (&state->stop, TRUE);
+}
+
+static gpointer
+stats_worker (gpointer data)
+{
+	StatsState *state = data;
+	GgitDiffStats *stats = state->stats;
+	git_repository *repo;
+	const git_diff_options *diff_options;
+	git_diff_options options = GIT_DIFF_OPTIONS_INIT;
+
+	if (!_ggit_diff_open_repository (state->diff, &repo, &diff_options))
+	{
+		stats_set_error (state, GIT_ERROR);
+		return NULL;
+	}
+
+	if (diff_options != NULL)
+	{
+		options = *diff_options;
+	}
+
+	/* The old and new sides of the deltas are already swapped */
+	options.flags &= ~GIT_DIFF_REVERSE;
+
+	while (!g_atomic_int_get (&state->stop))
+	{
+		guint start;
+		guint end;
+		guint i;
+
+		start = (guint)g_atomic_int_add (&state->next, SHARD_SIZE);
+
+		if (start >= stats->n_files ||
+		    g_cancellable_is_cancelled (state->cancellable))
+		{
+			break;
+		}
+
+		end = MIN (start + SHARD_SIZE, stats->n_files);
+
+		for (i = start; i < end; i++)
+		{
+			gint ret;
+
+			ret = count_file (stats, state->gdiff, i, repo, &options, state->cancellable);
+
+			if (ret != GIT_OK)
+			{
+				stats_set_error (state, ret);
+				break;
+			}
+		}
+	}
+
+	git_repository_free (repo);
+
+	return NULL;
+}
+
+/* Counts all files on the calling thread, in a single pass over @diff */
+static void
+count_all (StatsState *state)
+{
+	GgitDiffStats *stats = state->stats;
+	CountData data = { 0 };
+	guint i;
+	gint ret;
+
+	for (i = 0; i < stats->n_files; i++)
+	{
+		set_file (stats, state->gdiff, i);
+	}
+
+	data.stats = stats;
+	data.cancellable = state->cancellable;
+	data.diff = state->gdiff;
+
+	ret = git_diff_foreach (state->gdiff,
+	                        count_file_cb,
+	                        count_binary_cb,
+	                        NULL,
+	                        count_line_cb,
+	                        &data);
+
+	if (ret != GIT_OK)
+	{
+		stats_set_error (state, ret);
+	}
+}
+
+GgitDiffStats *
+_ggit_diff_stats_new (GgitDiff      *diff,
+                      guint          n_threads,
+                      GCancellable  *cancellable,
+                      GError       **error)
+{
+	GgitDiffStats *stats;
+	StatsState state = { 0 };
+	guint i;
+
+	stats = g_slice_new0 (GgitDiffStats);
+	stats->ref_count = 1;
+
+	state.stats = stats;
+	state.diff = diff;
+	state.gdiff = _ggit_native_get (diff);
+	state.cancellable = cancellable;
+
+	stats->n_files = git_diff_num_deltas (state.gdiff);
+	stats->paths = g_new0 (gchar *, stats->n_files);
+	stats->statuses = g_new0 (guint8, stats->n_files);
+	stats->binary = g_new0 (gboolean, stats->n_files);
+	stats->insertions = g_new0 (gsize, stats->n_files);
+	stats->deletions = g_new0 (gsize, stats->n_files);
+
+	g_mutex_init (&state.lock);
+
+	/* Each shard diffs the blobs of its deltas on a separate repository
+	 * handle, which only works for diffs between two trees.
+	 */
+	if (n_threads > 1 &&
+	    (git_libgit2_features () & GIT_FEATURE_THREADS) &&
+	    _ggit_diff_can_copy (diff))
+	{
+		_ggit_async_run_parallel (stats_worker, &state, n_threads);
+	}
+	else
+	{
+		count_all (&state);
+	}
+
+	g_mutex_clear (&state.lock);
+
+	if (state.error != NULL)
+	{
+		g_propagate_error (error, state.error);
+		ggit_diff_stats_unref (stats);
+
+		return NULL;
+	}
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	{
+		ggit_diff_stats_unref (stats);
+		return NULL;
+	}
+
+	for (i = 0; i < stats->n_files; i++)
+	{
+		if (stats->statuses[i] != GIT_DELTA_UNMODIFIED)
+		{
+			stats->files_changed++;
+		}
+
+		stats->total_insertions += stats->insertions[i];
+		stats->total_deletions += stats->deletions[i];
+	}
+
+	return stats;
+}
+
+/**
+ * ggit_diff_stats_ref:
+ * @stats: a #GgitDiffStats.
+ *
+ * Atomically increments the reference count of @stats by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitDiffStats.
+ */
+GgitDiffStats *
+ggit_diff_stats_ref (GgitDiffStats *stats)
+{
+	g_return_val_if_fail (stats != NULL, NULL);
+
+	g_atomic_int_inc (&stats->ref_count);
+
+	return stats;
+}
+
+/**
+ * ggit_diff_stats_unref:
+ * @stats: a #GgitDiffStats.
+ *
+ * Atomically decrements the reference count of @stats by one.
+ * If the reference count drops to 0, @stats is freed.
+ */
+void
+ggit_diff_stats_unref (GgitDiffStats *stats)
+{
+	g_return_if_fail (stats != NULL);
+
+	if (g_atomic_int_dec_and_test (&stats->ref_count))
+	{
+		guint i;
+
+		/* Not all paths are set when counting stopped early */
+		for (i = 0; i < stats->n_files; i++)
+		{
+			g_free (stats->paths[i]);
+		}
+
+		g_free (stats->paths);
+		g_free (stats->statuses);
+		g_free (stats->binary);
+		g_free (stats->insertions);
+		g_free (stats->deletions);
+
+		g_slice_free (GgitDiffStats, stats);
+	}
+}
+
+/**
+ * ggit_diff_stats_get_files_changed:
+ * @stats: a #GgitDiffStats.
+ *
+ * Gets the number of files that are not unmodified.
+ *
+ * Returns: the number of changed files.
+ */
+gsize
+ggit_diff_stats_get_files_changed (GgitDiffStats *stats)
+{
+	g_return_val_if_fail (stats != NULL, 0);
+
+	return stats->files_changed;
+}
+
+/**
+ * ggit_diff_stats_get_insertions:
+ * @stats: a #GgitDiffStats.
+ *
+ * Gets the total number of inserted lines.
+ *
+ * Returns: the number of insertions.
+ */
+gsize
+ggit_diff_stats_get_insertions (GgitDiffStats *stats)
+{
+	g_return_val_if_fail (stats != NULL, 0);
+
+	return stats->total_insertions;
+}
+
+/**
+ * ggit_diff_stats_get_deletions:
+ * @stats: a #GgitDiffStats.
+ *
+ * Gets the total number of deleted lines.
+ *
+ * Returns: the number of deletions.
+ */
+gsize
+ggit_diff_stats_get_deletions (GgitDiffStats *stats)
+{
+	g_return_val_if_fail (stats != NULL, 0);
+
+	return stats->total_deletions;
+}
+
+/**
+ * ggit_diff_stats_get_size:
+ * @stats: a #GgitDiffStats.
+ *
+ * Gets the number of files in @stats, which is the number of deltas of the
+ * diff. Files are in the order of the deltas.
+ *
+ * Returns: the number of files.
+ */
+guint
+ggit_diff_stats_get_size (GgitDiffStats *stats)
+{
+	g_return_val_if_fail (stats != NULL, 0);
+
+	return stats->n_files;
+}
+
+/**
+ * ggit_diff_stats_get_file_path:
+ * @stats: a #GgitDiffStats.
+ * @index: the index of the file.
+ *
+ * Gets the path of a file, its new path if it was renamed.
+ *
+ * Returns: (transfer none): the path of the file.
+ */
+const gchar *
+ggit_diff_stats_get_file_path (GgitDiffStats *stats,
+                               guint          index)
+{
+	g_return_val_if_fail (stats != NULL, NULL);
+	g_return_val_if_fail (index < stats->n_files, NULL);
+
+	return stats->paths[index];
+}
+
+/**
+ * ggit_diff_stats_get_file_status:
+ * @stats: a #GgitDiffStats.
+ * @index: the index of the file.
+ *
+ * Gets how a file changed.
+ *
+ * Returns: a #GgitDeltaType.
+ */
+GgitDeltaType
+ggit_diff_stats_get_file_status (GgitDiffStats *stats,
+                                 guint          index)
+{
+	g_return_val_if_fail (stats != NULL, GGIT_DELTA_UNMODIFIED);
+	g_return_val_if_fail (index < stats->n_files, GGIT_DELTA_UNMODIFIED);
+
+	return (GgitDeltaType)stats->statuses[index];
+}
+
+/**
+ * ggit_diff_stats_get_file_is_binary:
+ * @stats: a #GgitDiffStats.
+ * @index: the index of the file.
+ *
+ * Gets whether a file is binary, in which case it has no line counts.
+ *
+ * Returns: %TRUE if the file is binary, %FALSE otherwise.
+ */
+gboolean
+ggit_diff_stats_get_file_is_binary (GgitDiffStats *stats,
+                                    guint          index)
+{
+	g_return_val_if_fail (stats != NULL, FALSE);
+	g_return_val_if_fail (index < stats->n_files, FALSE);
+
+	return stats->binary[index];
+}
+
+/**
+ * ggit_diff_stats_get_file_insertions:
+ * @stats: a #GgitDiffStats.
+ * @index: the index of the file.
+ *
+ * Gets the number of lines inserted in a file.
+ *
+ * Returns: the number of insertions.
+ */
+gsize
+ggit_diff_stats_get_file_insertions (GgitDiffStats *stats,
+                                     guint          index)
+{
+	g_return_val_if_fail (stats != NULL, 0);
+	g_return_val_if_fail (index < stats->n_files, 0);
+
+	return stats->insertions[index];
+}
+
+/**
+ * ggit_diff_stats_get_file_deletions:
+ * @stats: a #GgitDiffStats.
+ * @index: the index of the file.
+ *
+ * Gets the number of lines deleted from a file.
+ *
+ * Returns: the number of deletions.
+ */
+gsize
+ggit_diff_stats_get_file_deletions (GgitDiffStats *stats,
+                                    guint          index)
+{
+	g_return_val_if_fail (stats != NULL, 0);
+	g_return_val_if_fail (index < stats->n_files, 0);
+
+	return stats->deletions[index];
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,73 @@
+/*
+ * ggit-diff-stats.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __GGIT_DIFF_STATS_H__
+#define __GGIT_DIFF_STATS_H__
+
+#include <gio/gio.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+#include "ggit-diff.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_DIFF_STATS       (ggit_diff_stats_get_type ())
+#define GGIT_DIFF_STATS(obj)       ((GgitDiffStats *)obj)
+
+GType           ggit_diff_stats_get_type             (void) G_GNUC_CONST;
+
+GgitDiffStats *_ggit_diff_stats_new                  (GgitDiff       *diff,
+                                                      guint           n_threads,
+                                                      GCancellable   *cancellable,
+                                                      GError        **error);
+
+GgitDiffStats  *ggit_diff_stats_ref                  (GgitDiffStats  *stats);
+void            ggit_diff_stats_unref                (GgitDiffStats  *stats);
+
+gsize           ggit_diff_stats_get_files_changed    (GgitDiffStats  *stats);
+gsize           ggit_diff_stats_get_insertions       (GgitDiffStats  *stats);
+gsize           ggit_diff_stats_get_deletions        (GgitDiffStats  *stats);
+
+guint           ggit_diff_stats_get_size             (GgitDiffStats  *stats);
+
+const gchar    *ggit_diff_stats_get_file_path        (GgitDiffStats  *stats,
+                                                      guint           index);
+
+GgitDeltaType   ggit_diff_stats_get_file_status      (GgitDiffStats  *stats,
+                                                      guint           index);
+
+gboolean        ggit_diff_stats_get_file_is_binary   (GgitDiffStats  *stats,
+                                                      guint           index);
+
+gsize           ggit_diff_stats_get_file_insertions  (GgitDiffStats  *stats,
+                                                      guint           index);
+
+gsize           ggit_diff_stats_get_file_deletions   (GgitDiffStats  *stats,
+                                                      guint           index);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitDiffStats, ggit_diff_stats_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_DIFF_STATS_H__ */
+
+/* ex:set ts=8 noet: */
@@ -22,10 +22,12 @@
 
 #include <git2.h>
 
+#include "ggit-async.h"
 #include "ggit-diff.h"
 #include "ggit-diff-binary.h"
 #include "ggit-diff-delta.h"
 #include "ggit-diff-options.h"
+#include "ggit-diff-stats.h"
 #include "ggit-diff-line.h"
 #include "ggit-diff-hunk.h"
 #include "ggit-patch.h"
@@ -34,6 +36,7 @@
 #include "ggit-diff-file.h"
 #include "ggit-diff-find-options.h"
 #include "ggit-diff-format-email-options.h"
+#include "ggit-stream-writer.h"
 
 
 /**
@@ -42,10 +45,41 @@
  * Represents a diff list.
  */
 
+/* How a diff between two trees was built, to build it again on another
+ * repository handle, see _ggit_diff_open_copy().
+ */
+typedef struct
+{
+	gchar *repo_path;
+	gchar *workdir;
+
+	git_oid old_tree_id;
+	git_oid new_tree_id;
+	gboolean has_old_tree;
+	gboolean has_new_tree;
+
+	gboolean has_options;
+	git_diff_options options;
+	gchar **pathspec;
+	gchar *old_prefix;
+	gchar *new_prefix;
+
+	/* FindStep, in the order they were applied */
+	GArray *find_steps;
+} DiffRecipe;
+
+typedef struct
+{
+	gboolean has_options;
+	git_diff_find_options options;
+} FindStep;
+
 typedef struct _GgitDiffPrivate
 {
 	GgitRepository *repository;
 	gchar *encoding;
+
+	DiffRecipe *recipe;
 } GgitDiffPrivate;
 
 typedef struct {
@@ -54,8 +88,20 @@ typedef struct {
 
 	gpointer user_data;
 
-	GHashTable *cached_deltas;
-	GHashTable *cached_hunks;
+	/* The wrappers of the delta and hunk libgit2 is currently on,
+	 * reused for all of their callbacks. */
+	const git_diff_delta *delta;
+	git_oid delta_old_id;
+	git_oid delta_new_id;
+	GgitDiffDelta *delta_cursor;
+
+	const git_diff_hunk *hunk;
+	gint hunk_old_start;
+	gint hunk_new_start;
+	GgitDiffHunk *hunk_cursor;
+
+	/* reused for every line not referenced by the callback */
+	GgitDiffLine *line_cursor;
 
 	GgitDiffFileCallback file_cb;
 	GgitDiffBinaryCallback binary_cb;
@@ -72,62 +118,41 @@ enum
 };
 
 static void
-wrapper_data_init (CallbackWrapperData *data)
+wrapper_data_clear (CallbackWrapperData *data)
 {
-	if (data != NULL)
-	{
-		data->cached_deltas =
-			g_hash_table_new_full (g_str_hash,
-			                       g_str_equal,
-			                       g_free,
-			                       (GDestroyNotify) ggit_diff_delta_unref);
-
-		data->cached_hunks =
-			g_hash_table_new_full (g_str_hash,
-			                       g_str_equal,
-			                       g_free,
-			                       (GDestroyNotify) ggit_diff_hunk_unref);
-	}
+	g_clear_pointer (&data->delta_cursor, ggit_diff_delta_unref);
+	g_clear_pointer (&data->hunk_cursor, ggit_diff_hunk_unref);
+	g_clear_pointer (&data->line_cursor, ggit_diff_line_unref);
 }
 
 static GgitDiffDelta *
 wrap_diff_delta_cached (CallbackWrapperData  *data,
                         const git_diff_delta *delta)
 {
-	GgitDiffDelta *gdelta;
-	gchar *key;
-
 	if (!delta)
 	{
 		return NULL;
 	}
 
-	if (delta->old_file.path != NULL)
-	{
-		key = g_strdup_printf ("%s%s",
-		                       delta->old_file.path,
-		                       git_oid_tostr_s (&delta->old_file.id));
-	}
-	else
+	/* libgit2 passes the same delta for every callback of a file, but
+	 * the memory of a finished delta may be reused for the next one. */
+	if (delta == data->delta &&
+	    git_oid_equal (&delta->old_file.id, &data->delta_old_id) &&
+	    git_oid_equal (&delta->new_file.id, &data->delta_new_id))
 	{
-		key = g_strdup_printf ("%s%s",
-		                       delta->new_file.path,
-		                       git_oid_tostr_s (&delta->new_file.id));
+		return data->delta_cursor;
 	}
 
-	gdelta = g_hash_table_lookup (data->cached_deltas, key);
+	g_clear_pointer (&data->delta_cursor, ggit_diff_delta_unref);
+	g_clear_pointer (&data->hunk_cursor, ggit_diff_hunk_unref);
+	data->hunk = NULL;
 
-	if (!gdelta)
-	{
-		gdelta = _ggit_diff_delta_wrap (delta);
-		g_hash_table_insert (data->cached_deltas, key, gdelta);
-	}
-	else
-	{
-		g_free (key);
-	}
+	data->delta = delta;
+	git_oid_cpy (&data->delta_old_id, &delta->old_file.id);
+	git_oid_cpy (&data->delta_new_id, &delta->new_file.id);
+	data->delta_cursor = _ggit_diff_delta_wrap (delta);
 
-	return gdelta;
+	return data->delta_cursor;
 }
 
 static GgitDiffHunk *
@@ -135,42 +160,28 @@ wrap_diff_hunk_cached (CallbackWrapperData *data,
                        const git_diff_delta *delta,
                        const git_diff_hunk *hunk)
 {
-	GgitDiffHunk *ghunk;
-	gchar *key;
-
 	if (!delta || !hunk)
 	{
 		return NULL;
 	}
 
-	if (delta->old_file.path != NULL)
-	{
-		key = g_strdup_printf ("%s%s%s",
-		                       delta->old_file.path,
-		                       git_oid_tostr_s (&delta->old_file.id),
-		                       hunk->header);
-	}
-	else
+	/* Only called after the delta was wrapped, which forgets the hunk
+	 * of the previous delta. */
+	if (hunk == data->hunk &&
+	    hunk->old_start == data->hunk_old_start &&
+	    hunk->new_start == data->hunk_new_start)
 	{
-		key = g_strdup_printf ("%s%s%s",
-		                       delta->new_file.path,
-		                       git_oid_tostr_s (&delta->new_file.id),
-		                       hunk->header);
+		return data->hunk_cursor;
 	}
 
-	ghunk = g_hash_table_lookup (data->cached_hunks, key);
+	g_clear_pointer (&data->hunk_cursor, ggit_diff_hunk_unref);
 
-	if (!ghunk)
-	{
-		ghunk = _ggit_diff_hunk_wrap (hunk);
-		g_hash_table_insert (data->cached_hunks, g_strdup (key), ghunk);
-	}
-	else
-	{
-		g_free (key);
-	}
+	data->hunk = hunk;
+	data->hunk_old_start = hunk->old_start;
+	data->hunk_new_start = hunk->new_start;
+	data->hunk_cursor = _ggit_diff_hunk_wrap (hunk);
 
-	return ghunk;
+	return data->hunk_cursor;
 }
 
 static gint
@@ -211,11 +222,11 @@ ggit_diff_file_callback_wrapper (const git_diff_delta *delta,
 			if (priv->repository != NULL)
 			{
 				data->encoding =
-					ggit_repository_get_attribute (priv->repository,
-				                                       path,
-				                                       "encoding",
-				                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
-				                                       NULL);
+					_ggit_repository_lookup_attribute (priv->repository,
+				                                           path,
+				                                           "encoding",
+				                                           GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+				                                           NULL);
 			} else {
 				data->encoding = "UTF-8";
 			}
@@ -293,18 +304,36 @@ ggit_diff_line_callback_wrapper (const git_diff_delta *delta,
 	gdelta = wrap_diff_delta_cached (data, delta);
 	ghunk = wrap_diff_hunk_cached (data, delta, hunk);
 
-	gline = line == NULL ? NULL : _ggit_diff_line_wrap (line, encoding);
-
-	ret = data->line_cb (gdelta, ghunk, gline, data->user_data);
-
-	if (gline != NULL)
+	if (line != NULL)
+	{
+		data->line_cursor = _ggit_diff_line_borrow (data->line_cursor,
+		                                            line,
+		                                            encoding);
+		gline = data->line_cursor;
+	}
+	else
 	{
-		ggit_diff_line_unref (gline);
+		gline = NULL;
 	}
 
+	ret = data->line_cb (gdelta, ghunk, gline, data->user_data);
+
 	return ret;
 }
 
+static void
+diff_recipe_free (DiffRecipe *recipe)
+{
+	g_free (recipe->repo_path);
+	g_free (recipe->workdir);
+	g_strfreev (recipe->pathspec);
+	g_free (recipe->old_prefix);
+	g_free (recipe->new_prefix);
+	g_array_unref (recipe->find_steps);
+
+	g_slice_free (DiffRecipe, recipe);
+}
+
 static void
 ggit_diff_finalize (GObject *object)
 {
@@ -314,6 +343,7 @@ ggit_diff_finalize (GObject *object)
 	priv = ggit_diff_get_instance_private (diff);
 
 	g_free (priv->encoding);
+	g_clear_pointer (&priv->recipe, diff_recipe_free);
 
 	G_OBJECT_CLASS (ggit_diff_parent_class)->finalize (object);
 }
@@ -430,6 +460,282 @@ _ggit_diff_wrap (GgitRepository *repository,
 	return gdiff;
 }
 
+static void
+diff_set_tree_recipe (GgitDiff        *diff,
+                      GgitTree        *old_tree,
+                      GgitTree        *new_tree,
+                      GgitDiffOptions *diff_options)
+{
+	GgitDiffPrivate *priv;
+	git_repository *repo;
+	const git_diff_options *options;
+	DiffRecipe *recipe;
+	gsize i;
+
+	options = _ggit_diff_options_get_diff_options (diff_options);
+
+	if (options != NULL &&
+	    (options->notify_cb != NULL || options->progress_cb != NULL))
+	{
+		/* Callbacks could filter the deltas differently */
+		return;
+	}
+
+	priv = ggit_diff_get_instance_private (diff);
+	repo = _ggit_native_get (priv->repository);
+
+	recipe = g_slice_new0 (DiffRecipe);
+	recipe->repo_path = g_strdup (git_repository_path (repo));
+	recipe->workdir = g_strdup (git_repository_workdir (repo));
+	recipe->find_steps = g_array_new (FALSE, FALSE, sizeof (FindStep));
+
+	if (old_tree != NULL)
+	{
+		git_oid_cpy (&recipe->old_tree_id, git_tree_id (_ggit_native_get (old_tree)));
+		recipe->has_old_tree = TRUE;
+	}
+
+	if (new_tree != NULL)
+	{
+		git_oid_cpy (&recipe->new_tree_id, git_tree_id (_ggit_native_get (new_tree)));
+		recipe->has_new_tree = TRUE;
+	}
+
+	/* The options can change afterwards, keep a copy of them */
+	if (options != NULL)
+	{
+		recipe->has_options = TRUE;
+		recipe->options = *options;
+
+		recipe->pathspec = g_new0 (gchar *, options->pathspec.count + 1);
+
+		for (i = 0; i < options->pathspec.count; i++)
+		{
+			recipe->pathspec[i] = g_strdup (options->pathspec.strings[i]);
+		}
+
+		recipe->options.pathspec.strings = recipe->pathspec;
+		recipe->options.pathspec.count = options->pathspec.count;
+
+		recipe->old_prefix = g_strdup (options->old_prefix);
+		recipe->new_prefix = g_strdup (options->new_prefix);
+		recipe->options.old_prefix = recipe->old_prefix;
+		recipe->options.new_prefix = recipe->new_prefix;
+	}
+
+	priv->recipe = recipe;
+}
+
+static void
+diff_clear_recipe (GgitDiff *diff)
+{
+	GgitDiffPrivate *priv;
+
+	priv = ggit_diff_get_instance_private (diff);
+
+	g_clear_pointer (&priv->recipe, diff_recipe_free);
+}
+
+static void
+diff_add_find_step (GgitDiff                    *diff,
+                    const git_diff_find_options *options)
+{
+	GgitDiffPrivate *priv;
+	FindStep step = { 0 };
+
+	priv = ggit_diff_get_instance_private (diff);
+
+	if (priv->recipe == NULL)
+	{
+		return;
+	}
+
+	if (options != NULL && options->metric != NULL)
+	{
+		/* A custom metric calls back into the application */
+		diff_clear_recipe (diff);
+		return;
+	}
+
+	if (options != NULL)
+	{
+		step.has_options = TRUE;
+		step.options = *options;
+	}
+
+	g_array_append_val (priv->recipe->find_steps, step);
+}
+
+static gboolean
+delta_file_equal (const git_diff_file *a,
+                  const git_diff_file *b)
+{
+	return git_oid_equal (&a->id, &b->id) &&
+	       a->mode == b->mode &&
+	       g_strcmp0 (a->path, b->path) == 0;
+}
+
+/*
+ * _ggit_diff_can_copy:
+ * @diff: a #GgitDiff.
+ *
+ * Returns: %TRUE if _ggit_diff_open_copy() can build @diff again.
+ */
+gboolean
+_ggit_diff_can_copy (GgitDiff *diff)
+{
+	GgitDiffPrivate *priv;
+
+	priv = ggit_diff_get_instance_private (diff);
+
+	return priv->recipe != NULL;
+}
+
+/*
+ * _ggit_diff_open_repository:
+ * @diff: a #GgitDiff.
+ * @repository: (out): return location for the new repository handle.
+ * @options: (out): return location for the options of @diff, or %NULL.
+ *
+ * Opens a new handle on the repository of @diff, for looking at its blobs
+ * from another thread, and gets the options @diff was created with. Only
+ * works for the diffs that _ggit_diff_open_copy() can copy.
+ *
+ * Returns: %TRUE if the repository was opened, %FALSE otherwise.
+ */
+gboolean
+_ggit_diff_open_repository (GgitDiff                 *diff,
+                            git_repository          **repository,
+                            const git_diff_options  **options)
+{
+	GgitDiffPrivate *priv;
+	DiffRecipe *recipe;
+	git_repository *repo;
+
+	priv = ggit_diff_get_instance_private (diff);
+	recipe = priv->recipe;
+
+	if (recipe == NULL ||
+	    git_repository_open (&repo, recipe->repo_path) != GIT_OK)
+	{
+		return FALSE;
+	}
+
+	if (recipe->workdir != NULL &&
+	    git_repository_set_workdir (repo, recipe->workdir, 0) != GIT_OK)
+	{
+		git_repository_free (repo);
+		return FALSE;
+	}
+
+	*repository = repo;
+	*options = recipe->has_options ? &recipe->options : NULL;
+
+	return TRUE;
+}
+
+/*
+ * _ggit_diff_open_copy:
+ * @diff: a #GgitDiff.
+ * @repository: (out): return location for the repository of @copy.
+ * @copy: (out): return location for the copy of @diff.
+ *
+ * Builds @diff again, on a new handle on its repository. libgit2 does not
+ * allow generating patches of the same diff, or of diffs of the same
+ * repository handle, from several threads at once: they share the diff
+ * driver registry and the attribute session of the diff. Worker threads
+ * each get their own copy instead.
+ *
+ * Only diffs between two trees, as created by ggit_diff_new_tree_to_tree()
+ * and possibly ggit_diff_find_similar(), can be copied. The copy is
+ * checked to have the same deltas as @diff. This may be called from any
+ * thread, as long as @diff is not modified in the meantime.
+ *
+ * Returns: %TRUE if @diff was copied, %FALSE otherwise.
+ */
+gboolean
+_ggit_diff_open_copy (GgitDiff        *diff,
+                      git_repository **repository,
+                      git_diff       **copy)
+{
+	GgitDiffPrivate *priv;
+	DiffRecipe *recipe;
+	git_repository *repo = NULL;
+	const git_diff_options *options;
+	git_tree *old_tree = NULL;
+	git_tree *new_tree = NULL;
+	git_diff *gdiff = NULL;
+	git_diff *original;
+	gboolean same;
+	gsize i;
+
+	priv = ggit_diff_get_instance_private (diff);
+	recipe = priv->recipe;
+
+	if (!_ggit_diff_open_repository (diff, &repo, &options))
+	{
+		return FALSE;
+	}
+
+	same = (!recipe->has_old_tree ||
+	        git_tree_lookup (&old_tree, repo, &recipe->old_tree_id) == GIT_OK) &&
+	       (!recipe->has_new_tree ||
+	        git_tree_lookup (&new_tree, repo, &recipe->new_tree_id) == GIT_OK) &&
+	       git_diff_tree_to_tree (&gdiff,
+	                              repo,
+	                              old_tree,
+	                              new_tree,
+	                              options) == GIT_OK;
+
+	for (i = 0; same && i < recipe->find_steps->len; i++)
+	{
+		FindStep *step = &g_array_index (recipe->find_steps, FindStep, i);
+
+		same = git_diff_find_similar (gdiff,
+		                              step->has_options ? &step->options : NULL) == GIT_OK;
+	}
+
+	/* Reading the deltas of the original does not modify it */
+	original = _ggit_native_get (diff);
+	same = same && git_diff_num_deltas (gdiff) == git_diff_num_deltas (original);
+
+	for (i = 0; same && i < git_diff_num_deltas (gdiff); i++)
+	{
+		const git_diff_delta *a = git_diff_get_delta (original, i);
+		const git_diff_delta *b = git_diff_get_delta (gdiff, i);
+
+		same = a->status == b->status &&
+		       delta_file_equal (&a->old_file, &b->old_file) &&
+		       delta_file_equal (&a->new_file, &b->new_file);
+	}
+
+	if (old_tree != NULL)
+	{
+		git_tree_free (old_tree);
+	}
+
+	if (new_tree != NULL)
+	{
+		git_tree_free (new_tree);
+	}
+
+	if (!same)
+	{
+		if (gdiff != NULL)
+		{
+			git_diff_free (gdiff);
+		}
+
+		git_repository_free (repo);
+		return FALSE;
+	}
+
+	*repository = repo;
+	*copy = gdiff;
+
+	return TRUE;
+}
+
 /**
  * ggit_diff_new_tree_to_tree:
  * @repository: a #GgitRepository.
@@ -453,6 +759,7 @@ ggit_diff_new_tree_to_tree (GgitRepository   *repository,
                             GgitDiffOptions  *diff_options,
                             GError          **error)
 {
+	GgitDiff *gdiff;
 	git_diff *diff;
 	gint ret;
 
@@ -474,7 +781,10 @@ ggit_diff_new_tree_to_tree (GgitRepository   *repository,
 		return NULL;
 	}
 
-	return _ggit_diff_wrap (repository, diff);
+	gdiff = _ggit_diff_wrap (repository, diff);
+	diff_set_tree_recipe (gdiff, old_tree, new_tree, diff_options);
+
+	return gdiff;
 }
 
 /**
@@ -609,6 +919,135 @@ ggit_diff_new_tree_to_workdir (GgitRepository   *repository,
 	return _ggit_diff_wrap (repository, diff);
 }
 
+typedef struct
+{
+	GgitTree *old_tree;
+	GgitDiffOptions *options;
+} DiffWorkdirData;
+
+static void
+diff_workdir_data_free (DiffWorkdirData *data)
+{
+	g_clear_object (&data->old_tree);
+	g_clear_object (&data->options);
+
+	g_slice_free (DiffWorkdirData, data);
+}
+
+static void
+diff_tree_to_workdir_thread (GTask        *task,
+                             gpointer      source_object,
+                             gpointer      task_data,
+                             GCancellable *cancellable)
+{
+	DiffWorkdirData *data = task_data;
+	git_diff_options options = GIT_DIFF_OPTIONS_INIT;
+	git_diff *diff;
+	gint ret;
+
+	if (data->options != NULL)
+	{
+		options = *_ggit_diff_options_get_diff_options (data->options);
+	}
+
+	_ggit_async_wrap_diff_options (&options);
+
+	ret = git_diff_tree_to_workdir (&diff,
+	                                _ggit_native_get (source_object),
+	                                data->old_tree ? _ggit_native_get (data->old_tree) : NULL,
+	                                &options);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_async_return_error (task, ret);
+		return;
+	}
+
+	g_task_return_pointer (task, diff, (GDestroyNotify)git_diff_free);
+}
+
+/**
+ * ggit_diff_new_tree_to_workdir_async:
+ * @repository: a #GgitRepository.
+ * @old_tree: (allow-none): a #GgitTree to diff from.
+ * @diff_options: (allow-none): a #GgitDiffOptions, or %NULL.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            diff has been created.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously creates a #GgitDiff which compares the working directory
+ * and @old_tree. See ggit_diff_new_tree_to_workdir() for the synchronous
+ * version.
+ *
+ * Cancelling @cancellable aborts scanning the working directory.
+ * @repository must not be used from another thread while the operation is
+ * running.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_diff_new_tree_to_workdir_finish() to get the result of the operation.
+ */
+void
+ggit_diff_new_tree_to_workdir_async (GgitRepository      *repository,
+                                     GgitTree            *old_tree,
+                                     GgitDiffOptions     *diff_options,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+	GTask *task;
+	DiffWorkdirData *data;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (old_tree == NULL || GGIT_IS_TREE (old_tree));
+	g_return_if_fail (diff_options == NULL || GGIT_IS_DIFF_OPTIONS (diff_options));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_diff_new_tree_to_workdir_async);
+
+	data = g_slice_new0 (DiffWorkdirData);
+	data->old_tree = old_tree != NULL ? g_object_ref (old_tree) : NULL;
+	data->options = diff_options != NULL ? g_object_ref (diff_options) : NULL;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)diff_workdir_data_free);
+
+	_ggit_async_run (task, diff_tree_to_workdir_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_diff_new_tree_to_workdir_finish:
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_diff_new_tree_to_workdir_async().
+ *
+ * Returns: (transfer full) (nullable): a newly allocated #GgitDiff if
+ * there was no error, %NULL otherwise.
+ */
+GgitDiff *
+ggit_diff_new_tree_to_workdir_finish (GAsyncResult  *result,
+                                      GError       **error)
+{
+	git_diff *diff;
+
+	g_return_val_if_fail (G_IS_TASK (result), NULL);
+	g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == ggit_diff_new_tree_to_workdir_async, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	diff = g_task_propagate_pointer (G_TASK (result), error);
+
+	if (diff == NULL)
+	{
+		return NULL;
+	}
+
+	return _ggit_diff_wrap (g_task_get_source_object (G_TASK (result)), diff);
+}
+
 /**
  * ggit_diff_merge:
  * @onto: the #GgitDiff to merge into.
@@ -631,6 +1070,8 @@ ggit_diff_merge (GgitDiff  *onto,
 	ret = git_diff_merge (_ggit_native_get (onto),
 	                      _ggit_native_get (from));
 
+	diff_clear_recipe (onto);
+
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
@@ -673,16 +1114,26 @@ ggit_diff_foreach (GgitDiff              *diff,
 	g_return_if_fail (file_cb != NULL || binary_cb != NULL || hunk_cb != NULL || line_cb != NULL);
 	g_return_if_fail (error == NULL || *error == NULL);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 	wrapper_data.diff = diff;
 
 
 	if (file_cb != NULL)
 	{
+		GgitDiffPrivate *priv;
+
 		real_file_cb = ggit_diff_file_callback_wrapper;
 		wrapper_data.file_cb = file_cb;
+
+		priv = ggit_diff_get_instance_private (diff);
+
+		/* Check the attribute files once for the whole diff instead
+		 * of once per delta.
+		 */
+		if (priv->repository != NULL)
+		{
+			_ggit_repository_revalidate_attributes (priv->repository);
+		}
 	}
 
 	if (binary_cb != NULL)
@@ -708,8 +1159,7 @@ ggit_diff_foreach (GgitDiff              *diff,
 	                        real_hunk_cb, real_line_cb,
 	                        &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -717,8 +1167,470 @@ ggit_diff_foreach (GgitDiff              *diff,
 	}
 }
 
-/**
- * ggit_diff_print:
+/* Number of patches each worker may run ahead of the callback */
+#define FOREACH_PATCH_WINDOW_PER_THREAD 4
+
+typedef struct
+{
+	gsize index;
+	git_patch *patch;
+	GError *error;
+	gboolean done;
+} PatchResult;
+
+typedef struct
+{
+	GgitDiff *diff;
+	GCancellable *cancellable;
+
+	GMutex lock;
+	GCond cond;
+
+	/* protected by lock */
+	gsize next;
+	gsize delivered;
+	gboolean stop;
+
+	/* The copies of the workers, freed once they all finished */
+	GPtrArray *repositories;
+	GPtrArray *copies;
+
+	gsize n_deltas;
+	gsize window;
+
+	GAsyncQueue *results;
+} ForeachPatchState;
+
+static void
+patch_result_free (PatchResult *result)
+{
+	if (result->patch != NULL)
+	{
+		git_patch_free (result->patch);
+	}
+
+	g_clear_error (&result->error);
+	g_slice_free (PatchResult, result);
+}
+
+static gpointer
+foreach_patch_worker (gpointer data)
+{
+	ForeachPatchState *state = data;
+	PatchResult *result;
+	git_repository *repo;
+	git_diff *diff;
+
+	/* Every worker generates the patches from its own copy of the diff.
+	 * When it cannot be made, the worker takes no delta and the calling
+	 * thread generates the ones left over.
+	 */
+	if (!_ggit_diff_open_copy (state->diff, &repo, &diff))
+	{
+		repo = NULL;
+		diff = NULL;
+	}
+
+	g_mutex_lock (&state->lock);
+
+	if (diff != NULL)
+	{
+		g_ptr_array_add (state->repositories, repo);
+		g_ptr_array_add (state->copies, diff);
+	}
+
+	g_mutex_unlock (&state->lock);
+
+	while (diff != NULL)
+	{
+		gsize index;
+		gint ret;
+
+		g_mutex_lock (&state->lock);
+
+		/* Do not run too far ahead of the callback, it would only
+		 * pile up patches in memory.
+		 */
+		while (!state->stop &&
+		       state->next < state->n_deltas &&
+		       state->next >= state->delivered + state->window)
+		{
+			g_cond_wait (&state->cond, &state->lock);
+		}
+
+		if (state->stop || state->next >= state->n_deltas ||
+		    g_cancellable_is_cancelled (state->cancellable))
+		{
+			g_mutex_unlock (&state->lock);
+			break;
+		}
+
+		index = state->next++;
+		g_mutex_unlock (&state->lock);
+
+		result = g_slice_new0 (PatchResult);
+		result->index = index;
+
+		ret = git_patch_from_diff (&result->patch, diff, index);
+
+		if (ret != GIT_OK)
+		{
+			/* The libgit2 error is per thread, get it here */
+			result->patch = NULL;
+			_ggit_error_set (&result->error, ret);
+		}
+
+		g_async_queue_push (state->results, result);
+	}
+
+	result = g_slice_new0 (PatchResult);
+	result->done = TRUE;
+	g_async_queue_push (state->results, result);
+
+	return NULL;
+}
+
+static gboolean
+foreach_patch_serial (git_diff               *diff,
+                      gsize                   start,
+                      gsize                   n_deltas,
+                      GgitDiffPatchCallback   callback,
+                      gpointer                user_data,
+                      GCancellable           *cancellable,
+                      GError                **error)
+{
+	gsize i;
+
+	for (i = start; i < n_deltas; i++)
+	{
+		git_patch *patch;
+		GgitPatch *gpatch;
+		gint ret;
+
+		if (g_cancellable_set_error_if_cancelled (cancellable, error))
+		{
+			return FALSE;
+		}
+
+		ret = git_patch_from_diff (&patch, diff, i);
+
+		if (ret == GIT_OK)
+		{
+			gpatch = _ggit_patch_wrap (patch);
+			ret = callback (i, gpatch, user_data);
+			ggit_patch_unref (gpatch);
+		}
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (error, ret);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gint
+foreach_patch_deliver (ForeachPatchState     *state,
+                       PatchResult           *result,
+                       GgitDiffPatchCallback  callback,
+                       gpointer               user_data,
+                       GError               **error)
+{
+	GgitPatch *patch;
+	gint ret;
+
+	if (result->error != NULL)
+	{
+		g_propagate_error (error, result->error);
+		result->error = NULL;
+
+		return GIT_ERROR;
+	}
+
+	patch = _ggit_patch_wrap (result->patch);
+	result->patch = NULL;
+
+	ret = callback (result->index, patch, user_data);
+	ggit_patch_unref (patch);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return ret;
+	}
+
+	g_mutex_lock (&state->lock);
+	state->delivered++;
+	g_cond_broadcast (&state->cond);
+	g_mutex_unlock (&state->lock);
+
+	return GIT_OK;
+}
+
+/**
+ * ggit_diff_foreach_patch:
+ * @diff: a #GgitDiff.
+ * @n_threads: the number of threads generating patches, or 0 for the
+ *             number of processors.
+ * @flags: a #GgitDiffForeachPatchFlags.
+ * @callback: (scope call) (closure user_data): a #GgitDiffPatchCallback.
+ * @user_data: callback user data.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Generates the #GgitPatch of each delta of @diff, like
+ * ggit_patch_new_from_diff() does, on @n_threads worker threads. Loading
+ * the blobs and diffing them runs in parallel, @callback is always
+ * called on the calling thread.
+ *
+ * libgit2 does not allow generating the patches of one diff from several
+ * threads, so every worker first builds @diff again on its own handle on
+ * the repository. This is only possible for diffs between two trees, see
+ * ggit_diff_new_tree_to_tree(); the patches of other diffs, and of diffs
+ * merged with ggit_diff_merge(), are generated on the calling thread.
+ *
+ * With %GGIT_DIFF_FOREACH_PATCH_ORDERED, @callback gets the patches in
+ * the order of the deltas. Otherwise it gets them as soon as they are
+ * generated, @index tells which delta they belong to. In both cases only
+ * a few patches per thread are generated ahead of @callback.
+ *
+ * Iteration stops when @callback returns a non-zero value, when a patch
+ * could not be generated or when @cancellable is cancelled. @diff must not
+ * be used from another thread during the iteration.
+ *
+ * Returns: %TRUE if all the patches were generated and passed to
+ * @callback, %FALSE otherwise.
+ */
+gboolean
+ggit_diff_foreach_patch (GgitDiff                   *diff,
+                         guint                       n_threads,
+                         GgitDiffForeachPatchFlags   flags,
+                         GgitDiffPatchCallback       callback,
+                         gpointer                    user_data,
+                         GCancellable               *cancellable,
+                         GError                    **error)
+{
+	ForeachPatchState state = { 0 };
+	git_diff *gdiff;
+	GThread **threads;
+	PatchResult **pending = NULL;
+	gboolean ordered;
+	guint n_running;
+	gsize n_deltas;
+	guint i;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	gdiff = _ggit_native_get (diff);
+	n_deltas = git_diff_num_deltas (gdiff);
+
+	if (n_threads == 0)
+	{
+		n_threads = g_get_num_processors ();
+	}
+
+	n_threads = (guint)MIN (n_threads, n_deltas);
+
+	if (!(git_libgit2_features () & GIT_FEATURE_THREADS) ||
+	    !_ggit_diff_can_copy (diff))
+	{
+		n_threads = 1;
+	}
+
+	if (n_threads <= 1)
+	{
+		return foreach_patch_serial (gdiff, 0, n_deltas,
+		                             callback, user_data,
+		                             cancellable, error);
+	}
+
+	ordered = (flags & GGIT_DIFF_FOREACH_PATCH_ORDERED) != 0;
+
+	state.diff = diff;
+	state.cancellable = cancellable;
+	state.n_deltas = n_deltas;
+	state.repositories = g_ptr_array_new_with_free_func ((GDestroyNotify)git_repository_free);
+	state.copies = g_ptr_array_new_with_free_func ((GDestroyNotify)git_diff_free);
+	state.window = (gsize)n_threads * FOREACH_PATCH_WINDOW_PER_THREAD;
+	state.results = g_async_queue_new ();
+
+	g_mutex_init (&state.lock);
+	g_cond_init (&state.cond);
+
+	if (ordered)
+	{
+		/* Results are always within the window of the next one to
+		 * deliver, so a ring of the window size holds them all.
+		 */
+		pending = g_new0 (PatchResult *, state.window);
+	}
+
+	threads = g_new (GThread *, n_threads);
+
+	for (i = 0; i < n_threads; i++)
+	{
+		threads[i] = g_thread_new ("ggit-diff-patch", foreach_patch_worker, &state);
+	}
+
+	n_running = n_threads;
+	ret = GIT_OK;
+
+	while (n_running > 0)
+	{
+		PatchResult *result;
+
+		result = g_async_queue_pop (state.results);
+
+		if (result->done)
+		{
+			n_running--;
+			patch_result_free (result);
+			continue;
+		}
+
+		if (ret == GIT_OK && g_cancellable_set_error_if_cancelled (cancellable, error))
+		{
+			ret = GIT_EUSER;
+		}
+
+		if (ret != GIT_OK)
+		{
+			/* Drain the results of the workers still running */
+			patch_result_free (result);
+			continue;
+		}
+
+		if (!ordered)
+		{
+			ret = foreach_patch_deliver (&state, result, callback, user_data, error);
+			patch_result_free (result);
+		}
+		else
+		{
+			pending[result->index % state.window] = result;
+
+			while (ret == GIT_OK && state.delivered < n_deltas)
+			{
+				PatchResult **slot;
+
+				slot = &pending[state.delivered % state.window];
+
+				if (*slot == NULL || (*slot)->index != state.delivered)
+				{
+					break;
+				}
+
+				result = *slot;
+				*slot = NULL;
+
+				ret = foreach_patch_deliver (&state, result, callback, user_data, error);
+				patch_result_free (result);
+			}
+		}
+
+		if (ret != GIT_OK)
+		{
+			g_mutex_lock (&state.lock);
+			state.stop = TRUE;
+			g_cond_broadcast (&state.cond);
+			g_mutex_unlock (&state.lock);
+		}
+	}
+
+	for (i = 0; i < n_threads; i++)
+	{
+		g_thread_join (threads[i]);
+	}
+
+	if (ret == GIT_OK && state.delivered < n_deltas)
+	{
+		if (g_cancellable_set_error_if_cancelled (cancellable, error))
+		{
+			ret = GIT_EUSER;
+		}
+		else
+		{
+			/* No worker could copy the diff, or the ones that
+			 * could stopped, every delta they took was delivered.
+			 * The workers are gone, the diff is ours again.
+			 */
+			ret = foreach_patch_serial (gdiff, state.delivered, n_deltas,
+			                            callback, user_data,
+			                            cancellable, error) ? GIT_OK : GIT_EUSER;
+		}
+	}
+
+	if (pending != NULL)
+	{
+		for (i = 0; i < state.window; i++)
+		{
+			g_clear_pointer (&pending[i], patch_result_free);
+		}
+
+		g_free (pending);
+	}
+
+	g_free (threads);
+	g_ptr_array_unref (state.copies);
+	g_ptr_array_unref (state.repositories);
+	g_async_queue_unref (state.results);
+	g_cond_clear (&state.cond);
+	g_mutex_clear (&state.lock);
+
+	return ret == GIT_OK;
+}
+
+/**
+ * ggit_diff_get_stats:
+ * @diff: a #GgitDiff.
+ * @n_threads: the number of threads counting lines, 1 to count them on
+ *             the calling thread or 0 for the number of processors.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Counts the inserted and deleted lines of every file in @diff, for
+ * `git diff --stat` like summaries. This is much cheaper than getting the
+ * line stats from a #GgitPatch of every delta, as the lines are only
+ * counted, not kept or wrapped. With more than one thread, the files of a
+ * diff between two trees are split in shards that are counted in
+ * parallel, each thread with its own handle on the repository; other
+ * diffs are always counted on the calling thread. @diff must not be
+ * modified in the meantime.
+ *
+ * Returns: (transfer full) (nullable): a #GgitDiffStats or %NULL.
+ */
+GgitDiffStats *
+ggit_diff_get_stats (GgitDiff      *diff,
+                     guint          n_threads,
+                     GCancellable  *cancellable,
+                     GError       **error)
+{
+	gsize n_deltas;
+
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	n_deltas = git_diff_num_deltas (_ggit_native_get (diff));
+
+	if (n_threads == 0)
+	{
+		n_threads = g_get_num_processors ();
+	}
+
+	n_threads = (guint)MIN (n_threads, n_deltas);
+
+	return _ggit_diff_stats_new (diff, n_threads, cancellable, error);
+}
+
+/**
+ * ggit_diff_print:
  * @diff: a #GgitDiff.
  * @type: a #GgitDiffFormatType.
  * @print_cb: (scope call) (closure user_data): a #GgitDiffLineCallback.
@@ -741,8 +1653,6 @@ ggit_diff_print (GgitDiff              *diff,
 	g_return_if_fail (print_cb != NULL);
 	g_return_if_fail (error == NULL || *error == NULL);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 	wrapper_data.diff = diff;
 
@@ -752,8 +1662,7 @@ ggit_diff_print (GgitDiff              *diff,
 	                      ggit_diff_line_callback_wrapper,
 	                      &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -810,6 +1719,413 @@ ggit_diff_format_email (GgitDiff                    *diff,
 	return retval;
 }
 
+#define EMAIL_STATS_FLAGS (GIT_DIFF_STATS_FULL | GIT_DIFF_STATS_INCLUDE_SUMMARY)
+
+/* git_diff_format_email() lays out an e-mail as the header, "---\n", the
+ * diffstat, "\n", the patch and the footer. The header and the footer do
+ * not depend on the diff, so they are taken from the e-mail libgit2 formats
+ * for an empty diff and the output matches git_diff_format_email() byte for
+ * byte.
+ */
+static gint
+format_email_frame (const git_diff_format_email_options  *options,
+                    gchar                               **header,
+                    gchar                               **footer)
+{
+	git_diff *empty = NULL;
+	git_diff_stats *stats = NULL;
+	git_buf email = {0,};
+	git_buf empty_stats = {0,};
+	const gchar *separator = NULL;
+	gint ret;
+
+	ret = git_diff_from_buffer (&empty, "", 0);
+
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_format_email (&email, empty, options);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_get_stats (&stats, empty);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_stats_to_buf (&empty_stats, stats, EMAIL_STATS_FLAGS, 0);
+	}
+
+	if (ret == GIT_OK)
+	{
+		const gchar *p;
+		gsize tail = 0;
+
+		/* The body may contain "---" lines too, the last one separates
+		 * the header from the diffstat.
+		 */
+		for (p = email.ptr; (p = strstr (p, "---\n")) != NULL; p += 4)
+		{
+			if (p == email.ptr || p[-1] == '\n')
+			{
+				separator = p + 4;
+			}
+		}
+
+		if (separator != NULL)
+		{
+			tail = email.size - (separator - email.ptr);
+		}
+
+		if (separator == NULL ||
+		    tail < empty_stats.size + 1 ||
+		    memcmp (separator, empty_stats.ptr, empty_stats.size) != 0)
+		{
+#if (LIBGIT2_VER_MAJOR > 0 && LIBGIT2_VER_MINOR < 8) || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+			git_error_set_str (GIT_ERROR, "Unexpected layout of the e-mail patch");
+#else
+			giterr_set_str (GIT_ERROR, "Unexpected layout of the e-mail patch");
+#endif
+			ret = GIT_ERROR;
+		}
+		else
+		{
+			*header = g_strndup (email.ptr, separator - email.ptr);
+			*footer = g_strndup (separator + empty_stats.size + 1,
+			                     tail - empty_stats.size - 1);
+		}
+	}
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	git_buf_dispose (&empty_stats);
+	git_buf_dispose (&email);
+#else
+	git_buf_free (&empty_stats);
+	git_buf_free (&email);
+#endif
+
+	if (stats != NULL)
+	{
+		git_diff_stats_free (stats);
+	}
+
+	if (empty != NULL)
+	{
+		git_diff_free (empty);
+	}
+
+	return ret;
+}
+
+static gint
+write_email_header (GgitStreamWriter *writer,
+                    git_diff         *diff,
+                    const gchar      *header)
+{
+	git_diff_stats *stats;
+	git_buf buf = {0,};
+	gint ret;
+
+	if (!_ggit_stream_writer_write (writer, header, strlen (header)))
+	{
+		return GIT_EUSER;
+	}
+
+	/* The diffstat is bounded by the number of files, not their size */
+	ret = git_diff_get_stats (&stats, diff);
+
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_stats_to_buf (&buf, stats, EMAIL_STATS_FLAGS, 0);
+		git_diff_stats_free (stats);
+	}
+
+	if (ret == GIT_OK &&
+	    (!_ggit_stream_writer_write (writer, buf.ptr, buf.size) ||
+	     !_ggit_stream_writer_write (writer, "\n", 1)))
+	{
+		ret = GIT_EUSER;
+	}
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	git_buf_dispose (&buf);
+#else
+	git_buf_free (&buf);
+#endif
+
+	return ret;
+}
+
+static gboolean
+diff_to_stream (git_diff                            *diff,
+                git_diff_format_t                    format,
+                const git_diff_format_email_options *email_options,
+                GOutputStream                       *stream,
+                gboolean                             pipelined,
+                GCancellable                        *cancellable,
+                GError                             **error)
+{
+	GgitStreamWriter *writer;
+	GError *write_error = NULL;
+	gchar *header = NULL;
+	gchar *footer = NULL;
+	gint ret = GIT_OK;
+
+	if (email_options != NULL)
+	{
+		ret = format_email_frame (email_options, &header, &footer);
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (error, ret);
+			return FALSE;
+		}
+	}
+
+	writer = _ggit_stream_writer_new (stream, 0, pipelined, cancellable);
+
+	if (header != NULL)
+	{
+		ret = write_email_header (writer, diff, header);
+	}
+
+	/* libgit2 generates and frees the patch of each file in turn, so
+	 * only one file is ever held in memory.
+	 */
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_print (diff,
+		                      format,
+		                      _ggit_stream_writer_print_line,
+		                      writer);
+	}
+
+	if (ret == GIT_OK && footer != NULL &&
+	    !_ggit_stream_writer_write (writer, footer, strlen (footer)))
+	{
+		ret = GIT_EUSER;
+	}
+
+	g_free (header);
+	g_free (footer);
+
+	if (!_ggit_stream_writer_close (writer, &write_error))
+	{
+		g_propagate_error (error, write_error);
+		return FALSE;
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_diff_to_stream:
+ * @diff: a #GgitDiff.
+ * @type: a #GgitDiffFormatType.
+ * @stream: a #GOutputStream.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes the text output of ggit_diff_print() for the whole of @diff to
+ * @stream. The patch of each file is generated in turn and written in
+ * 64 KiB chunks, so the memory used is bounded by the largest file rather
+ * than by the size of the diff.
+ *
+ * Returns: %TRUE if the diff was written successfully, %FALSE otherwise.
+ */
+gboolean
+ggit_diff_to_stream (GgitDiff            *diff,
+                     GgitDiffFormatType   type,
+                     GOutputStream       *stream,
+                     GCancellable        *cancellable,
+                     GError             **error)
+{
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), FALSE);
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return diff_to_stream (_ggit_native_get (diff),
+	                       (git_diff_format_t)type,
+	                       NULL,
+	                       stream,
+	                       FALSE,
+	                       cancellable,
+	                       error);
+}
+
+typedef struct
+{
+	GOutputStream *stream;
+	GgitDiffFormatType type;
+} DiffToStreamData;
+
+static void
+diff_to_stream_data_free (DiffToStreamData *data)
+{
+	g_object_unref (data->stream);
+
+	g_slice_free (DiffToStreamData, data);
+}
+
+static void
+diff_to_stream_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+	DiffToStreamData *data = task_data;
+	GError *error = NULL;
+
+	if (!diff_to_stream (_ggit_native_get (source_object),
+	                     (git_diff_format_t)data->type,
+	                     NULL,
+	                     data->stream,
+	                     TRUE,
+	                     cancellable,
+	                     &error))
+	{
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_return_boolean (task, TRUE);
+	}
+}
+
+/**
+ * ggit_diff_to_stream_async:
+ * @diff: a #GgitDiff.
+ * @type: a #GgitDiffFormatType.
+ * @stream: a #GOutputStream.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            diff has been written.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously writes @diff to @stream. See ggit_diff_to_stream() for
+ * the synchronous version.
+ *
+ * The diff is formatted on a worker thread while another one writes the
+ * previous chunk to @stream. At most two chunks are held in memory: when
+ * @stream is slower than the diff, formatting waits for it. Neither @diff
+ * nor @stream may be used until the operation is finished.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_diff_to_stream_finish() to get the result of the operation.
+ */
+void
+ggit_diff_to_stream_async (GgitDiff            *diff,
+                           GgitDiffFormatType   type,
+                           GOutputStream       *stream,
+                           GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+	GTask *task;
+	DiffToStreamData *data;
+
+	g_return_if_fail (GGIT_IS_DIFF (diff));
+	g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (diff, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_diff_to_stream_async);
+
+	data = g_slice_new (DiffToStreamData);
+	data->stream = g_object_ref (stream);
+	data->type = type;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)diff_to_stream_data_free);
+
+	_ggit_async_run (task, diff_to_stream_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_diff_to_stream_finish:
+ * @diff: a #GgitDiff.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_diff_to_stream_async().
+ *
+ * Returns: %TRUE if the diff was written successfully, %FALSE otherwise.
+ */
+gboolean
+ggit_diff_to_stream_finish (GgitDiff      *diff,
+                            GAsyncResult  *result,
+                            GError       **error)
+{
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, diff), FALSE);
+	g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == ggit_diff_to_stream_async, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * ggit_diff_format_email_to_stream:
+ * @diff: a #GgitDiff.
+ * @options: a #GgitDiffFormatEmailOptions.
+ * @stream: a #GOutputStream.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes an e-mail ready patch of @diff to @stream, the same as the output
+ * of ggit_diff_format_email(). Unlike ggit_diff_format_email(), the patch
+ * is streamed as it is generated, see ggit_diff_to_stream().
+ *
+ * The id, summary and author of @options must be set.
+ *
+ * Returns: %TRUE if the patch was written successfully, %FALSE otherwise.
+ */
+gboolean
+ggit_diff_format_email_to_stream (GgitDiff                    *diff,
+                                  GgitDiffFormatEmailOptions  *options,
+                                  GOutputStream               *stream,
+                                  GCancellable                *cancellable,
+                                  GError                     **error)
+{
+	const git_diff_format_email_options *email_options;
+
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), FALSE);
+	g_return_val_if_fail (GGIT_IS_DIFF_FORMAT_EMAIL_OPTIONS (options), FALSE);
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	email_options = _ggit_diff_format_email_options_get_diff_format_email_options (options);
+
+	if (email_options->id == NULL ||
+	    email_options->summary == NULL ||
+	    email_options->author == NULL)
+	{
+		g_set_error_literal (error,
+		                     GGIT_ERROR,
+		                     GGIT_ERROR_GIT_ERROR,
+		                     "The id, summary and author of the e-mail options must be set");
+		return FALSE;
+	}
+
+	return diff_to_stream (_ggit_native_get (diff),
+	                       GIT_DIFF_FORMAT_PATCH,
+	                       email_options,
+	                       stream,
+	                       FALSE,
+	                       cancellable,
+	                       error);
+}
+
 /**
  * ggit_diff_get_num_deltas:
  * @diff: a #GgitDiff.
@@ -901,8 +2217,6 @@ ggit_diff_blobs (GgitBlob              *old_blob,
 
 	gdiff_options = _ggit_diff_options_get_diff_options (diff_options);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 
 	if (file_cb != NULL)
@@ -938,8 +2252,7 @@ ggit_diff_blobs (GgitBlob              *old_blob,
 	                      real_hunk_cb, real_line_cb,
 	                      &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -1077,8 +2390,6 @@ ggit_diff_blob_to_buffer (GgitBlob                *old_blob,
 
 	gdiff_options = _ggit_diff_options_get_diff_options (diff_options);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 
 	if (buffer_len == -1)
@@ -1120,8 +2431,7 @@ ggit_diff_blob_to_buffer (GgitBlob                *old_blob,
 	                               real_hunk_cb, real_line_cb,
 	                               &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -1146,21 +2456,26 @@ ggit_diff_find_similar (GgitDiff             *diff,
                         GgitDiffFindOptions  *options,
                         GError              **error)
 {
+	const git_diff_find_options *find_options;
 	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_DIFF (diff), FALSE);
 	g_return_val_if_fail (options == NULL || GGIT_IS_DIFF_FIND_OPTIONS (options), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_diff_find_similar (_ggit_native_get (diff),
-	                             _ggit_diff_find_options_get_diff_find_options (options));
+	find_options = _ggit_diff_find_options_get_diff_find_options (options);
+
+	ret = git_diff_find_similar (_ggit_native_get (diff), find_options);
 
 	if (ret != GIT_OK)
 	{
+		diff_clear_recipe (diff);
 		_ggit_error_set (error, ret);
 		return FALSE;
 	}
 
+	diff_add_find_step (diff, find_options);
+
 	return TRUE;
 }
 
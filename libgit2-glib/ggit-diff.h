@@ -22,6 +22,7 @@
 #define __GGIT_DIFF_H__
 
 #include <git2.h>
+#include <gio/gio.h>
 #include "ggit-native.h"
 #include "ggit-types.h"
 #include "ggit-blob.h"
@@ -66,6 +67,14 @@ GgitDiff      *ggit_diff_new_tree_to_workdir       (GgitRepository        *repos
                                                     GgitTree              *old_tree,
                                                     GgitDiffOptions       *diff_options,
                                                     GError               **error);
+void           ggit_diff_new_tree_to_workdir_async (GgitRepository        *repository,
+                                                    GgitTree              *old_tree,
+                                                    GgitDiffOptions       *diff_options,
+                                                    GCancellable          *cancellable,
+                                                    GAsyncReadyCallback    callback,
+                                                    gpointer               user_data);
+GgitDiff      *ggit_diff_new_tree_to_workdir_finish (GAsyncResult         *result,
+                                                    GError               **error);
 GgitDiff      *ggit_diff_new_buffers               (const guint8          *buffer1,
                                                     gssize                 buffer1_len,
                                                     const gchar           *buffer1_as_path,
@@ -86,6 +95,19 @@ void           ggit_diff_foreach                   (GgitDiff              *diff,
                                                     GgitDiffLineCallback   line_cb,
                                                     gpointer               user_data,
                                                     GError               **error);
+gboolean       ggit_diff_foreach_patch             (GgitDiff              *diff,
+                                                    guint                  n_threads,
+                                                    GgitDiffForeachPatchFlags flags,
+                                                    GgitDiffPatchCallback  callback,
+                                                    gpointer               user_data,
+                                                    GCancellable          *cancellable,
+                                                    GError               **error);
+
+GgitDiffStats *ggit_diff_get_stats                 (GgitDiff              *diff,
+                                                    guint                  n_threads,
+                                                    GCancellable          *cancellable,
+                                                    GError               **error);
+
 void           ggit_diff_print                     (GgitDiff              *diff,
                                                     GgitDiffFormatType     type,
                                                     GgitDiffLineCallback   print_cb,
@@ -96,6 +118,27 @@ gchar         *ggit_diff_format_email              (GgitDiff              *diff,
                                                     GgitDiffFormatEmailOptions *options,
                                                     GError               **error);
 
+gboolean       ggit_diff_to_stream                 (GgitDiff              *diff,
+                                                    GgitDiffFormatType     type,
+                                                    GOutputStream         *stream,
+                                                    GCancellable          *cancellable,
+                                                    GError               **error);
+void           ggit_diff_to_stream_async           (GgitDiff              *diff,
+                                                    GgitDiffFormatType     type,
+                                                    GOutputStream         *stream,
+                                                    GCancellable          *cancellable,
+                                                    GAsyncReadyCallback    callback,
+                                                    gpointer               user_data);
+gboolean       ggit_diff_to_stream_finish          (GgitDiff              *diff,
+                                                    GAsyncResult          *result,
+                                                    GError               **error);
+
+gboolean       ggit_diff_format_email_to_stream    (GgitDiff              *diff,
+                                                    GgitDiffFormatEmailOptions *options,
+                                                    GOutputStream         *stream,
+                                                    GCancellable          *cancellable,
+                                                    GError               **error);
+
 gsize          ggit_diff_get_num_deltas            (GgitDiff              *diff);
 
 GgitDiffDelta *ggit_diff_get_delta                 (GgitDiff              *diff,
@@ -130,6 +173,16 @@ gboolean       ggit_diff_find_similar              (GgitDiff              *diff,
                                                     GgitDiffFindOptions   *options,
                                                     GError               **error);
 
+gboolean      _ggit_diff_can_copy                  (GgitDiff              *diff);
+
+gboolean      _ggit_diff_open_repository           (GgitDiff              *diff,
+                                                    git_repository       **repository,
+                                                    const git_diff_options **options);
+
+gboolean      _ggit_diff_open_copy                 (GgitDiff              *diff,
+                                                    git_repository       **repository,
+                                                    git_diff             **copy);
+
 G_END_DECLS
 
 #endif /* __GGIT_DIFF_H__ */
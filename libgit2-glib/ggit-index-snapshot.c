@@ -0,0 +1,594 @@
+/*
+ * ggit-index-snapshot.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <git2.h>
+
+#include "ggit-index-snapshot.h"
+#include "ggit-oid.h"
+
+/**
+ * GgitIndexSnapshot:
+ *
+ * An immutable copy of the entries of a #GgitIndex, sorted by path. The
+ * entries are stored as a set of parallel arrays instead of one object per
+ * entry, so walking or searching the snapshot does not allocate. Paths are
+ * sorted bytewise, which keeps all the entries below a directory in one
+ * contiguous range that can be found with ggit_index_snapshot_find_prefix().
+ *
+ * A snapshot does not change when the index it was taken from does and can
+ * be read from any thread.
+ */
+struct _GgitIndexSnapshot
+{
+	gint ref_count;
+
+	guint n_entries;
+
+	/* All paths, NUL terminated, back to back. */
+	gchar *path_data;
+	guint32 *path_offsets;
+
+	guint32 *modes;
+	guint8 *stages;
+	guint8 *ids;
+	guint64 *file_sizes;
+	gint64 *mtimes;
+};
+
+G_DEFINE_BOXED_TYPE (GgitIndexSnapshot, ggit_index_snapshot,
+                     ggit_index_snapshot_ref, ggit_index_snapshot_unref)
+
+static gint
+compare_entries (const git_index_entry *a,
+                 const git_index_entry *b)
+{
+	gint ret;
+
+	ret = strcmp (a->path, b->path);
+
+	if (ret == 0)
+	{
+		ret = GIT_IDXENTRY_STAGE (a) - GIT_IDXENTRY_STAGE (b);
+	}
+
+	return ret;
+}
+
+static gint
+compare_entry_ptrs (gconstpointer a,
+                    gconstpointer b)
+{
+	return compare_entries (*(const git_index_entry * const *)a,
+	                        *(const git_index_entry * const *)b);
+}
+
+/**
+ * ggit_index_snapshot_new:
+ * @index: a #GgitIndex.
+ *
+ * Takes a snapshot of the entries currently in @index.
+ *
+ * Returns: (transfer full): a newly allocated #GgitIndexSnapshot.
+ */
+GgitIndexSnapshot *
+ggit_index_snapshot_new (GgitIndex *index)
+{
+	g_return_val_if_fail (GGIT_IS_INDEX (index), NULL);
+
+	return _ggit_index_snapshot_new_native (_ggit_native_get (index));
+}
+
+GgitIndexSnapshot *
+_ggit_index_snapshot_new_native (git_index *gidx)
+{
+	GgitIndexSnapshot *snapshot;
+	const git_index_entry **entries;
+	gboolean sorted = TRUE;
+	gsize path_size = 0;
+	guint i;
+
+	snapshot = g_slice_new0 (GgitIndexSnapshot);
+	snapshot->ref_count = 1;
+	snapshot->n_entries = (guint)git_index_entrycount (gidx);
+
+	entries = g_new (const git_index_entry *, snapshot->n_entries);
+
+	for (i = 0; i < snapshot->n_entries; ++i)
+	{
+		entries[i] = git_index_get_byindex (gidx, i);
+		path_size += strlen (entries[i]->path) + 1;
+
+		if (sorted && i > 0 && compare_entries (entries[i - 1], entries[i]) > 0)
+		{
+			sorted = FALSE;
+		}
+	}
+
+	/* Case insensitive indexes are not in byte order */
+	if (!sorted)
+	{
+		qsort (entries, snapshot->n_entries, sizeof (entries[0]), compare_entry_ptrs);
+	}
+
+	snapshot->path_data = g_malloc (MAX (path_size, 1));
+	snapshot->path_offsets = g_new (guint32, snapshot->n_entries + 1);
+	snapshot->modes = g_new (guint32, snapshot->n_entries);
+	snapshot->stages = g_new (guint8, snapshot->n_entries);
+	snapshot->ids = g_new (guint8, (gsize)snapshot->n_entries * GIT_OID_RAWSZ);
+	snapshot->file_sizes = g_new (guint64, snapshot->n_entries);
+	snapshot->mtimes = g_new (gint64, snapshot->n_entries);
+
+	path_size = 0;
+
+	for (i = 0; i < snapshot->n_entries; ++i)
+	{
+		const git_index_entry *entry = entries[i];
+		gsize len = strlen (entry->path) + 1;
+
+		snapshot->path_offsets[i] = (guint32)path_size;
+		memcpy (snapshot->path_data + path_size, entry->path, len);
+		path_size += len;
+
+		snapshot->modes[i] = entry->mode;
+		snapshot->stages[i] = (guint8)GIT_IDXENTRY_STAGE (entry);
+		memcpy (snapshot->ids + (gsize)i * GIT_OID_RAWSZ, entry->id.id, GIT_OID_RAWSZ);
+		snapshot->file_sizes[i] = entry->file_size;
+		snapshot->mtimes[i] = (gint64)entry->mtime.seconds * G_GINT64_CONSTANT (1000000000) +
+		                      entry->mtime.nanoseconds;
+	}
+
+	snapshot->path_offsets[snapshot->n_entries] = (guint32)path_size;
+
+	g_free (entries);
+
+	return snapshot;
+}
+
+/**
+ * ggit_index_snapshot_ref:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Atomically increments the reference count of @snapshot by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitIndexSnapshot.
+ */
+GgitIndexSnapshot *
+ggit_index_snapshot_ref (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	g_atomic_int_inc (&snapshot->ref_count);
+
+	return snapshot;
+}
+
+/**
+ * ggit_index_snapshot_unref:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Atomically decrements the reference count of @snapshot by one.
+ * If the reference count drops to 0, @snapshot is freed.
+ */
+void
+ggit_index_snapshot_unref (GgitIndexSnapshot *snapshot)
+{
+	g_return_if_fail (snapshot != NULL);
+
+	if (g_atomic_int_dec_and_test (&snapshot->ref_count))
+	{
+		g_free (snapshot->path_data);
+		g_free (snapshot->path_offsets);
+		g_free (snapshot->modes);
+		g_free (snapshot->stages);
+		g_free (snapshot->ids);
+		g_free (snapshot->file_sizes);
+		g_free (snapshot->mtimes);
+
+		g_slice_free (GgitIndexSnapshot, snapshot);
+	}
+}
+
+/**
+ * ggit_index_snapshot_get_size:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the number of entries in @snapshot.
+ *
+ * Returns: the number of entries.
+ */
+guint
+ggit_index_snapshot_get_size (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, 0);
+
+	return snapshot->n_entries;
+}
+
+/**
+ * ggit_index_snapshot_get_path:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the path of the entry at @position.
+ *
+ * Returns: the path of the entry, owned by @snapshot.
+ */
+const gchar *
+ggit_index_snapshot_get_path (GgitIndexSnapshot *snapshot,
+                              guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (position < snapshot->n_entries, NULL);
+
+	return snapshot->path_data + snapshot->path_offsets[position];
+}
+
+/**
+ * ggit_index_snapshot_get_mode:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the file mode of the entry at @position.
+ *
+ * Returns: the mode of the entry.
+ */
+guint
+ggit_index_snapshot_get_mode (GgitIndexSnapshot *snapshot,
+                              guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, 0);
+	g_return_val_if_fail (position < snapshot->n_entries, 0);
+
+	return snapshot->modes[position];
+}
+
+/**
+ * ggit_index_snapshot_get_stage:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the stage of the entry at @position. Entries that are not in
+ * conflict have stage 0.
+ *
+ * Returns: the stage of the entry.
+ */
+gint
+ggit_index_snapshot_get_stage (GgitIndexSnapshot *snapshot,
+                               guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, 0);
+	g_return_val_if_fail (position < snapshot->n_entries, 0);
+
+	return snapshot->stages[position];
+}
+
+/**
+ * ggit_index_snapshot_get_id:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the id of the entry at @position. Use
+ * ggit_index_snapshot_get_raw_id() to avoid allocating a #GgitOId.
+ *
+ * Returns: (transfer full) (nullable): the id of the entry or %NULL.
+ */
+GgitOId *
+ggit_index_snapshot_get_id (GgitIndexSnapshot *snapshot,
+                            guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (position < snapshot->n_entries, NULL);
+
+	return ggit_oid_new_from_raw (snapshot->ids + (gsize)position * GIT_OID_RAWSZ);
+}
+
+/**
+ * ggit_index_snapshot_get_raw_id:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the raw id of the entry at @position.
+ *
+ * Returns: (array fixed-size=20) (transfer none): the raw id of the entry,
+ * owned by @snapshot.
+ */
+const guint8 *
+ggit_index_snapshot_get_raw_id (GgitIndexSnapshot *snapshot,
+                                guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (position < snapshot->n_entries, NULL);
+
+	return snapshot->ids + (gsize)position * GIT_OID_RAWSZ;
+}
+
+/**
+ * ggit_index_snapshot_get_file_size:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the size of the file of the entry at @position, as recorded when
+ * it was added to the index.
+ *
+ * Returns: the file size.
+ */
+guint64
+ggit_index_snapshot_get_file_size (GgitIndexSnapshot *snapshot,
+                                   guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, 0);
+	g_return_val_if_fail (position < snapshot->n_entries, 0);
+
+	return snapshot->file_sizes[position];
+}
+
+/**
+ * ggit_index_snapshot_get_mtime:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @position: the position of the entry.
+ *
+ * Gets the modification time of the file of the entry at @position, as
+ * recorded when it was added to the index.
+ *
+ * Returns: the modification time in nanoseconds since the epoch.
+ */
+gint64
+ggit_index_snapshot_get_mtime (GgitIndexSnapshot *snapshot,
+                               guint              position)
+{
+	g_return_val_if_fail (snapshot != NULL, 0);
+	g_return_val_if_fail (position < snapshot->n_entries, 0);
+
+	return snapshot->mtimes[position];
+}
+
+/**
+ * ggit_index_snapshot_get_modes:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @n_entries: (out): return location for the number of entries.
+ *
+ * Gets the file modes of all entries, in snapshot order.
+ *
+ * Returns: (array length=n_entries) (transfer none): the modes, owned by
+ * @snapshot.
+ */
+const guint32 *
+ggit_index_snapshot_get_modes (GgitIndexSnapshot *snapshot,
+                               guint             *n_entries)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (n_entries != NULL, NULL);
+
+	*n_entries = snapshot->n_entries;
+	return snapshot->modes;
+}
+
+/**
+ * ggit_index_snapshot_get_raw_ids:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @n_entries: (out): return location for the number of entries.
+ *
+ * Gets the raw ids of all entries, in snapshot order. The ids are stored
+ * back to back, 20 bytes each.
+ *
+ * Returns: (transfer none): the raw ids, owned by @snapshot.
+ */
+const guint8 *
+ggit_index_snapshot_get_raw_ids (GgitIndexSnapshot *snapshot,
+                                 guint             *n_entries)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (n_entries != NULL, NULL);
+
+	*n_entries = snapshot->n_entries;
+	return snapshot->ids;
+}
+
+/**
+ * ggit_index_snapshot_get_file_sizes:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @n_entries: (out): return location for the number of entries.
+ *
+ * Gets the file sizes of all entries, in snapshot order.
+ *
+ * Returns: (array length=n_entries) (transfer none): the file sizes, owned
+ * by @snapshot.
+ */
+const guint64 *
+ggit_index_snapshot_get_file_sizes (GgitIndexSnapshot *snapshot,
+                                    guint             *n_entries)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (n_entries != NULL, NULL);
+
+	*n_entries = snapshot->n_entries;
+	return snapshot->file_sizes;
+}
+
+/**
+ * ggit_index_snapshot_get_mtimes:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @n_entries: (out): return location for the number of entries.
+ *
+ * Gets the modification times of all entries, in nanoseconds since the
+ * epoch and in snapshot order.
+ *
+ * Returns: (array length=n_entries) (transfer none): the modification
+ * times, owned by @snapshot.
+ */
+const gint64 *
+ggit_index_snapshot_get_mtimes (GgitIndexSnapshot *snapshot,
+                                guint             *n_entries)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (n_entries != NULL, NULL);
+
+	*n_entries = snapshot->n_entries;
+	return snapshot->mtimes;
+}
+
+/* Position of the first entry whose path does not sort before @path. When
+ * @len is non zero only the first @len bytes are compared, and with @upper
+ * the first entry sorting after @path is found instead.
+ */
+static guint
+lower_bound (GgitIndexSnapshot *snapshot,
+             const gchar       *path,
+             gsize              len,
+             gboolean           upper)
+{
+	guint lo = 0;
+	guint hi = snapshot->n_entries;
+
+	while (lo < hi)
+	{
+		guint mid = lo + (hi - lo) / 2;
+		const gchar *p = snapshot->path_data + snapshot->path_offsets[mid];
+		gint cmp;
+
+		cmp = len > 0 ? strncmp (p, path, len) : strcmp (p, path);
+
+		if (cmp < 0 || (upper && cmp == 0))
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/**
+ * ggit_index_snapshot_find:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @path: the path to look for.
+ * @position: (out) (optional): return location for the position of the entry.
+ *
+ * Looks up the entry for @path. If the path is in conflict, the entry
+ * with the lowest stage is returned and the other stages follow it.
+ *
+ * Returns: %TRUE if an entry for @path was found, %FALSE otherwise.
+ */
+gboolean
+ggit_index_snapshot_find (GgitIndexSnapshot *snapshot,
+                          const gchar       *path,
+                          guint             *position)
+{
+	guint pos;
+
+	g_return_val_if_fail (snapshot != NULL, FALSE);
+	g_return_val_if_fail (path != NULL, FALSE);
+
+	pos = lower_bound (snapshot, path, 0, FALSE);
+
+	if (pos == snapshot->n_entries ||
+	    strcmp (snapshot->path_data + snapshot->path_offsets[pos], path) != 0)
+	{
+		return FALSE;
+	}
+
+	if (position != NULL)
+	{
+		*position = pos;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_index_snapshot_find_prefix:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @prefix: the path prefix.
+ * @start: (out): return location for the first matching position.
+ * @end: (out): return location for the position after the last match.
+ *
+ * Finds the range of entries whose path starts with @prefix. The prefix is
+ * matched bytewise, so use a trailing slash to only match the contents of
+ * a directory (e.g. "src/" but not "src2/").
+ *
+ * Returns: %TRUE if at least one entry matched, %FALSE otherwise.
+ */
+gboolean
+ggit_index_snapshot_find_prefix (GgitIndexSnapshot *snapshot,
+                                 const gchar       *prefix,
+                                 guint             *start,
+                                 guint             *end)
+{
+	gsize len;
+
+	g_return_val_if_fail (snapshot != NULL, FALSE);
+	g_return_val_if_fail (prefix != NULL, FALSE);
+	g_return_val_if_fail (start != NULL, FALSE);
+	g_return_val_if_fail (end != NULL, FALSE);
+
+	len = strlen (prefix);
+
+	if (len == 0)
+	{
+		*start = 0;
+		*end = snapshot->n_entries;
+	}
+	else
+	{
+		*start = lower_bound (snapshot, prefix, len, FALSE);
+		*end = lower_bound (snapshot, prefix, len, TRUE);
+	}
+
+	return *start < *end;
+}
+
+/**
+ * ggit_index_snapshot_get_range:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @from: (allow-none): the first path of the range, or %NULL.
+ * @to: (allow-none): the path after the range, or %NULL.
+ * @start: (out): return location for the first position in the range.
+ * @end: (out): return location for the position after the range.
+ *
+ * Finds the range of entries whose path sorts at or after @from and
+ * before @to. A %NULL @from or @to leaves that side of the range open.
+ */
+void
+ggit_index_snapshot_get_range (GgitIndexSnapshot *snapshot,
+                               const gchar       *from,
+                               const gchar       *to,
+                               guint             *start,
+                               guint             *end)
+{
+	g_return_if_fail (snapshot != NULL);
+	g_return_if_fail (start != NULL);
+	g_return_if_fail (end != NULL);
+
+	*start = from != NULL ? lower_bound (snapshot, from, 0, FALSE) : 0;
+	*end = to != NULL ? lower_bound (snapshot, to, 0, FALSE) : snapshot->n_entries;
+
+	if (*end < *start)
+	{
+		*end = *start;
+	}
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,100 @@
+/*
+ * ggit-index-snapshot.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_INDEX_SNAPSHOT_H__
+#define __GGIT_INDEX_SNAPSHOT_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+#include "ggit-index.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_INDEX_SNAPSHOT       (ggit_index_snapshot_get_type ())
+#define GGIT_INDEX_SNAPSHOT(obj)       ((GgitIndexSnapshot *)obj)
+
+GType              ggit_index_snapshot_get_type         (void) G_GNUC_CONST;
+
+GgitIndexSnapshot *ggit_index_snapshot_new              (GgitIndex          *index);
+
+GgitIndexSnapshot *_ggit_index_snapshot_new_native      (git_index          *gidx);
+
+GgitIndexSnapshot *ggit_index_snapshot_ref              (GgitIndexSnapshot  *snapshot);
+void               ggit_index_snapshot_unref            (GgitIndexSnapshot  *snapshot);
+
+guint              ggit_index_snapshot_get_size         (GgitIndexSnapshot  *snapshot);
+
+const gchar       *ggit_index_snapshot_get_path         (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+guint              ggit_index_snapshot_get_mode         (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+gint               ggit_index_snapshot_get_stage        (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+GgitOId           *ggit_index_snapshot_get_id           (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+const guint8      *ggit_index_snapshot_get_raw_id       (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+guint64            ggit_index_snapshot_get_file_size    (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+gint64             ggit_index_snapshot_get_mtime        (GgitIndexSnapshot  *snapshot,
+                                                         guint               position);
+
+const guint32     *ggit_index_snapshot_get_modes        (GgitIndexSnapshot  *snapshot,
+                                                         guint              *n_entries);
+
+const guint8      *ggit_index_snapshot_get_raw_ids      (GgitIndexSnapshot  *snapshot,
+                                                         guint              *n_entries);
+
+const guint64     *ggit_index_snapshot_get_file_sizes   (GgitIndexSnapshot  *snapshot,
+                                                         guint              *n_entries);
+
+const gint64      *ggit_index_snapshot_get_mtimes       (GgitIndexSnapshot  *snapshot,
+                                                         guint              *n_entries);
+
+gboolean           ggit_index_snapshot_find             (GgitIndexSnapshot  *snapshot,
+                                                         const gchar        *path,
+                                                         guint              *position);
+
+gboolean           ggit_index_snapshot_find_prefix      (GgitIndexSnapshot  *snapshot,
+                                                         const gchar        *prefix,
+                                                         guint              *start,
+                                                         guint              *end);
+
+void               ggit_index_snapshot_get_range        (GgitIndexSnapshot  *snapshot,
+                                                         const gchar        *from,
+                                                         const gchar        *to,
+                                                         guint              *start,
+                                                         guint              *end);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitIndexSnapshot, ggit_index_snapshot_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_INDEX_SNAPSHOT_H__ */
+
+/* ex:set ts=8 noet: */
@@ -18,6 +18,10 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
 #include "ggit-index.h"
 #include <git2.h>
 #include "ggit-error.h"
@@ -25,6 +29,10 @@
 #include "ggit-index-entry.h"
 #include "ggit-index-entry-resolve-undo.h"
 
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
 /**
  * GgitIndex:
  *
@@ -537,6 +545,433 @@ ggit_index_add_path (GgitIndex    *idx,
 	return ret;
 }
 
+typedef struct
+{
+	GgitIndexMatchedPathCallback callback;
+	gpointer user_data;
+
+	/* Paths collected for hashing on worker threads */
+	GPtrArray *paths;
+} MatchedPathData;
+
+static gint
+matched_path_wrap (const gchar *path,
+                   const gchar *matched_pathspec,
+                   gpointer     payload)
+{
+	MatchedPathData *data = payload;
+	gint ret = 0;
+
+	if (data->callback != NULL)
+	{
+		ret = data->callback (path, matched_pathspec, data->user_data);
+	}
+
+	if (ret == 0 && data->paths != NULL)
+	{
+		/* Defer the file to the worker threads and let libgit2 skip it */
+		g_ptr_array_add (data->paths, g_strdup (path));
+		ret = 1;
+	}
+
+	return ret;
+}
+
+static git_index_matched_path_cb
+matched_path_prepare (MatchedPathData              *data,
+                      GgitIndexMatchedPathCallback  callback,
+                      gpointer                      user_data,
+                      gboolean                      collect)
+{
+	data->callback = callback;
+	data->user_data = user_data;
+	data->paths = collect ? g_ptr_array_new_with_free_func (g_free) : NULL;
+
+	return callback != NULL || collect ? matched_path_wrap : NULL;
+}
+
+static void
+pathspec_to_strarray (const gchar * const *pathspec,
+                      git_strarray        *gitarray)
+{
+	/* The strings are only borrowed for the duration of the call */
+	gitarray->strings = (gchar **)pathspec;
+	gitarray->count = pathspec != NULL ? g_strv_length ((gchar **)pathspec) : 0;
+}
+
+typedef struct
+{
+	gchar *path;
+	git_oid id;
+	GStatBuf st;
+	gboolean hashed;
+} HashJob;
+
+typedef struct
+{
+	const gchar *repo_path;
+	const gchar *workdir;
+
+	HashJob *jobs;
+	gint n_jobs;
+	gint next_job;
+} HashState;
+
+static gpointer
+hash_worker (gpointer user_data)
+{
+	HashState *state = user_data;
+	git_repository *repo;
+	gint i;
+
+	/* A repository is not safe to share between threads, so every
+	 * worker hashes through its own handle on the same object database.
+	 * Jobs that are not hashed here are added on the calling thread.
+	 */
+	if (git_repository_open (&repo, state->repo_path) != GIT_OK)
+	{
+		return NULL;
+	}
+
+	if (git_repository_set_workdir (repo, state->workdir, 0) != GIT_OK)
+	{
+		git_repository_free (repo);
+		return NULL;
+	}
+
+	while ((i = g_atomic_int_add (&state->next_job, 1)) < state->n_jobs)
+	{
+		HashJob *job = &state->jobs[i];
+		gchar *filename;
+
+		filename = g_build_filename (state->workdir, job->path, NULL);
+
+		if (g_lstat (filename, &job->st) == 0 &&
+		    S_ISREG (job->st.st_mode) &&
+		    git_blob_create_fromworkdir (&job->id, repo, job->path) == GIT_OK)
+		{
+			job->hashed = TRUE;
+		}
+
+		g_free (filename);
+	}
+
+	git_repository_free (repo);
+	return NULL;
+}
+
+static gint
+hash_job_add (git_index   *index,
+              const gchar *workdir,
+              HashJob     *job,
+              gboolean     filemode)
+{
+	git_index_entry entry;
+
+	if (!job->hashed)
+	{
+		gchar *filename;
+		GStatBuf st;
+		gboolean missing;
+
+		/* add_all also reports deleted files, which are removed */
+		filename = g_build_filename (workdir, job->path, NULL);
+		missing = g_lstat (filename, &st) != 0 && errno == ENOENT;
+		g_free (filename);
+
+		if (missing)
+		{
+			return git_index_remove_bypath (index, job->path);
+		}
+	}
+
+	if (!job->hashed ||
+	    (git_index_has_conflicts (index) &&
+	     (git_index_get_bypath (index, job->path, 1) != NULL ||
+	      git_index_get_bypath (index, job->path, 2) != NULL ||
+	      git_index_get_bypath (index, job->path, 3) != NULL)))
+	{
+		/* Symlinks, submodules, files that failed to hash and
+		 * conflicts that need to move to the resolve undo list are
+		 * left to libgit2.
+		 */
+		return git_index_add_bypath (index, job->path);
+	}
+
+	memset (&entry, 0, sizeof (entry));
+
+	entry.ctime.seconds = (int32_t)job->st.st_ctime;
+	entry.mtime.seconds = (int32_t)job->st.st_mtime;
+#ifdef __linux__
+	entry.ctime.nanoseconds = (uint32_t)job->st.st_ctim.tv_nsec;
+	entry.mtime.nanoseconds = (uint32_t)job->st.st_mtim.tv_nsec;
+#endif
+	entry.dev = (uint32_t)job->st.st_dev;
+	entry.ino = (uint32_t)job->st.st_ino;
+	entry.uid = (uint32_t)job->st.st_uid;
+	entry.gid = (uint32_t)job->st.st_gid;
+	entry.file_size = (uint32_t)job->st.st_size;
+	entry.id = job->id;
+	entry.path = job->path;
+
+	if (filemode)
+	{
+		entry.mode = (job->st.st_mode & 0100) ? GIT_FILEMODE_BLOB_EXECUTABLE
+		                                      : GIT_FILEMODE_BLOB;
+	}
+	else
+	{
+		const git_index_entry *existing;
+
+		existing = git_index_get_bypath (index, job->path, 0);
+
+		if (existing != NULL && existing->mode == GIT_FILEMODE_BLOB_EXECUTABLE)
+		{
+			entry.mode = GIT_FILEMODE_BLOB_EXECUTABLE;
+		}
+		else
+		{
+			entry.mode = GIT_FILEMODE_BLOB;
+		}
+	}
+
+	return git_index_add (index, &entry);
+}
+
+static gint
+hash_and_add_paths (git_index *index,
+                    GPtrArray *paths)
+{
+	git_repository *owner;
+	git_config *config;
+	HashState state = { 0 };
+	GThread **threads;
+	gboolean filemode = TRUE;
+	guint n_threads;
+	guint i;
+	gint ret = GIT_OK;
+
+	owner = git_index_owner (index);
+
+	if (git_repository_config_snapshot (&config, owner) == GIT_OK)
+	{
+		gint value;
+
+		if (git_config_get_bool (&value, config, "core.filemode") == GIT_OK)
+		{
+			filemode = value != 0;
+		}
+
+		git_config_free (config);
+	}
+
+	state.repo_path = git_repository_path (owner);
+	state.workdir = git_repository_workdir (owner);
+
+	if (state.workdir == NULL)
+	{
+		return GIT_EBAREREPO;
+	}
+
+	state.n_jobs = (gint)paths->len;
+	state.jobs = g_new0 (HashJob, paths->len);
+
+	for (i = 0; i < paths->len; ++i)
+	{
+		state.jobs[i].path = g_ptr_array_index (paths, i);
+	}
+
+	n_threads = MIN (g_get_num_processors (), paths->len);
+
+	if (!(git_libgit2_features () & GIT_FEATURE_THREADS))
+	{
+		n_threads = 0;
+	}
+
+	threads = g_new0 (GThread *, n_threads);
+
+	for (i = 0; i < n_threads; ++i)
+	{
+		threads[i] = g_thread_new ("ggit-index-hash", hash_worker, &state);
+	}
+
+	for (i = 0; i < n_threads; ++i)
+	{
+		g_thread_join (threads[i]);
+	}
+
+	g_free (threads);
+
+	/* The index itself is only ever touched from the calling thread */
+	for (i = 0; i < paths->len && ret == GIT_OK; ++i)
+	{
+		ret = hash_job_add (index, state.workdir, &state.jobs[i], filemode);
+	}
+
+	g_free (state.jobs);
+	return ret;
+}
+
+/**
+ * ggit_index_add_paths:
+ * @idx: a #GgitIndex.
+ * @pathspec: (array zero-terminated=1) (allow-none): the pathspecs to match
+ *   files against, or %NULL to match all files.
+ * @flags: a #GgitIndexAddOption.
+ * @callback: (scope call) (allow-none): a #GgitIndexMatchedPathCallback.
+ * @user_data: (closure): callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Add or update all the files in the working directory matching @pathspec
+ * in one pass, which is much cheaper than calling ggit_index_add_path() for
+ * every file. Ignored files are skipped unless %GGIT_INDEX_ADD_FORCE is
+ * set. @callback is invoked for every file before it is added and can be
+ * used to skip files or to report progress.
+ *
+ * With %GGIT_INDEX_ADD_HASH_IN_PARALLEL, the contents of the matched files
+ * are hashed and written to the object database on worker threads first,
+ * which mostly helps when adding many large files.
+ *
+ * Returns: %TRUE if the files were added, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_index_add_paths (GgitIndex                    *idx,
+                      const gchar * const          *pathspec,
+                      GgitIndexAddOption            flags,
+                      GgitIndexMatchedPathCallback  callback,
+                      gpointer                      user_data,
+                      GError                      **error)
+{
+	MatchedPathData data;
+	git_index_matched_path_cb cb;
+	git_strarray gpathspec;
+	gboolean parallel;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_INDEX (idx), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	parallel = (flags & GGIT_INDEX_ADD_HASH_IN_PARALLEL) != 0;
+	flags &= ~GGIT_INDEX_ADD_HASH_IN_PARALLEL;
+
+	pathspec_to_strarray (pathspec, &gpathspec);
+	cb = matched_path_prepare (&data, callback, user_data, parallel);
+
+	ret = git_index_add_all (_ggit_native_get (idx),
+	                         &gpathspec,
+	                         (unsigned int)flags,
+	                         cb,
+	                         &data);
+
+	if (ret == GIT_OK && data.paths != NULL && data.paths->len > 0)
+	{
+		ret = hash_and_add_paths (_ggit_native_get (idx), data.paths);
+	}
+
+	if (data.paths != NULL)
+	{
+		g_ptr_array_unref (data.paths);
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_index_update_paths:
+ * @idx: a #GgitIndex.
+ * @pathspec: (array zero-terminated=1) (allow-none): the pathspecs to match
+ *   index entries against, or %NULL to match all entries.
+ * @callback: (scope call) (allow-none): a #GgitIndexMatchedPathCallback.
+ * @user_data: (closure): callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Update all the index entries matching @pathspec to the contents of the
+ * working directory in one pass. Entries whose file no longer exists are
+ * removed, and no new files are added.
+ *
+ * Returns: %TRUE if the entries were updated, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_index_update_paths (GgitIndex                    *idx,
+                         const gchar * const          *pathspec,
+                         GgitIndexMatchedPathCallback  callback,
+                         gpointer                      user_data,
+                         GError                      **error)
+{
+	MatchedPathData data;
+	git_index_matched_path_cb cb;
+	git_strarray gpathspec;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_INDEX (idx), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	pathspec_to_strarray (pathspec, &gpathspec);
+	cb = matched_path_prepare (&data, callback, user_data, FALSE);
+
+	ret = git_index_update_all (_ggit_native_get (idx), &gpathspec, cb, &data);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_index_remove_paths:
+ * @idx: a #GgitIndex.
+ * @pathspec: (array zero-terminated=1) (allow-none): the pathspecs to match
+ *   index entries against, or %NULL to match all entries.
+ * @callback: (scope call) (allow-none): a #GgitIndexMatchedPathCallback.
+ * @user_data: (closure): callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Remove all the index entries matching @pathspec in one pass. The files in
+ * the working directory are left untouched.
+ *
+ * Returns: %TRUE if the entries were removed, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_index_remove_paths (GgitIndex                    *idx,
+                         const gchar * const          *pathspec,
+                         GgitIndexMatchedPathCallback  callback,
+                         gpointer                      user_data,
+                         GError                      **error)
+{
+	MatchedPathData data;
+	git_index_matched_path_cb cb;
+	git_strarray gpathspec;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_INDEX (idx), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	pathspec_to_strarray (pathspec, &gpathspec);
+	cb = matched_path_prepare (&data, callback, user_data, FALSE);
+
+	ret = git_index_remove_all (_ggit_native_get (idx), &gpathspec, cb, &data);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 /**
  * ggit_index_get_owner:
  * @idx: a #GgitIndex.
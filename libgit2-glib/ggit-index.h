@@ -69,6 +69,25 @@ gboolean                  ggit_index_add_path                 (GgitIndex       *
                                                                const gchar     *path,
                                                                GError         **error);
 
+gboolean                  ggit_index_add_paths                (GgitIndex                    *idx,
+                                                               const gchar * const          *pathspec,
+                                                               GgitIndexAddOption            flags,
+                                                               GgitIndexMatchedPathCallback  callback,
+                                                               gpointer                      user_data,
+                                                               GError                      **error);
+
+gboolean                  ggit_index_update_paths             (GgitIndex                    *idx,
+                                                               const gchar * const          *pathspec,
+                                                               GgitIndexMatchedPathCallback  callback,
+                                                               gpointer                      user_data,
+                                                               GError                      **error);
+
+gboolean                  ggit_index_remove_paths             (GgitIndex                    *idx,
+                                                               const gchar * const          *pathspec,
+                                                               GgitIndexMatchedPathCallback  callback,
+                                                               gpointer                      user_data,
+                                                               GError                      **error);
+
 GgitRepository           *ggit_index_get_owner                (GgitIndex  *idx);
 
 gboolean                  ggit_index_has_conflicts            (GgitIndex  *idx);
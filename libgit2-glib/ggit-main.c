@@ -39,6 +39,10 @@ ggit_get_features (void)
  * ggit_init:
  *
  * Call this function before using any other libgit2-glib function.
+ *
+ * When using libgit2-glib from multiple threads, call it before starting
+ * the other threads. See the [Threading](threading.html) page for which
+ * objects may be shared between threads.
  */
 void
 ggit_init (void)
@@ -0,0 +1,406 @@
+/*
+ * ggit-object-cache.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ggit-object-cache.h"
+#include "ggit-oid-table.h"
+
+/* Tracks the live object wrappers of a repository by object id, so that
+ * looking up an object that is still wrapped returns the same instance.
+ *
+ * Wrappers are tracked with weak references and drop out of the cache when
+ * they are finalized. The most recently used ones are additionally kept
+ * alive by a bounded LRU list, so that hot objects (HEAD, root trees, ...)
+ * survive between lookups.
+ *
+ * Weak notifications may come from any thread and may outlive the cache,
+ * so all caches share a single lock and entries are detached from their
+ * cache (instead of being freed) when the cache is cleared.
+ */
+
+G_LOCK_DEFINE_STATIC (object_cache);
+
+typedef struct _GgitObjectCacheEntry GgitObjectCacheEntry;
+
+struct _GgitObjectCacheEntry
+{
+	/* NULL once detached from the cache */
+	GgitObjectCache *cache;
+
+	GWeakRef ref;
+	guint8 id[GIT_OID_RAWSZ];
+	git_otype type;
+
+	/* link in cache->lru while the entry holds a strong reference */
+	GList *lru_link;
+	GObject *lru_object;
+};
+
+struct _GgitObjectCache
+{
+	/* raw id -> GgitObjectCacheEntry */
+	GgitOIdTable entries;
+
+	/* entries holding a strong reference, most recently used first */
+	GQueue lru;
+
+	guint capacity;
+
+	guint64 hits;
+	guint64 misses;
+};
+
+GgitObjectCache *
+_ggit_object_cache_new (void)
+{
+	GgitObjectCache *cache;
+
+	cache = g_slice_new0 (GgitObjectCache);
+
+	_ggit_oid_table_init (&cache->entries, TRUE);
+	g_queue_init (&cache->lru);
+
+	return cache;
+}
+
+static void
+entry_weak_notify (gpointer  data,
+                   GObject  *where_the_object_was)
+{
+	GgitObjectCacheEntry *entry = data;
+
+	G_LOCK (object_cache);
+
+	if (entry->cache != NULL)
+	{
+		GgitOIdTable *entries = &entry->cache->entries;
+		gssize slot;
+
+		slot = _ggit_oid_table_lookup (entries, entry->id);
+
+		if (slot >= 0 && entries->values[slot] == entry)
+		{
+			_ggit_oid_table_remove (entries, entry->id, NULL);
+		}
+	}
+
+	G_UNLOCK (object_cache);
+
+	g_weak_ref_clear (&entry->ref);
+	g_slice_free (GgitObjectCacheEntry, entry);
+}
+
+static void
+entry_detach (gpointer data)
+{
+	GgitObjectCacheEntry *entry = data;
+
+	/* Freed by entry_weak_notify when the object goes away */
+	entry->cache = NULL;
+}
+
+/* Moves @entry to the front of the LRU list, taking a strong reference if
+ * needed. The objects dropped from the end of the list are prepended to
+ * @evicted, to be unreferenced once the lock is released.
+ */
+static void
+lru_touch (GgitObjectCache       *cache,
+           GgitObjectCacheEntry  *entry,
+           GObject               *object,
+           GSList               **evicted)
+{
+	if (entry->lru_link != NULL)
+	{
+		g_queue_unlink (&cache->lru, entry->lru_link);
+		g_queue_push_head_link (&cache->lru, entry->lru_link);
+	}
+	else
+	{
+		g_queue_push_head (&cache->lru, entry);
+		entry->lru_link = cache->lru.head;
+		entry->lru_object = g_object_ref (object);
+	}
+
+	while (cache->lru.length > cache->capacity)
+	{
+		GgitObjectCacheEntry *last;
+
+		last = g_queue_pop_tail (&cache->lru);
+
+		*evicted = g_slist_prepend (*evicted, last->lru_object);
+
+		last->lru_link = NULL;
+		last->lru_object = NULL;
+	}
+}
+
+static void
+clear_locked (GgitObjectCache  *cache,
+              GSList          **evicted)
+{
+	GgitObjectCacheEntry *entry;
+
+	while ((entry = g_queue_pop_head (&cache->lru)) != NULL)
+	{
+		*evicted = g_slist_prepend (*evicted, entry->lru_object);
+
+		entry->lru_link = NULL;
+		entry->lru_object = NULL;
+	}
+
+	_ggit_oid_table_clear (&cache->entries, entry_detach);
+}
+
+void
+_ggit_object_cache_free (GgitObjectCache *cache)
+{
+	GSList *evicted = NULL;
+
+	if (cache == NULL)
+	{
+		return;
+	}
+
+	G_LOCK (object_cache);
+	clear_locked (cache, &evicted);
+	G_UNLOCK (object_cache);
+
+	g_slist_free_full (evicted, g_object_unref);
+
+	g_slice_free (GgitObjectCache, cache);
+}
+
+/*
+ * _ggit_object_cache_set_capacity:
+ * @cache: a #GgitObjectCache.
+ * @capacity: the number of objects to keep alive, 0 disables the cache.
+ */
+void
+_ggit_object_cache_set_capacity (GgitObjectCache *cache,
+                                 guint            capacity)
+{
+	GSList *evicted = NULL;
+
+	G_LOCK (object_cache);
+
+	cache->capacity = capacity;
+
+	if (capacity == 0)
+	{
+		clear_locked (cache, &evicted);
+	}
+	else
+	{
+		while (cache->lru.length > capacity)
+		{
+			GgitObjectCacheEntry *last;
+
+			last = g_queue_pop_tail (&cache->lru);
+			evicted = g_slist_prepend (evicted, last->lru_object);
+
+			last->lru_link = NULL;
+			last->lru_object = NULL;
+		}
+	}
+
+	G_UNLOCK (object_cache);
+
+	g_slist_free_full (evicted, g_object_unref);
+}
+
+guint
+_ggit_object_cache_get_capacity (GgitObjectCache *cache)
+{
+	guint capacity;
+
+	G_LOCK (object_cache);
+	capacity = cache->capacity;
+	G_UNLOCK (object_cache);
+
+	return capacity;
+}
+
+/*
+ * _ggit_object_cache_lookup:
+ * @cache: a #GgitObjectCache.
+ * @id: the object id.
+ * @type: the object type, or GIT_OBJ_ANY.
+ *
+ * Returns: (transfer full) (nullable): the live wrapper of @id, or %NULL.
+ */
+GgitObject *
+_ggit_object_cache_lookup (GgitObjectCache *cache,
+                           const git_oid   *id,
+                           git_otype        type)
+{
+	GObject *object = NULL;
+	GSList *evicted = NULL;
+	gssize slot;
+
+	G_LOCK (object_cache);
+
+	if (cache->capacity == 0)
+	{
+		G_UNLOCK (object_cache);
+		return NULL;
+	}
+
+	slot = _ggit_oid_table_lookup (&cache->entries, id->id);
+
+	if (slot >= 0)
+	{
+		GgitObjectCacheEntry *entry = cache->entries.values[slot];
+
+		if (type == GIT_OBJ_ANY || type == entry->type)
+		{
+			object = g_weak_ref_get (&entry->ref);
+		}
+
+		if (object != NULL)
+		{
+			lru_touch (cache, entry, object, &evicted);
+		}
+	}
+
+	if (object != NULL)
+	{
+		cache->hits++;
+	}
+	else
+	{
+		cache->misses++;
+	}
+
+	G_UNLOCK (object_cache);
+
+	g_slist_free_full (evicted, g_object_unref);
+
+	return (GgitObject *)object;
+}
+
+/*
+ * _ggit_object_cache_insert:
+ * @cache: a #GgitObjectCache.
+ * @object: (transfer full): a newly created wrapper.
+ *
+ * Adds @object to @cache. If another wrapper for the same object has been
+ * added in the meantime, @object is dropped and the other one is returned.
+ *
+ * Returns: (transfer full): the wrapper to use.
+ */
+GgitObject *
+_ggit_object_cache_insert (GgitObjectCache *cache,
+                           GgitObject      *object)
+{
+	GgitObjectCacheEntry *entry;
+	GSList *evicted = NULL;
+	git_object *obj;
+	const git_oid *id;
+	gssize slot;
+
+	if (object == NULL)
+	{
+		return NULL;
+	}
+
+	obj = _ggit_native_get (object);
+	id = git_object_id (obj);
+
+	G_LOCK (object_cache);
+
+	if (cache->capacity == 0)
+	{
+		G_UNLOCK (object_cache);
+		return object;
+	}
+
+	slot = _ggit_oid_table_lookup (&cache->entries, id->id);
+
+	if (slot >= 0)
+	{
+		GObject *existing;
+
+		entry = cache->entries.values[slot];
+		existing = g_weak_ref_get (&entry->ref);
+
+		if (existing != NULL)
+		{
+			lru_touch (cache, entry, existing, &evicted);
+			G_UNLOCK (object_cache);
+
+			g_slist_free_full (evicted, g_object_unref);
+			g_object_unref (object);
+
+			return (GgitObject *)existing;
+		}
+
+		/* The previous wrapper is being finalized */
+		entry->cache = NULL;
+		_ggit_oid_table_remove (&cache->entries, id->id, NULL);
+	}
+
+	entry = g_slice_new0 (GgitObjectCacheEntry);
+	entry->cache = cache;
+	entry->type = git_object_type (obj);
+	memcpy (entry->id, id->id, GIT_OID_RAWSZ);
+
+	g_weak_ref_init (&entry->ref, object);
+	g_object_weak_ref (G_OBJECT (object), entry_weak_notify, entry);
+
+	slot = _ggit_oid_table_insert (&cache->entries, entry->id, NULL);
+	cache->entries.values[slot] = entry;
+
+	lru_touch (cache, entry, G_OBJECT (object), &evicted);
+
+	G_UNLOCK (object_cache);
+
+	g_slist_free_full (evicted, g_object_unref);
+
+	return object;
+}
+
+void
+_ggit_object_cache_get_stats (GgitObjectCache *cache,
+                              guint64         *hits,
+                              guint64         *misses,
+                              guint           *n_objects)
+{
+	G_LOCK (object_cache);
+
+	if (hits != NULL)
+	{
+		*hits = cache->hits;
+	}
+
+	if (misses != NULL)
+	{
+		*misses = cache->misses;
+	}
+
+	if (n_objects != NULL)
+	{
+		*n_objects = cache->entries.size;
+	}
+
+	G_UNLOCK (object_cache);
+}
+
+/* ex:set ts=8 noet: */
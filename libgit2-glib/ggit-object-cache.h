@@ -0,0 +1,58 @@
+/*
+ * ggit-object-cache.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OBJECT_CACHE_H__
+#define __GGIT_OBJECT_CACHE_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-object.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GgitObjectCache GgitObjectCache;
+
+GgitObjectCache *_ggit_object_cache_new          (void);
+
+void             _ggit_object_cache_free         (GgitObjectCache *cache);
+
+void             _ggit_object_cache_set_capacity (GgitObjectCache *cache,
+                                                  guint            capacity);
+
+guint            _ggit_object_cache_get_capacity (GgitObjectCache *cache);
+
+GgitObject      *_ggit_object_cache_lookup       (GgitObjectCache *cache,
+                                                  const git_oid   *id,
+                                                  git_otype        type);
+
+GgitObject      *_ggit_object_cache_insert       (GgitObjectCache *cache,
+                                                  GgitObject      *object);
+
+void             _ggit_object_cache_get_stats    (GgitObjectCache *cache,
+                                                  guint64         *hits,
+                                                  guint64         *misses,
+                                                  guint           *n_objects);
+
+G_END_DECLS
+
+#endif /* __GGIT_OBJECT_CACHE_H__ */
+
+/* ex:set ts=8 noet: */
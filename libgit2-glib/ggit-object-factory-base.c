@@ -27,18 +27,72 @@
  * Represents the base type for objects created by an object factory.
  */
 
-G_DEFINE_ABSTRACT_TYPE (GgitObjectFactoryBase, ggit_object_factory_base, G_TYPE_OBJECT)
+/* The subtype resolved for a class. Class private data is copied from the
+ * parent class, so the entry also records the type it was resolved for.
+ */
+typedef struct
+{
+	gint generation;
+	GType basetype;
+	GType subtype;
+} GgitObjectFactoryBaseClassPrivate;
+
+G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GgitObjectFactoryBase, ggit_object_factory_base, G_TYPE_OBJECT,
+                                  g_type_add_class_private (g_define_type_id,
+                                                            sizeof (GgitObjectFactoryBaseClassPrivate)))
+
+static GType
+resolve_subtype (GgitObjectFactory *factory,
+                 GType              type)
+{
+	GgitObjectFactoryBaseClassPrivate *priv;
+	gint current;
+	gint cached;
+	GType subtype;
+
+	priv = G_TYPE_CLASS_GET_PRIVATE (g_type_class_peek (type),
+	                                 GGIT_TYPE_OBJECT_FACTORY_BASE,
+	                                 GgitObjectFactoryBaseClassPrivate);
+
+	current = (gint)_ggit_object_factory_get_generation ();
+
+	cached = g_atomic_int_get (&priv->generation);
+
+	if (cached == current && priv->basetype == type)
+	{
+		subtype = priv->subtype;
+
+		/* Make sure no other thread updated the entry meanwhile */
+		if (g_atomic_int_get (&priv->generation) == cached)
+		{
+			return subtype;
+		}
+	}
+
+	subtype = _ggit_object_factory_lookup_subtype (factory, type);
+
+	g_atomic_int_set (&priv->generation, 0);
+	priv->basetype = type;
+	priv->subtype = subtype;
+	g_atomic_int_set (&priv->generation, current);
+
+	return subtype;
+}
 
 static GObject *
 ggit_object_factory_base_constructor (GType                  type,
                                       guint                  n_construct_properties,
                                       GObjectConstructParam *construct_properties)
 {
-	return ggit_object_factory_construct (ggit_object_factory_get_default (),
-	                                      ggit_object_factory_base_parent_class,
-	                                      type,
-	                                      n_construct_properties,
-	                                      construct_properties);
+	GgitObjectFactory *factory;
+
+	factory = ggit_object_factory_get_default ();
+
+	return _ggit_object_factory_construct_type (ggit_object_factory_base_parent_class,
+	                                            type,
+	                                            resolve_subtype (factory, type),
+	                                            n_construct_properties,
+	                                            construct_properties);
 }
 
 static void
@@ -43,6 +43,14 @@ G_DEFINE_TYPE (GgitObjectFactory, ggit_object_factory, G_TYPE_OBJECT)
 
 static GgitObjectFactory *the_instance = NULL;
 
+/* Bumped whenever the type mapping changes, so that subtypes resolved
+ * before (see _ggit_object_factory_get_generation()) can be invalidated.
+ */
+static gint generation = 1;
+
+/* Construct properties forwarded on the stack up to this many */
+#define MAX_STACK_PROPERTIES 16
+
 static TypeWrap *
 type_wrap_new (GType type)
 {
@@ -68,6 +76,7 @@ ggit_object_factory_finalize (GObject *object)
 	factory = GGIT_OBJECT_FACTORY (object);
 
 	g_hash_table_destroy (factory->typemap);
+	g_atomic_int_inc (&generation);
 
 	G_OBJECT_CLASS (ggit_object_factory_parent_class)->finalize (object);
 }
@@ -155,6 +164,8 @@ ggit_object_factory_register (GgitObjectFactory *factory,
 	g_hash_table_insert (factory->typemap,
 	                     GINT_TO_POINTER (g_type_qname (basetype)),
 	                     type_wrap_new (subtype));
+
+	g_atomic_int_inc (&generation);
 }
 
 /**
@@ -182,78 +193,145 @@ ggit_object_factory_unregister (GgitObjectFactory *factory,
 	{
 		g_hash_table_remove (factory->typemap,
 		                     GINT_TO_POINTER (g_type_qname (basetype)));
+
+		g_atomic_int_inc (&generation);
 	}
 }
 
-/**
- * ggit_object_factory_construct:
+/*
+ * _ggit_object_factory_get_generation:
+ *
+ * Gets the current generation of the type mapping. It changes every time
+ * a subtype is registered or unregistered.
+ *
+ * Returns: the current generation.
+ */
+guint
+_ggit_object_factory_get_generation (void)
+{
+	return (guint)g_atomic_int_get (&generation);
+}
+
+/*
+ * _ggit_object_factory_lookup_subtype:
  * @factory: a #GgitObjectFactory.
+ * @basetype: a #GType.
+ *
+ * Returns: the subtype registered for @basetype, or @basetype itself.
+ */
+GType
+_ggit_object_factory_lookup_subtype (GgitObjectFactory *factory,
+                                     GType              basetype)
+{
+	TypeWrap *val;
+
+	if (g_hash_table_size (factory->typemap) == 0)
+	{
+		return basetype;
+	}
+
+	val = g_hash_table_lookup (factory->typemap,
+	                           GINT_TO_POINTER (g_type_qname (basetype)));
+
+	return val != NULL ? val->type : basetype;
+}
+
+/*
+ * _ggit_object_factory_construct_type:
  * @parent_class: a #GObjectClass.
  * @basetype: a #GType.
+ * @subtype: the type to create, as returned by
+ *           _ggit_object_factory_lookup_subtype().
  * @n_construct_properties: number of construct properties.
  * @construct_properties: (array length=n_construct_properties): a list of #GObjectConstructParam.
  *
- * Construct a new object.
+ * Creates an object of @subtype from the construct properties of
+ * @basetype. The property values are passed on as they are, they are not
+ * copied.
  *
  * Returns: (transfer full) (nullable): a #GObject or %NULL.
- *
- **/
+ */
 GObject *
-ggit_object_factory_construct (GgitObjectFactory     *factory,
-                               GObjectClass          *parent_class,
-                               GType                  basetype,
-                               guint                  n_construct_properties,
-                               GObjectConstructParam *construct_properties)
+_ggit_object_factory_construct_type (GObjectClass          *parent_class,
+                                     GType                  basetype,
+                                     GType                  subtype,
+                                     guint                  n_construct_properties,
+                                     GObjectConstructParam *construct_properties)
 {
-	TypeWrap *val;
+	const gchar *stack_names[MAX_STACK_PROPERTIES];
+	GValue stack_values[MAX_STACK_PROPERTIES];
+	const gchar **names;
+	GValue *values;
 	GObject *ret;
+	guint i;
 
-	g_return_val_if_fail (GGIT_IS_OBJECT_FACTORY (factory), NULL);
-
-	val = g_hash_table_lookup (factory->typemap,
-	                           GINT_TO_POINTER (g_type_qname (basetype)));
-
-	if (val)
+	if (subtype == basetype)
 	{
-		/* convert construct properties and call new_with_properties */
-		const char **names;
-		GValue *values;
-		guint i;
-
-		names = g_new (const char *, n_construct_properties);
-		values = g_new0 (GValue, n_construct_properties);
-
-		for (i = 0; i < n_construct_properties; ++i)
-		{
-			const GValue *value;
-
-			names[i] = construct_properties[i].pspec->name;
-			value = construct_properties[i].value;
+		return parent_class->constructor (basetype,
+		                                  n_construct_properties,
+		                                  construct_properties);
+	}
 
-			g_value_init (&values[i], G_VALUE_TYPE (value));
-			g_value_copy (value, &values[i]);
-		}
+	if (n_construct_properties <= MAX_STACK_PROPERTIES)
+	{
+		names = stack_names;
+		values = stack_values;
+	}
+	else
+	{
+		names = g_new (const gchar *, n_construct_properties);
+		values = g_new (GValue, n_construct_properties);
+	}
 
-		ret = g_object_new_with_properties (val->type,
-		                                    n_construct_properties,
-		                                    names, values);
+	/* Shallow copies: g_object_new_with_properties() only reads the
+	 * values and they stay owned by the construct properties.
+	 */
+	for (i = 0; i < n_construct_properties; ++i)
+	{
+		names[i] = construct_properties[i].pspec->name;
+		values[i] = *construct_properties[i].value;
+	}
 
-		for (i = 0; i < n_construct_properties; ++i)
-		{
-			g_value_unset (&values[i]);
-		}
+	ret = g_object_new_with_properties (subtype,
+	                                    n_construct_properties,
+	                                    names, values);
 
+	if (names != stack_names)
+	{
 		g_free (names);
 		g_free (values);
 	}
-	else
-	{
-		ret = parent_class->constructor (basetype,
-		                                 n_construct_properties,
-		                                 construct_properties);
-	}
 
 	return ret;
 }
 
+/**
+ * ggit_object_factory_construct:
+ * @factory: a #GgitObjectFactory.
+ * @parent_class: a #GObjectClass.
+ * @basetype: a #GType.
+ * @n_construct_properties: number of construct properties.
+ * @construct_properties: (array length=n_construct_properties): a list of #GObjectConstructParam.
+ *
+ * Construct a new object.
+ *
+ * Returns: (transfer full) (nullable): a #GObject or %NULL.
+ *
+ **/
+GObject *
+ggit_object_factory_construct (GgitObjectFactory     *factory,
+                               GObjectClass          *parent_class,
+                               GType                  basetype,
+                               guint                  n_construct_properties,
+                               GObjectConstructParam *construct_properties)
+{
+	g_return_val_if_fail (GGIT_IS_OBJECT_FACTORY (factory), NULL);
+
+	return _ggit_object_factory_construct_type (parent_class,
+	                                            basetype,
+	                                            _ggit_object_factory_lookup_subtype (factory, basetype),
+	                                            n_construct_properties,
+	                                            construct_properties);
+}
+
 /* ex:set ts=8 noet: */
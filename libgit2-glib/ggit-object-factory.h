@@ -46,6 +46,16 @@ GObject           *ggit_object_factory_construct   (GgitObjectFactory     *facto
                                                     guint                  n_construct_properties,
                                                     GObjectConstructParam *construct_properties);
 
+guint              _ggit_object_factory_get_generation (void);
+
+GType              _ggit_object_factory_lookup_subtype (GgitObjectFactory     *factory,
+                                                        GType                  basetype);
+
+GObject           *_ggit_object_factory_construct_type (GObjectClass          *parent_class,
+                                                        GType                  basetype,
+                                                        GType                  subtype,
+                                                        guint                  n_construct_properties,
+                                                        GObjectConstructParam *construct_properties);
 
 G_END_DECLS
 
@@ -0,0 +1,293 @@
+/*
+ * ggit-oid-map.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <git2.h>
+
+#include "ggit-oid.h"
+#include "ggit-oid-map.h"
+#include "ggit-oid-table.h"
+
+/**
+ * GgitOIdMap:
+ *
+ * A map from object ids to arbitrary values. Like #GgitOIdSet, the ids are
+ * stored inline in an open addressing hash table instead of being
+ * allocated per entry.
+ */
+struct _GgitOIdMap
+{
+	gint ref_count;
+
+	GgitOIdTable table;
+	GDestroyNotify value_destroy;
+};
+
+G_DEFINE_BOXED_TYPE (GgitOIdMap, ggit_oid_map,
+                     ggit_oid_map_ref, ggit_oid_map_unref)
+
+/**
+ * ggit_oid_map_new: (skip)
+ * @value_destroy: (allow-none): a function to free the values, or %NULL.
+ *
+ * Creates a new empty #GgitOIdMap.
+ *
+ * Returns: (transfer full): a newly allocated #GgitOIdMap.
+ */
+GgitOIdMap *
+ggit_oid_map_new (GDestroyNotify value_destroy)
+{
+	GgitOIdMap *map;
+
+	map = g_slice_new (GgitOIdMap);
+	map->ref_count = 1;
+	map->value_destroy = value_destroy;
+
+	_ggit_oid_table_init (&map->table, TRUE);
+
+	return map;
+}
+
+/**
+ * ggit_oid_map_ref:
+ * @map: a #GgitOIdMap.
+ *
+ * Atomically increments the reference count of @map by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitOIdMap.
+ */
+GgitOIdMap *
+ggit_oid_map_ref (GgitOIdMap *map)
+{
+	g_return_val_if_fail (map != NULL, NULL);
+
+	g_atomic_int_inc (&map->ref_count);
+
+	return map;
+}
+
+/**
+ * ggit_oid_map_unref:
+ * @map: a #GgitOIdMap.
+ *
+ * Atomically decrements the reference count of @map by one.
+ * If the reference count drops to 0, @map is freed.
+ */
+void
+ggit_oid_map_unref (GgitOIdMap *map)
+{
+	g_return_if_fail (map != NULL);
+
+	if (g_atomic_int_dec_and_test (&map->ref_count))
+	{
+		_ggit_oid_table_clear (&map->table, map->value_destroy);
+		g_slice_free (GgitOIdMap, map);
+	}
+}
+
+/**
+ * ggit_oid_map_get_size:
+ * @map: a #GgitOIdMap.
+ *
+ * Gets the number of entries in @map.
+ *
+ * Returns: the number of entries in @map.
+ */
+guint
+ggit_oid_map_get_size (GgitOIdMap *map)
+{
+	g_return_val_if_fail (map != NULL, 0);
+
+	return map->table.size;
+}
+
+/**
+ * ggit_oid_map_reserve:
+ * @map: a #GgitOIdMap.
+ * @size: the expected number of entries.
+ *
+ * Makes room for @size entries in @map, so that inserting them does not
+ * need to grow the table.
+ */
+void
+ggit_oid_map_reserve (GgitOIdMap *map,
+                      guint       size)
+{
+	g_return_if_fail (map != NULL);
+
+	_ggit_oid_table_reserve (&map->table, size);
+}
+
+/**
+ * ggit_oid_map_insert: (skip)
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ * @value: (allow-none): the value to associate with @oid.
+ *
+ * Associates @value with @oid, replacing (and freeing) the previous value
+ * of @oid if any.
+ *
+ * Returns: %TRUE if @oid was not in @map yet.
+ */
+gboolean
+ggit_oid_map_insert (GgitOIdMap *map,
+                     GgitOId    *oid,
+                     gpointer    value)
+{
+	gboolean added;
+	gsize slot;
+
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	slot = _ggit_oid_table_insert (&map->table,
+	                               _ggit_oid_get_oid (oid)->id,
+	                               &added);
+
+	if (!added && map->value_destroy != NULL && map->table.values[slot] != NULL)
+	{
+		map->value_destroy (map->table.values[slot]);
+	}
+
+	map->table.values[slot] = value;
+
+	return added;
+}
+
+/**
+ * ggit_oid_map_lookup: (skip)
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ *
+ * Gets the value associated with @oid.
+ *
+ * Returns: (transfer none) (nullable): the value of @oid or %NULL.
+ */
+gpointer
+ggit_oid_map_lookup (GgitOIdMap *map,
+                     GgitOId    *oid)
+{
+	gpointer value = NULL;
+
+	ggit_oid_map_lookup_extended (map, oid, &value);
+
+	return value;
+}
+
+/**
+ * ggit_oid_map_lookup_extended: (skip)
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ * @value: (out) (optional): return location for the value of @oid.
+ *
+ * Looks up @oid, which unlike ggit_oid_map_lookup() allows telling a
+ * %NULL value apart from a missing entry.
+ *
+ * Returns: %TRUE if @oid is in @map.
+ */
+gboolean
+ggit_oid_map_lookup_extended (GgitOIdMap *map,
+                              GgitOId    *oid,
+                              gpointer   *value)
+{
+	gssize slot;
+
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	slot = _ggit_oid_table_lookup (&map->table, _ggit_oid_get_oid (oid)->id);
+
+	if (slot < 0)
+	{
+		return FALSE;
+	}
+
+	if (value != NULL)
+	{
+		*value = map->table.values[slot];
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_oid_map_contains:
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ *
+ * Checks whether @oid is in @map.
+ *
+ * Returns: %TRUE if @oid is in @map.
+ */
+gboolean
+ggit_oid_map_contains (GgitOIdMap *map,
+                       GgitOId    *oid)
+{
+	return ggit_oid_map_lookup_extended (map, oid, NULL);
+}
+
+/**
+ * ggit_oid_map_remove:
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ *
+ * Removes @oid and frees its value.
+ *
+ * Returns: %TRUE if @oid was in @map.
+ */
+gboolean
+ggit_oid_map_remove (GgitOIdMap *map,
+                     GgitOId    *oid)
+{
+	gpointer value;
+
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	if (!_ggit_oid_table_remove (&map->table,
+	                             _ggit_oid_get_oid (oid)->id,
+	                             &value))
+	{
+		return FALSE;
+	}
+
+	if (map->value_destroy != NULL && value != NULL)
+	{
+		map->value_destroy (value);
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_oid_map_remove_all:
+ * @map: a #GgitOIdMap.
+ *
+ * Removes all the entries from @map, freeing their values.
+ */
+void
+ggit_oid_map_remove_all (GgitOIdMap *map)
+{
+	g_return_if_fail (map != NULL);
+
+	_ggit_oid_table_clear (&map->table, map->value_destroy);
+}
+
+/* ex:set ts=8 noet: */
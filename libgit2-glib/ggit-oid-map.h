@@ -0,0 +1,71 @@
+/*
+ * ggit-oid-map.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OID_MAP_H__
+#define __GGIT_OID_MAP_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_OID_MAP       (ggit_oid_map_get_type ())
+#define GGIT_OID_MAP(obj)       ((GgitOIdMap *)obj)
+
+GType             ggit_oid_map_get_type        (void) G_GNUC_CONST;
+
+GgitOIdMap       *ggit_oid_map_new             (GDestroyNotify  value_destroy);
+
+GgitOIdMap       *ggit_oid_map_ref             (GgitOIdMap     *map);
+void              ggit_oid_map_unref           (GgitOIdMap     *map);
+
+guint             ggit_oid_map_get_size        (GgitOIdMap     *map);
+
+void              ggit_oid_map_reserve         (GgitOIdMap     *map,
+                                                guint           size);
+
+gboolean          ggit_oid_map_insert          (GgitOIdMap     *map,
+                                                GgitOId        *oid,
+                                                gpointer        value);
+
+gpointer          ggit_oid_map_lookup          (GgitOIdMap     *map,
+                                                GgitOId        *oid);
+
+gboolean          ggit_oid_map_lookup_extended (GgitOIdMap     *map,
+                                                GgitOId        *oid,
+                                                gpointer       *value);
+
+gboolean          ggit_oid_map_contains        (GgitOIdMap     *map,
+                                                GgitOId        *oid);
+
+gboolean          ggit_oid_map_remove          (GgitOIdMap     *map,
+                                                GgitOId        *oid);
+
+void              ggit_oid_map_remove_all      (GgitOIdMap     *map);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitOIdMap, ggit_oid_map_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_OID_MAP_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,322 @@
+/*
+ * ggit-oid-set.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <git2.h>
+
+#include "ggit-oid.h"
+#include "ggit-oid-set.h"
+#include "ggit-oid-table.h"
+
+/* Number of ids fetched from a revision walker at once */
+#define WALK_CHUNK 256
+
+/**
+ * GgitOIdSet:
+ *
+ * A set of object ids. Ids are stored inline in an open addressing hash
+ * table, so adding an id does not allocate (besides growing the table).
+ * This makes it suitable for reachability or deduplication passes over
+ * large numbers of objects.
+ */
+struct _GgitOIdSet
+{
+	gint ref_count;
+
+	GgitOIdTable table;
+};
+
+G_DEFINE_BOXED_TYPE (GgitOIdSet, ggit_oid_set,
+                     ggit_oid_set_ref, ggit_oid_set_unref)
+
+/**
+ * ggit_oid_set_new:
+ *
+ * Creates a new empty #GgitOIdSet.
+ *
+ * Returns: (transfer full): a newly allocated #GgitOIdSet.
+ */
+GgitOIdSet *
+ggit_oid_set_new (void)
+{
+	GgitOIdSet *set;
+
+	set = g_slice_new (GgitOIdSet);
+	set->ref_count = 1;
+
+	_ggit_oid_table_init (&set->table, FALSE);
+
+	return set;
+}
+
+/**
+ * ggit_oid_set_ref:
+ * @set: a #GgitOIdSet.
+ *
+ * Atomically increments the reference count of @set by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitOIdSet.
+ */
+GgitOIdSet *
+ggit_oid_set_ref (GgitOIdSet *set)
+{
+	g_return_val_if_fail (set != NULL, NULL);
+
+	g_atomic_int_inc (&set->ref_count);
+
+	return set;
+}
+
+/**
+ * ggit_oid_set_unref:
+ * @set: a #GgitOIdSet.
+ *
+ * Atomically decrements the reference count of @set by one.
+ * If the reference count drops to 0, @set is freed.
+ */
+void
+ggit_oid_set_unref (GgitOIdSet *set)
+{
+	g_return_if_fail (set != NULL);
+
+	if (g_atomic_int_dec_and_test (&set->ref_count))
+	{
+		_ggit_oid_table_clear (&set->table, NULL);
+		g_slice_free (GgitOIdSet, set);
+	}
+}
+
+/**
+ * ggit_oid_set_get_size:
+ * @set: a #GgitOIdSet.
+ *
+ * Gets the number of ids in @set.
+ *
+ * Returns: the number of ids in @set.
+ */
+guint
+ggit_oid_set_get_size (GgitOIdSet *set)
+{
+	g_return_val_if_fail (set != NULL, 0);
+
+	return set->table.size;
+}
+
+/**
+ * ggit_oid_set_reserve:
+ * @set: a #GgitOIdSet.
+ * @size: the expected number of ids.
+ *
+ * Makes room for @size ids in @set, so that adding them does not need to
+ * grow the table.
+ */
+void
+ggit_oid_set_reserve (GgitOIdSet *set,
+                      guint       size)
+{
+	g_return_if_fail (set != NULL);
+
+	_ggit_oid_table_reserve (&set->table, size);
+}
+
+/**
+ * ggit_oid_set_add:
+ * @set: a #GgitOIdSet.
+ * @oid: a #GgitOId.
+ *
+ * Adds @oid to @set.
+ *
+ * Returns: %TRUE if @oid was not in @set yet.
+ */
+gboolean
+ggit_oid_set_add (GgitOIdSet *set,
+                  GgitOId    *oid)
+{
+	gboolean added;
+
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	_ggit_oid_table_insert (&set->table, _ggit_oid_get_oid (oid)->id, &added);
+
+	return added;
+}
+
+/**
+ * ggit_oid_set_add_raw: (skip)
+ * @set: a #GgitOIdSet.
+ * @raw_ids: (array) (element-type guint8): @n_ids consecutive 20 byte raw
+ *           object ids.
+ * @n_ids: the number of ids in @raw_ids.
+ *
+ * Adds all the ids in @raw_ids to @set, as returned for example by
+ * ggit_revision_walker_next_n().
+ *
+ * Returns: the number of ids which were not in @set yet.
+ */
+gsize
+ggit_oid_set_add_raw (GgitOIdSet   *set,
+                      const guint8 *raw_ids,
+                      gsize         n_ids)
+{
+	gsize added = 0;
+	gsize i;
+
+	g_return_val_if_fail (set != NULL, 0);
+	g_return_val_if_fail (raw_ids != NULL || n_ids == 0, 0);
+
+	_ggit_oid_table_reserve (&set->table, set->table.size + n_ids);
+
+	for (i = 0; i < n_ids; i++)
+	{
+		gboolean is_new;
+
+		_ggit_oid_table_insert (&set->table,
+		                        raw_ids + i * GIT_OID_RAWSZ,
+		                        &is_new);
+
+		if (is_new)
+		{
+			added++;
+		}
+	}
+
+	return added;
+}
+
+/**
+ * ggit_oid_set_add_from_revision_walker:
+ * @set: a #GgitOIdSet.
+ * @walker: a #GgitRevisionWalker.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Walks @walker until the end and adds all the visited commit ids to @set.
+ * No #GgitOId is allocated along the way.
+ *
+ * Returns: the number of commits visited.
+ */
+gsize
+ggit_oid_set_add_from_revision_walker (GgitOIdSet          *set,
+                                       GgitRevisionWalker  *walker,
+                                       GError             **error)
+{
+	guint8 raw_ids[WALK_CHUNK * GIT_OID_RAWSZ];
+	GError *walk_error = NULL;
+	gsize total = 0;
+	gsize n;
+
+	g_return_val_if_fail (set != NULL, 0);
+	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), 0);
+	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+
+	do
+	{
+		n = ggit_revision_walker_next_n (walker,
+		                                 raw_ids,
+		                                 WALK_CHUNK,
+		                                 &walk_error);
+
+		ggit_oid_set_add_raw (set, raw_ids, n);
+		total += n;
+	} while (n == WALK_CHUNK);
+
+	if (walk_error != NULL)
+	{
+		g_propagate_error (error, walk_error);
+	}
+
+	return total;
+}
+
+/**
+ * ggit_oid_set_remove:
+ * @set: a #GgitOIdSet.
+ * @oid: a #GgitOId.
+ *
+ * Removes @oid from @set.
+ *
+ * Returns: %TRUE if @oid was in @set.
+ */
+gboolean
+ggit_oid_set_remove (GgitOIdSet *set,
+                     GgitOId    *oid)
+{
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return _ggit_oid_table_remove (&set->table,
+	                               _ggit_oid_get_oid (oid)->id,
+	                               NULL);
+}
+
+/**
+ * ggit_oid_set_contains:
+ * @set: a #GgitOIdSet.
+ * @oid: a #GgitOId.
+ *
+ * Checks whether @oid is in @set.
+ *
+ * Returns: %TRUE if @oid is in @set.
+ */
+gboolean
+ggit_oid_set_contains (GgitOIdSet *set,
+                       GgitOId    *oid)
+{
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return _ggit_oid_table_lookup (&set->table,
+	                               _ggit_oid_get_oid (oid)->id) >= 0;
+}
+
+/**
+ * ggit_oid_set_contains_raw:
+ * @set: a #GgitOIdSet.
+ * @raw_id: (array fixed-size=20): a raw object id.
+ *
+ * Checks whether the raw object id @raw_id is in @set.
+ *
+ * Returns: %TRUE if @raw_id is in @set.
+ */
+gboolean
+ggit_oid_set_contains_raw (GgitOIdSet   *set,
+                           const guint8 *raw_id)
+{
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (raw_id != NULL, FALSE);
+
+	return _ggit_oid_table_lookup (&set->table, raw_id) >= 0;
+}
+
+/**
+ * ggit_oid_set_remove_all:
+ * @set: a #GgitOIdSet.
+ *
+ * Removes all the ids from @set.
+ */
+void
+ggit_oid_set_remove_all (GgitOIdSet *set)
+{
+	g_return_if_fail (set != NULL);
+
+	_ggit_oid_table_clear (&set->table, NULL);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,75 @@
+/*
+ * ggit-oid-set.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OID_SET_H__
+#define __GGIT_OID_SET_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+#include "ggit-revision-walker.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_OID_SET       (ggit_oid_set_get_type ())
+#define GGIT_OID_SET(obj)       ((GgitOIdSet *)obj)
+
+GType             ggit_oid_set_get_type                  (void) G_GNUC_CONST;
+
+GgitOIdSet       *ggit_oid_set_new                       (void);
+
+GgitOIdSet       *ggit_oid_set_ref                       (GgitOIdSet          *set);
+void              ggit_oid_set_unref                     (GgitOIdSet          *set);
+
+guint             ggit_oid_set_get_size                  (GgitOIdSet          *set);
+
+void              ggit_oid_set_reserve                   (GgitOIdSet          *set,
+                                                          guint                size);
+
+gboolean          ggit_oid_set_add                       (GgitOIdSet          *set,
+                                                          GgitOId             *oid);
+
+gsize             ggit_oid_set_add_raw                   (GgitOIdSet          *set,
+                                                          const guint8        *raw_ids,
+                                                          gsize                n_ids);
+
+gsize             ggit_oid_set_add_from_revision_walker  (GgitOIdSet          *set,
+                                                          GgitRevisionWalker  *walker,
+                                                          GError             **error);
+
+gboolean          ggit_oid_set_remove                    (GgitOIdSet          *set,
+                                                          GgitOId             *oid);
+
+gboolean          ggit_oid_set_contains                  (GgitOIdSet          *set,
+                                                          GgitOId             *oid);
+
+gboolean          ggit_oid_set_contains_raw              (GgitOIdSet          *set,
+                                                          const guint8        *raw_id);
+
+void              ggit_oid_set_remove_all                (GgitOIdSet          *set);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitOIdSet, ggit_oid_set_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_OID_SET_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,317 @@
+/*
+ * ggit-oid-table.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ggit-oid-table.h"
+
+#define MIN_CAPACITY 16
+
+/* Maximum load factor of MAX_LOAD_NUM / MAX_LOAD_DEN */
+#define MAX_LOAD_NUM 7
+#define MAX_LOAD_DEN 10
+
+static inline guint32
+oid_hash (const guint8 *id)
+{
+	guint32 h;
+
+	/* Object ids are uniformly distributed already */
+	memcpy (&h, id, sizeof (h));
+
+	return h != 0 ? h : 1;
+}
+
+void
+_ggit_oid_table_init (GgitOIdTable *table,
+                      gboolean      with_values)
+{
+	memset (table, 0, sizeof (GgitOIdTable));
+	table->with_values = with_values != FALSE;
+}
+
+void
+_ggit_oid_table_clear (GgitOIdTable   *table,
+                       GDestroyNotify  value_destroy)
+{
+	if (value_destroy != NULL && table->values != NULL)
+	{
+		gsize i;
+
+		for (i = 0; i < table->capacity; i++)
+		{
+			if (table->hashes[i] != 0 && table->values[i] != NULL)
+			{
+				value_destroy (table->values[i]);
+			}
+		}
+	}
+
+	g_free (table->hashes);
+	g_free (table->keys);
+	g_free (table->values);
+
+	_ggit_oid_table_init (table, table->with_values);
+}
+
+static void
+oid_table_resize (GgitOIdTable *table,
+                  gsize         capacity)
+{
+	guint32 *hashes;
+	guint8 (*keys)[GIT_OID_RAWSZ];
+	gpointer *values;
+	gsize mask;
+	gsize i;
+
+	hashes = table->hashes;
+	keys = table->keys;
+	values = table->values;
+
+	table->hashes = g_new0 (guint32, capacity);
+	table->keys = g_malloc (capacity * GIT_OID_RAWSZ);
+	table->values = table->with_values ? g_new0 (gpointer, capacity) : NULL;
+
+	mask = capacity - 1;
+
+	for (i = 0; i < table->capacity; i++)
+	{
+		gsize j;
+
+		if (hashes[i] == 0)
+		{
+			continue;
+		}
+
+		j = hashes[i] & mask;
+
+		while (table->hashes[j] != 0)
+		{
+			j = (j + 1) & mask;
+		}
+
+		table->hashes[j] = hashes[i];
+		memcpy (table->keys[j], keys[i], GIT_OID_RAWSZ);
+
+		if (values != NULL)
+		{
+			table->values[j] = values[i];
+		}
+	}
+
+	table->capacity = capacity;
+
+	g_free (hashes);
+	g_free (keys);
+	g_free (values);
+}
+
+/*
+ * _ggit_oid_table_reserve:
+ * @table: a #GgitOIdTable.
+ * @size: the number of ids.
+ *
+ * Makes sure @table can hold @size ids without growing.
+ */
+void
+_ggit_oid_table_reserve (GgitOIdTable *table,
+                         gsize         size)
+{
+	gsize capacity;
+
+	capacity = MAX (table->capacity, MIN_CAPACITY);
+
+	while (size * MAX_LOAD_DEN > capacity * MAX_LOAD_NUM)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity != table->capacity)
+	{
+		oid_table_resize (table, capacity);
+	}
+}
+
+/*
+ * _ggit_oid_table_lookup:
+ * @table: a #GgitOIdTable.
+ * @id: a raw object id.
+ *
+ * Returns: the slot of @id or -1 if @id is not in @table.
+ */
+gssize
+_ggit_oid_table_lookup (GgitOIdTable *table,
+                        const guint8 *id)
+{
+	guint32 h;
+	gsize mask;
+	gsize i;
+
+	if (table->size == 0)
+	{
+		return -1;
+	}
+
+	h = oid_hash (id);
+	mask = table->capacity - 1;
+
+	for (i = h & mask; table->hashes[i] != 0; i = (i + 1) & mask)
+	{
+		if (table->hashes[i] == h &&
+		    memcmp (table->keys[i], id, GIT_OID_RAWSZ) == 0)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * _ggit_oid_table_insert:
+ * @table: a #GgitOIdTable.
+ * @id: a raw object id.
+ * @added: (out) (allow-none): whether @id was not in @table yet.
+ *
+ * Adds @id to @table. The value of a newly added slot is %NULL.
+ *
+ * Returns: the slot of @id.
+ */
+gsize
+_ggit_oid_table_insert (GgitOIdTable *table,
+                        const guint8 *id,
+                        gboolean     *added)
+{
+	guint32 h;
+	gsize mask;
+	gsize i;
+
+	_ggit_oid_table_reserve (table, table->size + 1);
+
+	h = oid_hash (id);
+	mask = table->capacity - 1;
+
+	for (i = h & mask; table->hashes[i] != 0; i = (i + 1) & mask)
+	{
+		if (table->hashes[i] == h &&
+		    memcmp (table->keys[i], id, GIT_OID_RAWSZ) == 0)
+		{
+			if (added != NULL)
+			{
+				*added = FALSE;
+			}
+
+			return i;
+		}
+	}
+
+	table->hashes[i] = h;
+	memcpy (table->keys[i], id, GIT_OID_RAWSZ);
+
+	if (table->values != NULL)
+	{
+		table->values[i] = NULL;
+	}
+
+	table->size++;
+
+	if (added != NULL)
+	{
+		*added = TRUE;
+	}
+
+	return i;
+}
+
+/*
+ * _ggit_oid_table_remove:
+ * @table: a #GgitOIdTable.
+ * @id: a raw object id.
+ * @value: (out) (allow-none): return location for the value of @id.
+ *
+ * Returns: %TRUE if @id was in @table.
+ */
+gboolean
+_ggit_oid_table_remove (GgitOIdTable *table,
+                        const guint8 *id,
+                        gpointer     *value)
+{
+	gssize slot;
+	gsize mask;
+	gsize i;
+	gsize j;
+
+	slot = _ggit_oid_table_lookup (table, id);
+
+	if (slot < 0)
+	{
+		return FALSE;
+	}
+
+	if (value != NULL)
+	{
+		*value = table->values != NULL ? table->values[slot] : NULL;
+	}
+
+	mask = table->capacity - 1;
+	i = slot;
+	j = i;
+
+	/* Shift back the following entries of the probe sequence so that no
+	 * tombstones are needed.
+	 */
+	for (;;)
+	{
+		gsize k;
+		gboolean in_place;
+
+		j = (j + 1) & mask;
+
+		if (table->hashes[j] == 0)
+		{
+			break;
+		}
+
+		k = table->hashes[j] & mask;
+
+		/* whether the ideal slot k lies cyclically in (i, j] */
+		in_place = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+
+		if (!in_place)
+		{
+			table->hashes[i] = table->hashes[j];
+			memcpy (table->keys[i], table->keys[j], GIT_OID_RAWSZ);
+
+			if (table->values != NULL)
+			{
+				table->values[i] = table->values[j];
+			}
+
+			i = j;
+		}
+	}
+
+	table->hashes[i] = 0;
+	table->size--;
+
+	return TRUE;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,72 @@
+/*
+ * ggit-oid-table.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OID_TABLE_H__
+#define __GGIT_OID_TABLE_H__
+
+#include <glib.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+/* Open addressing (linear probing) hash table of raw object ids, shared by
+ * GgitOIdSet and GgitOIdMap. Slots are stored as separate arrays so that
+ * probing mostly touches the hashes.
+ */
+typedef struct
+{
+	/* 0 marks an empty slot */
+	guint32 *hashes;
+	guint8 (*keys)[GIT_OID_RAWSZ];
+
+	/* NULL unless created with values */
+	gpointer *values;
+
+	gsize size;
+	gsize capacity;
+
+	guint with_values : 1;
+} GgitOIdTable;
+
+void     _ggit_oid_table_init    (GgitOIdTable   *table,
+                                  gboolean        with_values);
+
+void     _ggit_oid_table_clear   (GgitOIdTable   *table,
+                                  GDestroyNotify  value_destroy);
+
+void     _ggit_oid_table_reserve (GgitOIdTable   *table,
+                                  gsize           size);
+
+gssize   _ggit_oid_table_lookup  (GgitOIdTable   *table,
+                                  const guint8   *id);
+
+gsize    _ggit_oid_table_insert  (GgitOIdTable   *table,
+                                  const guint8   *id,
+                                  gboolean       *added);
+
+gboolean _ggit_oid_table_remove  (GgitOIdTable   *table,
+                                  const guint8   *id,
+                                  gpointer       *value);
+
+G_END_DECLS
+
+#endif /* __GGIT_OID_TABLE_H__ */
+
+/* ex:set ts=8 noet: */
@@ -18,6 +18,7 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <git2.h>
 
 #include "ggit-oid.h"
@@ -173,21 +174,12 @@ ggit_oid_to_string (GgitOId *oid)
 guint
 ggit_oid_hash (GgitOId const *oid)
 {
-	/* This is copied from glib
-	 * This function implements the widely used "djb" hash apparently posted
-	 * by Daniel Bernstein to comp.lang.c some time ago.  The 32 bit
-	 * unsigned hash value starts at 5381 and for each byte 'c' in the
-	 * string, is updated: <literal>hash = hash * 33 + c</literal>.  This
-	 * function uses the signed value of each byte.
-	 */
-
-	guint32 h = 5381;
-	guint i;
+	guint h;
 
-	for (i = 0; i < GIT_OID_RAWSZ; ++i)
-	{
-		h = (h << 5) + h + oid->oid.id[i];
-	}
+	/* An object id is a SHA-1 and thus already uniformly distributed,
+	 * its first bytes make a perfectly good hash.
+	 */
+	memcpy (&h, oid->oid.id, sizeof (h));
 
 	return h;
 }
@@ -19,11 +19,13 @@
  */
 
 #include "ggit-patch.h"
+#include "ggit-async.h"
 #include "ggit-diff.h"
 #include "ggit-diff-delta.h"
 #include "ggit-diff-hunk.h"
 #include "ggit-error.h"
 #include "ggit-diff-options.h"
+#include "ggit-stream-writer.h"
 
 struct _GgitPatch
 {
@@ -204,37 +206,37 @@ ggit_patch_to_string (GgitPatch  *patch,
 	return result;
 }
 
-typedef struct
-{
-	GOutputStream  *stream;
-	GError        **error;
-} PatchToStream;
-
-static int
-patch_to_stream (const git_diff_delta *delta,
-                 const git_diff_hunk  *hunk,
-                 const git_diff_line  *line,
-                 void                 *payload)
+static gboolean
+patch_print (GgitPatch      *patch,
+             GOutputStream  *stream,
+             gsize           buffer_size,
+             gboolean        pipelined,
+             GCancellable   *cancellable,
+             GError        **error)
 {
-	PatchToStream *info = payload;
-	gboolean ret;
-	gsize written;
-
-	ret = g_output_stream_write_all (info->stream,
-	                                 line->content,
-	                                 line->content_len,
-	                                 &written,
-	                                 NULL,
-	                                 info->error);
-
-	if (!ret)
+	GgitStreamWriter *writer;
+	GError *write_error = NULL;
+	gint ret;
+
+	writer = _ggit_stream_writer_new (stream, buffer_size, pipelined, cancellable);
+
+	ret = git_patch_print (patch->patch,
+	                       _ggit_stream_writer_print_line,
+	                       writer);
+
+	if (!_ggit_stream_writer_close (writer, &write_error))
 	{
-		return -1;
+		g_propagate_error (error, write_error);
+		return FALSE;
 	}
-	else
+
+	if (ret != GIT_OK)
 	{
-		return written;
+		_ggit_error_set (error, ret);
+		return FALSE;
 	}
+
+	return TRUE;
 }
 
 /**
@@ -243,7 +245,9 @@ patch_to_stream (const git_diff_delta *delta,
  * @stream: a #GOutputStream.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Write the contents of a patch to the provided stream.
+ * Write the contents of a patch to the provided stream. The patch is
+ * written in chunks of 64 KiB, see ggit_patch_to_stream_full() to use
+ * another size.
  *
  * Returns: %TRUE if the patch was written successfully, %FALSE otherwise.
  *
@@ -253,31 +257,150 @@ ggit_patch_to_stream (GgitPatch      *patch,
                       GOutputStream  *stream,
                       GError        **error)
 {
-	PatchToStream info;
-	gint ret;
+	return ggit_patch_to_stream_full (patch, stream, 0, NULL, error);
+}
 
+/**
+ * ggit_patch_to_stream_full:
+ * @patch: a #GgitPatch.
+ * @stream: a #GOutputStream.
+ * @buffer_size: the size of the chunks written to @stream, or 0 for the
+ *               default size.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write the contents of a patch to the provided stream. The lines of the
+ * patch are collected in a buffer of @buffer_size bytes which is written
+ * to @stream whenever it is full, instead of writing each line on its own.
+ *
+ * Returns: %TRUE if the patch was written successfully, %FALSE otherwise.
+ */
+gboolean
+ggit_patch_to_stream_full (GgitPatch      *patch,
+                           GOutputStream  *stream,
+                           gsize           buffer_size,
+                           GCancellable   *cancellable,
+                           GError        **error)
+{
 	g_return_val_if_fail (patch != NULL, FALSE);
 	g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	info.stream = stream;
-	info.error = error;
+	return patch_print (patch, stream, buffer_size, FALSE, cancellable, error);
+}
 
-	ret = git_patch_print (patch->patch,
-	                       patch_to_stream,
-	                       &info);
+typedef struct
+{
+	GgitPatch *patch;
+	GOutputStream *stream;
+	gsize buffer_size;
+} PatchToStreamData;
 
-	if (ret != GIT_OK)
-	{
-		if (error != NULL && *error == NULL)
-		{
-			_ggit_error_set (error, ret);
-		}
+static void
+patch_to_stream_data_free (PatchToStreamData *data)
+{
+	ggit_patch_unref (data->patch);
+	g_object_unref (data->stream);
 
-		return FALSE;
+	g_slice_free (PatchToStreamData, data);
+}
+
+static void
+patch_to_stream_thread (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+	PatchToStreamData *data = task_data;
+	GError *error = NULL;
+
+	if (!patch_print (data->patch,
+	                  data->stream,
+	                  data->buffer_size,
+	                  TRUE,
+	                  cancellable,
+	                  &error))
+	{
+		g_task_return_error (task, error);
 	}
+	else
+	{
+		g_task_return_boolean (task, TRUE);
+	}
+}
 
-	return TRUE;
+/**
+ * ggit_patch_to_stream_async:
+ * @patch: a #GgitPatch.
+ * @stream: a #GOutputStream.
+ * @buffer_size: the size of the chunks written to @stream, or 0 for the
+ *               default size.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            patch has been written.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously writes the contents of a patch to @stream. See
+ * ggit_patch_to_stream_full() for the synchronous version.
+ *
+ * The patch is generated on a worker thread while the previous chunk is
+ * being written to @stream by another one, at most two chunks are held in
+ * memory at any time. @stream must not be used until the operation is
+ * finished.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_patch_to_stream_finish() to get the result of the operation.
+ */
+void
+ggit_patch_to_stream_async (GgitPatch           *patch,
+                            GOutputStream       *stream,
+                            gsize                buffer_size,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+	GTask *task;
+	PatchToStreamData *data;
+
+	g_return_if_fail (patch != NULL);
+	g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_patch_to_stream_async);
+
+	data = g_slice_new (PatchToStreamData);
+	data->patch = ggit_patch_ref (patch);
+	data->stream = g_object_ref (stream);
+	data->buffer_size = buffer_size;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)patch_to_stream_data_free);
+
+	_ggit_async_run (task, patch_to_stream_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_patch_to_stream_finish:
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_patch_to_stream_async().
+ *
+ * Returns: %TRUE if the patch was written successfully, %FALSE otherwise.
+ */
+gboolean
+ggit_patch_to_stream_finish (GAsyncResult  *result,
+                             GError       **error)
+{
+	g_return_val_if_fail (G_IS_TASK (result), FALSE);
+	g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == ggit_patch_to_stream_async, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 /**
@@ -59,6 +59,22 @@ gboolean         ggit_patch_to_stream       (GgitPatch      *patch,
                                              GOutputStream  *stream,
                                              GError        **error);
 
+gboolean         ggit_patch_to_stream_full  (GgitPatch      *patch,
+                                             GOutputStream  *stream,
+                                             gsize           buffer_size,
+                                             GCancellable   *cancellable,
+                                             GError        **error);
+
+void             ggit_patch_to_stream_async (GgitPatch           *patch,
+                                             GOutputStream       *stream,
+                                             gsize                buffer_size,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             user_data);
+
+gboolean         ggit_patch_to_stream_finish (GAsyncResult  *result,
+                                              GError       **error);
+
 gboolean         ggit_patch_get_line_stats  (GgitPatch      *patch,
                                              gsize          *total_context,
                                              gsize          *total_additions,
@@ -0,0 +1,1117 @@
+/*
+ * ggit-reachability-index.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <string.h>
+
+#include "ggit-reachability-index.h"
+#include "ggit-error.h"
+#include "ggit-oid.h"
+
+/* The index lives next to the commit-graph and stores, for selected
+ * commits, the set of commits they can reach as a compressed bitmap. Bits
+ * are the commits of the graph ordered by generation, so that the history
+ * below a commit is mostly made of long runs.
+ *
+ * Layout, all numbers big endian:
+ *   "GRBI", version, checksum of the commit-graph, number of commits,
+ *   number of bitmaps
+ *   the bit of each commit, by commit-graph position (4 bytes each)
+ *   position, number of words and offset of each bitmap, by position
+ *   the encoded bitmaps
+ */
+#define INDEX_SIGNATURE 0x47524249 /* "GRBI" */
+#define INDEX_VERSION 1
+#define HEADER_SIZE (8 + GIT_OID_RAWSZ + 8)
+#define ENTRY_SIZE 16
+#define INDEX_FILENAME "ggit-reachability"
+
+/* Every that many commits along the first parent chain of each ref gets
+ * a bitmap, which bounds the walk from commits without one */
+#define SELECT_EVERY 128
+
+#define NO_BITMAP G_MAXUINT32
+
+#define FLAG_VISITED (1 << 0)
+#define FLAG_SELECTED (1 << 1)
+
+/* Bitmaps are encoded as in EWAH: a run-length word holds the fill bit
+ * (bit 0), the number of fill words (bits 1-32) and the number of literal
+ * words following it (bits 33-63). */
+#define RLW_MAX_FILL G_GUINT64_CONSTANT (0xffffffff)
+#define RLW_MAX_LITERALS G_GUINT64_CONSTANT (0x7fffffff)
+
+struct _GgitReachabilityIndex
+{
+	gint ref_count;
+
+	GMappedFile *file;
+	GgitCommitGraph *graph;
+
+	guint32 n_commits;
+	guint32 n_bitmaps;
+
+	const guint8 *bits;
+	const guint8 *entries;
+	const guint8 *data;
+	gsize data_size;
+
+	/* Identity of the file, to notice when it is replaced */
+	guint64 dev;
+	guint64 ino;
+	gint64 mtime;
+	gint64 size;
+};
+
+typedef struct
+{
+	guint32 position;
+	guint32 n_words;
+	guint64 offset;
+} BitmapEntry;
+
+typedef const guint8 *(*BitmapLookup) (gpointer  data,
+                                       guint32   position,
+                                       guint32  *n_words);
+
+/* Computes the commits reachable from a commit, walking the commit-graph
+ * until commits which have a bitmap */
+typedef struct
+{
+	GgitCommitGraph *graph;
+	const guint8 *bits;
+	guint32 n_commits;
+	gsize n_words;
+
+	BitmapLookup lookup;
+	gpointer lookup_data;
+
+	GArray *stack;
+	GArray *parents;
+} Reach;
+
+typedef struct
+{
+	guint32 generation;
+	guint32 position;
+} RankedCommit;
+
+typedef struct
+{
+	guint32 *entry_of_position;
+	GArray *entries;
+	GByteArray *data;
+} IndexBuilder;
+
+static inline guint32
+read_be32 (const guint8 *data)
+{
+	guint32 value;
+
+	memcpy (&value, data, sizeof (value));
+
+	return GUINT32_FROM_BE (value);
+}
+
+static inline guint64
+read_be64 (const guint8 *data)
+{
+	guint64 value;
+
+	memcpy (&value, data, sizeof (value));
+
+	return GUINT64_FROM_BE (value);
+}
+
+static void
+append_be32 (GByteArray *array,
+             guint32     value)
+{
+	value = GUINT32_TO_BE (value);
+	g_byte_array_append (array, (const guint8 *)&value, sizeof (value));
+}
+
+static void
+append_be64 (GByteArray *array,
+             guint64     value)
+{
+	value = GUINT64_TO_BE (value);
+	g_byte_array_append (array, (const guint8 *)&value, sizeof (value));
+}
+
+static inline guint
+popcount64 (guint64 word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll (word);
+#else
+	guint count = 0;
+
+	while (word != 0)
+	{
+		word &= word - 1;
+		count++;
+	}
+
+	return count;
+#endif
+}
+
+static gint64
+stat_mtime (const GStatBuf *st)
+{
+	gint64 mtime = (gint64)st->st_mtime * G_GINT64_CONSTANT (1000000000);
+
+#ifdef __linux__
+	mtime += st->st_mtim.tv_nsec;
+#endif
+
+	return mtime;
+}
+
+/* ORs an encoded bitmap into @words, returns FALSE if it is corrupt */
+static gboolean
+bitmap_or (guint64      *words,
+           gsize         n_words,
+           const guint8 *encoded,
+           guint32       n_encoded)
+{
+	gsize position = 0;
+	guint32 i = 0;
+
+	while (i < n_encoded)
+	{
+		guint64 rlw = read_be64 (encoded + (gsize)i * 8);
+		guint64 n_fill = (rlw >> 1) & RLW_MAX_FILL;
+		guint64 n_literals = rlw >> 33;
+
+		i++;
+
+		if (n_fill > n_words - position ||
+		    n_literals > n_words - position - n_fill ||
+		    n_literals > n_encoded - i)
+		{
+			return FALSE;
+		}
+
+		if ((rlw & 1) != 0)
+		{
+			memset (words + position, 0xff, n_fill * sizeof (guint64));
+		}
+
+		position += n_fill;
+
+		for (; n_literals > 0; n_literals--)
+		{
+			words[position++] |= read_be64 (encoded + (gsize)i++ * 8);
+		}
+	}
+
+	return TRUE;
+}
+
+/* Appends the encoding of @words to @out, returns the number of encoded
+ * words */
+static guint32
+bitmap_encode (const guint64 *words,
+               gsize          n_words,
+               GByteArray    *out)
+{
+	guint32 n_encoded = 0;
+	gsize i = 0;
+
+	while (i < n_words)
+	{
+		guint64 fill = 0;
+		guint64 n_fill = 0;
+		guint64 n_literals = 0;
+		gsize end;
+
+		if (words[i] == 0 || words[i] == G_MAXUINT64)
+		{
+			fill = words[i];
+
+			while (i < n_words && words[i] == fill && n_fill < RLW_MAX_FILL)
+			{
+				n_fill++;
+				i++;
+			}
+		}
+
+		end = i;
+
+		while (end < n_words && words[end] != 0 && words[end] != G_MAXUINT64 &&
+		       n_literals < RLW_MAX_LITERALS)
+		{
+			n_literals++;
+			end++;
+		}
+
+		append_be64 (out, (n_literals << 33) | (n_fill << 1) | (fill != 0 ? 1 : 0));
+
+		for (; i < end; i++)
+		{
+			append_be64 (out, words[i]);
+		}
+
+		n_encoded += 1 + n_literals;
+	}
+
+	return n_encoded;
+}
+
+static void
+reach_init (Reach           *reach,
+            GgitCommitGraph *graph,
+            const guint8    *bits,
+            BitmapLookup     lookup,
+            gpointer         lookup_data)
+{
+	reach->graph = graph;
+	reach->bits = bits;
+	reach->n_commits = ggit_commit_graph_get_size (graph);
+	reach->n_words = (reach->n_commits + 63) / 64;
+	reach->lookup = lookup;
+	reach->lookup_data = lookup_data;
+	reach->stack = g_array_new (FALSE, FALSE, sizeof (guint32));
+	reach->parents = g_array_new (FALSE, FALSE, sizeof (guint32));
+}
+
+static void
+reach_clear (Reach *reach)
+{
+	g_array_free (reach->stack, TRUE);
+	g_array_free (reach->parents, TRUE);
+}
+
+static inline guint32
+reach_bit (Reach   *reach,
+           guint32  position)
+{
+	return read_be32 (reach->bits + (gsize)position * 4);
+}
+
+/* Sets in @words the commits reachable from @position, itself included.
+ * Returns FALSE if the graph or the index is corrupt. */
+static gboolean
+reach_compute (Reach   *reach,
+               guint32  position,
+               guint64 *words)
+{
+	memset (words, 0, reach->n_words * sizeof (guint64));
+
+	g_array_set_size (reach->stack, 0);
+	g_array_append_val (reach->stack, position);
+
+	while (reach->stack->len > 0)
+	{
+		const guint8 *bitmap;
+		guint32 n_encoded;
+		guint32 bit;
+		guint64 mask;
+
+		position = g_array_index (reach->stack, guint32, reach->stack->len - 1);
+		g_array_set_size (reach->stack, reach->stack->len - 1);
+
+		bit = reach_bit (reach, position);
+
+		if (bit >= reach->n_commits)
+		{
+			return FALSE;
+		}
+
+		mask = G_GUINT64_CONSTANT (1) << (bit % 64);
+
+		if ((words[bit / 64] & mask) != 0)
+		{
+			continue;
+		}
+
+		bitmap = reach->lookup (reach->lookup_data, position, &n_encoded);
+
+		if (bitmap != NULL)
+		{
+			if (!bitmap_or (words, reach->n_words, bitmap, n_encoded))
+			{
+				return FALSE;
+			}
+
+			continue;
+		}
+
+		words[bit / 64] |= mask;
+
+		if (!_ggit_commit_graph_read_parents (reach->graph, position, reach->parents))
+		{
+			return FALSE;
+		}
+
+		g_array_append_vals (reach->stack, reach->parents->data, reach->parents->len);
+	}
+
+	return TRUE;
+}
+
+/**
+ * _ggit_reachability_index_get_path:
+ * @repository: a #git_repository.
+ *
+ * Gets the path of the reachability index of @repository, which may not
+ * exist.
+ *
+ * Returns: (transfer full): the path of the file.
+ */
+gchar *
+_ggit_reachability_index_get_path (git_repository *repository)
+{
+	return g_build_filename (git_repository_path (repository),
+	                         "objects",
+	                         "info",
+	                         INDEX_FILENAME,
+	                         NULL);
+}
+
+static gboolean
+parse_index (GgitReachabilityIndex *index)
+{
+	const guint8 *contents;
+	gsize size;
+	guint64 header_size;
+
+	contents = (const guint8 *)g_mapped_file_get_contents (index->file);
+	size = g_mapped_file_get_length (index->file);
+
+	if (contents == NULL || size < HEADER_SIZE)
+	{
+		return FALSE;
+	}
+
+	if (read_be32 (contents) != INDEX_SIGNATURE ||
+	    read_be32 (contents + 4) != INDEX_VERSION)
+	{
+		return FALSE;
+	}
+
+	/* The index is only valid for the commit-graph it was built from */
+	if (memcmp (contents + 8, _ggit_commit_graph_get_checksum (index->graph), GIT_OID_RAWSZ) != 0)
+	{
+		return FALSE;
+	}
+
+	index->n_commits = read_be32 (contents + 8 + GIT_OID_RAWSZ);
+	index->n_bitmaps = read_be32 (contents + 12 + GIT_OID_RAWSZ);
+
+	if (index->n_commits != ggit_commit_graph_get_size (index->graph))
+	{
+		return FALSE;
+	}
+
+	header_size = HEADER_SIZE + (guint64)index->n_commits * 4 +
+	              (guint64)index->n_bitmaps * ENTRY_SIZE;
+
+	if (header_size > size)
+	{
+		return FALSE;
+	}
+
+	index->bits = contents + HEADER_SIZE;
+	index->entries = index->bits + (gsize)index->n_commits * 4;
+	index->data = contents + header_size;
+	index->data_size = size - header_size;
+
+	return TRUE;
+}
+
+/**
+ * _ggit_reachability_index_open:
+ * @path: the path of a reachability index.
+ * @graph: the current commit-graph of the repository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Maps the reachability index at @path.
+ *
+ * Returns: (transfer full) (nullable): a #GgitReachabilityIndex or %NULL
+ * if the file does not exist, is invalid or was built from another
+ * commit-graph than @graph.
+ */
+GgitReachabilityIndex *
+_ggit_reachability_index_open (const gchar      *path,
+                               GgitCommitGraph  *graph,
+                               GError          **error)
+{
+	GgitReachabilityIndex *index;
+	GMappedFile *file;
+	GStatBuf st;
+
+	if (g_stat (path, &st) != 0)
+	{
+		gint errsv = errno;
+
+		g_set_error (error,
+		             G_IO_ERROR,
+		             g_io_error_from_errno (errsv),
+		             "Could not open %s: %s",
+		             path,
+		             g_strerror (errsv));
+
+		return NULL;
+	}
+
+	file = g_mapped_file_new (path, FALSE, error);
+
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	index = g_slice_new0 (GgitReachabilityIndex);
+	index->ref_count = 1;
+	index->file = file;
+	index->graph = ggit_commit_graph_ref (graph);
+
+	index->dev = st.st_dev;
+	index->ino = st.st_ino;
+	index->mtime = stat_mtime (&st);
+	index->size = st.st_size;
+
+	if (!parse_index (index))
+	{
+		g_set_error (error,
+		             G_IO_ERROR,
+		             G_IO_ERROR_INVALID_DATA,
+		             "Invalid or out of date reachability index %s",
+		             path);
+
+		_ggit_reachability_index_unref (index);
+		return NULL;
+	}
+
+	return index;
+}
+
+GgitReachabilityIndex *
+_ggit_reachability_index_ref (GgitReachabilityIndex *index)
+{
+	g_atomic_int_inc (&index->ref_count);
+
+	return index;
+}
+
+void
+_ggit_reachability_index_unref (GgitReachabilityIndex *index)
+{
+	if (g_atomic_int_dec_and_test (&index->ref_count))
+	{
+		g_mapped_file_unref (index->file);
+		ggit_commit_graph_unref (index->graph);
+
+		g_slice_free (GgitReachabilityIndex, index);
+	}
+}
+
+/**
+ * _ggit_reachability_index_is_current:
+ * @index: a #GgitReachabilityIndex.
+ * @st: the current status of the file of @index.
+ * @graph: the current commit-graph of the repository.
+ *
+ * Checks whether @index is still the content of its file and was loaded
+ * for @graph.
+ *
+ * Returns: %TRUE if @index can be used.
+ */
+gboolean
+_ggit_reachability_index_is_current (GgitReachabilityIndex *index,
+                                     const GStatBuf        *st,
+                                     GgitCommitGraph       *graph)
+{
+	return index->graph == graph &&
+	       index->dev == (guint64)st->st_dev &&
+	       index->ino == (guint64)st->st_ino &&
+	       index->mtime == stat_mtime (st) &&
+	       index->size == (gint64)st->st_size;
+}
+
+static const guint8 *
+index_lookup (gpointer  data,
+              guint32   position,
+              guint32  *n_words)
+{
+	GgitReachabilityIndex *index = data;
+	guint32 lo = 0;
+	guint32 hi = index->n_bitmaps;
+
+	while (lo < hi)
+	{
+		guint32 mid = lo + (hi - lo) / 2;
+		const guint8 *entry = index->entries + (gsize)mid * ENTRY_SIZE;
+		guint32 found = read_be32 (entry);
+
+		if (found == position)
+		{
+			guint64 offset = read_be64 (entry + 8);
+
+			*n_words = read_be32 (entry + 4);
+
+			/* A bitmap out of the file is ignored, the commits are
+			 * walked instead */
+			if (offset > index->data_size ||
+			    *n_words > (index->data_size - offset) / 8)
+			{
+				return NULL;
+			}
+
+			return index->data + offset;
+		}
+
+		if (found < position)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return NULL;
+}
+
+static const guint8 *
+builder_lookup (gpointer  data,
+                guint32   position,
+                guint32  *n_words)
+{
+	IndexBuilder *builder = data;
+	BitmapEntry *entry;
+
+	if (builder->entry_of_position[position] == NO_BITMAP)
+	{
+		return NULL;
+	}
+
+	entry = &g_array_index (builder->entries, BitmapEntry, builder->entry_of_position[position]);
+	*n_words = entry->n_words;
+
+	return builder->data->data + entry->offset;
+}
+
+static gboolean
+lookup_commit (GgitCommitGraph *graph,
+               GgitOId         *oid,
+               guint32         *position)
+{
+	return _ggit_commit_graph_lookup (graph, _ggit_oid_get_oid (oid)->id, position);
+}
+
+/**
+ * _ggit_reachability_index_descendant_of_many:
+ * @index: a #GgitReachabilityIndex.
+ * @commits: (array length=n_commits): the commits.
+ * @n_commits: the number of commits.
+ * @ancestor: the ancestor.
+ * @results: (array length=n_commits): return location for whether each
+ *           commit is a descendant of @ancestor.
+ * @answered: (array length=n_commits): return location for whether each
+ *            result was set.
+ *
+ * Checks which of @commits descend from @ancestor. Results are only set
+ * for the commits of the commit-graph of @index, @answered is left
+ * untouched for the others.
+ */
+void
+_ggit_reachability_index_descendant_of_many (GgitReachabilityIndex  *index,
+                                             GgitOId               **commits,
+                                             gsize                   n_commits,
+                                             GgitOId                *ancestor,
+                                             gboolean               *results,
+                                             gboolean               *answered)
+{
+	Reach reach;
+	guint64 *words;
+	guint32 target;
+	guint32 bit;
+	gsize i;
+
+	if (!lookup_commit (index->graph, ancestor, &target))
+	{
+		return;
+	}
+
+	reach_init (&reach, index->graph, index->bits, index_lookup, index);
+
+	bit = reach_bit (&reach, target);
+	words = g_new (guint64, reach.n_words);
+
+	/* A corrupt index answers nothing */
+	for (i = 0; i < n_commits && bit < reach.n_commits; i++)
+	{
+		guint32 position;
+
+		if (!lookup_commit (index->graph, commits[i], &position))
+		{
+			continue;
+		}
+
+		/* A commit is not a descendant of itself */
+		if (position == target)
+		{
+			results[i] = FALSE;
+			answered[i] = TRUE;
+		}
+		else if (reach_compute (&reach, position, words))
+		{
+			results[i] = (words[bit / 64] >> (bit % 64)) & 1;
+			answered[i] = TRUE;
+		}
+	}
+
+	g_free (words);
+	reach_clear (&reach);
+}
+
+/**
+ * _ggit_reachability_index_ahead_behind_many:
+ * @index: a #GgitReachabilityIndex.
+ * @locals: (array length=n_locals): the local commits.
+ * @n_locals: the number of local commits.
+ * @upstream: the upstream commit.
+ * @ahead: (array length=n_locals): return location for the number of
+ *         commits only reachable from each local commit.
+ * @behind: (array length=n_locals): return location for the number of
+ *          commits only reachable from @upstream.
+ * @answered: (array length=n_locals): return location for whether each
+ *            result was set.
+ *
+ * Counts the unique commits between each of @locals and @upstream with
+ * bitmap operations. Results are only set for the commits of the
+ * commit-graph of @index, @answered is left untouched for the others.
+ */
+void
+_ggit_reachability_index_ahead_behind_many (GgitReachabilityIndex  *index,
+                                            GgitOId               **locals,
+                                            gsize                   n_locals,
+                                            GgitOId                *upstream,
+                                            gsize                  *ahead,
+                                            gsize                  *behind,
+                                            gboolean               *answered)
+{
+	Reach reach;
+	guint64 *upstream_words;
+	guint64 *words;
+	guint32 position;
+	gsize i;
+
+	if (!lookup_commit (index->graph, upstream, &position))
+	{
+		return;
+	}
+
+	reach_init (&reach, index->graph, index->bits, index_lookup, index);
+
+	upstream_words = g_new (guint64, reach.n_words);
+	words = g_new (guint64, reach.n_words);
+
+	if (reach_compute (&reach, position, upstream_words))
+	{
+		for (i = 0; i < n_locals; i++)
+		{
+			gsize only_local = 0;
+			gsize only_upstream = 0;
+			gsize w;
+
+			if (!lookup_commit (index->graph, locals[i], &position) ||
+			    !reach_compute (&reach, position, words))
+			{
+				continue;
+			}
+
+			for (w = 0; w < reach.n_words; w++)
+			{
+				only_local += popcount64 (words[w] & ~upstream_words[w]);
+				only_upstream += popcount64 (upstream_words[w] & ~words[w]);
+			}
+
+			ahead[i] = only_local;
+			behind[i] = only_upstream;
+			answered[i] = TRUE;
+		}
+	}
+
+	g_free (words);
+	g_free (upstream_words);
+	reach_clear (&reach);
+}
+
+static void
+add_tip (GgitCommitGraph *graph,
+         git_reference   *ref,
+         GArray          *tips)
+{
+	git_object *obj;
+	guint32 position;
+
+	/* Refs to other objects, or dangling symbolic refs, are skipped */
+	if (git_reference_peel (&obj, ref, GIT_OBJ_COMMIT) != GIT_OK)
+	{
+		return;
+	}
+
+	if (_ggit_commit_graph_lookup (graph, git_object_id (obj)->id, &position))
+	{
+		g_array_append_val (tips, position);
+	}
+
+	git_object_free (obj);
+}
+
+static gint
+collect_tips (git_repository  *repository,
+              GgitCommitGraph *graph,
+              GArray          *tips)
+{
+	git_reference_iterator *iter;
+	git_reference *ref;
+	gint ret;
+
+	ret = git_reference_iterator_new (&iter, repository);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	while ((ret = git_reference_next (&ref, iter)) == GIT_OK)
+	{
+		add_tip (graph, ref, tips);
+		git_reference_free (ref);
+	}
+
+	git_reference_iterator_free (iter);
+
+	if (ret != GIT_ITEROVER)
+	{
+		return ret;
+	}
+
+	if (git_reference_lookup (&ref, repository, "HEAD") == GIT_OK)
+	{
+		add_tip (graph, ref, tips);
+		git_reference_free (ref);
+	}
+
+	return GIT_OK;
+}
+
+/* Selects the tips and every SELECT_EVERY commits of their first parent
+ * chain, stopping where the chain joins one already walked */
+static gboolean
+select_commits (GgitCommitGraph *graph,
+                GArray          *tips,
+                GArray          *selected)
+{
+	GArray *parents;
+	guint8 *flags;
+	gboolean ok = TRUE;
+	guint i;
+
+	flags = g_new0 (guint8, ggit_commit_graph_get_size (graph));
+	parents = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	for (i = 0; i < tips->len && ok; i++)
+	{
+		guint32 position = g_array_index (tips, guint32, i);
+		guint steps = 0;
+
+		while (TRUE)
+		{
+			if (steps % SELECT_EVERY == 0 &&
+			    (flags[position] & FLAG_SELECTED) == 0)
+			{
+				flags[position] |= FLAG_SELECTED;
+				g_array_append_val (selected, position);
+			}
+
+			if ((flags[position] & FLAG_VISITED) != 0)
+			{
+				break;
+			}
+
+			flags[position] |= FLAG_VISITED;
+			steps++;
+
+			if (!_ggit_commit_graph_read_parents (graph, position, parents))
+			{
+				ok = FALSE;
+				break;
+			}
+
+			if (parents->len == 0)
+			{
+				break;
+			}
+
+			position = g_array_index (parents, guint32, 0);
+		}
+	}
+
+	g_array_free (parents, TRUE);
+	g_free (flags);
+
+	return ok;
+}
+
+static gint
+compare_ranked (gconstpointer a,
+                gconstpointer b,
+                gpointer      user_data)
+{
+	const RankedCommit *ra = a;
+	const RankedCommit *rb = b;
+
+	if (ra->generation != rb->generation)
+	{
+		return ra->generation < rb->generation ? -1 : 1;
+	}
+
+	return ra->position < rb->position ? -1 : (ra->position > rb->position ? 1 : 0);
+}
+
+static gint
+compare_bits (gconstpointer a,
+              gconstpointer b,
+              gpointer      user_data)
+{
+	const guint32 *bit_of_position = user_data;
+	guint32 ba = bit_of_position[*(const guint32 *)a];
+	guint32 bb = bit_of_position[*(const guint32 *)b];
+
+	return ba < bb ? -1 : (ba > bb ? 1 : 0);
+}
+
+static gint
+compare_entries (gconstpointer a,
+                 gconstpointer b)
+{
+	const BitmapEntry *ea = a;
+	const BitmapEntry *eb = b;
+
+	return ea->position < eb->position ? -1 : (ea->position > eb->position ? 1 : 0);
+}
+
+static gboolean
+build_bitmaps (GgitCommitGraph  *graph,
+               const guint8     *bits,
+               GArray           *selected,
+               IndexBuilder     *builder,
+               GCancellable     *cancellable,
+               GError          **error)
+{
+	Reach reach;
+	guint64 *words;
+	gboolean ok = TRUE;
+	guint i;
+
+	reach_init (&reach, graph, bits, builder_lookup, builder);
+	words = g_new (guint64, reach.n_words);
+
+	/* By increasing generation, so that the bitmaps of the ancestors of
+	 * a commit are known when computing its own */
+	for (i = 0; i < selected->len; i++)
+	{
+		BitmapEntry entry;
+
+		if (i % 64 == 0 && g_cancellable_set_error_if_cancelled (cancellable, error))
+		{
+			ok = FALSE;
+			break;
+		}
+
+		entry.position = g_array_index (selected, guint32, i);
+
+		if (!reach_compute (&reach, entry.position, words))
+		{
+			g_set_error_literal (error,
+			                     G_IO_ERROR,
+			                     G_IO_ERROR_INVALID_DATA,
+			                     "Corrupt commit-graph");
+
+			ok = FALSE;
+			break;
+		}
+
+		entry.offset = builder->data->len;
+		entry.n_words = bitmap_encode (words, reach.n_words, builder->data);
+
+		builder->entry_of_position[entry.position] = builder->entries->len;
+		g_array_append_val (builder->entries, entry);
+	}
+
+	g_free (words);
+	reach_clear (&reach);
+
+	return ok;
+}
+
+/**
+ * _ggit_reachability_index_write:
+ * @repository: a #git_repository.
+ * @graph: the current commit-graph of @repository.
+ * @cancellable: (nullable): a #GCancellable, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Builds the bitmaps of the refs of @repository and of commits along their
+ * history, and writes them next to the commit-graph.
+ *
+ * Returns: %TRUE if the index was written, %FALSE if there was an error.
+ */
+gboolean
+_ggit_reachability_index_write (git_repository   *repository,
+                                GgitCommitGraph  *graph,
+                                GCancellable     *cancellable,
+                                GError          **error)
+{
+	IndexBuilder builder;
+	RankedCommit *ranked;
+	guint32 *bit_of_position;
+	GArray *tips;
+	GArray *selected;
+	GByteArray *out;
+	gchar *path;
+	guint32 n_commits;
+	gboolean success = FALSE;
+	guint32 i;
+	gint ret;
+
+	n_commits = ggit_commit_graph_get_size (graph);
+
+	tips = g_array_new (FALSE, FALSE, sizeof (guint32));
+	ret = collect_tips (repository, graph, tips);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		g_array_free (tips, TRUE);
+
+		return FALSE;
+	}
+
+	/* Bits go by increasing generation */
+	ranked = g_new (RankedCommit, n_commits);
+
+	for (i = 0; i < n_commits; i++)
+	{
+		ranked[i].generation = ggit_commit_graph_get_generation (graph, i);
+		ranked[i].position = i;
+	}
+
+	g_qsort_with_data (ranked, n_commits, sizeof (RankedCommit), compare_ranked, NULL);
+
+	bit_of_position = g_new (guint32, n_commits);
+
+	for (i = 0; i < n_commits; i++)
+	{
+		bit_of_position[ranked[i].position] = i;
+	}
+
+	g_free (ranked);
+
+	out = g_byte_array_sized_new (HEADER_SIZE + n_commits * 4);
+
+	append_be32 (out, INDEX_SIGNATURE);
+	append_be32 (out, INDEX_VERSION);
+	g_byte_array_append (out, _ggit_commit_graph_get_checksum (graph), GIT_OID_RAWSZ);
+	append_be32 (out, n_commits);
+	append_be32 (out, 0);
+
+	for (i = 0; i < n_commits; i++)
+	{
+		append_be32 (out, bit_of_position[i]);
+	}
+
+	builder.entry_of_position = g_new (guint32, n_commits);
+	builder.entries = g_array_new (FALSE, FALSE, sizeof (BitmapEntry));
+	builder.data = g_byte_array_new ();
+
+	for (i = 0; i < n_commits; i++)
+	{
+		builder.entry_of_position[i] = NO_BITMAP;
+	}
+
+	selected = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	if (!select_commits (graph, tips, selected))
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_INVALID_DATA,
+		                     "Corrupt commit-graph");
+	}
+	else
+	{
+		g_array_sort_with_data (selected, compare_bits, bit_of_position);
+
+		success = build_bitmaps (graph,
+		                         out->data + HEADER_SIZE,
+		                         selected,
+		                         &builder,
+		                         cancellable,
+		                         error);
+	}
+
+	if (success)
+	{
+		guint32 n_bitmaps = GUINT32_TO_BE (builder.entries->len);
+
+		memcpy (out->data + 12 + GIT_OID_RAWSZ, &n_bitmaps, sizeof (n_bitmaps));
+
+		g_array_sort (builder.entries, compare_entries);
+
+		for (i = 0; i < builder.entries->len; i++)
+		{
+			BitmapEntry *entry = &g_array_index (builder.entries, BitmapEntry, i);
+
+			append_be32 (out, entry->position);
+			append_be32 (out, entry->n_words);
+			append_be64 (out, entry->offset);
+		}
+
+		g_byte_array_append (out, builder.data->data, builder.data->len);
+
+		/* Written to a temporary file and renamed, so readers keep
+		 * mapping the previous file meanwhile */
+		path = _ggit_reachability_index_get_path (repository);
+		success = g_file_set_contents (path, (const gchar *)out->data, out->len, error);
+		g_free (path);
+	}
+
+	g_byte_array_unref (builder.data);
+	g_array_free (builder.entries, TRUE);
+	g_free (builder.entry_of_position);
+	g_array_free (selected, TRUE);
+	g_byte_array_unref (out);
+	g_free (bit_of_position);
+	g_array_free (tips, TRUE);
+
+	return success;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,73 @@
+/*
+ * ggit-reachability-index.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __GGIT_REACHABILITY_INDEX_H__
+#define __GGIT_REACHABILITY_INDEX_H__
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <git2.h>
+
+#include "ggit-commit-graph.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GgitReachabilityIndex GgitReachabilityIndex;
+
+gchar                 *_ggit_reachability_index_get_path           (git_repository         *repository);
+
+GgitReachabilityIndex *_ggit_reachability_index_open               (const gchar            *path,
+                                                                    GgitCommitGraph        *graph,
+                                                                    GError                **error);
+
+GgitReachabilityIndex *_ggit_reachability_index_ref                (GgitReachabilityIndex  *index);
+
+void                   _ggit_reachability_index_unref              (GgitReachabilityIndex  *index);
+
+gboolean               _ggit_reachability_index_is_current         (GgitReachabilityIndex  *index,
+                                                                    const GStatBuf         *st,
+                                                                    GgitCommitGraph        *graph);
+
+gboolean               _ggit_reachability_index_write              (git_repository         *repository,
+                                                                    GgitCommitGraph        *graph,
+                                                                    GCancellable           *cancellable,
+                                                                    GError                **error);
+
+void                   _ggit_reachability_index_descendant_of_many (GgitReachabilityIndex  *index,
+                                                                    GgitOId               **commits,
+                                                                    gsize                   n_commits,
+                                                                    GgitOId                *ancestor,
+                                                                    gboolean               *results,
+                                                                    gboolean               *answered);
+
+void                   _ggit_reachability_index_ahead_behind_many  (GgitReachabilityIndex  *index,
+                                                                    GgitOId               **locals,
+                                                                    gsize                   n_locals,
+                                                                    GgitOId                *upstream,
+                                                                    gsize                  *ahead,
+                                                                    gsize                  *behind,
+                                                                    gboolean               *answered);
+
+G_END_DECLS
+
+#endif /* __GGIT_REACHABILITY_INDEX_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,519 @@
+/*
+ * ggit-repository-scan-result.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <git2.h>
+
+#include "ggit-error.h"
+#include "ggit-oid.h"
+#include "ggit-repository-scan-result.h"
+#include "ggit-status-options.h"
+
+/**
+ * GgitRepositoryScanResult:
+ *
+ * Represents the outcome of scanning a single repository with a
+ * #GgitRepositoryScanner.
+ */
+struct _GgitRepositoryScanResult
+{
+	GObject parent_instance;
+
+	GFile *location;
+	GError *error;
+
+	GgitOId *head_id;
+	gchar *branch_name;
+
+	guint staged;
+	guint unstaged;
+	guint untracked;
+	guint conflicted;
+	gboolean is_dirty;
+
+	gboolean has_upstream;
+	gsize ahead;
+	gsize behind;
+
+	gint64 elapsed;
+};
+
+G_DEFINE_TYPE (GgitRepositoryScanResult, ggit_repository_scan_result, G_TYPE_OBJECT)
+
+#define STAGED_FLAGS (GIT_STATUS_INDEX_NEW | GIT_STATUS_INDEX_MODIFIED | \
+                      GIT_STATUS_INDEX_DELETED | GIT_STATUS_INDEX_RENAMED | \
+                      GIT_STATUS_INDEX_TYPECHANGE)
+
+#define UNSTAGED_FLAGS (GIT_STATUS_WT_MODIFIED | GIT_STATUS_WT_DELETED | \
+                        GIT_STATUS_WT_RENAMED | GIT_STATUS_WT_TYPECHANGE)
+
+static void
+ggit_repository_scan_result_finalize (GObject *object)
+{
+	GgitRepositoryScanResult *result = GGIT_REPOSITORY_SCAN_RESULT (object);
+
+	g_clear_object (&result->location);
+	g_clear_error (&result->error);
+	g_clear_pointer (&result->head_id, ggit_oid_free);
+	g_free (result->branch_name);
+
+	G_OBJECT_CLASS (ggit_repository_scan_result_parent_class)->finalize (object);
+}
+
+static void
+ggit_repository_scan_result_class_init (GgitRepositoryScanResultClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = ggit_repository_scan_result_finalize;
+}
+
+static void
+ggit_repository_scan_result_init (GgitRepositoryScanResult *result)
+{
+}
+
+GgitRepositoryScanResult *
+_ggit_repository_scan_result_new (GFile *location)
+{
+	GgitRepositoryScanResult *result;
+
+	result = g_object_new (GGIT_TYPE_REPOSITORY_SCAN_RESULT, NULL);
+	result->location = g_object_ref (location);
+
+	return result;
+}
+
+static gint
+scan_head (GgitRepositoryScanResult *result,
+           git_repository           *repo)
+{
+	git_reference *head;
+	gint ret;
+
+	ret = git_repository_head (&head, repo);
+
+	if (ret == GIT_EUNBORNBRANCH || ret == GIT_ENOTFOUND)
+	{
+		return GIT_OK;
+	}
+	else if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	result->head_id = _ggit_oid_wrap (git_reference_target (head));
+
+	if (git_reference_is_branch (head))
+	{
+		result->branch_name = g_strdup (git_reference_shorthand (head));
+	}
+
+	git_reference_free (head);
+
+	return GIT_OK;
+}
+
+static gint
+scan_status (GgitRepositoryScanResult *result,
+             git_repository           *repo,
+             GgitStatusOptions        *status_options)
+{
+	git_status_list *list;
+	gsize n;
+	gsize i;
+	gint ret;
+
+	ret = git_status_list_new (&list,
+	                           repo,
+	                           status_options != NULL ? _ggit_status_options_get_status_options (status_options) : NULL);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	n = git_status_list_entrycount (list);
+
+	for (i = 0; i < n; i++)
+	{
+		const git_status_entry *entry;
+
+		entry = git_status_byindex (list, i);
+
+		if (entry->status & GIT_STATUS_CONFLICTED)
+		{
+			result->conflicted++;
+			continue;
+		}
+
+		if (entry->status & STAGED_FLAGS)
+		{
+			result->staged++;
+		}
+
+		if (entry->status & UNSTAGED_FLAGS)
+		{
+			result->unstaged++;
+		}
+
+		if (entry->status & GIT_STATUS_WT_NEW)
+		{
+			result->untracked++;
+		}
+	}
+
+	git_status_list_free (list);
+
+	result->is_dirty = result->staged > 0 ||
+	                   result->unstaged > 0 ||
+	                   result->conflicted > 0;
+
+	return GIT_OK;
+}
+
+static gint
+stop_at_first_change (const char *path,
+                      unsigned    status_flags,
+                      void       *payload)
+{
+	return 1;
+}
+
+static gint
+scan_dirty (GgitRepositoryScanResult *result,
+            git_repository           *repo)
+{
+	git_status_options options = GIT_STATUS_OPTIONS_INIT;
+	gint ret;
+
+	/* Neither untracked nor ignored files make a repository dirty */
+	options.show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+	options.flags = GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+
+	ret = git_status_foreach_ext (repo, &options, stop_at_first_change, NULL);
+
+	if (ret < 0)
+	{
+		return ret;
+	}
+
+	result->is_dirty = ret > 0;
+
+	return GIT_OK;
+}
+
+static gint
+scan_ahead_behind (GgitRepositoryScanResult *result,
+                   git_repository           *repo)
+{
+	git_reference *head;
+	git_reference *upstream;
+	gint ret;
+
+	ret = git_repository_head (&head, repo);
+
+	if (ret == GIT_EUNBORNBRANCH || ret == GIT_ENOTFOUND)
+	{
+		return GIT_OK;
+	}
+	else if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	if (!git_reference_is_branch (head))
+	{
+		git_reference_free (head);
+		return GIT_OK;
+	}
+
+	ret = git_branch_upstream (&upstream, head);
+
+	if (ret == GIT_ENOTFOUND)
+	{
+		git_reference_free (head);
+		return GIT_OK;
+	}
+	else if (ret != GIT_OK)
+	{
+		git_reference_free (head);
+		return ret;
+	}
+
+	ret = git_graph_ahead_behind (&result->ahead,
+	                              &result->behind,
+	                              repo,
+	                              git_reference_target (head),
+	                              git_reference_target (upstream));
+
+	result->has_upstream = ret == GIT_OK;
+
+	git_reference_free (upstream);
+	git_reference_free (head);
+
+	return ret;
+}
+
+/*
+ * _ggit_repository_scan_result_run:
+ * @result: a #GgitRepositoryScanResult.
+ * @queries: the queries to run.
+ * @status_options: (allow-none): the options for the status query.
+ *
+ * Opens the repository at the location of @result and runs @queries on it.
+ * Only uses libgit2 directly, so it can run on any thread.
+ */
+void
+_ggit_repository_scan_result_run (GgitRepositoryScanResult *result,
+                                  GgitRepositoryScanFlags   queries,
+                                  GgitStatusOptions        *status_options)
+{
+	git_repository *repo = NULL;
+	gint64 start;
+	gchar *path;
+	gint ret;
+
+	start = g_get_monotonic_time ();
+
+	path = g_file_get_path (result->location);
+
+	if (path == NULL)
+	{
+		ret = GIT_ENOTFOUND;
+	}
+	else
+	{
+		ret = git_repository_open (&repo, path);
+		g_free (path);
+	}
+
+	if (ret == GIT_OK && (queries & GGIT_REPOSITORY_SCAN_HEAD))
+	{
+		ret = scan_head (result, repo);
+	}
+
+	if (ret == GIT_OK && (queries & GGIT_REPOSITORY_SCAN_STATUS))
+	{
+		ret = scan_status (result, repo, status_options);
+	}
+	else if (ret == GIT_OK && (queries & GGIT_REPOSITORY_SCAN_DIRTY))
+	{
+		ret = scan_dirty (result, repo);
+	}
+
+	if (ret == GIT_OK && (queries & GGIT_REPOSITORY_SCAN_AHEAD_BEHIND))
+	{
+		ret = scan_ahead_behind (result, repo);
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (&result->error, ret);
+	}
+
+	if (repo != NULL)
+	{
+		git_repository_free (repo);
+	}
+
+	result->elapsed = g_get_monotonic_time () - start;
+}
+
+/**
+ * ggit_repository_scan_result_get_location:
+ * @result: a #GgitRepositoryScanResult.
+ *
+ * Gets the location of the scanned repository.
+ *
+ * Returns: (transfer none): the location of the repository.
+ */
+GFile *
+ggit_repository_scan_result_get_location (GgitRepositoryScanResult *result)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), NULL);
+
+	return result->location;
+}
+
+/**
+ * ggit_repository_scan_result_get_error:
+ * @result: a #GgitRepositoryScanResult.
+ *
+ * Gets the error which stopped the scan of the repository, for example
+ * because there is no repository at its location. The other values of
+ * @result are only partially filled in that case.
+ *
+ * Returns: (transfer none) (nullable): a #GError or %NULL.
+ */
+const GError *
+ggit_repository_scan_result_get_error (GgitRepositoryScanResult *result)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), NULL);
+
+	return result->error;
+}
+
+/**
+ * ggit_repository_scan_result_get_head_id:
+ * @result: a #GgitRepositoryScanResult.
+ *
+ * Gets the id of the commit HEAD points to, if #GGIT_REPOSITORY_SCAN_HEAD
+ * was queried.
+ *
+ * Returns: (transfer full) (nullable): a #GgitOId or %NULL if HEAD is
+ * unborn or was not queried.
+ */
+GgitOId *
+ggit_repository_scan_result_get_head_id (GgitRepositoryScanResult *result)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), NULL);
+
+	return result->head_id != NULL ? ggit_oid_copy (result->head_id) : NULL;
+}
+
+/**
+ * ggit_repository_scan_result_get_branch_name:
+ * @result: a #GgitRepositoryScanResult.
+ *
+ * Gets the short name of the branch HEAD points to, if
+ * #GGIT_REPOSITORY_SCAN_HEAD was queried.
+ *
+ * Returns: (transfer none) (nullable): the branch name or %NULL if HEAD is
+ * detached, unborn or was not queried.
+ */
+const gchar *
+ggit_repository_scan_result_get_branch_name (GgitRepositoryScanResult *result)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), NULL);
+
+	return result->branch_name;
+}
+
+/**
+ * ggit_repository_scan_result_get_is_dirty:
+ * @result: a #GgitRepositoryScanResult.
+ *
+ * Gets whether there are staged, unstaged or conflicted changes, if
+ * #GGIT_REPOSITORY_SCAN_STATUS or #GGIT_REPOSITORY_SCAN_DIRTY was queried.
+ * Untracked files do not make a repository dirty.
+ *
+ * Returns: %TRUE if the repository is dirty.
+ */
+gboolean
+ggit_repository_scan_result_get_is_dirty (GgitRepositoryScanResult *result)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), FALSE);
+
+	return result->is_dirty;
+}
+
+/**
+ * ggit_repository_scan_result_get_status_counts:
+ * @result: a #GgitRepositoryScanResult.
+ * @staged: (out) (optional): return location for the number of staged files.
+ * @unstaged: (out) (optional): return location for the number of modified
+ *            tracked files.
+ * @untracked: (out) (optional): return location for the number of
+ *             untracked files.
+ * @conflicted: (out) (optional): return location for the number of
+ *              conflicted files.
+ *
+ * Gets the file counts of the #GGIT_REPOSITORY_SCAN_STATUS query. A file
+ * both staged and modified again counts as staged and unstaged.
+ */
+void
+ggit_repository_scan_result_get_status_counts (GgitRepositoryScanResult *result,
+                                               guint                    *staged,
+                                               guint                    *unstaged,
+                                               guint                    *untracked,
+                                               guint                    *conflicted)
+{
+	g_return_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result));
+
+	if (staged != NULL)
+	{
+		*staged = result->staged;
+	}
+
+	if (unstaged != NULL)
+	{
+		*unstaged = result->unstaged;
+	}
+
+	if (untracked != NULL)
+	{
+		*untracked = result->untracked;
+	}
+
+	if (conflicted != NULL)
+	{
+		*conflicted = result->conflicted;
+	}
+}
+
+/**
+ * ggit_repository_scan_result_get_ahead_behind:
+ * @result: a #GgitRepositoryScanResult.
+ * @ahead: (out) (optional): return location for the number of commits
+ *         only on the current branch.
+ * @behind: (out) (optional): return location for the number of commits
+ *          only on its upstream branch.
+ *
+ * Gets the result of the #GGIT_REPOSITORY_SCAN_AHEAD_BEHIND query.
+ *
+ * Returns: %TRUE if the current branch has an upstream branch.
+ */
+gboolean
+ggit_repository_scan_result_get_ahead_behind (GgitRepositoryScanResult *result,
+                                              gsize                    *ahead,
+                                              gsize                    *behind)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), FALSE);
+
+	if (ahead != NULL)
+	{
+		*ahead = result->ahead;
+	}
+
+	if (behind != NULL)
+	{
+		*behind = result->behind;
+	}
+
+	return result->has_upstream;
+}
+
+/**
+ * ggit_repository_scan_result_get_elapsed:
+ * @result: a #GgitRepositoryScanResult.
+ *
+ * Gets the time it took to open and scan the repository.
+ *
+ * Returns: the elapsed time in microseconds.
+ */
+gint64
+ggit_repository_scan_result_get_elapsed (GgitRepositoryScanResult *result)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCAN_RESULT (result), 0);
+
+	return result->elapsed;
+}
+
+/* ex:set ts=8 noet: */
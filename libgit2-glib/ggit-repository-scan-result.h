@@ -0,0 +1,69 @@
+/*
+ * ggit-repository-scan-result.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_REPOSITORY_SCAN_RESULT_H__
+#define __GGIT_REPOSITORY_SCAN_RESULT_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_REPOSITORY_SCAN_RESULT (ggit_repository_scan_result_get_type ())
+G_DECLARE_FINAL_TYPE (GgitRepositoryScanResult, ggit_repository_scan_result, GGIT, REPOSITORY_SCAN_RESULT, GObject)
+
+GgitRepositoryScanResult *_ggit_repository_scan_result_new          (GFile                     *location);
+
+void                      _ggit_repository_scan_result_run          (GgitRepositoryScanResult  *result,
+                                                                     GgitRepositoryScanFlags    queries,
+                                                                     GgitStatusOptions         *status_options);
+
+GFile                    *ggit_repository_scan_result_get_location  (GgitRepositoryScanResult  *result);
+
+const GError             *ggit_repository_scan_result_get_error     (GgitRepositoryScanResult  *result);
+
+GgitOId                  *ggit_repository_scan_result_get_head_id   (GgitRepositoryScanResult  *result);
+
+const gchar              *ggit_repository_scan_result_get_branch_name
+                                                                    (GgitRepositoryScanResult  *result);
+
+gboolean                  ggit_repository_scan_result_get_is_dirty  (GgitRepositoryScanResult  *result);
+
+void                      ggit_repository_scan_result_get_status_counts
+                                                                    (GgitRepositoryScanResult  *result,
+                                                                     guint                     *staged,
+                                                                     guint                     *unstaged,
+                                                                     guint                     *untracked,
+                                                                     guint                     *conflicted);
+
+gboolean                  ggit_repository_scan_result_get_ahead_behind
+                                                                    (GgitRepositoryScanResult  *result,
+                                                                     gsize                     *ahead,
+                                                                     gsize                     *behind);
+
+gint64                    ggit_repository_scan_result_get_elapsed   (GgitRepositoryScanResult  *result);
+
+G_END_DECLS
+
+#endif /* __GGIT_REPOSITORY_SCAN_RESULT_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,468 @@
+/*
+ * ggit-repository-scanner.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <git2.h>
+
+#include "ggit-repository-scanner.h"
+#include "ggit-enum-types.h"
+#include "ggit-status-options.h"
+
+/**
+ * GgitRepositoryScanner:
+ *
+ * Runs a set of queries (see #GgitRepositoryScanFlags) on many
+ * repositories in parallel.
+ *
+ * Each repository is opened and scanned on a pool of worker threads. The
+ * results are appended to the list returned by
+ * ggit_repository_scanner_get_results() on the thread-default main context
+ * of the caller of ggit_repository_scanner_scan_async(), in the order in
+ * which the repositories finish.
+ */
+struct _GgitRepositoryScanner
+{
+	GObject parent_instance;
+
+	GgitRepositoryScanFlags queries;
+	guint max_threads;
+	GgitStatusOptions *status_options;
+
+	GListStore *results;
+	guint scanning : 1;
+};
+
+typedef struct
+{
+	GgitRepositoryScanner *scanner;
+	GTask *task;
+	GMainContext *context;
+	GThreadPool *pool;
+
+	GgitRepositoryScanFlags queries;
+	GgitStatusOptions *status_options;
+
+	/* only accessed on the main context */
+	gsize pending;
+} ScanData;
+
+typedef struct
+{
+	ScanData *data;
+	GgitRepositoryScanResult *result;
+} ScanJob;
+
+enum
+{
+	PROP_0,
+	PROP_QUERIES,
+	PROP_MAX_THREADS
+};
+
+G_DEFINE_TYPE (GgitRepositoryScanner, ggit_repository_scanner, G_TYPE_OBJECT)
+
+static void
+ggit_repository_scanner_finalize (GObject *object)
+{
+	GgitRepositoryScanner *scanner = GGIT_REPOSITORY_SCANNER (object);
+
+	g_clear_pointer (&scanner->status_options, ggit_status_options_free);
+	g_clear_object (&scanner->results);
+
+	G_OBJECT_CLASS (ggit_repository_scanner_parent_class)->finalize (object);
+}
+
+static void
+ggit_repository_scanner_get_property (GObject    *object,
+                                      guint       prop_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+	GgitRepositoryScanner *scanner = GGIT_REPOSITORY_SCANNER (object);
+
+	switch (prop_id)
+	{
+		case PROP_QUERIES:
+			g_value_set_flags (value, scanner->queries);
+			break;
+		case PROP_MAX_THREADS:
+			g_value_set_uint (value, scanner->max_threads);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+ggit_repository_scanner_set_property (GObject      *object,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+	GgitRepositoryScanner *scanner = GGIT_REPOSITORY_SCANNER (object);
+
+	switch (prop_id)
+	{
+		case PROP_QUERIES:
+			scanner->queries = g_value_get_flags (value);
+			break;
+		case PROP_MAX_THREADS:
+			ggit_repository_scanner_set_max_threads (scanner,
+			                                         g_value_get_uint (value));
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+ggit_repository_scanner_class_init (GgitRepositoryScannerClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = ggit_repository_scanner_finalize;
+	object_class->get_property = ggit_repository_scanner_get_property;
+	object_class->set_property = ggit_repository_scanner_set_property;
+
+	g_object_class_install_property (object_class,
+	                                 PROP_QUERIES,
+	                                 g_param_spec_flags ("queries",
+	                                                     "Queries",
+	                                                     "The queries to run on each repository",
+	                                                     GGIT_TYPE_REPOSITORY_SCAN_FLAGS,
+	                                                     GGIT_REPOSITORY_SCAN_HEAD,
+	                                                     G_PARAM_READWRITE |
+	                                                     G_PARAM_CONSTRUCT_ONLY |
+	                                                     G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_MAX_THREADS,
+	                                 g_param_spec_uint ("max-threads",
+	                                                    "Max threads",
+	                                                    "The maximum number of repositories scanned at once, 0 for the number of processors",
+	                                                    0,
+	                                                    G_MAXUINT,
+	                                                    0,
+	                                                    G_PARAM_READWRITE |
+	                                                    G_PARAM_STATIC_STRINGS));
+}
+
+static void
+ggit_repository_scanner_init (GgitRepositoryScanner *scanner)
+{
+	scanner->results = g_list_store_new (GGIT_TYPE_REPOSITORY_SCAN_RESULT);
+}
+
+/**
+ * ggit_repository_scanner_new:
+ * @queries: the queries to run on each repository.
+ *
+ * Creates a new #GgitRepositoryScanner.
+ *
+ * Returns: (transfer full): a new #GgitRepositoryScanner.
+ */
+GgitRepositoryScanner *
+ggit_repository_scanner_new (GgitRepositoryScanFlags queries)
+{
+	return g_object_new (GGIT_TYPE_REPOSITORY_SCANNER,
+	                     "queries", queries,
+	                     NULL);
+}
+
+/**
+ * ggit_repository_scanner_get_queries:
+ * @scanner: a #GgitRepositoryScanner.
+ *
+ * Gets the queries run on each repository.
+ *
+ * Returns: a #GgitRepositoryScanFlags.
+ */
+GgitRepositoryScanFlags
+ggit_repository_scanner_get_queries (GgitRepositoryScanner *scanner)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner), 0);
+
+	return scanner->queries;
+}
+
+/**
+ * ggit_repository_scanner_set_max_threads:
+ * @scanner: a #GgitRepositoryScanner.
+ * @max_threads: the maximum number of repositories scanned at once, or 0
+ *               for the number of processors.
+ *
+ * Sets how many repositories are scanned in parallel. Takes effect on the
+ * next scan.
+ */
+void
+ggit_repository_scanner_set_max_threads (GgitRepositoryScanner *scanner,
+                                         guint                  max_threads)
+{
+	g_return_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner));
+
+	if (scanner->max_threads != max_threads)
+	{
+		scanner->max_threads = max_threads;
+		g_object_notify (G_OBJECT (scanner), "max-threads");
+	}
+}
+
+/**
+ * ggit_repository_scanner_get_max_threads:
+ * @scanner: a #GgitRepositoryScanner.
+ *
+ * Gets how many repositories are scanned in parallel.
+ *
+ * Returns: the maximum number of threads, 0 for the number of processors.
+ */
+guint
+ggit_repository_scanner_get_max_threads (GgitRepositoryScanner *scanner)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner), 0);
+
+	return scanner->max_threads;
+}
+
+/**
+ * ggit_repository_scanner_set_status_options:
+ * @scanner: a #GgitRepositoryScanner.
+ * @status_options: (allow-none): a #GgitStatusOptions or %NULL.
+ *
+ * Sets the options of the #GGIT_REPOSITORY_SCAN_STATUS query. Takes effect
+ * on the next scan.
+ */
+void
+ggit_repository_scanner_set_status_options (GgitRepositoryScanner *scanner,
+                                            GgitStatusOptions     *status_options)
+{
+	g_return_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner));
+
+	g_clear_pointer (&scanner->status_options, ggit_status_options_free);
+
+	if (status_options != NULL)
+	{
+		scanner->status_options = ggit_status_options_copy (status_options);
+	}
+}
+
+/**
+ * ggit_repository_scanner_get_results:
+ * @scanner: a #GgitRepositoryScanner.
+ *
+ * Gets the list of #GgitRepositoryScanResult of the last scan. Results are
+ * added while the scan is running, the list is emptied when a new scan
+ * starts.
+ *
+ * Returns: (transfer none): a #GListModel of #GgitRepositoryScanResult.
+ */
+GListModel *
+ggit_repository_scanner_get_results (GgitRepositoryScanner *scanner)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner), NULL);
+
+	return G_LIST_MODEL (scanner->results);
+}
+
+static void
+scan_data_free (ScanData *data)
+{
+	g_thread_pool_free (data->pool, FALSE, FALSE);
+
+	g_clear_pointer (&data->status_options, ggit_status_options_free);
+	g_main_context_unref (data->context);
+	g_object_unref (data->scanner);
+
+	g_slice_free (ScanData, data);
+}
+
+static gboolean
+scan_job_done (gpointer user_data)
+{
+	ScanJob *job = user_data;
+	ScanData *data = job->data;
+
+	if (job->result != NULL)
+	{
+		g_list_store_append (data->scanner->results, job->result);
+		g_object_unref (job->result);
+	}
+
+	g_slice_free (ScanJob, job);
+
+	if (--data->pending == 0)
+	{
+		GTask *task = data->task;
+
+		data->scanner->scanning = FALSE;
+
+		/* task owns data */
+		g_task_return_boolean (task, TRUE);
+		g_object_unref (task);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+scan_worker (gpointer job_data,
+             gpointer user_data)
+{
+	ScanJob *job = job_data;
+	ScanData *data = job->data;
+	GSource *source;
+
+	if (g_cancellable_is_cancelled (g_task_get_cancellable (data->task)))
+	{
+		g_clear_object (&job->result);
+	}
+	else
+	{
+		_ggit_repository_scan_result_run (job->result,
+		                                  data->queries,
+		                                  data->status_options);
+	}
+
+	/* Not g_main_context_invoke(), which would run the callback on this
+	 * thread when nobody owns the context. */
+	source = g_idle_source_new ();
+	g_source_set_priority (source, G_PRIORITY_DEFAULT);
+	g_source_set_callback (source, scan_job_done, job, NULL);
+	g_source_attach (source, data->context);
+	g_source_unref (source);
+}
+
+/**
+ * ggit_repository_scanner_scan_async:
+ * @scanner: a #GgitRepositoryScanner.
+ * @locations: (array length=n_locations): the working directories or git
+ *             directories of the repositories to scan.
+ * @n_locations: the number of elements in @locations.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback called when all
+ *            repositories have been scanned.
+ * @user_data: (closure): user data for @callback.
+ *
+ * Scans @locations in parallel. The results of the previous scan are
+ * removed from the list returned by ggit_repository_scanner_get_results()
+ * and a #GgitRepositoryScanResult is appended to it, on the thread-default
+ * main context of the caller, as soon as each repository is done.
+ * Repositories which fail to open or to scan still get a result, see
+ * ggit_repository_scan_result_get_error().
+ *
+ * When @cancellable is cancelled, repositories not yet started are skipped
+ * and the scan finishes with %G_IO_ERROR_CANCELLED.
+ *
+ * Only one scan may run at a time on @scanner.
+ */
+void
+ggit_repository_scanner_scan_async (GgitRepositoryScanner  *scanner,
+                                    GFile                 **locations,
+                                    gsize                   n_locations,
+                                    GCancellable           *cancellable,
+                                    GAsyncReadyCallback     callback,
+                                    gpointer                user_data)
+{
+	ScanData *data;
+	GTask *task;
+	guint max_threads;
+	gsize i;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner));
+	g_return_if_fail (locations != NULL || n_locations == 0);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (!scanner->scanning);
+
+	task = g_task_new (scanner, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_scanner_scan_async);
+
+	g_list_store_remove_all (scanner->results);
+
+	if (n_locations == 0)
+	{
+		g_task_return_boolean (task, TRUE);
+		g_object_unref (task);
+		return;
+	}
+
+	max_threads = scanner->max_threads;
+
+	if (max_threads == 0)
+	{
+		max_threads = g_get_num_processors ();
+	}
+
+	data = g_slice_new0 (ScanData);
+	data->scanner = g_object_ref (scanner);
+	data->task = task;
+	data->context = g_main_context_ref_thread_default ();
+	data->queries = scanner->queries;
+	data->pending = n_locations;
+
+	if (scanner->status_options != NULL)
+	{
+		data->status_options = ggit_status_options_copy (scanner->status_options);
+	}
+
+	data->pool = g_thread_pool_new (scan_worker,
+	                                data,
+	                                (gint)MIN (max_threads, n_locations),
+	                                FALSE,
+	                                NULL);
+
+	g_task_set_task_data (task, data, (GDestroyNotify)scan_data_free);
+	scanner->scanning = TRUE;
+
+	for (i = 0; i < n_locations; i++)
+	{
+		ScanJob *job;
+
+		job = g_slice_new (ScanJob);
+		job->data = data;
+		job->result = _ggit_repository_scan_result_new (locations[i]);
+
+		g_thread_pool_push (data->pool, job, NULL);
+	}
+}
+
+/**
+ * ggit_repository_scanner_scan_finish:
+ * @scanner: a #GgitRepositoryScanner.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes a scan started with ggit_repository_scanner_scan_async().
+ * Per-repository failures are reported by the individual results, @error
+ * is only set when the scan was cancelled.
+ *
+ * Returns: %TRUE if all repositories were scanned, %FALSE otherwise.
+ */
+gboolean
+ggit_repository_scanner_scan_finish (GgitRepositoryScanner  *scanner,
+                                     GAsyncResult           *result,
+                                     GError                **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY_SCANNER (scanner), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, scanner), FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,64 @@
+/*
+ * ggit-repository-scanner.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_REPOSITORY_SCANNER_H__
+#define __GGIT_REPOSITORY_SCANNER_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-repository-scan-result.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_REPOSITORY_SCANNER (ggit_repository_scanner_get_type ())
+G_DECLARE_FINAL_TYPE (GgitRepositoryScanner, ggit_repository_scanner, GGIT, REPOSITORY_SCANNER, GObject)
+
+GgitRepositoryScanner   *ggit_repository_scanner_new                (GgitRepositoryScanFlags   queries);
+
+GgitRepositoryScanFlags  ggit_repository_scanner_get_queries        (GgitRepositoryScanner    *scanner);
+
+void                     ggit_repository_scanner_set_max_threads    (GgitRepositoryScanner    *scanner,
+                                                                     guint                     max_threads);
+
+guint                    ggit_repository_scanner_get_max_threads    (GgitRepositoryScanner    *scanner);
+
+void                     ggit_repository_scanner_set_status_options (GgitRepositoryScanner    *scanner,
+                                                                     GgitStatusOptions        *status_options);
+
+GListModel              *ggit_repository_scanner_get_results        (GgitRepositoryScanner    *scanner);
+
+void                     ggit_repository_scanner_scan_async         (GgitRepositoryScanner    *scanner,
+                                                                     GFile                   **locations,
+                                                                     gsize                     n_locations,
+                                                                     GCancellable             *cancellable,
+                                                                     GAsyncReadyCallback       callback,
+                                                                     gpointer                  user_data);
+
+gboolean                 ggit_repository_scanner_scan_finish        (GgitRepositoryScanner    *scanner,
+                                                                     GAsyncResult             *result,
+                                                                     GError                  **error);
+
+G_END_DECLS
+
+#endif /* __GGIT_REPOSITORY_SCANNER_H__ */
+
+/* ex:set ts=8 noet: */
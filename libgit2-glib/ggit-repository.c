@@ -18,20 +18,30 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
+#include <stdio.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <git2.h>
 #include <git2/sys/commit.h>
 
+#include "ggit-async.h"
+#include "ggit-attribute-cache.h"
+#include "ggit-commit-graph.h"
+#include "ggit-object-cache.h"
+#include "ggit-oid-table.h"
 #include "ggit-error.h"
 #include "ggit-oid.h"
 #include "ggit-ref.h"
 #include "ggit-repository.h"
 #include "ggit-utils.h"
+#include "ggit-reachability-index.h"
 #include "ggit-remote.h"
 #include "ggit-submodule.h"
 #include "ggit-signature.h"
 #include "ggit-clone-options.h"
 #include "ggit-status-options.h"
+#include "ggit-untracked-cache.h"
 #include "ggit-tree-builder.h"
 #include "ggit-branch-enumerator.h"
 #include "ggit-blame.h"
@@ -55,6 +65,15 @@ typedef struct _GgitRepositoryPrivate
 
 	GgitCloneOptions *clone_options;
 
+	GMutex attribute_lock;
+	GgitAttributeCache *attribute_cache;
+
+	GgitObjectCache *object_cache;
+
+	GMutex commit_graph_lock;
+	GgitCommitGraph *commit_graph;
+	GgitReachabilityIndex *reachability_index;
+
 	guint is_bare : 1;
 	guint init : 1;
 } GgitRepositoryPrivate;
@@ -79,46 +98,153 @@ G_DEFINE_TYPE_EXTENDED (GgitRepository, ggit_repository, GGIT_TYPE_NATIVE,
                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
                                                ggit_repository_initable_iface_init))
 
-static GHashTable *registry = NULL;
+/* Maps git_repository pointers to their owning wrapper, so that wrapping a
+ * git_repository again (e.g. from ggit_object_get_owner()) returns the same
+ * GgitRepository. Repositories are opened and closed from any thread, so
+ * the registry is split in shards with their own lock, and entries hold
+ * weak references so that a wrapper being finalized is never handed out.
+ */
+#define REGISTRY_SHARDS 16
+
+typedef struct
+{
+	GMutex lock;
+	GHashTable *entries;
+} RegistryShard;
+
+typedef struct
+{
+	/* not a reference, only used to match the wrapper on unregister */
+	GgitRepository *wrapper;
+	GWeakRef ref;
+} RegistryEntry;
+
+static RegistryShard registry[REGISTRY_SHARDS];
+
+static RegistryShard *
+registry_get_shard (git_repository *repository)
+{
+	guintptr p = (guintptr)repository;
+
+	/* skip the low bits, which are the same for all allocations */
+	return &registry[((p >> 4) ^ (p >> 12)) % REGISTRY_SHARDS];
+}
+
+static void
+registry_entry_free (RegistryEntry *entry)
+{
+	g_weak_ref_clear (&entry->ref);
+	g_slice_free (RegistryEntry, entry);
+}
 
+/* Returns: (transfer full) (nullable): the registered wrapper */
 static GgitRepository *
 repository_from_registry (git_repository *repository)
 {
-	if (registry == NULL)
+	RegistryShard *shard;
+	GgitRepository *ret = NULL;
+
+	shard = registry_get_shard (repository);
+
+	g_mutex_lock (&shard->lock);
+
+	if (shard->entries != NULL)
 	{
-		return NULL;
+		RegistryEntry *entry;
+
+		entry = g_hash_table_lookup (shard->entries, repository);
+
+		if (entry != NULL)
+		{
+			ret = g_weak_ref_get (&entry->ref);
+		}
 	}
 
-	return g_hash_table_lookup (registry, repository);
+	g_mutex_unlock (&shard->lock);
+
+	return ret;
 }
 
-static void
+/* Registers @wrapper unless another live wrapper was registered for
+ * @repository in the meantime, which is then returned instead.
+ *
+ * Returns: (transfer full) (nullable): the already registered wrapper
+ */
+static GgitRepository *
 register_repository (git_repository *repository,
                      GgitRepository *wrapper)
 {
-	if (registry == NULL)
+	RegistryShard *shard;
+	RegistryEntry *entry;
+
+	shard = registry_get_shard (repository);
+
+	g_mutex_lock (&shard->lock);
+
+	if (shard->entries == NULL)
+	{
+		shard->entries = g_hash_table_new_full (g_direct_hash,
+		                                        g_direct_equal,
+		                                        NULL,
+		                                        (GDestroyNotify)registry_entry_free);
+	}
+
+	entry = g_hash_table_lookup (shard->entries, repository);
+
+	if (entry != NULL)
 	{
-		registry = g_hash_table_new (g_direct_hash, g_direct_equal);
+		GgitRepository *existing;
+
+		existing = g_weak_ref_get (&entry->ref);
+
+		if (existing != NULL)
+		{
+			g_mutex_unlock (&shard->lock);
+			return existing;
+		}
 	}
 
-	g_hash_table_insert (registry, repository, wrapper);
+	entry = g_slice_new (RegistryEntry);
+	entry->wrapper = wrapper;
+	g_weak_ref_init (&entry->ref, wrapper);
+
+	/* replaces the entry of a wrapper being finalized, if any */
+	g_hash_table_insert (shard->entries, repository, entry);
+
+	g_mutex_unlock (&shard->lock);
+
+	return NULL;
 }
 
 static void
-unregister_repository (git_repository *repository)
+unregister_repository (git_repository *repository,
+                       GgitRepository *wrapper)
 {
-	if (registry == NULL)
-	{
-		return;
-	}
+	RegistryShard *shard;
 
-	g_hash_table_remove (registry, repository);
+	shard = registry_get_shard (repository);
 
-	if (g_hash_table_size (registry) == 0)
+	g_mutex_lock (&shard->lock);
+
+	if (shard->entries != NULL)
 	{
-		g_hash_table_destroy (registry);
-		registry = NULL;
+		RegistryEntry *entry;
+
+		entry = g_hash_table_lookup (shard->entries, repository);
+
+		if (entry != NULL && entry->wrapper == wrapper)
+		{
+			g_hash_table_remove (shard->entries, repository);
+		}
+
+		if (g_hash_table_size (shard->entries) == 0)
+		{
+			g_hash_table_destroy (shard->entries);
+			shard->entries = NULL;
+		}
 	}
+
+	g_mutex_unlock (&shard->lock);
 }
 
 /**
@@ -170,11 +296,20 @@ ggit_repository_finalize (GObject *object)
 	g_clear_object (&priv->workdir);
 	g_clear_object (&priv->clone_options);
 
+	_ggit_attribute_cache_free (priv->attribute_cache);
+	g_mutex_clear (&priv->attribute_lock);
+
+	_ggit_object_cache_free (priv->object_cache);
+
+	g_clear_pointer (&priv->reachability_index, _ggit_reachability_index_unref);
+	g_clear_pointer (&priv->commit_graph, ggit_commit_graph_unref);
+	g_mutex_clear (&priv->commit_graph_lock);
+
 	repo = _ggit_native_get (object);
 
 	if (repo != NULL)
 	{
-		unregister_repository (repo);
+		unregister_repository (repo, repository);
 	}
 
 	G_OBJECT_CLASS (ggit_repository_parent_class)->finalize (object);
@@ -384,6 +519,14 @@ ggit_repository_class_init (GgitRepositoryClass *klass)
 static void
 ggit_repository_init (GgitRepository *repository)
 {
+	GgitRepositoryPrivate *priv;
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	g_mutex_init (&priv->attribute_lock);
+	g_mutex_init (&priv->commit_graph_lock);
+
+	priv->object_cache = _ggit_object_cache_new ();
 }
 
 static gboolean
@@ -465,6 +608,15 @@ ggit_repository_initable_init (GInitable    *initable,
 		priv->workdir = ggit_repository_get_workdir (GGIT_REPOSITORY (initable));
 	}
 
+	if (success)
+	{
+		GgitRepository *existing;
+
+		/* Cannot be registered already, repo was just opened */
+		existing = register_repository (repo, GGIT_REPOSITORY (initable));
+		g_warn_if_fail (existing == NULL);
+	}
+
 	return success;
 }
 
@@ -485,7 +637,7 @@ _ggit_repository_wrap (git_repository *repository,
 
 	if (ret != NULL)
 	{
-		return g_object_ref (ret);
+		return ret;
 	}
 
 	ret = g_object_new (GGIT_TYPE_REPOSITORY,
@@ -498,15 +650,23 @@ _ggit_repository_wrap (git_repository *repository,
 
 	if (owned)
 	{
+		GgitRepository *existing;
+
+		/* Another thread may have wrapped it meanwhile. ret does not
+		 * own the repository yet, so it can simply be dropped.
+		 */
+		existing = register_repository (repository, ret);
+
+		if (existing != NULL)
+		{
+			g_object_unref (ret);
+			return existing;
+		}
+
 		_ggit_native_set_destroy_func (ret,
 		                               (GDestroyNotify)git_repository_free);
 	}
 
-	if (owned)
-	{
-		register_repository (repository, ret);
-	}
-
 	return ret;
 }
 
@@ -609,6 +769,266 @@ ggit_repository_clone (const gchar       *url,
 	                       NULL);
 }
 
+typedef struct
+{
+	gchar *url;
+	gchar *path;
+	GgitCloneOptions *options;
+} CloneData;
+
+static void
+clone_data_free (CloneData *data)
+{
+	g_free (data->url);
+	g_free (data->path);
+	g_clear_object (&data->options);
+
+	g_slice_free (CloneData, data);
+}
+
+static void
+clone_thread (GTask        *task,
+              gpointer      source_object,
+              gpointer      task_data,
+              GCancellable *cancellable)
+{
+	CloneData *data = task_data;
+	git_clone_options options = GIT_CLONE_OPTIONS_INIT;
+	git_repository *repo;
+	gint ret;
+
+	if (data->options != NULL)
+	{
+		options = *_ggit_clone_options_get_native (data->options);
+	}
+
+	_ggit_async_wrap_remote_callbacks (&options.fetch_opts.callbacks);
+	_ggit_async_wrap_checkout_options (&options.checkout_opts);
+
+	ret = git_clone (&repo, data->url, data->path, &options);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_async_return_error (task, ret);
+		return;
+	}
+
+	g_task_return_pointer (task, repo, (GDestroyNotify)git_repository_free);
+}
+
+/**
+ * ggit_repository_clone_async:
+ * @url: url to fetch the repository from.
+ * @location: the location of the repository.
+ * @options: (allow-none): a #GgitCloneOptions.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            repository has been cloned.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously clones a new git repository in the given folder. See
+ * ggit_repository_clone() for the synchronous version.
+ *
+ * The clone runs on the libgit2-glib worker pool, so the remote callbacks of
+ * @options are invoked from a worker thread. Cancelling @cancellable aborts
+ * the transfer and the checkout of the cloned files.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_repository_clone_finish() to get the result of the operation.
+ */
+void
+ggit_repository_clone_async (const gchar         *url,
+                             GFile               *location,
+                             GgitCloneOptions    *options,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+	GTask *task;
+	CloneData *data;
+
+	g_return_if_fail (url != NULL);
+	g_return_if_fail (G_IS_FILE (location));
+	g_return_if_fail (options == NULL || GGIT_IS_CLONE_OPTIONS (options));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_clone_async);
+
+	data = g_slice_new0 (CloneData);
+	data->url = g_strdup (url);
+	data->path = g_file_get_path (location);
+	data->options = options != NULL ? g_object_ref (options) : NULL;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)clone_data_free);
+
+	if (data->path == NULL)
+	{
+		g_task_return_new_error (task, GGIT_ERROR, GGIT_ERROR_NOTFOUND,
+		                         "The clone location must be a local path");
+	}
+	else
+	{
+		_ggit_async_run (task, clone_thread);
+	}
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_clone_finish:
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_clone_async().
+ *
+ * Returns: (transfer full) (nullable): a newly created #GgitRepository or
+ * %NULL if there was an error.
+ */
+GgitRepository *
+ggit_repository_clone_finish (GAsyncResult  *result,
+                              GError       **error)
+{
+	git_repository *repo;
+
+	g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+	g_return_val_if_fail (g_async_result_is_tagged (result, ggit_repository_clone_async), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	repo = g_task_propagate_pointer (G_TASK (result), error);
+
+	if (repo == NULL)
+	{
+		return NULL;
+	}
+
+	return _ggit_repository_wrap (repo, TRUE);
+}
+
+/*
+ * _ggit_repository_lookup_cached_object:
+ * @repository: a #GgitRepository.
+ * @id: the object id.
+ * @type: the object type, or GIT_OBJ_ANY.
+ *
+ * Returns: (transfer full) (nullable): the live wrapper of @id if the object
+ * cache is enabled and knows it, %NULL otherwise.
+ */
+GgitObject *
+_ggit_repository_lookup_cached_object (GgitRepository *repository,
+                                       const git_oid  *id,
+                                       git_otype       type)
+{
+	GgitRepositoryPrivate *priv;
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	return _ggit_object_cache_lookup (priv->object_cache, id, type);
+}
+
+/*
+ * _ggit_repository_wrap_object:
+ * @repository: a #GgitRepository.
+ * @obj: (transfer full): a git_object of @repository.
+ *
+ * Wraps @obj like ggit_utils_create_real_object() and adds the wrapper to
+ * the object cache of @repository. Use
+ * _ggit_repository_lookup_cached_object() first to avoid creating a
+ * wrapper at all.
+ *
+ * Returns: (transfer full) (nullable): a #GgitObject.
+ */
+GgitObject *
+_ggit_repository_wrap_object (GgitRepository *repository,
+                              git_object     *obj)
+{
+	GgitRepositoryPrivate *priv;
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	return _ggit_object_cache_insert (priv->object_cache,
+	                                  ggit_utils_create_real_object (obj, TRUE));
+}
+
+/**
+ * ggit_repository_set_object_cache_size:
+ * @repository: a #GgitRepository.
+ * @size: the number of objects to keep alive, or 0 to disable the cache.
+ *
+ * Enables reuse of object wrappers. While enabled, looking up an object
+ * (ggit_repository_lookup(), ggit_repository_lookup_commit(),
+ * ggit_repository_revparse(), ...) which is still alive returns the
+ * existing #GgitObject instead of creating a new one. On top of that, the
+ * @size most recently looked up objects are kept alive by the cache.
+ *
+ * The cache is disabled by default.
+ *
+ **/
+void
+ggit_repository_set_object_cache_size (GgitRepository *repository,
+                                       guint           size)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	_ggit_object_cache_set_capacity (priv->object_cache, size);
+}
+
+/**
+ * ggit_repository_get_object_cache_size:
+ * @repository: a #GgitRepository.
+ *
+ * Gets the number of objects kept alive by the object cache, see
+ * ggit_repository_set_object_cache_size().
+ *
+ * Returns: the object cache size, 0 if it is disabled.
+ *
+ **/
+guint
+ggit_repository_get_object_cache_size (GgitRepository *repository)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), 0);
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	return _ggit_object_cache_get_capacity (priv->object_cache);
+}
+
+/**
+ * ggit_repository_get_object_cache_stats:
+ * @repository: a #GgitRepository.
+ * @hits: (out) (optional): return location for the number of lookups
+ *        which returned an existing object.
+ * @misses: (out) (optional): return location for the number of lookups
+ *          which created a new object.
+ * @n_objects: (out) (optional): return location for the number of live
+ *             objects currently tracked by the cache.
+ *
+ * Get the statistics of the object cache, see
+ * ggit_repository_set_object_cache_size().
+ *
+ **/
+void
+ggit_repository_get_object_cache_stats (GgitRepository *repository,
+                                        guint64        *hits,
+                                        guint64        *misses,
+                                        guint          *n_objects)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	_ggit_object_cache_get_stats (priv->object_cache, hits, misses, n_objects);
+}
+
 /**
  * ggit_repository_lookup:
  * @repository: a #GgitRepository.
@@ -644,6 +1064,13 @@ ggit_repository_lookup (GgitRepository  *repository,
 	id = (const git_oid *)_ggit_oid_get_oid (oid);
 	otype = ggit_utils_get_otype_from_gtype (gtype);
 
+	object = _ggit_repository_lookup_cached_object (repository, id, otype);
+
+	if (object != NULL)
+	{
+		return object;
+	}
+
 	ret = git_object_lookup (&obj,
 	                         _ggit_native_get (repository),
 	                         id,
@@ -651,7 +1078,7 @@ ggit_repository_lookup (GgitRepository  *repository,
 
 	if (ret == GIT_OK)
 	{
-		object = ggit_utils_create_real_object (obj, TRUE);
+		object = _ggit_repository_wrap_object (repository, obj);
 	}
 	else
 	{
@@ -688,16 +1115,23 @@ ggit_repository_revparse (GgitRepository  *repository,
 
 	ret = git_revparse_single (&obj, _ggit_native_get (repository), spec);
 
-	if (ret == GIT_OK)
+	if (ret != GIT_OK)
 	{
-		object = ggit_utils_create_real_object (obj, TRUE);
+		_ggit_error_set (error, ret);
+		return NULL;
 	}
-	else
+
+	object = _ggit_repository_lookup_cached_object (repository,
+	                                                git_object_id (obj),
+	                                                git_object_type (obj));
+
+	if (object != NULL)
 	{
-		_ggit_error_set (error, ret);
+		git_object_free (obj);
+		return object;
 	}
 
-	return object;
+	return _ggit_repository_wrap_object (repository, obj);
 }
 
 /**
@@ -1304,10 +1738,22 @@ ggit_repository_file_status_foreach (GgitRepository     *repository,
 	g_return_val_if_fail (callback != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_status_foreach_ext (_ggit_native_get (repository),
-	                              _ggit_status_options_get_status_options (options),
-	                              callback,
-	                              user_data);
+	if (options != NULL && ggit_status_options_get_untracked_cache (options) != NULL)
+	{
+		ret = _ggit_untracked_cache_status_foreach (ggit_status_options_get_untracked_cache (options),
+		                                            _ggit_native_get (repository),
+		                                            _ggit_status_options_get_status_options (options),
+		                                            ggit_status_options_get_changed_paths (options),
+		                                            (git_status_cb)callback,
+		                                            user_data);
+	}
+	else
+	{
+		ret = git_status_foreach_ext (_ggit_native_get (repository),
+		                              _ggit_status_options_get_status_options (options),
+		                              callback,
+		                              user_data);
+	}
 
 	if (ret != GIT_OK)
 	{
@@ -1991,11 +2437,20 @@ ggit_repository_lookup_blob (GgitRepository *repository,
 	gint ret;
 	git_blob *blob;
 	const git_oid *id;
+	GgitObject *cached;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
 	id = (const git_oid *)_ggit_oid_get_oid (oid);
+
+	cached = _ggit_repository_lookup_cached_object (repository, id, GIT_OBJ_BLOB);
+
+	if (cached != NULL)
+	{
+		return GGIT_BLOB (cached);
+	}
+
 	ret = git_blob_lookup (&blob,
 	                       _ggit_native_get (repository),
 	                       id);
@@ -2006,32 +2461,68 @@ ggit_repository_lookup_blob (GgitRepository *repository,
 		return NULL;
 	}
 
-	return _ggit_blob_wrap (blob, TRUE);
+	return GGIT_BLOB (_ggit_repository_wrap_object (repository,
+	                                                (git_object *)blob));
 }
 
 /**
- * ggit_repository_lookup_commit:
+ * ggit_repository_open_blob:
  * @repository: a #GgitRepository.
  * @oid: a #GgitOId.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Lookups a branch by its name in a repository.
+ * Opens the blob @oid for reading. Unlike ggit_repository_lookup_blob(),
+ * a loose blob is inflated while it is read, so that reading only a prefix
+ * or a range of a large blob does not load all of it in memory.
  *
- * Returns: (transfer full) (nullable): a #GgitCommit pointer.
+ * Returns: (transfer full) (nullable): a #GgitBlobInputStream or %NULL.
  */
-GgitCommit *
-ggit_repository_lookup_commit (GgitRepository *repository,
-                               GgitOId        *oid,
-                               GError         **error)
+GgitBlobInputStream *
+ggit_repository_open_blob (GgitRepository  *repository,
+                           GgitOId         *oid,
+                           GError         **error)
 {
-	gint ret;
-	git_commit *commit;
-	const git_oid *id;
-
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return _ggit_blob_input_stream_new (repository,
+	                                    (const git_oid *)_ggit_oid_get_oid (oid),
+	                                    error);
+}
+
+/**
+ * ggit_repository_lookup_commit:
+ * @repository: a #GgitRepository.
+ * @oid: a #GgitOId.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Lookups a branch by its name in a repository.
+ *
+ * Returns: (transfer full) (nullable): a #GgitCommit pointer.
+ */
+GgitCommit *
+ggit_repository_lookup_commit (GgitRepository *repository,
+                               GgitOId        *oid,
+                               GError         **error)
+{
+	gint ret;
+	git_commit *commit;
+	const git_oid *id;
+	GgitObject *cached;
+
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
 	id = (const git_oid *)_ggit_oid_get_oid (oid);
+
+	cached = _ggit_repository_lookup_cached_object (repository, id, GIT_OBJ_COMMIT);
+
+	if (cached != NULL)
+	{
+		return GGIT_COMMIT (cached);
+	}
+
 	ret = git_commit_lookup (&commit,
 	                         _ggit_native_get (repository),
 	                         id);
@@ -2042,7 +2533,8 @@ ggit_repository_lookup_commit (GgitRepository *repository,
 		return NULL;
 	}
 
-	return _ggit_commit_wrap (commit, TRUE);
+	return GGIT_COMMIT (_ggit_repository_wrap_object (repository,
+	                                                  (git_object *)commit));
 }
 
 /**
@@ -2063,11 +2555,20 @@ ggit_repository_lookup_tag (GgitRepository *repository,
 	gint ret;
 	git_tag *tag;
 	const git_oid *id;
+	GgitObject *cached;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
 	id = (const git_oid *)_ggit_oid_get_oid (oid);
+
+	cached = _ggit_repository_lookup_cached_object (repository, id, GIT_OBJ_TAG);
+
+	if (cached != NULL)
+	{
+		return GGIT_TAG (cached);
+	}
+
 	ret = git_tag_lookup (&tag,
 	                      _ggit_native_get (repository),
 	                      id);
@@ -2078,7 +2579,8 @@ ggit_repository_lookup_tag (GgitRepository *repository,
 		return NULL;
 	}
 
-	return _ggit_tag_wrap (tag, TRUE);
+	return GGIT_TAG (_ggit_repository_wrap_object (repository,
+	                                               (git_object *)tag));
 }
 
 /**
@@ -2099,11 +2601,20 @@ ggit_repository_lookup_tree (GgitRepository *repository,
 	gint ret;
 	git_tree *tree;
 	const git_oid *id;
+	GgitObject *cached;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
 	id = (const git_oid *)_ggit_oid_get_oid (oid);
+
+	cached = _ggit_repository_lookup_cached_object (repository, id, GIT_OBJ_TREE);
+
+	if (cached != NULL)
+	{
+		return GGIT_TREE (cached);
+	}
+
 	ret = git_tree_lookup (&tree,
 	                       _ggit_native_get (repository),
 	                       id);
@@ -2114,7 +2625,8 @@ ggit_repository_lookup_tree (GgitRepository *repository,
 		return NULL;
 	}
 
-	return _ggit_tree_wrap (tree, TRUE);
+	return GGIT_TREE (_ggit_repository_wrap_object (repository,
+	                                                (git_object *)tree));
 }
 
 /**
@@ -2899,6 +3411,371 @@ ggit_repository_stash_foreach (GgitRepository     *repository,
 	return TRUE;
 }
 
+static GgitCommitGraph *
+get_commit_graph (GgitRepository *repository)
+{
+	GgitRepositoryPrivate *priv;
+	GgitCommitGraph *graph = NULL;
+	GStatBuf st;
+	gchar *path;
+
+	priv = ggit_repository_get_instance_private (repository);
+	path = _ggit_commit_graph_get_path (_ggit_native_get (repository));
+
+	g_mutex_lock (&priv->commit_graph_lock);
+
+	/* The file is replaced when written, by us or by git */
+	if (g_stat (path, &st) != 0)
+	{
+		g_clear_pointer (&priv->commit_graph, ggit_commit_graph_unref);
+	}
+	else if (priv->commit_graph == NULL ||
+	         !_ggit_commit_graph_is_current (priv->commit_graph, &st))
+	{
+		g_clear_pointer (&priv->commit_graph, ggit_commit_graph_unref);
+
+		/* Unsupported files are ignored, libgit2 walks the commits */
+		priv->commit_graph = _ggit_commit_graph_open (path, NULL);
+	}
+
+	if (priv->commit_graph != NULL)
+	{
+		graph = ggit_commit_graph_ref (priv->commit_graph);
+	}
+
+	g_mutex_unlock (&priv->commit_graph_lock);
+	g_free (path);
+
+	return graph;
+}
+
+/**
+ * ggit_repository_get_commit_graph:
+ * @repository: a #GgitRepository.
+ *
+ * Gets the commit-graph of @repository, reloading it if the file was
+ * replaced since it was last used. Only single file commit-graphs, as
+ * written by ggit_repository_write_commit_graph() or by
+ * `git commit-graph write` without `--split`, are supported.
+ *
+ * Returns: (transfer full) (nullable): a #GgitCommitGraph or %NULL if the
+ * repository has no supported commit-graph.
+ */
+GgitCommitGraph *
+ggit_repository_get_commit_graph (GgitRepository *repository)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+
+	return get_commit_graph (repository);
+}
+
+/**
+ * ggit_repository_write_commit_graph:
+ * @repository: a #GgitRepository.
+ * @cancellable: (nullable): a #GCancellable, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes the commit-graph of @repository, an index of all the commits
+ * reachable from its references and HEAD, in the format of
+ * `git commit-graph`. Graph queries such as
+ * ggit_repository_get_ahead_behind(), ggit_repository_get_descendant_of()
+ * and ggit_repository_merge_base() then run from the memory mapped graph
+ * instead of parsing commits. Commits created after the graph was written
+ * are not in it, call this function again after a fetch or a series of
+ * commits to refresh it.
+ *
+ * Returns: %TRUE if the commit-graph was written, %FALSE if there was an
+ * error.
+ */
+gboolean
+ggit_repository_write_commit_graph (GgitRepository  *repository,
+                                    GCancellable    *cancellable,
+                                    GError         **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return _ggit_commit_graph_write (_ggit_native_get (repository),
+	                                 cancellable,
+	                                 error);
+}
+
+static GgitReachabilityIndex *
+get_reachability_index (GgitRepository *repository)
+{
+	GgitRepositoryPrivate *priv;
+	GgitReachabilityIndex *index = NULL;
+	GgitCommitGraph *graph;
+	GStatBuf st;
+	gchar *path;
+
+	/* The index is only usable with the graph it was built from */
+	graph = get_commit_graph (repository);
+
+	if (graph == NULL)
+	{
+		return NULL;
+	}
+
+	priv = ggit_repository_get_instance_private (repository);
+	path = _ggit_reachability_index_get_path (_ggit_native_get (repository));
+
+	g_mutex_lock (&priv->commit_graph_lock);
+
+	if (g_stat (path, &st) != 0)
+	{
+		g_clear_pointer (&priv->reachability_index, _ggit_reachability_index_unref);
+	}
+	else if (priv->reachability_index == NULL ||
+	         !_ggit_reachability_index_is_current (priv->reachability_index, &st, graph))
+	{
+		g_clear_pointer (&priv->reachability_index, _ggit_reachability_index_unref);
+		priv->reachability_index = _ggit_reachability_index_open (path, graph, NULL);
+	}
+
+	if (priv->reachability_index != NULL)
+	{
+		index = _ggit_reachability_index_ref (priv->reachability_index);
+	}
+
+	g_mutex_unlock (&priv->commit_graph_lock);
+
+	g_free (path);
+	ggit_commit_graph_unref (graph);
+
+	return index;
+}
+
+/**
+ * ggit_repository_write_reachability_index:
+ * @repository: a #GgitRepository.
+ * @cancellable: (nullable): a #GCancellable, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes the reachability index of @repository, which stores for each ref,
+ * and for commits along the history of the refs, the set of commits it can
+ * reach as a compressed bitmap. The commit-graph is written first, see
+ * ggit_repository_write_commit_graph(), since the index refers to the
+ * commits by their position in it.
+ *
+ * ggit_repository_get_descendant_of_many() and
+ * ggit_repository_get_ahead_behind_many() then answer for many refs at
+ * once with bitmap operations. Like the commit-graph, the index only
+ * covers the commits which existed when it was written, call this function
+ * again after a fetch to refresh it.
+ *
+ * Returns: %TRUE if the index was written, %FALSE if there was an error.
+ */
+gboolean
+ggit_repository_write_reachability_index (GgitRepository  *repository,
+                                          GCancellable    *cancellable,
+                                          GError         **error)
+{
+	GgitCommitGraph *graph;
+	git_repository *repo;
+	gboolean success;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	repo = _ggit_native_get (repository);
+
+	if (!_ggit_commit_graph_write (repo, cancellable, error))
+	{
+		return FALSE;
+	}
+
+	graph = get_commit_graph (repository);
+
+	if (graph == NULL)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_FAILED,
+		                     "Could not load the commit-graph");
+
+		return FALSE;
+	}
+
+	success = _ggit_reachability_index_write (repo, graph, cancellable, error);
+	ggit_commit_graph_unref (graph);
+
+	return success;
+}
+
+/**
+ * ggit_repository_get_descendant_of_many:
+ * @repository: a #GgitRepository.
+ * @commits: (array length=n_commits): the commits.
+ * @n_commits: the number of commits.
+ * @ancestor: the ancestor.
+ * @results: (out caller-allocates) (array length=n_commits): return
+ *           location for whether each commit is a descendant of @ancestor.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Checks which of @commits are descendants of @ancestor, such as which
+ * branches contain a commit. Each result is the one of
+ * ggit_repository_get_descendant_of(), so a commit is not a descendant of
+ * itself.
+ *
+ * The commits covered by the reachability index of the repository, see
+ * ggit_repository_write_reachability_index(), are answered together from
+ * their bitmaps. The others are checked one by one.
+ *
+ * Returns: %TRUE if @results was filled, %FALSE if there was an error.
+ */
+gboolean
+ggit_repository_get_descendant_of_many (GgitRepository  *repository,
+                                        GgitOId        **commits,
+                                        gsize            n_commits,
+                                        GgitOId         *ancestor,
+                                        gboolean        *results,
+                                        GError         **error)
+{
+	GgitReachabilityIndex *index;
+	gboolean *answered;
+	gsize i;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (commits != NULL || n_commits == 0, FALSE);
+	g_return_val_if_fail (ancestor != NULL, FALSE);
+	g_return_val_if_fail (results != NULL || n_commits == 0, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	answered = g_new0 (gboolean, n_commits);
+	index = get_reachability_index (repository);
+
+	if (index != NULL)
+	{
+		_ggit_reachability_index_descendant_of_many (index,
+		                                             commits,
+		                                             n_commits,
+		                                             ancestor,
+		                                             results,
+		                                             answered);
+
+		_ggit_reachability_index_unref (index);
+	}
+
+	for (i = 0; i < n_commits; i++)
+	{
+		GError *err = NULL;
+
+		if (answered[i])
+		{
+			continue;
+		}
+
+		results[i] = ggit_repository_get_descendant_of (repository,
+		                                                commits[i],
+		                                                ancestor,
+		                                                &err);
+
+		if (err != NULL)
+		{
+			g_propagate_error (error, err);
+			g_free (answered);
+
+			return FALSE;
+		}
+	}
+
+	g_free (answered);
+
+	return TRUE;
+}
+
+/**
+ * ggit_repository_get_ahead_behind_many:
+ * @repository: a #GgitRepository.
+ * @locals: (array length=n_locals): the local commits.
+ * @n_locals: the number of local commits.
+ * @upstream: the commit for upstream.
+ * @ahead: (out caller-allocates) (array length=n_locals): return location
+ *         for the number of commits only reachable from each local commit.
+ * @behind: (out caller-allocates) (array length=n_locals): return location
+ *          for the number of commits only reachable from @upstream.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Counts the unique commits between each of @locals and @upstream, such
+ * as every branch against the main branch. Each result is the one of
+ * ggit_repository_get_ahead_behind().
+ *
+ * The commits covered by the reachability index of the repository, see
+ * ggit_repository_write_reachability_index(), are counted together from
+ * their bitmaps. The others are counted one by one.
+ *
+ * Returns: %TRUE if @ahead and @behind were filled, %FALSE if there was an
+ * error.
+ */
+gboolean
+ggit_repository_get_ahead_behind_many (GgitRepository  *repository,
+                                       GgitOId        **locals,
+                                       gsize            n_locals,
+                                       GgitOId         *upstream,
+                                       gsize           *ahead,
+                                       gsize           *behind,
+                                       GError         **error)
+{
+	GgitReachabilityIndex *index;
+	gboolean *answered;
+	gsize i;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (locals != NULL || n_locals == 0, FALSE);
+	g_return_val_if_fail (upstream != NULL, FALSE);
+	g_return_val_if_fail (ahead != NULL || n_locals == 0, FALSE);
+	g_return_val_if_fail (behind != NULL || n_locals == 0, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	answered = g_new0 (gboolean, n_locals);
+	index = get_reachability_index (repository);
+
+	if (index != NULL)
+	{
+		_ggit_reachability_index_ahead_behind_many (index,
+		                                            locals,
+		                                            n_locals,
+		                                            upstream,
+		                                            ahead,
+		                                            behind,
+		                                            answered);
+
+		_ggit_reachability_index_unref (index);
+	}
+
+	for (i = 0; i < n_locals; i++)
+	{
+		GError *err = NULL;
+
+		if (answered[i])
+		{
+			continue;
+		}
+
+		ggit_repository_get_ahead_behind (repository,
+		                                  locals[i],
+		                                  upstream,
+		                                  &ahead[i],
+		                                  &behind[i],
+		                                  &err);
+
+		if (err != NULL)
+		{
+			g_propagate_error (error, err);
+			g_free (answered);
+
+			return FALSE;
+		}
+	}
+
+	g_free (answered);
+
+	return TRUE;
+}
+
 /**
  * ggit_repository_get_ahead_behind:
  * @repository: a #GgitRepository.
@@ -2914,6 +3791,9 @@ ggit_repository_stash_foreach (GgitRepository     *repository,
  * upstream relationship, but it helps to think of one as a branch and
  * the other as its upstream, the @ahead and @behind values will be
  * what git would report for the branches.
+ *
+ * The commit-graph of the repository is used when both commits are in it,
+ * see ggit_repository_write_commit_graph().
  */
 void
 ggit_repository_get_ahead_behind (GgitRepository  *repository,
@@ -2923,6 +3803,7 @@ ggit_repository_get_ahead_behind (GgitRepository  *repository,
                                   gsize           *behind,
                                   GError         **error)
 {
+	GgitCommitGraph *graph;
 	gint ret;
 
 	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
@@ -2932,6 +3813,26 @@ ggit_repository_get_ahead_behind (GgitRepository  *repository,
 	g_return_if_fail (behind != NULL);
 	g_return_if_fail (error == NULL || *error == NULL);
 
+	graph = get_commit_graph (repository);
+
+	if (graph != NULL)
+	{
+		gboolean done;
+
+		done = _ggit_commit_graph_ahead_behind (graph,
+		                                        _ggit_oid_get_oid (local),
+		                                        _ggit_oid_get_oid (upstream),
+		                                        ahead,
+		                                        behind);
+
+		ggit_commit_graph_unref (graph);
+
+		if (done)
+		{
+			return;
+		}
+	}
+
 	ret = git_graph_ahead_behind (ahead, behind,
 	                              _ggit_native_get (repository),
 	                              _ggit_oid_get_oid (local),
@@ -2952,7 +3853,8 @@ ggit_repository_get_ahead_behind (GgitRepository  *repository,
  *
  * Check whether @com mit is a descendant of @ancestor. Note that if this
  * function returns %FALSE, an error might have occurred. If so, @error will
- * be set appropriately.
+ * be set appropriately. The commit-graph of the repository is used when
+ * both commits are in it, see ggit_repository_write_commit_graph().
  *
  * Returns: %TRUE if @commit is a descendant of @ancestor, or %FALSE otherwise.
  *
@@ -2963,6 +3865,7 @@ ggit_repository_get_descendant_of (GgitRepository  *repository,
                                    GgitOId         *ancestor,
                                    GError         **error)
 {
+	GgitCommitGraph *graph;
 	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
@@ -2970,6 +3873,26 @@ ggit_repository_get_descendant_of (GgitRepository  *repository,
 	g_return_val_if_fail (ancestor != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	graph = get_commit_graph (repository);
+
+	if (graph != NULL)
+	{
+		gboolean result;
+		gboolean done;
+
+		done = _ggit_commit_graph_descendant_of (graph,
+		                                         _ggit_oid_get_oid (commit),
+		                                         _ggit_oid_get_oid (ancestor),
+		                                         &result);
+
+		ggit_commit_graph_unref (graph);
+
+		if (done)
+		{
+			return result;
+		}
+	}
+
 	ret = git_graph_descendant_of (_ggit_native_get (repository),
 	                               _ggit_oid_get_oid (commit),
 	                               _ggit_oid_get_oid (ancestor));
@@ -3007,6 +3930,29 @@ ggit_repository_create_blob (GgitRepository *repository)
 	return _ggit_blob_output_stream_new (repository);
 }
 
+/**
+ * ggit_repository_create_blob_with_size:
+ * @repository: a #GgitRepository.
+ * @size: the exact number of bytes that will be written.
+ *
+ * Like ggit_repository_create_blob(), but for a blob of which the size is
+ * known in advance, such as a file. The contents are then hashed and
+ * compressed while they are written instead of first being copied to a
+ * temporary file, which matters for large blobs. Writing more than @size
+ * bytes fails, and so does closing the stream after writing less.
+ *
+ * Returns: (transfer full) (nullable): a #GgitBlobOutputStream.
+ */
+GgitBlobOutputStream *
+ggit_repository_create_blob_with_size (GgitRepository *repository,
+                                       guint64         size)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (size <= G_MAXINT64, NULL);
+
+	return _ggit_blob_output_stream_new_with_size (repository, size);
+}
+
 /**
  * ggit_repository_create_blob_from_buffer:
  * @repository: a #GgitRepository.
@@ -3124,22 +4070,673 @@ ggit_repository_create_blob_from_path (GgitRepository  *repository,
 	return _ggit_oid_wrap (&oid);
 }
 
-/**
- * ggit_repository_create_commit:
- * @repository: a #GgitRepository.
- * @update_ref: (allow-none): name of the reference to update.
- * @author: author signature.
- * @committer: committer signature (and time of commit).
- * @message_encoding: (allow-none): message encoding.
- * @message: commit message.
- * @tree: the tree of objects to commit.
- * @parents: (array length=parent_count): parent commits.
- * @parent_count: number of parent commits in @parents.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Create a new commit. If @update_ref is not %NULL, the given reference will
- * be updated to point to the newly created commit. Use "HEAD" to update the
- * HEAD of the current branch and make it point to this commit.
+typedef struct
+{
+	gchar *path;
+	git_oid id;
+
+	/* Index of the job with the same path, or -1 */
+	gint same_as;
+
+	GError *error;
+} BlobJob;
+
+typedef struct
+{
+	const gchar *repo_path;
+	GCancellable *cancellable;
+
+	BlobJob *jobs;
+	gint n_jobs;
+	gint next_job;
+
+	/* Guards written, pack_stream and n_packed */
+	GMutex mutex;
+	GgitOIdTable written;
+
+	/* The compressed pack entries, without the pack header, when
+	 * writing a pack */
+	GOutputStream *pack_stream;
+	guint32 n_packed;
+} BlobState;
+
+/* The type and size header of an undeltified pack entry */
+static void
+append_pack_entry_header (GByteArray *entry,
+                          gsize       size)
+{
+	guint8 c;
+
+	c = (GIT_OBJ_BLOB << 4) | (size & 0x0f);
+	size >>= 4;
+
+	while (size != 0)
+	{
+		c |= 0x80;
+		g_byte_array_append (entry, &c, 1);
+
+		c = size & 0x7f;
+		size >>= 7;
+	}
+
+	g_byte_array_append (entry, &c, 1);
+}
+
+/* Appends the zlib compressed @data to @entry */
+static gboolean
+append_deflated (GConverter  *compressor,
+                 const gchar *data,
+                 gsize        len,
+                 GByteArray  *entry,
+                 GError     **error)
+{
+	gsize used = entry->len;
+
+	g_converter_reset (compressor);
+	g_byte_array_set_size (entry, used + len / 2 + 64);
+
+	while (TRUE)
+	{
+		GConverterResult result;
+		GError *local_error = NULL;
+		gsize bytes_read;
+		gsize bytes_written;
+
+		result = g_converter_convert (compressor,
+		                              data, len,
+		                              entry->data + used, entry->len - used,
+		                              G_CONVERTER_INPUT_AT_END,
+		                              &bytes_read, &bytes_written,
+		                              &local_error);
+
+		if (result == G_CONVERTER_ERROR)
+		{
+			if (!g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+			{
+				g_propagate_error (error, local_error);
+				return FALSE;
+			}
+
+			g_error_free (local_error);
+			g_byte_array_set_size (entry, entry->len * 2);
+			continue;
+		}
+
+		data += bytes_read;
+		len -= bytes_read;
+		used += bytes_written;
+
+		if (result == G_CONVERTER_FINISHED)
+		{
+			break;
+		}
+
+		if (used == entry->len)
+		{
+			g_byte_array_set_size (entry, entry->len * 2);
+		}
+	}
+
+	g_byte_array_set_size (entry, used);
+	return TRUE;
+}
+
+/* Compresses the blob on the calling worker, only appending the finished
+ * entry to the pack is serialized.
+ */
+static gboolean
+blob_job_pack (BlobState   *state,
+               BlobJob     *job,
+               const gchar *data,
+               gsize        len,
+               GConverter  *compressor,
+               GByteArray  *entry)
+{
+	gboolean ret;
+
+	g_byte_array_set_size (entry, 0);
+	append_pack_entry_header (entry, len);
+
+	if (!append_deflated (compressor, data, len, entry, &job->error))
+	{
+		return FALSE;
+	}
+
+	g_mutex_lock (&state->mutex);
+
+	ret = g_output_stream_write_all (state->pack_stream,
+	                                 entry->data,
+	                                 entry->len,
+	                                 NULL,
+	                                 state->cancellable,
+	                                 &job->error);
+
+	if (ret)
+	{
+		state->n_packed++;
+	}
+
+	g_mutex_unlock (&state->mutex);
+
+	return ret;
+}
+
+/* Reads the file into @contents. Unlike mapping it, this copes with the
+ * file being truncated while it is read, which only changes what is read.
+ */
+static gboolean
+read_file_contents (const gchar  *path,
+                    GByteArray   *contents,
+                    GError      **error)
+{
+	FILE *file;
+	GStatBuf st;
+	gsize used = 0;
+
+	file = g_fopen (path, "rb");
+
+	if (file == NULL)
+	{
+		gint saved_errno = errno;
+
+		g_set_error (error,
+		             G_IO_ERROR,
+		             g_io_error_from_errno (saved_errno),
+		             "Could not open %s: %s",
+		             path,
+		             g_strerror (saved_errno));
+
+		return FALSE;
+	}
+
+	/* One more byte than the file has, so that reading it all ends
+	 * with a short read */
+	if (g_stat (path, &st) == 0)
+	{
+		g_byte_array_set_size (contents, (gsize)st.st_size + 1);
+	}
+
+	while (TRUE)
+	{
+		gsize n;
+
+		if (used == contents->len)
+		{
+			g_byte_array_set_size (contents, MAX (contents->len * 2, 65536));
+		}
+
+		n = fread (contents->data + used, 1, contents->len - used, file);
+		used += n;
+
+		if (used < contents->len)
+		{
+			break;
+		}
+	}
+
+	g_byte_array_set_size (contents, used);
+
+	if (ferror (file))
+	{
+		g_set_error (error,
+		             G_IO_ERROR,
+		             G_IO_ERROR_FAILED,
+		             "Could not read %s",
+		             path);
+
+		fclose (file);
+		return FALSE;
+	}
+
+	fclose (file);
+	return TRUE;
+}
+
+static gboolean
+blob_job_write (BlobState  *state,
+                BlobJob    *job,
+                git_odb    *odb,
+                GByteArray *contents,
+                GConverter *compressor,
+                GByteArray *entry)
+{
+	const gchar *data;
+	gsize len;
+	gboolean added;
+	gint ret;
+
+	if (!read_file_contents (job->path, contents, &job->error))
+	{
+		return FALSE;
+	}
+
+	data = (const gchar *)contents->data;
+	len = contents->len;
+
+	ret = git_odb_hash (&job->id, data, len, GIT_OBJ_BLOB);
+
+	if (ret == GIT_OK)
+	{
+		/* Identical contents are only compressed once */
+		g_mutex_lock (&state->mutex);
+		_ggit_oid_table_insert (&state->written, job->id.id, &added);
+		g_mutex_unlock (&state->mutex);
+
+		if (added && !git_odb_exists (odb, &job->id))
+		{
+			git_oid id;
+
+			if (state->pack_stream != NULL)
+			{
+				return blob_job_pack (state, job, data, len, compressor, entry);
+			}
+
+			ret = git_odb_write (&id, odb, data, len, GIT_OBJ_BLOB);
+		}
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (&job->error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gpointer
+blob_worker (gpointer user_data)
+{
+	BlobState *state = user_data;
+	git_repository *repo;
+	git_odb *odb;
+	GConverter *compressor = NULL;
+	GByteArray *contents;
+	GByteArray *entry = NULL;
+	gint ret;
+	gint i;
+
+	/* Like the index, every worker writes through its own handle */
+	ret = git_repository_open (&repo, state->repo_path);
+
+	if (ret == GIT_OK)
+	{
+		ret = git_repository_odb (&odb, repo);
+
+		if (ret != GIT_OK)
+		{
+			git_repository_free (repo);
+		}
+	}
+
+	contents = g_byte_array_new ();
+
+	if (state->pack_stream != NULL)
+	{
+		compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, -1));
+		entry = g_byte_array_new ();
+	}
+
+	while ((i = g_atomic_int_add (&state->next_job, 1)) < state->n_jobs)
+	{
+		BlobJob *job = &state->jobs[i];
+
+		if (job->same_as >= 0)
+		{
+			continue;
+		}
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (&job->error, ret);
+		}
+		else if (!g_cancellable_set_error_if_cancelled (state->cancellable, &job->error))
+		{
+			blob_job_write (state, job, odb, contents, compressor, entry);
+		}
+	}
+
+	g_clear_object (&compressor);
+	g_byte_array_unref (contents);
+
+	if (entry != NULL)
+	{
+		g_byte_array_unref (entry);
+	}
+
+	if (ret == GIT_OK)
+	{
+		git_odb_free (odb);
+		git_repository_free (repo);
+	}
+
+	return NULL;
+}
+
+static gint
+writepack_append (git_odb_writepack     *writepack,
+                  GChecksum             *checksum,
+                  const guint8          *data,
+                  gsize                  len,
+                  git_transfer_progress *stats)
+{
+	g_checksum_update (checksum, data, len);
+
+	return writepack->append (writepack, data, len, stats);
+}
+
+/* Streams the entries collected by the workers into a pack of @odb */
+static gboolean
+write_pack (BlobState     *state,
+            GFileIOStream *iostream,
+            git_odb       *odb,
+            GError       **error)
+{
+	git_transfer_progress stats = { 0 };
+	git_odb_writepack *writepack;
+	GInputStream *input;
+	GChecksum *checksum;
+	guint8 header[12] = { 'P', 'A', 'C', 'K', 0, 0, 0, 2 };
+	guint8 *buffer;
+	guint8 digest[20];
+	gsize digest_len = sizeof (digest);
+	gssize n_read = 0;
+	gint ret;
+
+	if (!g_seekable_seek (G_SEEKABLE (iostream), 0, G_SEEK_SET, state->cancellable, error))
+	{
+		return FALSE;
+	}
+
+	ret = git_odb_write_pack (&writepack, odb, NULL, NULL);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	header[8] = state->n_packed >> 24;
+	header[9] = state->n_packed >> 16;
+	header[10] = state->n_packed >> 8;
+	header[11] = state->n_packed;
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+	input = g_io_stream_get_input_stream (G_IO_STREAM (iostream));
+	buffer = g_malloc (64 * 1024);
+
+	ret = writepack_append (writepack, checksum, header, sizeof (header), &stats);
+
+	while (ret == GIT_OK &&
+	       (n_read = g_input_stream_read (input, buffer, 64 * 1024, state->cancellable, error)) > 0)
+	{
+		ret = writepack_append (writepack, checksum, buffer, n_read, &stats);
+	}
+
+	if (ret == GIT_OK && n_read == 0)
+	{
+		g_checksum_get_digest (checksum, digest, &digest_len);
+		ret = writepack->append (writepack, digest, digest_len, &stats);
+
+		if (ret == GIT_OK)
+		{
+			ret = writepack->commit (writepack, &stats);
+		}
+	}
+
+	writepack->free (writepack);
+	g_checksum_free (checksum);
+	g_free (buffer);
+
+	if (n_read < 0)
+	{
+		return FALSE;
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* The entries are collected next to the packs, the temporary directory may
+ * well be in memory.
+ */
+static GFileIOStream *
+open_pack_file (const gchar  *repo_path,
+                gchar       **filename,
+                GError      **error)
+{
+	GFileIOStream *iostream;
+	GFile *file;
+	gint fd;
+
+	*filename = g_build_filename (repo_path, "objects", "pack", "tmp_ggit_pack_XXXXXX", NULL);
+	fd = g_mkstemp (*filename);
+
+	if (fd == -1)
+	{
+		gint saved_errno = errno;
+
+		g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+		             "Could not create %s: %s", *filename, g_strerror (saved_errno));
+		g_clear_pointer (filename, g_free);
+
+		return NULL;
+	}
+
+	g_close (fd, NULL);
+
+	file = g_file_new_for_path (*filename);
+	iostream = g_file_open_readwrite (file, NULL, error);
+	g_object_unref (file);
+
+	if (iostream == NULL)
+	{
+		g_unlink (*filename);
+		g_clear_pointer (filename, g_free);
+	}
+
+	return iostream;
+}
+
+/**
+ * ggit_repository_create_blobs_from_files:
+ * @repository: a #GgitRepository.
+ * @files: (array length=n_files): the files to write.
+ * @n_files: the number of files in @files.
+ * @flags: a #GgitCreateBlobsFlags.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes many files to the object database as blobs, like
+ * ggit_repository_create_blob_from_file() does for a single one. The files
+ * are hashed and compressed on the shared worker threads. Files that are
+ * listed more than once, or that have the same contents, are only
+ * compressed once, and nothing is written for blobs that are already in the
+ * object database.
+ *
+ * By default every blob is written as a loose object. With
+ * %GGIT_CREATE_BLOBS_PACK they are written to a single pack file instead,
+ * which is faster to write and to read back when there are many of them.
+ * The compressed blobs are collected in a temporary file in the object
+ * database, only the one each thread is working on is kept in memory.
+ *
+ * Each file is read whole before it is hashed, so a file that changes
+ * during the call is written as it was when it was read.
+ *
+ * Returns: (transfer full) (array zero-terminated=1) (nullable): the ids
+ * of the blobs in the order of @files, or %NULL if writing any of them
+ * failed.
+ */
+GgitOId **
+ggit_repository_create_blobs_from_files (GgitRepository        *repository,
+                                         GFile                **files,
+                                         gsize                  n_files,
+                                         GgitCreateBlobsFlags   flags,
+                                         GCancellable          *cancellable,
+                                         GError               **error)
+{
+	git_repository *repo;
+	BlobState state = { 0 };
+	GHashTable *paths;
+	GFileIOStream *pack_file = NULL;
+	gchar *pack_filename = NULL;
+	GgitOId **ids = NULL;
+	GError *local_error = NULL;
+	gsize i;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (files != NULL || n_files == 0, NULL);
+	g_return_val_if_fail (n_files < G_MAXINT, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	repo = _ggit_native_get (repository);
+
+	state.repo_path = git_repository_path (repo);
+	state.cancellable = cancellable;
+	state.jobs = g_new0 (BlobJob, n_files);
+	state.n_jobs = n_files;
+
+	g_mutex_init (&state.mutex);
+	_ggit_oid_table_init (&state.written, FALSE);
+
+	paths = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (i = 0; i < n_files; i++)
+	{
+		BlobJob *job = &state.jobs[i];
+		gpointer first;
+
+		job->path = g_file_get_path (files[i]);
+		job->same_as = -1;
+
+		if (job->path == NULL)
+		{
+			gchar *uri = g_file_get_uri (files[i]);
+
+			g_set_error (&job->error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+			             "Could not create a blob from non-local file %s", uri);
+			g_free (uri);
+
+			/* Keep the workers from looking at it */
+			job->same_as = i;
+		}
+		else if (g_hash_table_lookup_extended (paths, job->path, NULL, &first))
+		{
+			job->same_as = GPOINTER_TO_INT (first);
+		}
+		else
+		{
+			g_hash_table_insert (paths, job->path, GINT_TO_POINTER (i));
+		}
+	}
+
+	g_hash_table_unref (paths);
+
+	if ((flags & GGIT_CREATE_BLOBS_PACK) != 0 && n_files > 0)
+	{
+		pack_file = open_pack_file (state.repo_path, &pack_filename, &local_error);
+
+		if (pack_file != NULL)
+		{
+			state.pack_stream = g_io_stream_get_output_stream (G_IO_STREAM (pack_file));
+		}
+	}
+
+	if (local_error == NULL)
+	{
+		_ggit_async_run_parallel (blob_worker, &state, MIN (g_get_num_processors (), n_files));
+	}
+
+	for (i = 0; i < n_files && local_error == NULL; i++)
+	{
+		if (state.jobs[i].error != NULL)
+		{
+			local_error = state.jobs[i].error;
+			state.jobs[i].error = NULL;
+		}
+	}
+
+	if (pack_file != NULL)
+	{
+		if (local_error == NULL && state.n_packed > 0)
+		{
+			git_odb *odb;
+			gint ret;
+
+			ret = git_repository_odb (&odb, repo);
+
+			if (ret != GIT_OK)
+			{
+				_ggit_error_set (&local_error, ret);
+			}
+			else
+			{
+				write_pack (&state, pack_file, odb, &local_error);
+				git_odb_free (odb);
+			}
+		}
+
+		g_object_unref (pack_file);
+		g_unlink (pack_filename);
+		g_free (pack_filename);
+	}
+
+	if (local_error != NULL)
+	{
+		g_propagate_error (error, local_error);
+	}
+	else
+	{
+		ids = g_new0 (GgitOId *, n_files + 1);
+
+		for (i = 0; i < n_files; i++)
+		{
+			BlobJob *job = &state.jobs[i];
+
+			if (job->same_as >= 0)
+			{
+				job = &state.jobs[job->same_as];
+			}
+
+			ids[i] = _ggit_oid_wrap (&job->id);
+		}
+	}
+
+	for (i = 0; i < n_files; i++)
+	{
+		g_free (state.jobs[i].path);
+		g_clear_error (&state.jobs[i].error);
+	}
+
+	g_free (state.jobs);
+	_ggit_oid_table_clear (&state.written, NULL);
+	g_mutex_clear (&state.mutex);
+
+	return ids;
+}
+
+/**
+ * ggit_repository_create_commit:
+ * @repository: a #GgitRepository.
+ * @update_ref: (allow-none): name of the reference to update.
+ * @author: author signature.
+ * @committer: committer signature (and time of commit).
+ * @message_encoding: (allow-none): message encoding.
+ * @message: commit message.
+ * @tree: the tree of objects to commit.
+ * @parents: (array length=parent_count): parent commits.
+ * @parent_count: number of parent commits in @parents.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new commit. If @update_ref is not %NULL, the given reference will
+ * be updated to point to the newly created commit. Use "HEAD" to update the
+ * HEAD of the current branch and make it point to this commit.
  *
  * If @message_encoding is set to %NULL, "UTF-8" encoding is assumed for the
  * provided @message. Note that @message will not be cleaned up automatically.
@@ -3545,78 +5142,287 @@ ggit_repository_create_index_entry_for_path (GgitRepository  *repository,
                                              GgitOId         *id,
                                              GError         **error)
 {
-	GgitRepositoryPrivate *priv;
-	GFile *f;
-	GgitIndexEntry *ret;
+	GgitRepositoryPrivate *priv;
+	GFile *f;
+	GgitIndexEntry *ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	if (path)
+	{
+		if (!g_path_is_absolute (path))
+		{
+			f = g_file_resolve_relative_path (priv->workdir, path);
+		}
+		else
+		{
+			f = g_file_new_for_path (path);
+		}
+	}
+	else
+	{
+		f = NULL;
+	}
+
+	ret = ggit_repository_create_index_entry_for_file (repository,
+	                                                   f,
+	                                                   id,
+	                                                   error);
+
+	g_object_unref (f);
+
+	return ret;
+}
+
+/**
+ * ggit_repository_blame_file:
+ * @repository: a #GgitRepository.
+ * @file: the file to blame.
+ * @blame_options: (allow-none): blame options.
+ * @error: a #GError.
+ *
+ * Get a blame for a single file.
+ *
+ * Returns: (transfer full) (nullable): a #GgitBlame.
+ *
+ **/
+GgitBlame *
+ggit_repository_blame_file (GgitRepository    *repository,
+                            GFile             *file,
+                            GgitBlameOptions  *blame_options,
+                            GError           **error)
+{
+	GgitRepositoryPrivate *priv;
+	git_blame *blame;
+	gchar *path;
+	int ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	path = g_file_get_relative_path (priv->workdir, file);
+
+	ret = git_blame_file (&blame,
+	                      _ggit_native_get (repository),
+	                      path,
+	                      _ggit_blame_options_get_blame_options (blame_options));
+
+	g_free (path);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_blame_wrap (blame);
+}
+
+typedef struct
+{
+	gchar *path;
+	GgitBlameOptions *options;
+} BlameData;
+
+static void
+blame_data_free (BlameData *data)
+{
+	g_free (data->path);
+
+	if (data->options != NULL)
+	{
+		ggit_blame_options_free (data->options);
+	}
+
+	g_slice_free (BlameData, data);
+}
+
+static void
+blame_file_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+	BlameData *data = task_data;
+	git_blame *blame;
+	gint ret;
+
+	ret = git_blame_file (&blame,
+	                      _ggit_native_get (source_object),
+	                      data->path,
+	                      _ggit_blame_options_get_blame_options (data->options));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_async_return_error (task, ret);
+		return;
+	}
+
+	g_task_return_pointer (task, blame, (GDestroyNotify)git_blame_free);
+}
+
+/**
+ * ggit_repository_blame_file_async:
+ * @repository: a #GgitRepository.
+ * @file: the file to blame.
+ * @blame_options: (allow-none): blame options.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            blame is ready.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously gets a blame for a single file. See
+ * ggit_repository_blame_file() for the synchronous version.
+ *
+ * libgit2 does not report progress while blaming, so cancelling
+ * @cancellable only has an effect when the operation has not started
+ * running yet. @repository must not be used from another thread while the
+ * operation is running.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_repository_blame_file_finish() to get the result of the operation.
+ */
+void
+ggit_repository_blame_file_async (GgitRepository      *repository,
+                                  GFile               *file,
+                                  GgitBlameOptions    *blame_options,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+	GgitRepositoryPrivate *priv;
+	GTask *task;
+	BlameData *data;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (G_IS_FILE (file));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_blame_file_async);
+
+	data = g_slice_new0 (BlameData);
+	data->path = g_file_get_relative_path (priv->workdir, file);
+	data->options = blame_options != NULL ? ggit_blame_options_copy (blame_options) : NULL;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)blame_data_free);
+
+	_ggit_async_run (task, blame_file_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_blame_file_finish:
+ * @repository: a #GgitRepository.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_blame_file_async().
+ *
+ * Returns: (transfer full) (nullable): a #GgitBlame or %NULL if there was
+ * an error.
+ */
+GgitBlame *
+ggit_repository_blame_file_finish (GgitRepository  *repository,
+                                   GAsyncResult    *result,
+                                   GError         **error)
+{
+	git_blame *blame;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (g_task_is_valid (result, repository), NULL);
+	g_return_val_if_fail (g_async_result_is_tagged (result, ggit_repository_blame_file_async), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
+	blame = g_task_propagate_pointer (G_TASK (result), error);
+
+	return blame != NULL ? _ggit_blame_wrap (blame) : NULL;
+}
+
+/*
+ * _ggit_repository_revalidate_attributes:
+ * @repository: a #GgitRepository.
+ *
+ * Makes the next attribute lookups check once whether the attribute files
+ * involved changed. Callers doing many lookups in a row (like a diff walking
+ * every delta) revalidate once and then use
+ * _ggit_repository_lookup_attribute().
+ */
+void
+_ggit_repository_revalidate_attributes (GgitRepository *repository)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+
 	priv = ggit_repository_get_instance_private (repository);
 
-	if (path)
-	{
-		if (!g_path_is_absolute (path))
-		{
-			f = g_file_resolve_relative_path (priv->workdir, path);
-		}
-		else
-		{
-			f = g_file_new_for_path (path);
-		}
-	}
-	else
+	g_mutex_lock (&priv->attribute_lock);
+
+	if (priv->attribute_cache != NULL)
 	{
-		f = NULL;
+		_ggit_attribute_cache_revalidate (priv->attribute_cache);
 	}
 
-	ret = ggit_repository_create_index_entry_for_file (repository,
-	                                                   f,
-	                                                   id,
-	                                                   error);
-
-	g_object_unref (f);
-
-	return ret;
+	g_mutex_unlock (&priv->attribute_lock);
 }
 
-/**
- * ggit_repository_blame_file:
+/*
+ * _ggit_repository_lookup_attribute:
  * @repository: a #GgitRepository.
- * @file: the file to blame.
- * @blame_options: (allow-none): blame options.
+ * @path: the relative path to the file.
+ * @name: the name of the attribute.
+ * @flags: a #GgitAttributeCheckFlags.
  * @error: a #GError.
  *
- * Get a blame for a single file.
- *
- * Returns: (transfer full) (nullable): a #GgitBlame.
+ * Like ggit_repository_get_attribute() but without revalidating the
+ * attribute cache first.
  *
- **/
-GgitBlame *
-ggit_repository_blame_file (GgitRepository    *repository,
-                            GFile             *file,
-                            GgitBlameOptions  *blame_options,
-                            GError           **error)
+ * Returns: (transfer none) (nullable): the attribute value, or %NULL.
+ */
+const gchar *
+_ggit_repository_lookup_attribute (GgitRepository           *repository,
+                                   const gchar              *path,
+                                   const gchar              *name,
+                                   GgitAttributeCheckFlags   flags,
+                                   GError                  **error)
 {
 	GgitRepositoryPrivate *priv;
-	git_blame *blame;
-	gchar *path;
-	int ret;
+	const gchar *value;
+	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (path != NULL, NULL);
+	g_return_val_if_fail (name != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
 	priv = ggit_repository_get_instance_private (repository);
 
-	path = g_file_get_relative_path (priv->workdir, file);
+	g_mutex_lock (&priv->attribute_lock);
 
-	ret = git_blame_file (&blame,
-	                      _ggit_native_get (repository),
-	                      path,
-	                      _ggit_blame_options_get_blame_options (blame_options));
+	if (priv->attribute_cache == NULL)
+	{
+		priv->attribute_cache = _ggit_attribute_cache_new ();
+	}
 
-	g_free (path);
+	ret = _ggit_attribute_cache_get (priv->attribute_cache,
+	                                 _ggit_native_get (repository),
+	                                 flags,
+	                                 path,
+	                                 name,
+	                                 &value);
+
+	g_mutex_unlock (&priv->attribute_lock);
 
 	if (ret != GIT_OK)
 	{
@@ -3624,7 +5430,7 @@ ggit_repository_blame_file (GgitRepository    *repository,
 		return NULL;
 	}
 
-	return _ggit_blame_wrap (blame);
+	return value;
 }
 
 /**
@@ -3637,6 +5443,13 @@ ggit_repository_blame_file (GgitRepository    *repository,
  *
  * Get the attribute value of the specified attribute for the given file.
  *
+ * Values are cached per repository. The .gitattributes files of the
+ * parent directories of @path (in the working directory and in the index)
+ * and $GIT_DIR/info/attributes are checked for changes, and only values
+ * below a changed file are looked up again. Changes to the global or system
+ * attribute files are not noticed, use
+ * ggit_repository_clear_attribute_cache() after changing those.
+ *
  * Returns: (transfer none) (nullable): the attribute value, or %NULL.
  *
  **/
@@ -3647,27 +5460,85 @@ ggit_repository_get_attribute (GgitRepository           *repository,
                                GgitAttributeCheckFlags   flags,
                                GError                  **error)
 {
-	const char *value;
-	int ret;
-
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (path != NULL, NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_attr_get (&value,
-	                    _ggit_native_get (repository),
-	                    flags,
-	                    path,
-	                    name);
+	_ggit_repository_revalidate_attributes (repository);
 
-	if (ret != GIT_OK)
+	return _ggit_repository_lookup_attribute (repository,
+	                                          path,
+	                                          name,
+	                                          flags,
+	                                          error);
+}
+
+/**
+ * ggit_repository_clear_attribute_cache:
+ * @repository: a #GgitRepository.
+ *
+ * Drops all the attribute values cached by
+ * ggit_repository_get_attribute() and resets the cache statistics.
+ *
+ **/
+void
+ggit_repository_clear_attribute_cache (GgitRepository *repository)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	g_mutex_lock (&priv->attribute_lock);
+
+	if (priv->attribute_cache != NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		_ggit_attribute_cache_clear (priv->attribute_cache);
 	}
 
-	return value;
+	g_mutex_unlock (&priv->attribute_lock);
+}
+
+/**
+ * ggit_repository_get_attribute_cache_stats:
+ * @repository: a #GgitRepository.
+ * @hits: (out) (optional): return location for the number of lookups
+ *        answered from the cache.
+ * @misses: (out) (optional): return location for the number of lookups
+ *          which had to read the attribute files.
+ *
+ * Get the statistics of the attribute cache used by
+ * ggit_repository_get_attribute().
+ *
+ **/
+void
+ggit_repository_get_attribute_cache_stats (GgitRepository *repository,
+                                           guint64        *hits,
+                                           guint64        *misses)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	if (hits != NULL)
+	{
+		*hits = 0;
+	}
+
+	if (misses != NULL)
+	{
+		*misses = 0;
+	}
+
+	g_mutex_lock (&priv->attribute_lock);
+
+	if (priv->attribute_cache != NULL)
+	{
+		_ggit_attribute_cache_get_stats (priv->attribute_cache, hits, misses);
+	}
+
+	g_mutex_unlock (&priv->attribute_lock);
 }
 
 /**
@@ -3791,6 +5662,128 @@ ggit_repository_checkout_tree (GgitRepository       *repository,
 	return TRUE;
 }
 
+typedef struct
+{
+	GgitObject *tree;
+	GgitCheckoutOptions *options;
+} CheckoutData;
+
+static void
+checkout_data_free (CheckoutData *data)
+{
+	g_clear_object (&data->tree);
+	g_clear_object (&data->options);
+
+	g_slice_free (CheckoutData, data);
+}
+
+static void
+checkout_tree_thread (GTask        *task,
+                      gpointer      source_object,
+                      gpointer      task_data,
+                      GCancellable *cancellable)
+{
+	CheckoutData *data = task_data;
+	git_checkout_options options = GIT_CHECKOUT_OPTIONS_INIT;
+	gint ret;
+
+	if (data->options != NULL)
+	{
+		options = *_ggit_checkout_options_get_checkout_options (data->options);
+	}
+
+	_ggit_async_wrap_checkout_options (&options);
+
+	ret = git_checkout_tree (_ggit_native_get (source_object),
+	                         data->tree != NULL ? _ggit_native_get (data->tree) : NULL,
+	                         &options);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_async_return_error (task, ret);
+		return;
+	}
+
+	g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * ggit_repository_checkout_tree_async:
+ * @repository: a #GgitRepository.
+ * @tree: (allow-none): a #GgitObject or %NULL.
+ * @options: (allow-none): a #GgitCheckoutOptions or %NULL.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            checkout is done.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously updates files in the working tree to reflect the contents
+ * of the specified commit, tag or tree object. See
+ * ggit_repository_checkout_tree() for the synchronous version.
+ *
+ * The checkout runs on the libgit2-glib worker pool, so the progress and
+ * notify callbacks of @options are invoked from a worker thread. Cancelling
+ * @cancellable aborts the checkout before the next file is written.
+ * @repository must not be used from another thread while the operation is
+ * running.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_repository_checkout_tree_finish() to get the result of the operation.
+ */
+void
+ggit_repository_checkout_tree_async (GgitRepository      *repository,
+                                     GgitObject          *tree,
+                                     GgitCheckoutOptions *options,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+	GTask *task;
+	CheckoutData *data;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (tree == NULL || GGIT_IS_OBJECT (tree));
+	g_return_if_fail (options == NULL || GGIT_IS_CHECKOUT_OPTIONS (options));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_checkout_tree_async);
+
+	data = g_slice_new0 (CheckoutData);
+	data->tree = tree != NULL ? g_object_ref (tree) : NULL;
+	data->options = options != NULL ? g_object_ref (options) : NULL;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)checkout_data_free);
+
+	_ggit_async_run (task, checkout_tree_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_checkout_tree_finish:
+ * @repository: a #GgitRepository.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_checkout_tree_async().
+ *
+ * Returns: %TRUE if the checkout was successfull, %FALSE otherwise.
+ */
+gboolean
+ggit_repository_checkout_tree_finish (GgitRepository  *repository,
+                                      GAsyncResult    *result,
+                                      GError         **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, repository), FALSE);
+	g_return_val_if_fail (g_async_result_is_tagged (result, ggit_repository_checkout_tree_async), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * ggit_repository_revert:
  * @repository: a #GgitRepository.
@@ -4219,7 +6212,9 @@ ggit_repository_merge (GgitRepository       *repository,
  * @oid_two: the oid of the second of the commits
  * @error: a #GError for error reporting, or %NULL.
  *
- * Find the merge base between two commits
+ * Find the merge base between two commits. The commit-graph of the
+ * repository is used when both commits are in it, see
+ * ggit_repository_write_commit_graph().
  *
  * Returns: (transfer full) (nullable): a new #GgitOId or %NULL if an error occurred.
  *
@@ -4230,6 +6225,7 @@ ggit_repository_merge_base (GgitRepository  *repository,
                             GgitOId         *oid_two,
                             GError         **error)
 {
+	GgitCommitGraph *graph;
 	git_oid oid;
 	gint ret;
 
@@ -4238,6 +6234,37 @@ ggit_repository_merge_base (GgitRepository  *repository,
 	g_return_val_if_fail (oid_two != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
+	graph = get_commit_graph (repository);
+
+	if (graph != NULL)
+	{
+		gboolean found;
+		gboolean done;
+
+		done = _ggit_commit_graph_merge_base (graph,
+		                                      _ggit_oid_get_oid (oid_one),
+		                                      _ggit_oid_get_oid (oid_two),
+		                                      &oid,
+		                                      &found);
+
+		ggit_commit_graph_unref (graph);
+
+		if (done && found)
+		{
+			return _ggit_oid_wrap (&oid);
+		}
+
+		if (done)
+		{
+			g_set_error_literal (error,
+			                     GGIT_ERROR,
+			                     GGIT_ERROR_NOTFOUND,
+			                     "no merge base found");
+
+			return NULL;
+		}
+	}
+
 	ret = git_merge_base (&oid,
 	                      _ggit_native_get (repository),
 	                      _ggit_oid_get_oid (oid_one),
@@ -4342,6 +6369,135 @@ ggit_repository_merge_commits (GgitRepository    *repository,
 	return _ggit_index_wrap (out);
 }
 
+typedef struct
+{
+	GgitCommit *our_commit;
+	GgitCommit *their_commit;
+	GgitMergeOptions *options;
+} MergeCommitsData;
+
+static void
+merge_commits_data_free (MergeCommitsData *data)
+{
+	g_clear_object (&data->our_commit);
+	g_clear_object (&data->their_commit);
+
+	if (data->options != NULL)
+	{
+		ggit_merge_options_free (data->options);
+	}
+
+	g_slice_free (MergeCommitsData, data);
+}
+
+static void
+merge_commits_thread (GTask        *task,
+                      gpointer      source_object,
+                      gpointer      task_data,
+                      GCancellable *cancellable)
+{
+	MergeCommitsData *data = task_data;
+	git_index *out;
+	gint ret;
+
+	ret = git_merge_commits (&out,
+	                         _ggit_native_get (source_object),
+	                         _ggit_native_get (data->our_commit),
+	                         _ggit_native_get (data->their_commit),
+	                         _ggit_merge_options_get_merge_options (data->options));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_async_return_error (task, ret);
+		return;
+	}
+
+	g_task_return_pointer (task, out, (GDestroyNotify)git_index_free);
+}
+
+/**
+ * ggit_repository_merge_commits_async:
+ * @repository: a #GgitRepository.
+ * @our_commit: the commit that reflects the destination tree.
+ * @their_commit: the commit that reflects the source tree.
+ * @merge_options: (allow-none): the merge options.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            merge is done.
+ * @user_data: the data to pass to @callback.
+ *
+ * Asynchronously merges two commits creating a #GgitIndex reflecting the
+ * result of the merge. See ggit_repository_merge_commits() for the
+ * synchronous version.
+ *
+ * libgit2 does not report progress while merging, so cancelling
+ * @cancellable only has an effect when the operation has not started
+ * running yet. @repository must not be used from another thread while the
+ * operation is running.
+ *
+ * When the operation is finished, @callback will be called on the thread
+ * default main context of the calling thread. You can then call
+ * ggit_repository_merge_commits_finish() to get the result of the operation.
+ */
+void
+ggit_repository_merge_commits_async (GgitRepository      *repository,
+                                     GgitCommit          *our_commit,
+                                     GgitCommit          *their_commit,
+                                     GgitMergeOptions    *merge_options,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+	GTask *task;
+	MergeCommitsData *data;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (GGIT_IS_COMMIT (our_commit));
+	g_return_if_fail (GGIT_IS_COMMIT (their_commit));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_merge_commits_async);
+
+	data = g_slice_new0 (MergeCommitsData);
+	data->our_commit = g_object_ref (our_commit);
+	data->their_commit = g_object_ref (their_commit);
+	data->options = merge_options != NULL ? ggit_merge_options_copy (merge_options) : NULL;
+
+	g_task_set_task_data (task, data, (GDestroyNotify)merge_commits_data_free);
+
+	_ggit_async_run (task, merge_commits_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_merge_commits_finish:
+ * @repository: a #GgitRepository.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_merge_commits_async().
+ *
+ * Returns: (transfer full) (nullable): a new #GgitIndex or %NULL if an error occurred.
+ */
+GgitIndex *
+ggit_repository_merge_commits_finish (GgitRepository  *repository,
+                                      GAsyncResult    *result,
+                                      GError         **error)
+{
+	git_index *out;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (g_task_is_valid (result, repository), NULL);
+	g_return_val_if_fail (g_async_result_is_tagged (result, ggit_repository_merge_commits_async), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	out = g_task_propagate_pointer (G_TASK (result), error);
+
+	return out != NULL ? _ggit_index_wrap (out) : NULL;
+}
+
 /**
  * ggit_repository_rebase_init:
  * @repository: a #GgitRepository.
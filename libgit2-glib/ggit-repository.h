@@ -32,6 +32,7 @@
 #include <libgit2-glib/ggit-object.h>
 #include <libgit2-glib/ggit-tree.h>
 #include <libgit2-glib/ggit-branch.h>
+#include <libgit2-glib/ggit-blob-input-stream.h>
 #include <libgit2-glib/ggit-blob-output-stream.h>
 #include <libgit2-glib/ggit-checkout-options.h>
 #include <libgit2-glib/ggit-note.h>
@@ -80,6 +81,23 @@ GgitRepository     *_ggit_repository_wrap             (git_repository        *re
 
 git_repository     *_ggit_repository_get_repository   (GgitRepository        *repository);
 
+void                _ggit_repository_revalidate_attributes
+                                                      (GgitRepository        *repository);
+
+GgitObject         *_ggit_repository_lookup_cached_object
+                                                      (GgitRepository        *repository,
+                                                       const git_oid         *id,
+                                                       git_otype              type);
+
+GgitObject         *_ggit_repository_wrap_object      (GgitRepository        *repository,
+                                                       git_object            *obj);
+
+const gchar        *_ggit_repository_lookup_attribute (GgitRepository           *repository,
+                                                       const gchar              *path,
+                                                       const gchar              *name,
+                                                       GgitAttributeCheckFlags   flags,
+                                                       GError                  **error);
+
 GgitRepository     *ggit_repository_open              (GFile                 *location,
                                                        GError               **error);
 
@@ -92,6 +110,29 @@ GgitRepository     *ggit_repository_clone             (const gchar           *ur
                                                        GgitCloneOptions      *options,
                                                        GError               **error);
 
+void                ggit_repository_clone_async       (const gchar           *url,
+                                                       GFile                 *location,
+                                                       GgitCloneOptions      *options,
+                                                       GCancellable          *cancellable,
+                                                       GAsyncReadyCallback    callback,
+                                                       gpointer               user_data);
+
+GgitRepository     *ggit_repository_clone_finish      (GAsyncResult          *result,
+                                                       GError               **error);
+
+void                ggit_repository_set_object_cache_size
+                                                      (GgitRepository        *repository,
+                                                       guint                  size);
+
+guint               ggit_repository_get_object_cache_size
+                                                      (GgitRepository        *repository);
+
+void                ggit_repository_get_object_cache_stats
+                                                      (GgitRepository        *repository,
+                                                       guint64               *hits,
+                                                       guint64               *misses,
+                                                       guint                 *n_objects);
+
 GgitObject         *ggit_repository_lookup            (GgitRepository        *repository,
                                                        GgitOId               *oid,
                                                        GType                  gtype,
@@ -121,6 +162,11 @@ GgitRef            *ggit_repository_create_symbolic_reference
 GgitBlobOutputStream *
                     ggit_repository_create_blob       (GgitRepository        *repository);
 
+GgitBlobOutputStream *
+                    ggit_repository_create_blob_with_size (
+                                                       GgitRepository        *repository,
+                                                       guint64                size);
+
 
 GgitOId            *ggit_repository_create_blob_from_buffer (
                                                        GgitRepository        *repository,
@@ -138,6 +184,14 @@ GgitOId            *ggit_repository_create_blob_from_path (
                                                        const gchar           *path,
                                                        GError               **error);
 
+GgitOId           **ggit_repository_create_blobs_from_files (
+                                                       GgitRepository        *repository,
+                                                       GFile                **files,
+                                                       gsize                  n_files,
+                                                       GgitCreateBlobsFlags   flags,
+                                                       GCancellable          *cancellable,
+                                                       GError               **error);
+
 GgitOId                    *ggit_repository_create_commit (
                                                        GgitRepository        *repository,
                                                        const gchar           *update_ref,
@@ -266,6 +320,11 @@ GgitBlob           *ggit_repository_lookup_blob       (GgitRepository        *re
                                                        GgitOId               *oid,
                                                              GError         **error);
 
+GgitBlobInputStream *
+                    ggit_repository_open_blob         (GgitRepository        *repository,
+                                                       GgitOId               *oid,
+                                                       GError               **error);
+
 GgitCommit         *ggit_repository_lookup_commit     (GgitRepository        *repository,
                                                        GgitOId               *oid,
                                                        GError               **error);
@@ -454,17 +513,65 @@ gboolean            ggit_repository_get_descendant_of (GgitRepository        *re
                                                        GgitOId               *ancestor,
                                                        GError               **error);
 
+GgitCommitGraph    *ggit_repository_get_commit_graph  (GgitRepository        *repository);
+
+gboolean            ggit_repository_write_commit_graph (
+                                                       GgitRepository        *repository,
+                                                       GCancellable          *cancellable,
+                                                       GError               **error);
+
+gboolean            ggit_repository_write_reachability_index (
+                                                       GgitRepository        *repository,
+                                                       GCancellable          *cancellable,
+                                                       GError               **error);
+
+gboolean            ggit_repository_get_descendant_of_many (
+                                                       GgitRepository        *repository,
+                                                       GgitOId              **commits,
+                                                       gsize                  n_commits,
+                                                       GgitOId               *ancestor,
+                                                       gboolean              *results,
+                                                       GError               **error);
+
+gboolean            ggit_repository_get_ahead_behind_many (
+                                                       GgitRepository        *repository,
+                                                       GgitOId              **locals,
+                                                       gsize                  n_locals,
+                                                       GgitOId               *upstream,
+                                                       gsize                 *ahead,
+                                                       gsize                 *behind,
+                                                       GError               **error);
+
 GgitBlame          *ggit_repository_blame_file        (GgitRepository        *repository,
                                                        GFile                 *file,
                                                        GgitBlameOptions      *blame_options,
                                                        GError               **error);
 
+void                ggit_repository_blame_file_async  (GgitRepository        *repository,
+                                                       GFile                 *file,
+                                                       GgitBlameOptions      *blame_options,
+                                                       GCancellable          *cancellable,
+                                                       GAsyncReadyCallback    callback,
+                                                       gpointer               user_data);
+
+GgitBlame          *ggit_repository_blame_file_finish (GgitRepository        *repository,
+                                                       GAsyncResult          *result,
+                                                       GError               **error);
+
 const gchar        *ggit_repository_get_attribute     (GgitRepository           *repository,
                                                        const gchar              *path,
                                                        const gchar              *name,
                                                        GgitAttributeCheckFlags   flags,
                                                        GError                  **error);
 
+void                ggit_repository_clear_attribute_cache
+                                                      (GgitRepository           *repository);
+
+void                ggit_repository_get_attribute_cache_stats
+                                                      (GgitRepository           *repository,
+                                                       guint64                  *hits,
+                                                       guint64                  *misses);
+
 gboolean            ggit_repository_checkout_head     (GgitRepository           *repository,
                                                        GgitCheckoutOptions      *options,
                                                        GError                  **error);
@@ -479,6 +586,19 @@ gboolean            ggit_repository_checkout_tree     (GgitRepository
                                                        GgitCheckoutOptions      *options,
                                                        GError                  **error);
 
+void                ggit_repository_checkout_tree_async (
+                                                       GgitRepository           *repository,
+                                                       GgitObject               *tree,
+                                                       GgitCheckoutOptions      *options,
+                                                       GCancellable             *cancellable,
+                                                       GAsyncReadyCallback       callback,
+                                                       gpointer                  user_data);
+
+gboolean            ggit_repository_checkout_tree_finish (
+                                                       GgitRepository           *repository,
+                                                       GAsyncResult             *result,
+                                                       GError                  **error);
+
 gboolean            ggit_repository_revert            (GgitRepository           *repository,
                                                        GgitCommit               *commit,
                                                        GgitRevertOptions        *options,
@@ -554,6 +674,18 @@ GgitIndex          *ggit_repository_merge_commits      (GgitRepository
                                                         GgitMergeOptions        *merge_options,
                                                         GError                 **error);
 
+void                ggit_repository_merge_commits_async (GgitRepository         *repository,
+                                                        GgitCommit              *our_commit,
+                                                        GgitCommit              *their_commit,
+                                                        GgitMergeOptions        *merge_options,
+                                                        GCancellable            *cancellable,
+                                                        GAsyncReadyCallback      callback,
+                                                        gpointer                 user_data);
+
+GgitIndex          *ggit_repository_merge_commits_finish (GgitRepository        *repository,
+                                                        GAsyncResult            *result,
+                                                        GError                 **error);
+
 GgitRebase         *ggit_repository_rebase_init        (GgitRepository       *repository,
                                                         GgitAnnotatedCommit  *branch,
                                                         GgitAnnotatedCommit  *upstream,
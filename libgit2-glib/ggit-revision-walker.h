@@ -85,6 +85,15 @@ void                    ggit_revision_walker_hide_head      (GgitRevisionWalker
 GgitOId                *ggit_revision_walker_next           (GgitRevisionWalker  *walker,
                                                              GError             **error);
 
+gsize                   ggit_revision_walker_next_n         (GgitRevisionWalker  *walker,
+                                                             guint8              *raw_ids,
+                                                             gsize                n_ids,
+                                                             GError             **error);
+
+GBytes                 *ggit_revision_walker_collect        (GgitRevisionWalker  *walker,
+                                                             gsize                max_ids,
+                                                             GError             **error);
+
 void                    ggit_revision_walker_set_sort_mode  (GgitRevisionWalker *walker,
                                                              GgitSortMode        sort_mode);
 
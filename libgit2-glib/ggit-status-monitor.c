@@ -0,0 +1,1741 @@
+/*
+ * ggit-status-monitor.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include <git2.h>
+
+#include "ggit-status-monitor.h"
+#include "ggit-async.h"
+#include "ggit-enum-types.h"
+#include "ggit-error.h"
+#include "ggit-index-snapshot.h"
+#include "ggit-repository.h"
+#include "ggit-status-options.h"
+#include "ggit-untracked-cache.h"
+
+#ifndef S_ISDIR
+#define S_ISDIR(m) (((m) & S_IFMT) == S_IFDIR)
+#endif
+
+#define DEFAULT_LATENCY 50
+#define DEFAULT_RESCAN_THRESHOLD 10000
+
+/* Milliseconds before retrying a failed update */
+#define RETRY_INTERVAL 1000
+
+/**
+ * GgitStatusMonitor:
+ *
+ * Keeps the status of the files in the working directory of a repository
+ * up to date while they change.
+ *
+ * The monitor watches the directories of the working directory (skipping
+ * ignored directories and nested repositories) and the git directory.
+ * Changed paths are collected for #GgitStatusMonitor:latency milliseconds
+ * and then only their status is recomputed, on a worker thread with a
+ * private handle on the repository. Changes to the index only refresh the
+ * entries that differ, while a change of the HEAD tree or more than
+ * #GgitStatusMonitor:rescan-threshold pending paths fall back to a full
+ * scan of the working directory. Full scans find the untracked files
+ * through the #GgitUntrackedCache of the #GgitStatusOptions, or a private
+ * one, and only read the directories again that changed since the previous
+ * scan, as far as the monitor knows.
+ *
+ * Every status maps to a single path: untracked directories are always
+ * recursed into, rename detection is disabled and the pathspec of the
+ * #GgitStatusOptions is ignored, as are its changed paths. Branches in
+ * nested directories below refs/heads are not watched, use
+ * ggit_status_monitor_rescan() after moving them.
+ *
+ * The #GgitStatusMonitor::changed signal is emitted on the thread-default
+ * main context of the thread that created the monitor.
+ */
+struct _GgitStatusMonitor
+{
+	GObject parent_instance;
+
+	GgitRepository *repository;
+	GgitStatusOptions *status_options;
+	GgitUntrackedCache *untracked_cache;
+	guint latency;
+	guint rescan_threshold;
+
+	GFile *workdir;
+	GMainContext *context;
+	GCancellable *cancellable;
+
+	/* relative directory path ("" for the root) -> GFileMonitor */
+	GHashTable *monitors;
+	GPtrArray *gitdir_monitors;
+
+	/* path -> GgitStatusFlags, only paths that are not current */
+	GHashTable *statuses;
+
+	/* path -> GINT_TO_POINTER (is_directory) */
+	GHashTable *pending;
+	GSource *timeout;
+
+	guint pending_rescan : 1;
+	guint pending_refresh : 1;
+	guint busy : 1;
+	guint ready : 1;
+	guint watching : 1;
+
+	/* Only accessed by the update running on the worker */
+	git_repository *repo;
+	GgitIndexSnapshot *index_snapshot;
+	GStatBuf index_stat;
+	git_oid head_tree;
+	gboolean has_head_tree;
+
+	/* Paths changed since the untracked cache was last used, %NULL
+	 * when unknown */
+	GHashTable *changed_paths;
+};
+
+typedef struct
+{
+	/* path -> GINT_TO_POINTER (is_directory) */
+	GHashTable *paths;
+	gboolean rescan;
+	gboolean refresh;
+	guint rescan_threshold;
+
+	/* Only collect the directories to watch, before the first scan */
+	gboolean directories_only;
+
+	/* path -> GgitStatusFlags */
+	GHashTable *statuses;
+	GPtrArray *directories;
+} Update;
+
+enum
+{
+	PROP_0,
+	PROP_REPOSITORY,
+	PROP_STATUS_OPTIONS,
+	PROP_LATENCY,
+	PROP_RESCAN_THRESHOLD,
+	PROP_READY
+};
+
+enum
+{
+	CHANGED,
+	NUM_SIGNALS
+};
+
+static guint signals[NUM_SIGNALS] = { 0 };
+
+static void ggit_status_monitor_initable_iface_init (GInitableIface *iface);
+
+static void on_workdir_changed (GFileMonitor      *file_monitor,
+                                GFile             *file,
+                                GFile             *other_file,
+                                GFileMonitorEvent  event,
+                                GgitStatusMonitor *monitor);
+
+static void on_gitdir_changed  (GFileMonitor      *file_monitor,
+                                GFile             *file,
+                                GFile             *other_file,
+                                GFileMonitorEvent  event,
+                                GgitStatusMonitor *monitor);
+
+G_DEFINE_TYPE_WITH_CODE (GgitStatusMonitor, ggit_status_monitor, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
+                                                ggit_status_monitor_initable_iface_init))
+
+static void
+file_monitor_free (GFileMonitor *file_monitor)
+{
+	g_signal_handlers_disconnect_matched (file_monitor, G_SIGNAL_MATCH_FUNC,
+	                                      0, 0, NULL, on_workdir_changed, NULL);
+	g_signal_handlers_disconnect_matched (file_monitor, G_SIGNAL_MATCH_FUNC,
+	                                      0, 0, NULL, on_gitdir_changed, NULL);
+
+	g_file_monitor_cancel (file_monitor);
+	g_object_unref (file_monitor);
+}
+
+static void
+update_free (Update *update)
+{
+	g_hash_table_unref (update->paths);
+	g_hash_table_unref (update->statuses);
+	g_ptr_array_unref (update->directories);
+
+	g_slice_free (Update, update);
+}
+
+static void
+ggit_status_monitor_dispose (GObject *object)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	g_cancellable_cancel (monitor->cancellable);
+
+	if (monitor->timeout != NULL)
+	{
+		g_source_destroy (monitor->timeout);
+		g_clear_pointer (&monitor->timeout, g_source_unref);
+	}
+
+	g_hash_table_remove_all (monitor->monitors);
+	g_ptr_array_set_size (monitor->gitdir_monitors, 0);
+
+	G_OBJECT_CLASS (ggit_status_monitor_parent_class)->dispose (object);
+}
+
+static void
+ggit_status_monitor_finalize (GObject *object)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	g_clear_object (&monitor->repository);
+	g_clear_pointer (&monitor->status_options, ggit_status_options_free);
+	g_clear_pointer (&monitor->untracked_cache, ggit_untracked_cache_unref);
+	g_clear_object (&monitor->workdir);
+	g_clear_object (&monitor->cancellable);
+	g_main_context_unref (monitor->context);
+
+	g_hash_table_unref (monitor->monitors);
+	g_ptr_array_unref (monitor->gitdir_monitors);
+	g_hash_table_unref (monitor->statuses);
+	g_hash_table_unref (monitor->pending);
+
+	g_clear_pointer (&monitor->index_snapshot, ggit_index_snapshot_unref);
+	g_clear_pointer (&monitor->repo, git_repository_free);
+	g_clear_pointer (&monitor->changed_paths, g_hash_table_unref);
+
+	G_OBJECT_CLASS (ggit_status_monitor_parent_class)->finalize (object);
+}
+
+static void
+ggit_status_monitor_get_property (GObject    *object,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	switch (prop_id)
+	{
+		case PROP_REPOSITORY:
+			g_value_set_object (value, monitor->repository);
+			break;
+		case PROP_STATUS_OPTIONS:
+			g_value_set_boxed (value, monitor->status_options);
+			break;
+		case PROP_LATENCY:
+			g_value_set_uint (value, monitor->latency);
+			break;
+		case PROP_RESCAN_THRESHOLD:
+			g_value_set_uint (value, monitor->rescan_threshold);
+			break;
+		case PROP_READY:
+			g_value_set_boolean (value, monitor->ready);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+ggit_status_monitor_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	switch (prop_id)
+	{
+		case PROP_REPOSITORY:
+			monitor->repository = g_value_dup_object (value);
+			break;
+		case PROP_STATUS_OPTIONS:
+			monitor->status_options = g_value_dup_boxed (value);
+			break;
+		case PROP_LATENCY:
+			ggit_status_monitor_set_latency (monitor, g_value_get_uint (value));
+			break;
+		case PROP_RESCAN_THRESHOLD:
+			ggit_status_monitor_set_rescan_threshold (monitor, g_value_get_uint (value));
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static gboolean
+read_head_tree (git_repository *repo,
+                git_oid        *oid)
+{
+	git_object *tree;
+
+	/* Fails on an unborn branch, which has no tree */
+	if (git_revparse_single (&tree, repo, "HEAD^{tree}") != GIT_OK)
+	{
+		return FALSE;
+	}
+
+	git_oid_cpy (oid, git_object_id (tree));
+	git_object_free (tree);
+
+	return TRUE;
+}
+
+static void
+add_path (GHashTable  *paths,
+          const gchar *path)
+{
+	if (!g_hash_table_contains (paths, path))
+	{
+		g_hash_table_insert (paths, g_strdup (path), GINT_TO_POINTER (FALSE));
+	}
+}
+
+static void
+add_index_changes (GgitIndexSnapshot *old_snapshot,
+                   GgitIndexSnapshot *new_snapshot,
+                   GHashTable        *paths)
+{
+	guint n_old = ggit_index_snapshot_get_size (old_snapshot);
+	guint n_new = ggit_index_snapshot_get_size (new_snapshot);
+	guint i = 0;
+	guint j = 0;
+
+	/* Both snapshots are sorted, so this is a merge of the two */
+	while (i < n_old || j < n_new)
+	{
+		const gchar *old_path = NULL;
+		const gchar *new_path = NULL;
+		gint cmp;
+
+		if (i < n_old)
+		{
+			old_path = ggit_index_snapshot_get_path (old_snapshot, i);
+		}
+
+		if (j < n_new)
+		{
+			new_path = ggit_index_snapshot_get_path (new_snapshot, j);
+		}
+
+		if (old_path == NULL)
+		{
+			cmp = 1;
+		}
+		else if (new_path == NULL)
+		{
+			cmp = -1;
+		}
+		else
+		{
+			cmp = strcmp (old_path, new_path);
+
+			if (cmp == 0)
+			{
+				cmp = ggit_index_snapshot_get_stage (old_snapshot, i) -
+				      ggit_index_snapshot_get_stage (new_snapshot, j);
+			}
+		}
+
+		if (cmp < 0)
+		{
+			add_path (paths, old_path);
+			i++;
+		}
+		else if (cmp > 0)
+		{
+			add_path (paths, new_path);
+			j++;
+		}
+		else
+		{
+			if (ggit_index_snapshot_get_mode (old_snapshot, i) !=
+			    ggit_index_snapshot_get_mode (new_snapshot, j) ||
+			    memcmp (ggit_index_snapshot_get_raw_id (old_snapshot, i),
+			            ggit_index_snapshot_get_raw_id (new_snapshot, j),
+			            GIT_OID_RAWSZ) != 0)
+			{
+				add_path (paths, old_path);
+			}
+
+			i++;
+			j++;
+		}
+	}
+}
+
+static gint
+refresh_index (GgitStatusMonitor *monitor,
+               GHashTable        *paths)
+{
+	GgitIndexSnapshot *snapshot;
+	git_index *index;
+	gchar *filename;
+	GStatBuf st;
+	gint ret;
+
+	filename = g_build_filename (git_repository_path (monitor->repo), "index", NULL);
+
+	if (g_stat (filename, &st) != 0)
+	{
+		memset (&st, 0, sizeof (st));
+	}
+
+	g_free (filename);
+
+	if (monitor->index_snapshot != NULL &&
+	    st.st_mtime == monitor->index_stat.st_mtime &&
+	    st.st_size == monitor->index_stat.st_size &&
+	    st.st_ino == monitor->index_stat.st_ino)
+	{
+		return GIT_OK;
+	}
+
+	ret = git_repository_index (&index, monitor->repo);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	ret = git_index_read (index, 0);
+
+	if (ret != GIT_OK)
+	{
+		git_index_free (index);
+		return ret;
+	}
+
+	snapshot = _ggit_index_snapshot_new_native (index);
+	git_index_free (index);
+
+	if (paths != NULL && monitor->index_snapshot != NULL)
+	{
+		add_index_changes (monitor->index_snapshot, snapshot, paths);
+	}
+
+	g_clear_pointer (&monitor->index_snapshot, ggit_index_snapshot_unref);
+	monitor->index_snapshot = snapshot;
+	monitor->index_stat = st;
+
+	return GIT_OK;
+}
+
+static gboolean
+refresh_head (GgitStatusMonitor *monitor)
+{
+	git_oid tree;
+	gboolean has_tree;
+	gboolean changed;
+
+	has_tree = read_head_tree (monitor->repo, &tree);
+
+	changed = has_tree != monitor->has_head_tree ||
+	          (has_tree && !git_oid_equal (&tree, &monitor->head_tree));
+
+	monitor->has_head_tree = has_tree;
+
+	if (has_tree)
+	{
+		git_oid_cpy (&monitor->head_tree, &tree);
+	}
+
+	return changed;
+}
+
+static gboolean
+is_ignored_directory (git_repository *repo,
+                      const gchar    *relative)
+{
+	gchar *path;
+	gint ignored = 0;
+
+	path = g_strconcat (relative, "/", NULL);
+
+	if (git_ignore_path_is_ignored (&ignored, repo, path) != GIT_OK)
+	{
+		ignored = 0;
+	}
+
+	g_free (path);
+	return ignored != 0;
+}
+
+static void
+collect_directories (git_repository *repo,
+                     const gchar    *workdir,
+                     const gchar    *relative,
+                     GPtrArray      *directories)
+{
+	const gchar *name;
+	gchar *path;
+	GDir *dir;
+
+	path = g_build_filename (workdir, relative, NULL);
+	dir = g_dir_open (path, 0, NULL);
+
+	if (dir == NULL)
+	{
+		g_free (path);
+		return;
+	}
+
+	g_ptr_array_add (directories, g_strdup (relative));
+
+	while ((name = g_dir_read_name (dir)) != NULL)
+	{
+		gchar *child;
+		gchar *child_relative;
+		gchar *dotgit;
+		GStatBuf st;
+
+		if (strcmp (name, ".git") == 0)
+		{
+			continue;
+		}
+
+		child = g_build_filename (path, name, NULL);
+
+		if (g_lstat (child, &st) != 0 || !S_ISDIR (st.st_mode))
+		{
+			g_free (child);
+			continue;
+		}
+
+		child_relative = *relative != '\0' ? g_strconcat (relative, "/", name, NULL)
+		                                   : g_strdup (name);
+
+		/* Nested repositories and submodules are not descended into */
+		dotgit = g_build_filename (child, ".git", NULL);
+
+		if (!g_file_test (dotgit, G_FILE_TEST_EXISTS) &&
+		    !is_ignored_directory (repo, child_relative))
+		{
+			collect_directories (repo, workdir, child_relative, directories);
+		}
+
+		g_free (dotgit);
+		g_free (child_relative);
+		g_free (child);
+	}
+
+	g_dir_close (dir);
+	g_free (path);
+}
+
+static gint
+add_status (const gchar *path,
+            guint        status_flags,
+            gpointer     payload)
+{
+	Update *update = payload;
+
+	if (status_flags != GIT_STATUS_CURRENT)
+	{
+		g_hash_table_insert (update->statuses,
+		                     g_strdup (path),
+		                     GUINT_TO_POINTER (status_flags));
+	}
+
+	return GIT_OK;
+}
+
+static gint
+collect_all_statuses (GgitStatusMonitor        *monitor,
+                      Update                   *update,
+                      const git_status_options *options)
+{
+	gchar **changed = NULL;
+	gint ret;
+
+	if (monitor->changed_paths != NULL)
+	{
+		changed = (gchar **)g_hash_table_get_keys_as_array (monitor->changed_paths, NULL);
+	}
+
+	ret = _ggit_untracked_cache_status_foreach (monitor->untracked_cache,
+	                                            monitor->repo,
+	                                            options,
+	                                            (const gchar * const *)changed,
+	                                            add_status,
+	                                            update);
+	g_free (changed);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	/* From here on, the events tell what changed */
+	if (monitor->changed_paths != NULL)
+	{
+		g_hash_table_remove_all (monitor->changed_paths);
+	}
+	else
+	{
+		monitor->changed_paths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	}
+
+	return GIT_OK;
+}
+
+static gint
+collect_statuses (GgitStatusMonitor *monitor,
+                  Update            *update)
+{
+	git_status_options options = GIT_STATUS_OPTIONS_INIT;
+	git_status_list *list;
+	gchar **paths;
+	guint len;
+	gsize n;
+	gsize i;
+	gint ret;
+
+	if (monitor->status_options != NULL)
+	{
+		options = *_ggit_status_options_get_status_options (monitor->status_options);
+	}
+	else
+	{
+		options.flags = GIT_STATUS_OPT_INCLUDE_UNTRACKED;
+	}
+
+	options.flags |= GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+	options.flags &= ~(GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+	                   GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR |
+	                   GIT_STATUS_OPT_RENAMES_FROM_REWRITES);
+
+	options.pathspec.strings = NULL;
+	options.pathspec.count = 0;
+
+	if (update->rescan)
+	{
+		return collect_all_statuses (monitor, update, &options);
+	}
+
+	/* Literal paths let libgit2 skip everything else while iterating,
+	 * directories also match their contents.
+	 */
+	paths = (gchar **)g_hash_table_get_keys_as_array (update->paths, &len);
+
+	options.pathspec.strings = paths;
+	options.pathspec.count = len;
+	options.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+
+	ret = git_status_list_new (&list, monitor->repo, &options);
+	g_free (paths);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	n = git_status_list_entrycount (list);
+
+	for (i = 0; i < n; i++)
+	{
+		const git_status_entry *entry;
+		const git_diff_delta *delta;
+
+		entry = git_status_byindex (list, i);
+
+		if (entry->status == GIT_STATUS_CURRENT)
+		{
+			continue;
+		}
+
+		delta = entry->index_to_workdir != NULL ? entry->index_to_workdir
+		                                        : entry->head_to_index;
+
+		g_hash_table_insert (update->statuses,
+		                     g_strdup (delta->old_file.path),
+		                     GUINT_TO_POINTER (entry->status));
+	}
+
+	git_status_list_free (list);
+
+	return GIT_OK;
+}
+
+/* Collects the directories below the changed directories of @update */
+static void
+collect_changed_directories (GgitStatusMonitor *monitor,
+                             Update            *update,
+                             GPtrArray         *directories)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, update->paths);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		if (GPOINTER_TO_INT (value) && !is_ignored_directory (monitor->repo, key))
+		{
+			collect_directories (monitor->repo,
+			                     git_repository_workdir (monitor->repo),
+			                     key,
+			                     directories);
+		}
+	}
+}
+
+/* Remembers the paths of @update and the @directories found below them as
+ * changed for the next use of the untracked cache.
+ */
+static void
+add_changed_paths (GgitStatusMonitor *monitor,
+                   Update            *update,
+                   GPtrArray         *directories)
+{
+	GHashTableIter iter;
+	gpointer key;
+	guint i;
+
+	if (monitor->changed_paths == NULL)
+	{
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, update->paths);
+
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		g_hash_table_add (monitor->changed_paths, g_strdup (key));
+	}
+
+	for (i = 0; i < directories->len; i++)
+	{
+		g_hash_table_add (monitor->changed_paths,
+		                  g_strdup (g_ptr_array_index (directories, i)));
+	}
+}
+
+static void
+update_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+	GgitStatusMonitor *monitor = source_object;
+	Update *update = task_data;
+	const gchar *workdir;
+	gint ret;
+
+	workdir = git_repository_workdir (monitor->repo);
+
+	if (update->directories_only)
+	{
+		collect_directories (monitor->repo, workdir, "", update->directories);
+
+		g_task_return_boolean (task, TRUE);
+		return;
+	}
+
+	/* The changes that led to a requested rescan are not known */
+	if (update->rescan)
+	{
+		g_clear_pointer (&monitor->changed_paths, g_hash_table_unref);
+	}
+
+	if (update->refresh || update->rescan)
+	{
+		if (refresh_head (monitor))
+		{
+			update->rescan = TRUE;
+		}
+
+		ret = refresh_index (monitor, update->rescan ? NULL : update->paths);
+
+		if (ret != GIT_OK)
+		{
+			_ggit_async_return_error (task, ret);
+			return;
+		}
+	}
+
+	if (g_hash_table_size (update->paths) > update->rescan_threshold)
+	{
+		update->rescan = TRUE;
+	}
+
+	if (update->rescan && monitor->changed_paths != NULL)
+	{
+		GPtrArray *directories;
+
+		/* Only the update itself turned into a rescan, its paths
+		 * are still all that changed. */
+		directories = g_ptr_array_new_with_free_func (g_free);
+		collect_changed_directories (monitor, update, directories);
+		add_changed_paths (monitor, update, directories);
+		g_ptr_array_unref (directories);
+	}
+
+	if (update->rescan)
+	{
+		collect_directories (monitor->repo, workdir, "", update->directories);
+	}
+	else
+	{
+		collect_changed_directories (monitor, update, update->directories);
+		add_changed_paths (monitor, update, update->directories);
+	}
+
+	if (update->rescan || g_hash_table_size (update->paths) > 0)
+	{
+		ret = collect_statuses (monitor, update);
+
+		if (ret != GIT_OK)
+		{
+			_ggit_async_return_error (task, ret);
+			return;
+		}
+	}
+
+	g_task_return_boolean (task, TRUE);
+}
+
+static gboolean
+in_scope (GHashTable  *paths,
+          const gchar *path,
+          GString     *scratch)
+{
+	const gchar *slash;
+
+	if (g_hash_table_contains (paths, path))
+	{
+		return TRUE;
+	}
+
+	/* Or below one of the directories in the scope */
+	for (slash = strchr (path, '/'); slash != NULL; slash = strchr (slash + 1, '/'))
+	{
+		g_string_truncate (scratch, 0);
+		g_string_append_len (scratch, path, slash - path);
+
+		if (GPOINTER_TO_INT (g_hash_table_lookup (paths, scratch->str)))
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static void
+add_changed (GHashTable  *changed,
+             const gchar *path)
+{
+	if (!g_hash_table_contains (changed, path))
+	{
+		g_hash_table_add (changed, g_strdup (path));
+	}
+}
+
+static GHashTable *
+apply_statuses (GgitStatusMonitor *monitor,
+                Update            *update)
+{
+	GHashTable *changed;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	changed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	g_hash_table_iter_init (&iter, update->statuses);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		gpointer old_value;
+
+		if (!g_hash_table_lookup_extended (monitor->statuses, key, NULL, &old_value) ||
+		    old_value != value)
+		{
+			add_changed (changed, key);
+		}
+	}
+
+	if (update->rescan)
+	{
+		g_hash_table_iter_init (&iter, monitor->statuses);
+
+		while (g_hash_table_iter_next (&iter, &key, &value))
+		{
+			if (!g_hash_table_contains (update->statuses, key))
+			{
+				add_changed (changed, key);
+			}
+		}
+
+		g_hash_table_remove_all (monitor->statuses);
+	}
+	else
+	{
+		GString *scratch = g_string_new (NULL);
+
+		g_hash_table_iter_init (&iter, monitor->statuses);
+
+		while (g_hash_table_iter_next (&iter, &key, &value))
+		{
+			if (in_scope (update->paths, key, scratch))
+			{
+				if (!g_hash_table_contains (update->statuses, key))
+				{
+					add_changed (changed, key);
+				}
+
+				g_hash_table_iter_remove (&iter);
+			}
+		}
+
+		g_string_free (scratch, TRUE);
+	}
+
+	g_hash_table_iter_init (&iter, update->statuses);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		g_hash_table_insert (monitor->statuses, g_strdup (key), value);
+	}
+
+	return changed;
+}
+
+static gboolean
+add_directory_monitor (GgitStatusMonitor *monitor,
+                       const gchar       *relative)
+{
+	GFileMonitor *file_monitor;
+	GFile *dir;
+
+	dir = g_file_resolve_relative_path (monitor->workdir, relative);
+	file_monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_NONE, NULL, NULL);
+	g_object_unref (dir);
+
+	/* For example when running out of inotify watches. The directory is
+	 * still covered by full scans. */
+	if (file_monitor == NULL)
+	{
+		return FALSE;
+	}
+
+	g_signal_connect (file_monitor,
+	                  "changed",
+	                  G_CALLBACK (on_workdir_changed),
+	                  monitor);
+
+	g_hash_table_insert (monitor->monitors, g_strdup (relative), file_monitor);
+
+	return TRUE;
+}
+
+static void
+remove_directory_monitors (GgitStatusMonitor *monitor,
+                           const gchar       *relative)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gsize len;
+
+	len = strlen (relative);
+
+	g_hash_table_iter_init (&iter, monitor->monitors);
+
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		const gchar *path = key;
+
+		if (strncmp (path, relative, len) == 0 &&
+		    (path[len] == '\0' || path[len] == '/'))
+		{
+			g_hash_table_iter_remove (&iter);
+		}
+	}
+}
+
+static void schedule_update (GgitStatusMonitor *monitor);
+
+static void
+queue_path (GgitStatusMonitor *monitor,
+            const gchar       *path,
+            gboolean           is_directory)
+{
+	if (monitor->pending_rescan)
+	{
+		return;
+	}
+
+	if (is_directory || !g_hash_table_contains (monitor->pending, path))
+	{
+		g_hash_table_insert (monitor->pending,
+		                     g_strdup (path),
+		                     GINT_TO_POINTER (is_directory));
+	}
+
+	/* Too many events to keep up with, start over */
+	if (g_hash_table_size (monitor->pending) > monitor->rescan_threshold)
+	{
+		g_hash_table_remove_all (monitor->pending);
+		monitor->pending_rescan = TRUE;
+	}
+
+	schedule_update (monitor);
+}
+
+/* Directories that were not watched while the update ran are queued, files
+ * changed in them in the meantime would otherwise be missed. Only before the
+ * first scan, nothing can have been missed yet.
+ */
+static void
+apply_directories (GgitStatusMonitor *monitor,
+                   Update            *update)
+{
+	guint i;
+
+	if (update->rescan)
+	{
+		GHashTable *wanted;
+		GHashTableIter iter;
+		gpointer key;
+
+		wanted = g_hash_table_new (g_str_hash, g_str_equal);
+
+		for (i = 0; i < update->directories->len; i++)
+		{
+			g_hash_table_add (wanted, g_ptr_array_index (update->directories, i));
+		}
+
+		g_hash_table_iter_init (&iter, monitor->monitors);
+
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			if (!g_hash_table_contains (wanted, key))
+			{
+				g_hash_table_iter_remove (&iter);
+			}
+		}
+
+		g_hash_table_unref (wanted);
+	}
+
+	for (i = 0; i < update->directories->len; i++)
+	{
+		const gchar *relative = g_ptr_array_index (update->directories, i);
+
+		if (!g_hash_table_contains (monitor->monitors, relative) &&
+		    add_directory_monitor (monitor, relative) &&
+		    !update->directories_only)
+		{
+			queue_path (monitor, relative, TRUE);
+		}
+	}
+}
+
+static gint
+compare_strings (gconstpointer a,
+                 gconstpointer b)
+{
+	return strcmp (*(const gchar * const *)a, *(const gchar * const *)b);
+}
+
+static gchar **
+sorted_keys (GHashTable *table)
+{
+	gchar **keys;
+	guint len;
+	guint i;
+
+	keys = (gchar **)g_hash_table_get_keys_as_array (table, &len);
+
+	for (i = 0; i < len; i++)
+	{
+		keys[i] = g_strdup (keys[i]);
+	}
+
+	qsort (keys, len, sizeof (gchar *), compare_strings);
+
+	return keys;
+}
+
+static void start_update (GgitStatusMonitor *monitor);
+
+static void schedule_update_in (GgitStatusMonitor *monitor,
+                                guint              interval);
+
+/* Puts the changes of an update back in the pending set */
+static void
+requeue_update (GgitStatusMonitor *monitor,
+                Update            *update)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	if (update->rescan)
+	{
+		monitor->pending_rescan = TRUE;
+	}
+
+	if (update->refresh)
+	{
+		monitor->pending_refresh = TRUE;
+	}
+
+	if (monitor->pending_rescan)
+	{
+		g_hash_table_remove_all (monitor->pending);
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, update->paths);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		if (GPOINTER_TO_INT (value) || !g_hash_table_contains (monitor->pending, key))
+		{
+			g_hash_table_insert (monitor->pending, g_strdup (key), value);
+		}
+	}
+}
+
+static void
+update_ready (GObject      *source_object,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (source_object);
+	Update *update;
+	GError *error = NULL;
+
+	monitor->busy = FALSE;
+	update = g_task_get_task_data (G_TASK (result));
+
+	if (!g_task_propagate_boolean (G_TASK (result), &error))
+	{
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			g_warning ("Failed to update the status of %s: %s",
+			           git_repository_workdir (monitor->repo),
+			           error->message);
+
+			/* Nothing of the update was applied, try it again
+			 * later together with what changed since.
+			 */
+			requeue_update (monitor, update);
+			schedule_update_in (monitor, MAX (monitor->latency, RETRY_INTERVAL));
+		}
+
+		g_error_free (error);
+		return;
+	}
+
+	if (update->directories_only)
+	{
+		/* Watch everything before the first scan starts, so that
+		 * changes made during the scan are seen.
+		 */
+		apply_directories (monitor, update);
+		monitor->watching = TRUE;
+
+		requeue_update (monitor, update);
+		start_update (monitor);
+
+		return;
+	}
+
+	if (!monitor->ready || g_hash_table_size (update->paths) > 0 || update->rescan)
+	{
+		GHashTable *changed;
+
+		apply_directories (monitor, update);
+		changed = apply_statuses (monitor, update);
+
+		if (g_hash_table_size (changed) > 0)
+		{
+			gchar **paths = sorted_keys (changed);
+
+			g_signal_emit (monitor, signals[CHANGED], 0, paths);
+			g_strfreev (paths);
+		}
+
+		g_hash_table_unref (changed);
+	}
+
+	if (!monitor->ready)
+	{
+		monitor->ready = TRUE;
+		g_object_notify (G_OBJECT (monitor), "ready");
+	}
+
+	start_update (monitor);
+}
+
+static void
+start_update (GgitStatusMonitor *monitor)
+{
+	Update *update;
+	GTask *task;
+
+	if (monitor->busy || g_cancellable_is_cancelled (monitor->cancellable))
+	{
+		return;
+	}
+
+	if (!monitor->pending_rescan &&
+	    !monitor->pending_refresh &&
+	    g_hash_table_size (monitor->pending) == 0)
+	{
+		return;
+	}
+
+	update = g_slice_new0 (Update);
+	update->paths = monitor->pending;
+	update->rescan = monitor->pending_rescan;
+	update->refresh = monitor->pending_refresh;
+	update->rescan_threshold = monitor->rescan_threshold;
+	update->directories_only = update->rescan && !monitor->watching;
+	update->statuses = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	update->directories = g_ptr_array_new_with_free_func (g_free);
+
+	monitor->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	monitor->pending_rescan = FALSE;
+	monitor->pending_refresh = FALSE;
+	monitor->busy = TRUE;
+
+	task = g_task_new (monitor, monitor->cancellable, update_ready, NULL);
+	g_task_set_source_tag (task, start_update);
+	g_task_set_task_data (task, update, (GDestroyNotify)update_free);
+
+	_ggit_async_run (task, update_thread);
+	g_object_unref (task);
+}
+
+static gboolean
+on_timeout (gpointer user_data)
+{
+	GgitStatusMonitor *monitor = user_data;
+
+	g_clear_pointer (&monitor->timeout, g_source_unref);
+	start_update (monitor);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_update_in (GgitStatusMonitor *monitor,
+                    guint              interval)
+{
+	/* Events arriving while an update runs are picked up when it is done */
+	if (monitor->busy || monitor->timeout != NULL)
+	{
+		return;
+	}
+
+	monitor->timeout = g_timeout_source_new (interval);
+	g_source_set_callback (monitor->timeout, on_timeout, monitor, NULL);
+	g_source_attach (monitor->timeout, monitor->context);
+}
+
+static void
+schedule_update (GgitStatusMonitor *monitor)
+{
+	schedule_update_in (monitor, monitor->latency);
+}
+
+static void
+on_workdir_changed (GFileMonitor      *file_monitor,
+                    GFile             *file,
+                    GFile             *other_file,
+                    GFileMonitorEvent  event,
+                    GgitStatusMonitor *monitor)
+{
+	gchar *path;
+	gboolean is_directory;
+
+	if (event == G_FILE_MONITOR_EVENT_PRE_UNMOUNT ||
+	    event == G_FILE_MONITOR_EVENT_UNMOUNTED)
+	{
+		return;
+	}
+
+	path = g_file_get_relative_path (monitor->workdir, file);
+
+	if (path == NULL ||
+	    strcmp (path, ".git") == 0 ||
+	    g_str_has_prefix (path, ".git/"))
+	{
+		g_free (path);
+		return;
+	}
+
+#ifdef G_OS_WIN32
+	g_strdelimit (path, "\\", '/');
+#endif
+
+	is_directory = g_hash_table_contains (monitor->monitors, path);
+
+	if (event == G_FILE_MONITOR_EVENT_DELETED && is_directory)
+	{
+		remove_directory_monitors (monitor, path);
+	}
+	else if (event == G_FILE_MONITOR_EVENT_CREATED && !is_directory)
+	{
+		is_directory = g_file_query_file_type (file,
+		                                       G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+		                                       NULL) == G_FILE_TYPE_DIRECTORY;
+	}
+
+	queue_path (monitor, path, is_directory);
+	g_free (path);
+}
+
+static void
+on_gitdir_changed (GFileMonitor      *file_monitor,
+                   GFile             *file,
+                   GFile             *other_file,
+                   GFileMonitorEvent  event,
+                   GgitStatusMonitor *monitor)
+{
+	gchar *name;
+
+	name = g_file_get_basename (file);
+
+	/* Lock files come and go with every write, wait for the rename */
+	if (!g_str_has_suffix (name, ".lock"))
+	{
+		monitor->pending_refresh = TRUE;
+		schedule_update (monitor);
+	}
+
+	g_free (name);
+}
+
+static void
+add_gitdir_monitor (GgitStatusMonitor *monitor,
+                    GFile             *dir)
+{
+	GFileMonitor *file_monitor;
+
+	file_monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_NONE, NULL, NULL);
+
+	if (file_monitor != NULL)
+	{
+		g_signal_connect (file_monitor,
+		                  "changed",
+		                  G_CALLBACK (on_gitdir_changed),
+		                  monitor);
+
+		g_ptr_array_add (monitor->gitdir_monitors, file_monitor);
+	}
+}
+
+static gboolean
+ggit_status_monitor_initable_init (GInitable     *initable,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (initable);
+	GFile *location;
+	GFile *refs;
+	gchar *path;
+	gint ret;
+
+	if (cancellable != NULL)
+	{
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+		                     "Cancellable initialization not supported");
+
+		return FALSE;
+	}
+
+	if (monitor->repository == NULL)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_NOT_INITIALIZED,
+		                     "No repository specified");
+		return FALSE;
+	}
+
+	monitor->workdir = ggit_repository_get_workdir (monitor->repository);
+
+	if (monitor->workdir == NULL)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_NOT_SUPPORTED,
+		                     "Bare repositories have no status to monitor");
+		return FALSE;
+	}
+
+	/* The status is computed on worker threads, with a handle on the
+	 * repository that is not shared with the caller. */
+	location = ggit_repository_get_location (monitor->repository);
+	path = g_file_get_path (location);
+
+	ret = git_repository_open (&monitor->repo, path);
+	g_free (path);
+
+	if (ret == GIT_OK)
+	{
+		path = g_file_get_path (monitor->workdir);
+		ret = git_repository_set_workdir (monitor->repo, path, 0);
+		g_free (path);
+	}
+
+	if (ret != GIT_OK)
+	{
+		g_object_unref (location);
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	add_gitdir_monitor (monitor, location);
+
+	refs = g_file_resolve_relative_path (location, "refs/heads");
+	add_gitdir_monitor (monitor, refs);
+	g_object_unref (refs);
+
+	g_object_unref (location);
+
+	if (monitor->status_options != NULL &&
+	    ggit_status_options_get_untracked_cache (monitor->status_options) != NULL)
+	{
+		monitor->untracked_cache = ggit_untracked_cache_ref (ggit_status_options_get_untracked_cache (monitor->status_options));
+	}
+	else
+	{
+		monitor->untracked_cache = ggit_untracked_cache_new ();
+	}
+
+	monitor->pending_rescan = TRUE;
+	monitor->pending_refresh = TRUE;
+	start_update (monitor);
+
+	return TRUE;
+}
+
+static void
+ggit_status_monitor_initable_iface_init (GInitableIface *iface)
+{
+	iface->init = ggit_status_monitor_initable_init;
+}
+
+static void
+ggit_status_monitor_class_init (GgitStatusMonitorClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = ggit_status_monitor_dispose;
+	object_class->finalize = ggit_status_monitor_finalize;
+	object_class->get_property = ggit_status_monitor_get_property;
+	object_class->set_property = ggit_status_monitor_set_property;
+
+	g_object_class_install_property (object_class,
+	                                 PROP_REPOSITORY,
+	                                 g_param_spec_object ("repository",
+	                                                      "Repository",
+	                                                      "The repository to monitor",
+	                                                      GGIT_TYPE_REPOSITORY,
+	                                                      G_PARAM_READWRITE |
+	                                                      G_PARAM_CONSTRUCT_ONLY |
+	                                                      G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_STATUS_OPTIONS,
+	                                 g_param_spec_boxed ("status-options",
+	                                                     "Status options",
+	                                                     "The options used to compute the status",
+	                                                     GGIT_TYPE_STATUS_OPTIONS,
+	                                                     G_PARAM_READWRITE |
+	                                                     G_PARAM_CONSTRUCT_ONLY |
+	                                                     G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_LATENCY,
+	                                 g_param_spec_uint ("latency",
+	                                                    "Latency",
+	                                                    "How long changes are collected before updating, in milliseconds",
+	                                                    0,
+	                                                    G_MAXUINT,
+	                                                    DEFAULT_LATENCY,
+	                                                    G_PARAM_READWRITE |
+	                                                    G_PARAM_CONSTRUCT |
+	                                                    G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_RESCAN_THRESHOLD,
+	                                 g_param_spec_uint ("rescan-threshold",
+	                                                    "Rescan threshold",
+	                                                    "The number of pending paths above which the whole working directory is scanned",
+	                                                    1,
+	                                                    G_MAXUINT,
+	                                                    DEFAULT_RESCAN_THRESHOLD,
+	                                                    G_PARAM_READWRITE |
+	                                                    G_PARAM_CONSTRUCT |
+	                                                    G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_READY,
+	                                 g_param_spec_boolean ("ready",
+	                                                       "Ready",
+	                                                       "Whether the initial scan is done",
+	                                                       FALSE,
+	                                                       G_PARAM_READABLE |
+	                                                       G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GgitStatusMonitor::changed:
+	 * @monitor: a #GgitStatusMonitor.
+	 * @paths: the sorted paths whose status changed.
+	 *
+	 * Emitted after an update when the status of some paths changed,
+	 * including after the initial scan. Paths that became current are
+	 * included, ggit_status_monitor_get_status() returns
+	 * #GGIT_STATUS_CURRENT for them.
+	 */
+	signals[CHANGED] =
+		g_signal_new ("changed",
+		              G_TYPE_FROM_CLASS (klass),
+		              G_SIGNAL_RUN_LAST,
+		              0,
+		              NULL, NULL,
+		              NULL,
+		              G_TYPE_NONE,
+		              1,
+		              G_TYPE_STRV);
+}
+
+static void
+ggit_status_monitor_init (GgitStatusMonitor *monitor)
+{
+	monitor->context = g_main_context_ref_thread_default ();
+	monitor->cancellable = g_cancellable_new ();
+
+	monitor->monitors = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                           g_free,
+	                                           (GDestroyNotify)file_monitor_free);
+	monitor->gitdir_monitors = g_ptr_array_new_with_free_func ((GDestroyNotify)file_monitor_free);
+	monitor->statuses = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	monitor->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
+
+/**
+ * ggit_status_monitor_new:
+ * @repository: a #GgitRepository.
+ * @status_options: (allow-none): a #GgitStatusOptions or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Creates a new #GgitStatusMonitor for the working directory of
+ * @repository and starts the initial scan. Without @status_options,
+ * untracked files are included.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitStatusMonitor or %NULL
+ * if there was an error.
+ */
+GgitStatusMonitor *
+ggit_status_monitor_new (GgitRepository     *repository,
+                         GgitStatusOptions  *status_options,
+                         GError            **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return g_initable_new (GGIT_TYPE_STATUS_MONITOR, NULL, error,
+	                       "repository", repository,
+	                       "status-options", status_options,
+	                       NULL);
+}
+
+/**
+ * ggit_status_monitor_get_repository:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Gets the repository monitored by @monitor.
+ *
+ * Returns: (transfer none): a #GgitRepository.
+ */
+GgitRepository *
+ggit_status_monitor_get_repository (GgitStatusMonitor *monitor)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), NULL);
+
+	return monitor->repository;
+}
+
+/**
+ * ggit_status_monitor_get_ready:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Gets whether the initial scan of the working directory is done. Before
+ * that, every path is reported as current.
+ *
+ * Returns: %TRUE if the initial scan is done, %FALSE otherwise.
+ */
+gboolean
+ggit_status_monitor_get_ready (GgitStatusMonitor *monitor)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), FALSE);
+
+	return monitor->ready;
+}
+
+/**
+ * ggit_status_monitor_set_latency:
+ * @monitor: a #GgitStatusMonitor.
+ * @latency: the latency in milliseconds.
+ *
+ * Sets how long changes are collected before the status is updated. A
+ * longer latency coalesces more events into one update.
+ */
+void
+ggit_status_monitor_set_latency (GgitStatusMonitor *monitor,
+                                 guint              latency)
+{
+	g_return_if_fail (GGIT_IS_STATUS_MONITOR (monitor));
+
+	if (monitor->latency != latency)
+	{
+		monitor->latency = latency;
+		g_object_notify (G_OBJECT (monitor), "latency");
+	}
+}
+
+/**
+ * ggit_status_monitor_get_latency:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Gets how long changes are collected before the status is updated.
+ *
+ * Returns: the latency in milliseconds.
+ */
+guint
+ggit_status_monitor_get_latency (GgitStatusMonitor *monitor)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), 0);
+
+	return monitor->latency;
+}
+
+/**
+ * ggit_status_monitor_set_rescan_threshold:
+ * @monitor: a #GgitStatusMonitor.
+ * @threshold: the number of pending paths.
+ *
+ * Sets the number of pending paths above which the whole working
+ * directory is scanned again instead of the individual paths.
+ */
+void
+ggit_status_monitor_set_rescan_threshold (GgitStatusMonitor *monitor,
+                                          guint              threshold)
+{
+	g_return_if_fail (GGIT_IS_STATUS_MONITOR (monitor));
+	g_return_if_fail (threshold > 0);
+
+	if (monitor->rescan_threshold != threshold)
+	{
+		monitor->rescan_threshold = threshold;
+		g_object_notify (G_OBJECT (monitor), "rescan-threshold");
+	}
+}
+
+/**
+ * ggit_status_monitor_get_rescan_threshold:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Gets the number of pending paths above which the whole working directory
+ * is scanned again.
+ *
+ * Returns: the rescan threshold.
+ */
+guint
+ggit_status_monitor_get_rescan_threshold (GgitStatusMonitor *monitor)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), 0);
+
+	return monitor->rescan_threshold;
+}
+
+/**
+ * ggit_status_monitor_get_status:
+ * @monitor: a #GgitStatusMonitor.
+ * @path: a path relative to the working directory.
+ *
+ * Gets the last known status of @path. This does not touch the file
+ * system.
+ *
+ * Returns: the #GgitStatusFlags of @path.
+ */
+GgitStatusFlags
+ggit_status_monitor_get_status (GgitStatusMonitor *monitor,
+                                const gchar       *path)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), GGIT_STATUS_CURRENT);
+	g_return_val_if_fail (path != NULL, GGIT_STATUS_CURRENT);
+
+	return GPOINTER_TO_UINT (g_hash_table_lookup (monitor->statuses, path));
+}
+
+/**
+ * ggit_status_monitor_get_paths:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Gets the paths whose last known status is not current.
+ *
+ * Returns: (transfer full) (array zero-terminated=1): the sorted paths.
+ */
+gchar **
+ggit_status_monitor_get_paths (GgitStatusMonitor *monitor)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), NULL);
+
+	return sorted_keys (monitor->statuses);
+}
+
+/**
+ * ggit_status_monitor_rescan:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Schedules a full scan of the working directory, for example after
+ * changes the monitor cannot observe.
+ */
+void
+ggit_status_monitor_rescan (GgitStatusMonitor *monitor)
+{
+	g_return_if_fail (GGIT_IS_STATUS_MONITOR (monitor));
+
+	g_hash_table_remove_all (monitor->pending);
+	monitor->pending_rescan = TRUE;
+	monitor->pending_refresh = TRUE;
+
+	schedule_update (monitor);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,63 @@
+/*
+ * ggit-status-monitor.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_STATUS_MONITOR_H__
+#define __GGIT_STATUS_MONITOR_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_STATUS_MONITOR (ggit_status_monitor_get_type ())
+G_DECLARE_FINAL_TYPE (GgitStatusMonitor, ggit_status_monitor, GGIT, STATUS_MONITOR, GObject)
+
+GgitStatusMonitor   *ggit_status_monitor_new                    (GgitRepository     *repository,
+                                                                 GgitStatusOptions  *status_options,
+                                                                 GError            **error);
+
+GgitRepository      *ggit_status_monitor_get_repository         (GgitStatusMonitor  *monitor);
+
+gboolean             ggit_status_monitor_get_ready              (GgitStatusMonitor  *monitor);
+
+void                 ggit_status_monitor_set_latency            (GgitStatusMonitor  *monitor,
+                                                                 guint               latency);
+
+guint                ggit_status_monitor_get_latency            (GgitStatusMonitor  *monitor);
+
+void                 ggit_status_monitor_set_rescan_threshold   (GgitStatusMonitor  *monitor,
+                                                                 guint               threshold);
+
+guint                ggit_status_monitor_get_rescan_threshold   (GgitStatusMonitor  *monitor);
+
+GgitStatusFlags      ggit_status_monitor_get_status             (GgitStatusMonitor  *monitor,
+                                                                 const gchar        *path);
+
+gchar              **ggit_status_monitor_get_paths              (GgitStatusMonitor  *monitor);
+
+void                 ggit_status_monitor_rescan                 (GgitStatusMonitor  *monitor);
+
+G_END_DECLS
+
+#endif /* __GGIT_STATUS_MONITOR_H__ */
+
+/* ex:set ts=8 noet: */
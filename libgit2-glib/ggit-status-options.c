@@ -20,11 +20,15 @@
  */
 
 #include "ggit-status-options.h"
+#include "ggit-untracked-cache.h"
 #include "ggit-utils.h"
 
 struct _GgitStatusOptions
 {
 	git_status_options status_options;
+
+	GgitUntrackedCache *untracked_cache;
+	gchar **changed_paths;
 };
 
 G_DEFINE_BOXED_TYPE (GgitStatusOptions, ggit_status_options,
@@ -66,6 +70,15 @@ ggit_status_options_copy (GgitStatusOptions *status_options)
 	git_strarray_copy (&new_status_options->status_options.pathspec,
 	                   &status_options->status_options.pathspec);
 
+	new_status_options->untracked_cache = NULL;
+
+	if (status_options->untracked_cache != NULL)
+	{
+		new_status_options->untracked_cache = ggit_untracked_cache_ref (status_options->untracked_cache);
+	}
+
+	new_status_options->changed_paths = g_strdupv (status_options->changed_paths);
+
 	return new_status_options;
 }
 
@@ -85,6 +98,9 @@ ggit_status_options_free (GgitStatusOptions *status_options)
 	gstatus_options = &status_options->status_options;
 	git_strarray_free (&gstatus_options->pathspec);
 
+	g_clear_pointer (&status_options->untracked_cache, ggit_untracked_cache_unref);
+	g_strfreev (status_options->changed_paths);
+
 	g_slice_free (GgitStatusOptions, status_options);
 }
 
@@ -115,8 +131,90 @@ ggit_status_options_new (GgitStatusOption   options,
 	                                            &gstatus_options.pathspec);
 
 	status_options->status_options = gstatus_options;
+	status_options->untracked_cache = NULL;
+	status_options->changed_paths = NULL;
 
 	return status_options;
 }
 
+/**
+ * ggit_status_options_set_untracked_cache:
+ * @status_options: a #GgitStatusOptions.
+ * @cache: (allow-none): a #GgitUntrackedCache, or %NULL.
+ *
+ * Sets the cache used to find untracked files. The cache is only used when
+ * untracked files are included, ignored files are not and no pathspec is
+ * set; otherwise the status is computed without it.
+ */
+void
+ggit_status_options_set_untracked_cache (GgitStatusOptions  *status_options,
+                                         GgitUntrackedCache *cache)
+{
+	g_return_if_fail (status_options != NULL);
+
+	if (cache != NULL)
+	{
+		ggit_untracked_cache_ref (cache);
+	}
+
+	g_clear_pointer (&status_options->untracked_cache, ggit_untracked_cache_unref);
+	status_options->untracked_cache = cache;
+}
+
+/**
+ * ggit_status_options_get_untracked_cache:
+ * @status_options: a #GgitStatusOptions.
+ *
+ * Gets the cache used to find untracked files.
+ *
+ * Returns: (transfer none) (nullable): a #GgitUntrackedCache or %NULL.
+ */
+GgitUntrackedCache *
+ggit_status_options_get_untracked_cache (GgitStatusOptions *status_options)
+{
+	g_return_val_if_fail (status_options != NULL, NULL);
+
+	return status_options->untracked_cache;
+}
+
+/**
+ * ggit_status_options_set_changed_paths:
+ * @status_options: a #GgitStatusOptions.
+ * @paths: (allow-none) (array zero-terminated=1): the paths, relative to
+ *   the working directory, that changed since the untracked cache was last
+ *   used, or %NULL.
+ *
+ * Tells the untracked cache which paths changed, for example as reported
+ * by a file system monitor, so that other directories are not even looked
+ * at. %NULL means the changes are unknown and every directory is checked;
+ * an empty array means nothing changed. Has no effect without an untracked
+ * cache, see ggit_status_options_set_untracked_cache().
+ */
+void
+ggit_status_options_set_changed_paths (GgitStatusOptions  *status_options,
+                                       const gchar       **paths)
+{
+	g_return_if_fail (status_options != NULL);
+
+	g_strfreev (status_options->changed_paths);
+	status_options->changed_paths = g_strdupv ((gchar **)paths);
+}
+
+/**
+ * ggit_status_options_get_changed_paths:
+ * @status_options: a #GgitStatusOptions.
+ *
+ * Gets the paths set with ggit_status_options_set_changed_paths().
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   changed paths or %NULL.
+ */
+const gchar * const *
+ggit_status_options_get_changed_paths (GgitStatusOptions *status_options)
+{
+	g_return_val_if_fail (status_options != NULL, NULL);
+
+	return (const gchar * const *)status_options->changed_paths;
+}
+
 /* ex:set ts=8 noet: */
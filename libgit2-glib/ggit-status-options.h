@@ -45,6 +45,16 @@ GgitStatusOptions *ggit_status_options_new                (GgitStatusOption
                                                            GgitStatusShow            show,
                                                            const gchar             **pathspec);
 
+void               ggit_status_options_set_untracked_cache (GgitStatusOptions       *status_options,
+                                                            GgitUntrackedCache      *cache);
+GgitUntrackedCache *
+                   ggit_status_options_get_untracked_cache (GgitStatusOptions       *status_options);
+
+void               ggit_status_options_set_changed_paths  (GgitStatusOptions        *status_options,
+                                                           const gchar             **paths);
+const gchar * const *
+                   ggit_status_options_get_changed_paths  (GgitStatusOptions        *status_options);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitStatusOptions, ggit_status_options_free)
 
 G_END_DECLS
@@ -0,0 +1,451 @@
+/*
+ * ggit-stream-writer.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ggit-stream-writer.h"
+
+/* Number of buffers in flight in pipelined mode, one being filled while
+ * the other is written out.
+ */
+#define N_PIPELINE_BLOCKS 2
+
+typedef struct
+{
+	gchar *data;
+	gsize size;
+	gboolean last;
+} Block;
+
+/*
+ * GgitStreamWriter:
+ *
+ * Coalesces the many small writes done when serializing diffs and patches
+ * into writes of the configured buffer size.
+ *
+ * In pipelined mode the buffers are written out by a dedicated thread, so
+ * producing the next buffer overlaps with writing the previous one. The
+ * number of buffers is bounded, a producer faster than the stream blocks
+ * until a buffer has been written.
+ */
+struct _GgitStreamWriter
+{
+	GOutputStream *stream;
+	GCancellable *cancellable;
+	GError *error;
+
+	gsize buffer_size;
+	Block *current;
+
+	gboolean vectored;
+
+	/* pipelined mode */
+	GThread *thread;
+	GAsyncQueue *free_blocks;
+	GAsyncQueue *full_blocks;
+	gint failed;
+	GError *thread_error;
+};
+
+static Block *
+block_new (gsize buffer_size)
+{
+	Block *block;
+
+	block = g_slice_new0 (Block);
+	block->data = g_malloc (buffer_size);
+
+	return block;
+}
+
+static void
+block_free (Block *block)
+{
+	g_free (block->data);
+	g_slice_free (Block, block);
+}
+
+static gpointer
+writer_thread (gpointer data)
+{
+	GgitStreamWriter *writer = data;
+
+	while (TRUE)
+	{
+		Block *block;
+		gboolean last;
+
+		block = g_async_queue_pop (writer->full_blocks);
+		last = block->last;
+
+		/* Keep recycling the blocks after a failure so that the
+		 * producer never waits forever for a free one.
+		 */
+		if (!g_atomic_int_get (&writer->failed) && block->size > 0)
+		{
+			if (!g_output_stream_write_all (writer->stream,
+			                                block->data,
+			                                block->size,
+			                                NULL,
+			                                writer->cancellable,
+			                                &writer->thread_error))
+			{
+				g_atomic_int_set (&writer->failed, 1);
+			}
+		}
+
+		block->size = 0;
+		block->last = FALSE;
+		g_async_queue_push (writer->free_blocks, block);
+
+		if (last)
+		{
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * _ggit_stream_writer_new:
+ * @stream: the #GOutputStream to write to.
+ * @buffer_size: the size of the buffer, or 0 for the default size.
+ * @pipelined: whether to write from a separate thread.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ *
+ * Creates a writer buffering the data written to @stream. @stream must not
+ * be used until the writer is closed with _ggit_stream_writer_close().
+ *
+ * Returns: a new #GgitStreamWriter.
+ */
+GgitStreamWriter *
+_ggit_stream_writer_new (GOutputStream *stream,
+                         gsize          buffer_size,
+                         gboolean       pipelined,
+                         GCancellable  *cancellable)
+{
+	GgitStreamWriter *writer;
+
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), NULL);
+
+	writer = g_slice_new0 (GgitStreamWriter);
+
+	writer->stream = g_object_ref (stream);
+	writer->cancellable = cancellable != NULL ? g_object_ref (cancellable) : NULL;
+	writer->buffer_size = buffer_size > 0 ? buffer_size : GGIT_STREAM_WRITER_DEFAULT_BUFFER_SIZE;
+
+#if GLIB_CHECK_VERSION (2, 60, 0)
+	/* Pollable streams (sockets, pipes, files) implement writev natively,
+	 * for others it only falls back to one write per vector.
+	 */
+	writer->vectored = G_IS_POLLABLE_OUTPUT_STREAM (stream) &&
+	                   g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (stream));
+#endif
+
+	if (pipelined)
+	{
+		gint i;
+
+		writer->free_blocks = g_async_queue_new_full ((GDestroyNotify)block_free);
+		writer->full_blocks = g_async_queue_new_full ((GDestroyNotify)block_free);
+
+		for (i = 1; i < N_PIPELINE_BLOCKS; i++)
+		{
+			g_async_queue_push (writer->free_blocks, block_new (writer->buffer_size));
+		}
+
+		writer->thread = g_thread_new ("ggit-stream-writer", writer_thread, writer);
+	}
+
+	writer->current = block_new (writer->buffer_size);
+
+	return writer;
+}
+
+static gboolean
+writer_check_cancelled (GgitStreamWriter *writer)
+{
+	if (writer->error == NULL)
+	{
+		g_cancellable_set_error_if_cancelled (writer->cancellable, &writer->error);
+	}
+
+	return writer->error != NULL;
+}
+
+static gboolean
+writer_flush (GgitStreamWriter *writer)
+{
+	Block *block = writer->current;
+	gsize size;
+
+	if (block->size == 0)
+	{
+		return TRUE;
+	}
+
+	if (writer->thread != NULL)
+	{
+		if (g_atomic_int_get (&writer->failed))
+		{
+			return FALSE;
+		}
+
+		g_async_queue_push (writer->full_blocks, block);
+
+		/* Blocks while the writer thread is behind */
+		writer->current = g_async_queue_pop (writer->free_blocks);
+
+		return TRUE;
+	}
+
+	size = block->size;
+	block->size = 0;
+
+	return g_output_stream_write_all (writer->stream,
+	                                  block->data,
+	                                  size,
+	                                  NULL,
+	                                  writer->cancellable,
+	                                  &writer->error);
+}
+
+static gboolean
+writer_write_large (GgitStreamWriter *writer,
+                    const gchar      *data,
+                    gsize             size)
+{
+#if GLIB_CHECK_VERSION (2, 60, 0)
+	if (writer->vectored && writer->thread == NULL)
+	{
+		GOutputVector vectors[2];
+		Block *block = writer->current;
+		gsize n_vectors = 0;
+
+		if (block->size > 0)
+		{
+			vectors[n_vectors].buffer = block->data;
+			vectors[n_vectors].size = block->size;
+			n_vectors++;
+		}
+
+		vectors[n_vectors].buffer = data;
+		vectors[n_vectors].size = size;
+		n_vectors++;
+
+		block->size = 0;
+
+		/* The buffered data and the chunk in a single syscall */
+		return g_output_stream_writev_all (writer->stream,
+		                                   vectors,
+		                                   n_vectors,
+		                                   NULL,
+		                                   writer->cancellable,
+		                                   &writer->error);
+	}
+#endif
+
+	if (!writer_flush (writer))
+	{
+		return FALSE;
+	}
+
+	if (writer->thread == NULL)
+	{
+		return g_output_stream_write_all (writer->stream,
+		                                  data,
+		                                  size,
+		                                  NULL,
+		                                  writer->cancellable,
+		                                  &writer->error);
+	}
+
+	/* Copy through the bounded blocks to keep the memory use bounded */
+	while (size > 0)
+	{
+		Block *block = writer->current;
+		gsize n;
+
+		n = MIN (size, writer->buffer_size - block->size);
+		memcpy (block->data + block->size, data, n);
+		block->size += n;
+
+		data += n;
+		size -= n;
+
+		if (block->size == writer->buffer_size && !writer_flush (writer))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * _ggit_stream_writer_write:
+ * @writer: a #GgitStreamWriter.
+ * @data: the data to write.
+ * @size: the size of @data.
+ *
+ * Appends @data to the buffer of @writer, writing the buffer out when it is
+ * full. Once a write failed, all the following writes fail too and the
+ * error is reported by _ggit_stream_writer_close().
+ *
+ * Returns: %TRUE if the data was written or buffered, %FALSE otherwise.
+ */
+gboolean
+_ggit_stream_writer_write (GgitStreamWriter *writer,
+                           const gchar      *data,
+                           gsize             size)
+{
+	Block *block = writer->current;
+
+	if (writer->error != NULL || g_atomic_int_get (&writer->failed))
+	{
+		return FALSE;
+	}
+
+	if (size <= writer->buffer_size - block->size)
+	{
+		memcpy (block->data + block->size, data, size);
+		block->size += size;
+
+		return TRUE;
+	}
+
+	if (writer_check_cancelled (writer))
+	{
+		return FALSE;
+	}
+
+	if (size >= writer->buffer_size)
+	{
+		return writer_write_large (writer, data, size);
+	}
+
+	if (!writer_flush (writer))
+	{
+		return FALSE;
+	}
+
+	block = writer->current;
+
+	memcpy (block->data, data, size);
+	block->size = size;
+
+	return TRUE;
+}
+
+/*
+ * _ggit_stream_writer_close:
+ * @writer: a #GgitStreamWriter.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes out the remaining buffered data, waits for the writer thread in
+ * pipelined mode and frees @writer. The stream itself is not closed.
+ *
+ * Returns: %TRUE if all the data was written, %FALSE otherwise.
+ */
+gboolean
+_ggit_stream_writer_close (GgitStreamWriter  *writer,
+                           GError           **error)
+{
+	gboolean ret;
+
+	if (writer->error == NULL)
+	{
+		writer_flush (writer);
+	}
+
+	if (writer->thread != NULL)
+	{
+		Block *block;
+
+		block = g_async_queue_pop (writer->free_blocks);
+		block->last = TRUE;
+		g_async_queue_push (writer->full_blocks, block);
+
+		g_thread_join (writer->thread);
+
+		if (writer->error == NULL && writer->thread_error != NULL)
+		{
+			writer->error = writer->thread_error;
+			writer->thread_error = NULL;
+		}
+
+		g_clear_error (&writer->thread_error);
+		g_async_queue_unref (writer->full_blocks);
+		g_async_queue_unref (writer->free_blocks);
+	}
+
+	ret = writer->error == NULL;
+
+	if (!ret)
+	{
+		g_propagate_error (error, writer->error);
+	}
+
+	block_free (writer->current);
+	g_clear_object (&writer->cancellable);
+	g_object_unref (writer->stream);
+
+	g_slice_free (GgitStreamWriter, writer);
+
+	return ret;
+}
+
+/*
+ * _ggit_stream_writer_print_line:
+ *
+ * A libgit2 print callback writing each line to the #GgitStreamWriter
+ * passed as @payload, prefixed by its origin for context, addition and
+ * deletion lines like git_patch_to_buf() does.
+ */
+gint
+_ggit_stream_writer_print_line (const git_diff_delta *delta,
+                                const git_diff_hunk  *hunk,
+                                const git_diff_line  *line,
+                                gpointer              payload)
+{
+	GgitStreamWriter *writer = payload;
+
+	if (line->origin == GIT_DIFF_LINE_CONTEXT ||
+	    line->origin == GIT_DIFF_LINE_ADDITION ||
+	    line->origin == GIT_DIFF_LINE_DELETION)
+	{
+		gchar origin = line->origin;
+
+		if (!_ggit_stream_writer_write (writer, &origin, 1))
+		{
+			return GIT_EUSER;
+		}
+	}
+
+	if (!_ggit_stream_writer_write (writer, line->content, line->content_len))
+	{
+		return GIT_EUSER;
+	}
+
+	return 0;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,54 @@
+/*
+ * ggit-stream-writer.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_STREAM_WRITER_H__
+#define __GGIT_STREAM_WRITER_H__
+
+#include <gio/gio.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_STREAM_WRITER_DEFAULT_BUFFER_SIZE (64 * 1024)
+
+typedef struct _GgitStreamWriter GgitStreamWriter;
+
+GgitStreamWriter *_ggit_stream_writer_new        (GOutputStream        *stream,
+                                                  gsize                 buffer_size,
+                                                  gboolean              pipelined,
+                                                  GCancellable         *cancellable);
+
+gboolean          _ggit_stream_writer_write      (GgitStreamWriter     *writer,
+                                                  const gchar          *data,
+                                                  gsize                 size);
+
+gboolean          _ggit_stream_writer_close      (GgitStreamWriter     *writer,
+                                                  GError              **error);
+
+gint              _ggit_stream_writer_print_line (const git_diff_delta *delta,
+                                                  const git_diff_hunk  *hunk,
+                                                  const git_diff_line  *line,
+                                                  gpointer              payload);
+
+G_END_DECLS
+
+#endif /* __GGIT_STREAM_WRITER_H__ */
+
+/* ex:set ts=8 noet: */
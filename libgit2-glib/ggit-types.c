@@ -121,6 +121,11 @@ ASSERT_ENUM (GGIT_FILE_MODE_BLOB_EXECUTABLE, GIT_FILEMODE_BLOB_EXECUTABLE);
 ASSERT_ENUM (GGIT_FILE_MODE_LINK, GIT_FILEMODE_LINK);
 ASSERT_ENUM (GGIT_FILE_MODE_COMMIT, GIT_FILEMODE_COMMIT);
 
+ASSERT_ENUM (GGIT_INDEX_ADD_DEFAULT,                GIT_INDEX_ADD_DEFAULT);
+ASSERT_ENUM (GGIT_INDEX_ADD_FORCE,                  GIT_INDEX_ADD_FORCE);
+ASSERT_ENUM (GGIT_INDEX_ADD_DISABLE_PATHSPEC_MATCH, GIT_INDEX_ADD_DISABLE_PATHSPEC_MATCH);
+ASSERT_ENUM (GGIT_INDEX_ADD_CHECK_PATHSPEC,         GIT_INDEX_ADD_CHECK_PATHSPEC);
+
 ASSERT_ENUM (GGIT_MERGE_FILE_FAVOR_NORMAL, GIT_MERGE_FILE_FAVOR_NORMAL);
 ASSERT_ENUM (GGIT_MERGE_FILE_FAVOR_OURS, GIT_MERGE_FILE_FAVOR_OURS);
 ASSERT_ENUM (GGIT_MERGE_FILE_FAVOR_THEIRS, GIT_MERGE_FILE_FAVOR_THEIRS);
@@ -53,6 +53,20 @@ typedef struct _GgitCloneOptions GgitCloneOptions;
  */
 typedef struct _GgitConfigEntry GgitConfigEntry;
 
+/**
+ * GgitCommitGraph:
+ *
+ * Represents a commit-graph file.
+ */
+typedef struct _GgitCommitGraph GgitCommitGraph;
+
+/**
+ * GgitCommitTable:
+ *
+ * Represents the metadata of a list of commits.
+ */
+typedef struct _GgitCommitTable GgitCommitTable;
+
 /**
  * GgitCredSshInteractivePrompt:
  *
@@ -109,6 +123,13 @@ typedef struct _GgitDiffLine GgitDiffLine;
  */
 typedef struct _GgitDiffSimilarityMetric GgitDiffSimilarityMetric;
 
+/**
+ * GgitDiffStats:
+ *
+ * Represents the line counts of a diff.
+ */
+typedef struct _GgitDiffStats GgitDiffStats;
+
 /**
  * GgitBlameHunk:
  *
@@ -151,6 +172,13 @@ typedef struct _GgitIndexEntriesResolveUndo GgitIndexEntriesResolveUndo;
  */
 typedef struct _GgitIndexEntryResolveUndo GgitIndexEntryResolveUndo;
 
+/**
+ * GgitIndexSnapshot:
+ *
+ * Represents an immutable snapshot of the entries in an index.
+ */
+typedef struct _GgitIndexSnapshot GgitIndexSnapshot;
+
 /**
  * GgitMergeOptions:
  *
@@ -172,6 +200,20 @@ typedef struct _GgitNote GgitNote;
  */
 typedef struct _GgitOId GgitOId;
 
+/**
+ * GgitOIdMap:
+ *
+ * Represents a map from object ids to arbitrary values.
+ */
+typedef struct _GgitOIdMap GgitOIdMap;
+
+/**
+ * GgitOIdSet:
+ *
+ * Represents a set of object ids.
+ */
+typedef struct _GgitOIdSet GgitOIdSet;
+
 /**
  * GgitPatch:
  *
@@ -240,6 +282,10 @@ typedef struct _GgitRemote GgitRemote;
  *
  * Represents an existing git repository including all of it's
  * object contents.
+ *
+ * Repositories can be opened and closed from any thread, but a single
+ * #GgitRepository must not be used from two threads at the same time.
+ * Open the repository once per thread instead.
  */
 typedef struct _GgitRepository GgitRepository;
 
@@ -271,6 +317,13 @@ typedef struct _GgitTransferProgress GgitTransferProgress;
  */
 typedef struct _GgitTreeEntry GgitTreeEntry;
 
+/**
+ * GgitUntrackedCache:
+ *
+ * Represents a cache of the untracked files in a working directory.
+ */
+typedef struct _GgitUntrackedCache GgitUntrackedCache;
+
 /**
  * GgitBlameOptions:
  *
@@ -418,6 +471,20 @@ typedef enum {
 	GGIT_DIFF_FORMAT_NAME_STATUS  = 5u
 } GgitDiffFormatType;
 
+/**
+ * GgitDiffForeachPatchFlags:
+ * @GGIT_DIFF_FOREACH_PATCH_NONE: patches are passed to the callback as soon
+ *   as they are generated.
+ * @GGIT_DIFF_FOREACH_PATCH_ORDERED: patches are passed to the callback in
+ *   the order of the deltas of the diff.
+ *
+ * Flags for ggit_diff_foreach_patch().
+ */
+typedef enum {
+	GGIT_DIFF_FOREACH_PATCH_NONE    = 0,
+	GGIT_DIFF_FOREACH_PATCH_ORDERED = 1 << 0
+} GgitDiffForeachPatchFlags;
+
 /**
  * GgitDiffOption:
  * @GGIT_DIFF_NORMAL: normal.
@@ -559,6 +626,40 @@ typedef enum {
 	GGIT_FILE_MODE_COMMIT          = 0160000
 } GgitFileMode;
 
+/* NOTE: keep in sync with git2/index.h */
+/**
+ * GgitIndexAddOption:
+ * @GGIT_INDEX_ADD_DEFAULT: default behaviour.
+ * @GGIT_INDEX_ADD_FORCE: also add files which are ignored.
+ * @GGIT_INDEX_ADD_DISABLE_PATHSPEC_MATCH: treat the pathspecs as plain
+ *   paths instead of glob patterns.
+ * @GGIT_INDEX_ADD_CHECK_PATHSPEC: fail when a pathspec is the exact path
+ *   of an ignored file, unless %GGIT_INDEX_ADD_FORCE is set.
+ * @GGIT_INDEX_ADD_HASH_IN_PARALLEL: hash the contents of the files on
+ *   worker threads before adding them to the index.
+ *
+ * Options for ggit_index_add_paths().
+ */
+typedef enum {
+	GGIT_INDEX_ADD_DEFAULT                = 0,
+	GGIT_INDEX_ADD_FORCE                  = 1u << 0,
+	GGIT_INDEX_ADD_DISABLE_PATHSPEC_MATCH = 1u << 1,
+	GGIT_INDEX_ADD_CHECK_PATHSPEC         = 1u << 2,
+	GGIT_INDEX_ADD_HASH_IN_PARALLEL       = 1u << 16
+} GgitIndexAddOption;
+
+/**
+ * GgitCreateBlobsFlags:
+ * @GGIT_CREATE_BLOBS_DEFAULT: write every blob as a loose object.
+ * @GGIT_CREATE_BLOBS_PACK: write the blobs to a single pack file.
+ *
+ * Options for ggit_repository_create_blobs_from_files().
+ */
+typedef enum {
+	GGIT_CREATE_BLOBS_DEFAULT = 0,
+	GGIT_CREATE_BLOBS_PACK    = 1u << 0
+} GgitCreateBlobsFlags;
+
 /* NOTE: keep in sync with git2/merge.h */
 /**
  * GgitMergeAutomergeMode:
@@ -760,6 +861,25 @@ typedef enum {
 	GGIT_SORT_REVERSE     = 1 << 2
 } GgitSortMode;
 
+/**
+ * GgitRepositoryScanFlags:
+ * @GGIT_REPOSITORY_SCAN_HEAD: resolve HEAD and the current branch.
+ * @GGIT_REPOSITORY_SCAN_STATUS: count the staged, unstaged, untracked and
+ * conflicted files.
+ * @GGIT_REPOSITORY_SCAN_DIRTY: only check whether tracked files changed,
+ * stopping at the first change. Implied by @GGIT_REPOSITORY_SCAN_STATUS.
+ * @GGIT_REPOSITORY_SCAN_AHEAD_BEHIND: count the commits the current branch
+ * is ahead and behind of its upstream branch.
+ *
+ * The queries run by a #GgitRepositoryScanner on each repository.
+ */
+typedef enum {
+	GGIT_REPOSITORY_SCAN_HEAD         = 1 << 0,
+	GGIT_REPOSITORY_SCAN_STATUS       = 1 << 1,
+	GGIT_REPOSITORY_SCAN_DIRTY        = 1 << 2,
+	GGIT_REPOSITORY_SCAN_AHEAD_BEHIND = 1 << 3
+} GgitRepositoryScanFlags;
+
 /**
  * GgitStashFlags:
  * @GGIT_STASH_DEFAULT: default stash.
@@ -1151,7 +1271,8 @@ typedef gint (* GgitDiffHunkCallback) (GgitDiffDelta *delta,
  * @line: a #GgitDiffLine.
  * @user_data: (closure): user-supplied data.
  *
- * Called for each line.
+ * Called for each line. @line is only valid during the callback, use
+ * ggit_diff_line_ref() to keep it around.
  *
  * Returns: 0 to go continue or a #GgitError in case there was an error.
  */
@@ -1160,6 +1281,21 @@ typedef gint (* GgitDiffLineCallback) (GgitDiffDelta    *delta,
                                        GgitDiffLine     *line,
                                        gpointer          user_data);
 
+/**
+ * GgitDiffPatchCallback:
+ * @index: the index of the delta of @patch in the diff.
+ * @patch: a #GgitPatch.
+ * @user_data: (closure): user-supplied data.
+ *
+ * Called for each patch generated by ggit_diff_foreach_patch(). Use
+ * ggit_patch_ref() to keep @patch around.
+ *
+ * Returns: 0 to go continue or a #GgitError in case there was an error.
+ */
+typedef gint (* GgitDiffPatchCallback) (gsize      index,
+                                        GgitPatch *patch,
+                                        gpointer   user_data);
+
 /*
  * FIXME: request docs for this to libgit2
  */
@@ -1261,6 +1397,23 @@ typedef gint (* GgitStashCallback) (gsize        index,
                                     GgitOId     *stash_oid,
                                     gpointer     user_data);
 
+/**
+ * GgitIndexMatchedPathCallback:
+ * @path: the path of the file, relative to the working directory.
+ * @matched_pathspec: (nullable): the pathspec that matched @path.
+ * @user_data: (closure): user-supplied data.
+ *
+ * Called for each file matched by ggit_index_add_paths(),
+ * ggit_index_update_paths() or ggit_index_remove_paths() before it is
+ * processed, which also makes it usable to report progress.
+ *
+ * Returns: 0 to process the file, a positive value to skip it or a
+ * negative value to stop.
+ */
+typedef gint (* GgitIndexMatchedPathCallback) (const gchar *path,
+                                               const gchar *matched_pathspec,
+                                               gpointer     user_data);
+
 /**
  * GgitStatusCallback:
  * @path: the file to retrieve status for, rooted at the repository working dir.
@@ -0,0 +1,1075 @@
+/*
+ * ggit-untracked-cache.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <git2.h>
+
+#include "ggit-untracked-cache.h"
+#include "ggit-error.h"
+#include "ggit-repository.h"
+#include "ggit-status-options.h"
+
+#ifndef S_ISDIR
+#define S_ISDIR(m) (((m) & S_IFMT) == S_IFDIR)
+#endif
+
+#define CACHE_FILENAME "ggit-untracked-cache"
+#define CACHE_VERSION 1
+#define CACHE_FORMAT "(usa{s(xxxa(sy))})"
+
+/* Directories modified this recently may still change within the
+ * resolution of their timestamp, so they are read again next time. */
+#define RACY_INTERVAL G_GINT64_CONSTANT (1000000000)
+
+enum
+{
+	ENTRY_FILE,
+	ENTRY_DIRECTORY,
+	ENTRY_REPOSITORY
+};
+
+typedef struct
+{
+	gchar *name;
+	guint8 type;
+} CachedEntry;
+
+typedef struct
+{
+	gint64 mtime;
+	gint64 ignore_mtime;
+	gint64 ignore_size;
+
+	/* CachedEntry, sorted by name, without ignored entries */
+	GArray *entries;
+} CachedDirectory;
+
+/**
+ * GgitUntrackedCache:
+ *
+ * Remembers the contents of the directories of a working directory, minus
+ * the ignored files, so that finding the untracked files does not need to
+ * read every directory and match every file against the ignore rules.
+ *
+ * A cached directory is reused as long as its modification time and the
+ * one of its .gitignore did not change; whether a file is tracked is always
+ * checked against the current index. When the changed paths are known, for
+ * example from a file system monitor, see
+ * ggit_status_options_set_changed_paths(), only the directories containing
+ * them are looked at at all.
+ *
+ * Attach the cache to a #GgitStatusOptions with
+ * ggit_status_options_set_untracked_cache() and keep it across status
+ * calls, or persist it in the repository with ggit_untracked_cache_save().
+ * A cache must only be used with the working directory it was filled for.
+ * It can be used from multiple threads.
+ */
+struct _GgitUntrackedCache
+{
+	gint ref_count;
+
+	GMutex mutex;
+
+	/* Working directory and global ignore files the cache is valid for */
+	gchar *key;
+
+	/* relative directory path ("" for the root) -> CachedDirectory */
+	GHashTable *directories;
+
+	guint64 hits;
+	guint64 misses;
+	gboolean dirty;
+};
+
+typedef struct
+{
+	GgitUntrackedCache *cache;
+	git_repository *repo;
+	git_index *index;
+	const gchar *workdir;
+
+	/* Directories that may have changed, or NULL to check all of them */
+	GHashTable *changed;
+
+	gboolean recurse;
+	gint64 now;
+
+	GPtrArray *untracked;
+} CollectData;
+
+typedef struct
+{
+	const gchar *path;
+	guint status;
+} StatusItem;
+
+G_DEFINE_BOXED_TYPE (GgitUntrackedCache, ggit_untracked_cache,
+                     ggit_untracked_cache_ref, ggit_untracked_cache_unref)
+
+static void
+cached_entry_clear (CachedEntry *entry)
+{
+	g_free (entry->name);
+}
+
+static CachedDirectory *
+cached_directory_new (void)
+{
+	CachedDirectory *dir;
+
+	dir = g_slice_new0 (CachedDirectory);
+	dir->entries = g_array_new (FALSE, FALSE, sizeof (CachedEntry));
+	g_array_set_clear_func (dir->entries, (GDestroyNotify)cached_entry_clear);
+
+	return dir;
+}
+
+static void
+cached_directory_free (CachedDirectory *dir)
+{
+	g_array_unref (dir->entries);
+	g_slice_free (CachedDirectory, dir);
+}
+
+/**
+ * ggit_untracked_cache_new:
+ *
+ * Creates a new empty #GgitUntrackedCache.
+ *
+ * Returns: (transfer full): a newly allocated #GgitUntrackedCache.
+ */
+GgitUntrackedCache *
+ggit_untracked_cache_new (void)
+{
+	GgitUntrackedCache *cache;
+
+	cache = g_slice_new0 (GgitUntrackedCache);
+	cache->ref_count = 1;
+
+	g_mutex_init (&cache->mutex);
+
+	cache->directories = g_hash_table_new_full (g_str_hash,
+	                                            g_str_equal,
+	                                            g_free,
+	                                            (GDestroyNotify)cached_directory_free);
+
+	return cache;
+}
+
+/**
+ * ggit_untracked_cache_ref:
+ * @cache: a #GgitUntrackedCache.
+ *
+ * Atomically increments the reference count of @cache by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none): a #GgitUntrackedCache.
+ */
+GgitUntrackedCache *
+ggit_untracked_cache_ref (GgitUntrackedCache *cache)
+{
+	g_return_val_if_fail (cache != NULL, NULL);
+
+	g_atomic_int_inc (&cache->ref_count);
+
+	return cache;
+}
+
+/**
+ * ggit_untracked_cache_unref:
+ * @cache: a #GgitUntrackedCache.
+ *
+ * Atomically decrements the reference count of @cache by one.
+ * If the reference count drops to 0, @cache is freed.
+ */
+void
+ggit_untracked_cache_unref (GgitUntrackedCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+
+	if (g_atomic_int_dec_and_test (&cache->ref_count))
+	{
+		g_hash_table_unref (cache->directories);
+		g_free (cache->key);
+		g_mutex_clear (&cache->mutex);
+
+		g_slice_free (GgitUntrackedCache, cache);
+	}
+}
+
+static gchar *
+get_cache_filename (GgitRepository *repository)
+{
+	GFile *location;
+	gchar *path;
+	gchar *filename;
+
+	location = ggit_repository_get_location (repository);
+	path = g_file_get_path (location);
+	g_object_unref (location);
+
+	filename = g_build_filename (path, CACHE_FILENAME, NULL);
+	g_free (path);
+
+	return filename;
+}
+
+/**
+ * ggit_untracked_cache_load:
+ * @repository: a #GgitRepository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Loads the cache saved in the git directory of @repository by
+ * ggit_untracked_cache_save(). A missing or outdated cache results in an
+ * empty one.
+ *
+ * Returns: (transfer full) (nullable): a #GgitUntrackedCache or %NULL if
+ * the cache could not be read.
+ */
+GgitUntrackedCache *
+ggit_untracked_cache_load (GgitRepository  *repository,
+                           GError         **error)
+{
+	GgitUntrackedCache *cache;
+	GError *local_error = NULL;
+	GVariant *variant;
+	GVariantIter *iter;
+	GVariant *entries;
+	gchar *filename;
+	gchar *contents;
+	gsize length;
+	const gchar *key;
+	const gchar *path;
+	gint64 mtime;
+	gint64 ignore_mtime;
+	gint64 ignore_size;
+	guint32 version;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	cache = ggit_untracked_cache_new ();
+	filename = get_cache_filename (repository);
+
+	if (!g_file_get_contents (filename, &contents, &length, &local_error))
+	{
+		g_free (filename);
+
+		if (g_error_matches (local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+		{
+			g_error_free (local_error);
+			return cache;
+		}
+
+		g_propagate_error (error, local_error);
+		ggit_untracked_cache_unref (cache);
+
+		return NULL;
+	}
+
+	g_free (filename);
+
+	variant = g_variant_new_from_data (G_VARIANT_TYPE (CACHE_FORMAT),
+	                                   contents, length,
+	                                   FALSE,
+	                                   g_free, contents);
+	g_variant_ref_sink (variant);
+
+	g_variant_get (variant, "(u&sa{s(xxxa(sy))})", &version, &key, &iter);
+
+	if (version == CACHE_VERSION)
+	{
+		cache->key = g_strdup (key);
+
+		while (g_variant_iter_loop (iter, "{&s(xxx@a(sy))}",
+		                            &path, &mtime, &ignore_mtime, &ignore_size, &entries))
+		{
+			CachedDirectory *dir;
+			GVariantIter entry_iter;
+			const gchar *name;
+			guint8 type;
+
+			dir = cached_directory_new ();
+			dir->mtime = mtime;
+			dir->ignore_mtime = ignore_mtime;
+			dir->ignore_size = ignore_size;
+
+			g_variant_iter_init (&entry_iter, entries);
+
+			while (g_variant_iter_next (&entry_iter, "(&sy)", &name, &type))
+			{
+				CachedEntry entry;
+
+				entry.name = g_strdup (name);
+				entry.type = type;
+
+				g_array_append_val (dir->entries, entry);
+			}
+
+			g_hash_table_insert (cache->directories, g_strdup (path), dir);
+		}
+	}
+
+	g_variant_iter_free (iter);
+	g_variant_unref (variant);
+
+	return cache;
+}
+
+/**
+ * ggit_untracked_cache_save:
+ * @cache: a #GgitUntrackedCache.
+ * @repository: a #GgitRepository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Saves @cache in the git directory of @repository, to be loaded again
+ * with ggit_untracked_cache_load(). Nothing is written when @cache did not
+ * change since it was loaded or last saved.
+ *
+ * Returns: %TRUE if the cache was saved, %FALSE otherwise.
+ */
+gboolean
+ggit_untracked_cache_save (GgitUntrackedCache  *cache,
+                           GgitRepository      *repository,
+                           GError             **error)
+{
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	GVariant *variant;
+	gpointer key;
+	gpointer value;
+	gchar *filename;
+	gboolean ret;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (!cache->dirty)
+	{
+		g_mutex_unlock (&cache->mutex);
+		return TRUE;
+	}
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(xxxa(sy))}"));
+	g_hash_table_iter_init (&iter, cache->directories);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		CachedDirectory *dir = value;
+		GVariantBuilder entries;
+		guint i;
+
+		g_variant_builder_init (&entries, G_VARIANT_TYPE ("a(sy)"));
+
+		for (i = 0; i < dir->entries->len; i++)
+		{
+			CachedEntry *entry = &g_array_index (dir->entries, CachedEntry, i);
+
+			g_variant_builder_add (&entries, "(sy)", entry->name, entry->type);
+		}
+
+		g_variant_builder_add (&builder, "{s(xxxa(sy))}",
+		                       key,
+		                       dir->mtime,
+		                       dir->ignore_mtime,
+		                       dir->ignore_size,
+		                       &entries);
+	}
+
+	variant = g_variant_new ("(usa{s(xxxa(sy))})",
+	                         CACHE_VERSION,
+	                         cache->key != NULL ? cache->key : "",
+	                         &builder);
+	g_variant_ref_sink (variant);
+
+	filename = get_cache_filename (repository);
+
+	ret = g_file_set_contents (filename,
+	                           g_variant_get_data (variant),
+	                           g_variant_get_size (variant),
+	                           error);
+
+	if (ret)
+	{
+		cache->dirty = FALSE;
+	}
+
+	g_free (filename);
+	g_variant_unref (variant);
+	g_mutex_unlock (&cache->mutex);
+
+	return ret;
+}
+
+/**
+ * ggit_untracked_cache_get_size:
+ * @cache: a #GgitUntrackedCache.
+ *
+ * Gets the number of directories in @cache.
+ *
+ * Returns: the number of cached directories.
+ */
+guint
+ggit_untracked_cache_get_size (GgitUntrackedCache *cache)
+{
+	guint size;
+
+	g_return_val_if_fail (cache != NULL, 0);
+
+	g_mutex_lock (&cache->mutex);
+	size = g_hash_table_size (cache->directories);
+	g_mutex_unlock (&cache->mutex);
+
+	return size;
+}
+
+/**
+ * ggit_untracked_cache_get_stats:
+ * @cache: a #GgitUntrackedCache.
+ * @hits: (out) (optional): return location for the number of directories
+ *   that were reused.
+ * @misses: (out) (optional): return location for the number of directories
+ *   that had to be read.
+ *
+ * Gets how often @cache could be used since it was created or cleared.
+ */
+void
+ggit_untracked_cache_get_stats (GgitUntrackedCache *cache,
+                                guint64            *hits,
+                                guint64            *misses)
+{
+	g_return_if_fail (cache != NULL);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (hits != NULL)
+	{
+		*hits = cache->hits;
+	}
+
+	if (misses != NULL)
+	{
+		*misses = cache->misses;
+	}
+
+	g_mutex_unlock (&cache->mutex);
+}
+
+/**
+ * ggit_untracked_cache_clear:
+ * @cache: a #GgitUntrackedCache.
+ *
+ * Removes all directories from @cache and resets its statistics.
+ */
+void
+ggit_untracked_cache_clear (GgitUntrackedCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+
+	g_mutex_lock (&cache->mutex);
+
+	g_hash_table_remove_all (cache->directories);
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->dirty = TRUE;
+
+	g_mutex_unlock (&cache->mutex);
+}
+
+static gint64
+stat_mtime (const GStatBuf *st)
+{
+	gint64 mtime = (gint64)st->st_mtime * G_GINT64_CONSTANT (1000000000);
+
+#ifdef __linux__
+	mtime += st->st_mtim.tv_nsec;
+#endif
+
+	return mtime;
+}
+
+static void
+append_stat_key (GString     *key,
+                 const gchar *filename)
+{
+	GStatBuf st;
+
+	if (g_stat (filename, &st) == 0)
+	{
+		g_string_append_printf (key, "%s:%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT ";",
+		                        filename, stat_mtime (&st), (gint64)st.st_size);
+	}
+	else
+	{
+		g_string_append_printf (key, "%s:-;", filename);
+	}
+}
+
+static gchar *
+get_cache_key (git_repository *repo)
+{
+	git_config *config;
+	GString *key;
+	gchar *filename = NULL;
+
+	key = g_string_new (git_repository_workdir (repo));
+	g_string_append_c (key, ';');
+
+	filename = g_build_filename (git_repository_path (repo), "info", "exclude", NULL);
+	append_stat_key (key, filename);
+	g_free (filename);
+	filename = NULL;
+
+	if (git_repository_config_snapshot (&config, repo) == GIT_OK)
+	{
+		const gchar *value;
+
+		if (git_config_get_string (&value, config, "core.excludesfile") == GIT_OK)
+		{
+			if (g_str_has_prefix (value, "~/"))
+			{
+				filename = g_build_filename (g_get_home_dir (), value + 2, NULL);
+			}
+			else
+			{
+				filename = g_strdup (value);
+			}
+		}
+
+		git_config_free (config);
+	}
+
+	if (filename == NULL)
+	{
+		filename = g_build_filename (g_get_user_config_dir (), "git", "ignore", NULL);
+	}
+
+	append_stat_key (key, filename);
+	g_free (filename);
+
+	return g_string_free (key, FALSE);
+}
+
+static void
+remove_subdirectories (GgitUntrackedCache *cache,
+                       const gchar        *relative)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gsize len;
+
+	len = strlen (relative);
+	g_hash_table_iter_init (&iter, cache->directories);
+
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		const gchar *path = key;
+
+		if (len == 0 ?
+		    *path != '\0' :
+		    strncmp (path, relative, len) == 0 && path[len] == '/')
+		{
+			g_hash_table_iter_remove (&iter);
+		}
+	}
+}
+
+static gchar *
+build_relative (const gchar *relative,
+                const gchar *name)
+{
+	return *relative != '\0' ? g_strconcat (relative, "/", name, NULL)
+	                         : g_strdup (name);
+}
+
+static gint
+compare_entries (gconstpointer a,
+                 gconstpointer b)
+{
+	return strcmp (((const CachedEntry *)a)->name, ((const CachedEntry *)b)->name);
+}
+
+static gboolean
+read_directory (CollectData     *data,
+                const gchar     *relative,
+                const gchar     *path,
+                CachedDirectory *dir)
+{
+	const gchar *name;
+	GDir *gdir;
+
+	gdir = g_dir_open (path, 0, NULL);
+
+	if (gdir == NULL)
+	{
+		return FALSE;
+	}
+
+	while ((name = g_dir_read_name (gdir)) != NULL)
+	{
+		CachedEntry entry;
+		gchar *child;
+		gchar *child_relative;
+		gchar *match;
+		GStatBuf st;
+		gint ignored = 0;
+
+		if (strcmp (name, ".git") == 0)
+		{
+			continue;
+		}
+
+		child = g_build_filename (path, name, NULL);
+
+		if (g_lstat (child, &st) != 0)
+		{
+			g_free (child);
+			continue;
+		}
+
+		entry.type = ENTRY_FILE;
+
+		if (S_ISDIR (st.st_mode))
+		{
+			gchar *dotgit;
+
+			dotgit = g_build_filename (child, ".git", NULL);
+			entry.type = g_file_test (dotgit, G_FILE_TEST_EXISTS) ? ENTRY_REPOSITORY
+			                                                      : ENTRY_DIRECTORY;
+			g_free (dotgit);
+		}
+
+		child_relative = build_relative (relative, name);
+		match = entry.type == ENTRY_FILE ? g_strdup (child_relative)
+		                                 : g_strconcat (child_relative, "/", NULL);
+
+		/* Matching every file against the ignore rules is what
+		 * makes finding untracked files slow, so only the files
+		 * that are not ignored are remembered. */
+		if (git_ignore_path_is_ignored (&ignored, data->repo, match) != GIT_OK)
+		{
+			ignored = 0;
+		}
+
+		if (!ignored)
+		{
+			entry.name = g_strdup (name);
+			g_array_append_val (dir->entries, entry);
+		}
+
+		g_free (match);
+		g_free (child_relative);
+		g_free (child);
+	}
+
+	g_dir_close (gdir);
+
+	g_array_sort (dir->entries, compare_entries);
+
+	return TRUE;
+}
+
+static CachedDirectory *
+lookup_directory (CollectData *data,
+                  const gchar *relative)
+{
+	GgitUntrackedCache *cache = data->cache;
+	CachedDirectory *dir;
+	gchar *path;
+	gchar *ignore_file;
+	GStatBuf st;
+	GStatBuf ignore_st;
+	gint64 ignore_mtime = 0;
+	gint64 ignore_size = -1;
+
+	dir = g_hash_table_lookup (cache->directories, relative);
+
+	if (dir != NULL && data->changed != NULL &&
+	    !g_hash_table_contains (data->changed, relative))
+	{
+		cache->hits++;
+		return dir;
+	}
+
+	path = g_build_filename (data->workdir, relative, NULL);
+
+	if (g_lstat (path, &st) != 0 || !S_ISDIR (st.st_mode))
+	{
+		if (dir != NULL)
+		{
+			remove_subdirectories (cache, relative);
+			g_hash_table_remove (cache->directories, relative);
+			cache->dirty = TRUE;
+		}
+
+		g_free (path);
+		return NULL;
+	}
+
+	ignore_file = g_build_filename (path, ".gitignore", NULL);
+
+	if (g_stat (ignore_file, &ignore_st) == 0)
+	{
+		ignore_mtime = stat_mtime (&ignore_st);
+		ignore_size = ignore_st.st_size;
+	}
+
+	g_free (ignore_file);
+
+	if (dir != NULL &&
+	    dir->mtime == stat_mtime (&st) &&
+	    dir->ignore_mtime == ignore_mtime &&
+	    dir->ignore_size == ignore_size)
+	{
+		cache->hits++;
+		g_free (path);
+
+		return dir;
+	}
+
+	/* New ignore rules also apply to everything below */
+	if (dir != NULL &&
+	    (dir->ignore_mtime != ignore_mtime || dir->ignore_size != ignore_size))
+	{
+		remove_subdirectories (cache, relative);
+	}
+
+	dir = cached_directory_new ();
+
+	if (!read_directory (data, relative, path, dir))
+	{
+		cached_directory_free (dir);
+		g_free (path);
+
+		return NULL;
+	}
+
+	dir->mtime = stat_mtime (&st);
+	dir->ignore_mtime = ignore_mtime;
+	dir->ignore_size = ignore_size;
+
+	if (data->now - dir->mtime < RACY_INTERVAL)
+	{
+		dir->mtime = 0;
+	}
+
+	g_hash_table_insert (cache->directories, g_strdup (relative), dir);
+
+	cache->misses++;
+	cache->dirty = TRUE;
+
+	g_free (path);
+
+	return dir;
+}
+
+static gboolean
+is_tracked (git_index   *index,
+            const gchar *path,
+            gboolean     prefix)
+{
+	const git_index_entry *entry;
+	size_t pos;
+
+	if (git_index_find_prefix (&pos, index, path) != GIT_OK)
+	{
+		return FALSE;
+	}
+
+	if (prefix)
+	{
+		return TRUE;
+	}
+
+	entry = git_index_get_byindex (index, pos);
+
+	return entry != NULL && strcmp (entry->path, path) == 0;
+}
+
+/* Returns whether @relative contains untracked files */
+static gboolean
+collect_directory (CollectData *data,
+                   const gchar *relative)
+{
+	CachedDirectory *dir;
+	gboolean found = FALSE;
+	GArray *entries;
+	guint i;
+
+	dir = lookup_directory (data, relative);
+
+	if (dir == NULL)
+	{
+		return FALSE;
+	}
+
+	/* Recursing may replace the directory in the cache */
+	entries = g_array_ref (dir->entries);
+
+	for (i = 0; i < entries->len; i++)
+	{
+		CachedEntry *entry = &g_array_index (entries, CachedEntry, i);
+		gchar *path;
+		gchar *dir_path;
+
+		path = build_relative (relative, entry->name);
+
+		switch (entry->type)
+		{
+			case ENTRY_FILE:
+				if (!is_tracked (data->index, path, FALSE))
+				{
+					g_ptr_array_add (data->untracked, path);
+					path = NULL;
+					found = TRUE;
+				}
+				break;
+			case ENTRY_REPOSITORY:
+				if (!is_tracked (data->index, path, FALSE))
+				{
+					g_ptr_array_add (data->untracked, g_strconcat (path, "/", NULL));
+					found = TRUE;
+				}
+				break;
+			case ENTRY_DIRECTORY:
+				dir_path = g_strconcat (path, "/", NULL);
+
+				if (data->recurse || is_tracked (data->index, dir_path, TRUE))
+				{
+					found |= collect_directory (data, path);
+				}
+				else
+				{
+					guint len = data->untracked->len;
+
+					/* Like git, a directory without tracked
+					 * files is reported as a whole. */
+					if (collect_directory (data, path))
+					{
+						g_ptr_array_set_size (data->untracked, len);
+						g_ptr_array_add (data->untracked, dir_path);
+						dir_path = NULL;
+						found = TRUE;
+					}
+				}
+
+				g_free (dir_path);
+				break;
+		}
+
+		g_free (path);
+	}
+
+	g_array_unref (entries);
+
+	return found;
+}
+
+static void
+add_changed_directories (GHashTable          *changed,
+                         const gchar * const *paths)
+{
+	for (; *paths != NULL; paths++)
+	{
+		gchar *path;
+		gchar *slash;
+
+		path = g_strdup (*paths);
+
+		/* A changed path changes its parent directory, and may itself
+		 * be a directory that was created or replaced. */
+		g_hash_table_add (changed, g_strdup (path));
+
+		slash = strrchr (path, '/');
+
+		if (slash != NULL)
+		{
+			*slash = '\0';
+			g_hash_table_add (changed, path);
+		}
+		else
+		{
+			g_free (path);
+			g_hash_table_add (changed, g_strdup (""));
+		}
+	}
+}
+
+static gint
+compare_items (gconstpointer a,
+               gconstpointer b)
+{
+	return strcmp (((const StatusItem *)a)->path, ((const StatusItem *)b)->path);
+}
+
+static gint
+compare_items_icase (gconstpointer a,
+                     gconstpointer b)
+{
+	return g_ascii_strcasecmp (((const StatusItem *)a)->path, ((const StatusItem *)b)->path);
+}
+
+/*
+ * _ggit_untracked_cache_status_foreach:
+ *
+ * Like git_status_foreach_ext(), but libgit2 only checks the tracked files
+ * and the untracked files are found through @cache. Only the cached
+ * directories in @changed_paths are read again, unless it is %NULL. Falls
+ * back to git_status_foreach_ext() for options the cache cannot answer:
+ * ignored files, a pathspec or no working directory.
+ */
+gint
+_ggit_untracked_cache_status_foreach (GgitUntrackedCache        *cache,
+                                      git_repository            *repo,
+                                      const git_status_options  *options,
+                                      const gchar * const       *changed_paths,
+                                      git_status_cb              callback,
+                                      gpointer                   payload)
+{
+	git_status_options gopts;
+	git_status_list *list;
+	CollectData data = { 0 };
+	GArray *items;
+	gchar *key;
+	gsize n;
+	gsize i;
+	gint ret;
+
+	gopts = *options;
+
+	if (!(gopts.flags & GIT_STATUS_OPT_INCLUDE_UNTRACKED) ||
+	    (gopts.flags & GIT_STATUS_OPT_INCLUDE_IGNORED) ||
+	    gopts.show == GIT_STATUS_SHOW_INDEX_ONLY ||
+	    gopts.pathspec.count > 0 ||
+	    git_repository_is_bare (repo))
+	{
+		return git_status_foreach_ext (repo, &gopts, callback, payload);
+	}
+
+	data.recurse = (gopts.flags & GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS) != 0;
+	gopts.flags &= ~(GIT_STATUS_OPT_INCLUDE_UNTRACKED |
+	                 GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS);
+
+	ret = git_status_list_new (&list, repo, &gopts);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	ret = git_repository_index (&data.index, repo);
+
+	if (ret != GIT_OK)
+	{
+		git_status_list_free (list);
+		return ret;
+	}
+
+	data.cache = cache;
+	data.repo = repo;
+	data.workdir = git_repository_workdir (repo);
+	data.now = g_get_real_time () * 1000;
+	data.untracked = g_ptr_array_new_with_free_func (g_free);
+
+	if (changed_paths != NULL)
+	{
+		data.changed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		add_changed_directories (data.changed, changed_paths);
+	}
+
+	key = get_cache_key (repo);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (g_strcmp0 (cache->key, key) != 0)
+	{
+		g_hash_table_remove_all (cache->directories);
+		g_free (cache->key);
+		cache->key = key;
+		cache->dirty = TRUE;
+		key = NULL;
+
+		/* Nothing cached can be trusted, so neither can the hints */
+		g_clear_pointer (&data.changed, g_hash_table_unref);
+	}
+
+	collect_directory (&data, "");
+
+	g_mutex_unlock (&cache->mutex);
+
+	g_free (key);
+
+	/* Merge the untracked files into the status of the tracked ones */
+	n = git_status_list_entrycount (list);
+	items = g_array_sized_new (FALSE, FALSE, sizeof (StatusItem), n + data.untracked->len);
+
+	for (i = 0; i < n; i++)
+	{
+		const git_status_entry *entry;
+		StatusItem item;
+
+		entry = git_status_byindex (list, i);
+
+		item.path = entry->head_to_index != NULL ? entry->head_to_index->old_file.path
+		                                         : entry->index_to_workdir->old_file.path;
+		item.status = entry->status;
+
+		g_array_append_val (items, item);
+	}
+
+	for (i = 0; i < data.untracked->len; i++)
+	{
+		StatusItem item;
+
+		item.path = g_ptr_array_index (data.untracked, i);
+		item.status = GIT_STATUS_WT_NEW;
+
+		g_array_append_val (items, item);
+	}
+
+	if (data.untracked->len > 0)
+	{
+		g_array_sort (items, (gopts.flags & GIT_STATUS_OPT_SORT_CASE_INSENSITIVELY) ?
+		                     compare_items_icase : compare_items);
+	}
+
+	ret = GIT_OK;
+
+	for (i = 0; i < items->len && ret == GIT_OK; i++)
+	{
+		StatusItem *item = &g_array_index (items, StatusItem, i);
+
+		ret = callback (item->path, item->status, payload);
+	}
+
+	g_array_unref (items);
+	g_ptr_array_unref (data.untracked);
+	g_clear_pointer (&data.changed, g_hash_table_unref);
+	git_index_free (data.index);
+	git_status_list_free (list);
+
+	return ret;
+}
+
+/* ex:set ts=8 noet: */
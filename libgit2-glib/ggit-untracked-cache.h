@@ -0,0 +1,69 @@
+/*
+ * ggit-untracked-cache.h
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_UNTRACKED_CACHE_H__
+#define __GGIT_UNTRACKED_CACHE_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-types.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_UNTRACKED_CACHE       (ggit_untracked_cache_get_type ())
+#define GGIT_UNTRACKED_CACHE(obj)       ((GgitUntrackedCache *)obj)
+
+GType               ggit_untracked_cache_get_type        (void) G_GNUC_CONST;
+
+GgitUntrackedCache *ggit_untracked_cache_new             (void);
+
+GgitUntrackedCache *ggit_untracked_cache_load            (GgitRepository      *repository,
+                                                          GError             **error);
+
+gboolean            ggit_untracked_cache_save            (GgitUntrackedCache  *cache,
+                                                          GgitRepository      *repository,
+                                                          GError             **error);
+
+GgitUntrackedCache *ggit_untracked_cache_ref             (GgitUntrackedCache  *cache);
+void                ggit_untracked_cache_unref           (GgitUntrackedCache  *cache);
+
+guint               ggit_untracked_cache_get_size        (GgitUntrackedCache  *cache);
+
+void                ggit_untracked_cache_get_stats       (GgitUntrackedCache  *cache,
+                                                          guint64             *hits,
+                                                          guint64             *misses);
+
+void                ggit_untracked_cache_clear           (GgitUntrackedCache  *cache);
+
+gint               _ggit_untracked_cache_status_foreach  (GgitUntrackedCache        *cache,
+                                                          git_repository            *repo,
+                                                          const git_status_options  *options,
+                                                          const gchar * const       *changed_paths,
+                                                          git_status_cb              callback,
+                                                          gpointer                   payload);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitUntrackedCache, ggit_untracked_cache_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_UNTRACKED_CACHE_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,1380 @@
+/*
+ * benchmark.c
+ * This file is part of libgit2-glib
+ *
+ * Copyright (C) 2026 - libgit2-glib contributors
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmarks for the hot paths of the wrappers.
+ *
+ * A synthetic repository is generated in a temporary directory and every
+ * benchmark is run both through libgit2-glib and through plain libgit2 so
+ * the overhead of the wrappers can be tracked over time. Results are
+ * written as JSON, one object per line.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <git2.h>
+#include <git2/sys/commit.h>
+
+#include "libgit2-glib/ggit.h"
+#include "libgit2-glib/ggit-version.h"
+
+#define N_CONTENTS 256
+#define FILES_PER_DIR 1000
+#define MODIFIED_EVERY 100
+#define INDEX_SAMPLE_EVERY 20
+
+static gint n_commits = 100000;
+static gint n_files = 200000;
+static gint n_blame_commits = 500;
+static gint n_branches = 1000;
+static gint blob_size_mb = 64;
+static gint n_iterations = 5;
+static gchar *only = NULL;
+static gchar *output = NULL;
+static gboolean keep = FALSE;
+
+static GOptionEntry options[] =
+{
+	{ "commits", 0, 0, G_OPTION_ARG_INT, &n_commits, "Number of commits in the history", "N" },
+	{ "files", 0, 0, G_OPTION_ARG_INT, &n_files, "Number of files in the tree", "N" },
+	{ "blame-commits", 0, 0, G_OPTION_ARG_INT, &n_blame_commits, "Number of commits touching the blamed file", "N" },
+	{ "branches", 0, 0, G_OPTION_ARG_INT, &n_branches, "Number of branches spread over the history", "N" },
+	{ "blob-size", 0, 0, G_OPTION_ARG_INT, &blob_size_mb, "Size of the large blob in MiB", "MIB" },
+	{ "iterations", 'i', 0, G_OPTION_ARG_INT, &n_iterations, "Number of runs of each benchmark", "N" },
+	{ "only", 0, 0, G_OPTION_ARG_STRING, &only, "Only run the benchmarks whose name starts with PREFIX", "PREFIX" },
+	{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &output, "Write the results to FILE instead of stdout", "FILE" },
+	{ "keep", 'k', 0, G_OPTION_ARG_NONE, &keep, "Keep the generated repository", NULL },
+	{ NULL }
+};
+
+typedef struct
+{
+	gchar *path;
+	FILE *out;
+
+	GgitRepository *repo;
+	git_repository *raw;
+
+	GArray *commit_ids;
+	GPtrArray *commit_oids;
+	GArray *branch_ids;
+	GPtrArray *branch_oids;
+	GPtrArray *index_paths;
+	GPtrArray *index_files;
+	GFile *blame_file;
+
+	git_oid base_tree;
+	git_oid modified_tree;
+	git_oid large_blob;
+} Bench;
+
+typedef guint (*BenchFunc) (Bench *bench);
+
+static void
+check (gint ret)
+{
+	if (ret < 0)
+	{
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+		const git_error *err = git_error_last ();
+#else
+		const git_error *err = giterr_last ();
+#endif
+
+		g_error ("libgit2 error %d: %s", ret, err != NULL ? err->message : "unknown");
+	}
+}
+
+static void
+check_error (GError *error)
+{
+	if (error != NULL)
+	{
+		g_error ("%s", error->message);
+	}
+}
+
+static gchar *
+content_for (guint    n,
+             gboolean modified)
+{
+	GString *str;
+	guint i;
+
+	str = g_string_new (NULL);
+
+	for (i = 0; i < 20; i++)
+	{
+		if (modified && i % 4 == 1)
+		{
+			g_string_append_printf (str, "changed line %u of content %u\n", i, n);
+		}
+		else
+		{
+			g_string_append_printf (str, "line %u of content %u\n", i, n);
+		}
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+static void
+create_contents (git_repository *repo,
+                 git_oid        *ids,
+                 gboolean        modified)
+{
+	guint i;
+
+	for (i = 0; i < N_CONTENTS; i++)
+	{
+		gchar *content;
+
+		content = content_for (i, modified);
+		check (git_blob_create_frombuffer (&ids[i], repo, content, strlen (content)));
+		g_free (content);
+	}
+}
+
+static gchar *
+file_path (guint i)
+{
+	return g_strdup_printf ("d%04u/f%07u.txt", i / FILES_PER_DIR, i);
+}
+
+static void
+add_files (git_index     *index,
+           const git_oid *base_ids,
+           const git_oid *modified_ids)
+{
+	guint i;
+
+	/* Paths are generated in sorted order, which keeps the inserts cheap */
+	for (i = 0; i < (guint)n_files; i++)
+	{
+		git_index_entry entry;
+		gchar *path;
+
+		path = file_path (i);
+
+		memset (&entry, 0, sizeof (entry));
+		entry.mode = GIT_FILEMODE_BLOB;
+		entry.path = path;
+
+		if (modified_ids != NULL && i % MODIFIED_EVERY == 0)
+		{
+			entry.id = modified_ids[i % N_CONTENTS];
+		}
+		else
+		{
+			entry.id = base_ids[i % N_CONTENTS];
+		}
+
+		check (git_index_add (index, &entry));
+		g_free (path);
+	}
+}
+
+static void
+create_large_blob (Bench          *bench,
+                   git_repository *repo)
+{
+	gsize size = (gsize)blob_size_mb * 1024 * 1024;
+	gchar *data;
+	gsize i;
+	GRand *rand;
+
+	rand = g_rand_new_with_seed (42);
+	data = g_malloc (size);
+
+	for (i = 0; i < size; i++)
+	{
+		data[i] = (i % 80 == 79) ? '\n' : (gchar)g_rand_int_range (rand, 'a', 'z' + 1);
+	}
+
+	check (git_blob_create_frombuffer (&bench->large_blob, repo, data, size));
+
+	g_free (data);
+	g_rand_free (rand);
+}
+
+static void
+create_history (Bench          *bench,
+                git_repository *repo)
+{
+	git_tree *base;
+	git_signature *sig;
+	git_reference *ref;
+	GString *blame;
+	git_oid parent = { { 0 } };
+	guint blame_start;
+	guint i;
+
+	check (git_tree_lookup (&base, repo, &bench->base_tree));
+
+	blame = g_string_new (NULL);
+	blame_start = (guint)MAX (n_commits - n_blame_commits, 0);
+
+	for (i = 0; i < (guint)n_commits; i++)
+	{
+		const git_oid *parents[1] = { &parent };
+		git_oid tree_id;
+		git_oid commit_id;
+		gchar *message;
+
+		if (i < blame_start)
+		{
+			tree_id = bench->base_tree;
+		}
+		else
+		{
+			git_treebuilder *builder;
+			git_oid blob_id;
+
+			/* Every commit touching the blamed file adds a line */
+			g_string_append_printf (blame, "line added by commit %u\n", i);
+			check (git_blob_create_frombuffer (&blob_id, repo, blame->str, blame->len));
+
+			check (git_treebuilder_new (&builder, repo, base));
+			check (git_treebuilder_insert (NULL, builder, "blame.txt", &blob_id, GIT_FILEMODE_BLOB));
+			check (git_treebuilder_write (&tree_id, builder));
+			git_treebuilder_free (builder);
+		}
+
+		check (git_signature_new (&sig, "Bench", "bench@example.com", 1000000000 + i, 0));
+
+		message = g_strdup_printf ("commit %u\n", i);
+
+		check (git_commit_create_from_ids (&commit_id, repo, NULL, sig, sig,
+		                                   NULL, message, &tree_id,
+		                                   i > 0 ? 1 : 0, parents));
+
+		g_free (message);
+		git_signature_free (sig);
+
+		g_array_append_val (bench->commit_ids, commit_id);
+		parent = commit_id;
+	}
+
+	check (git_reference_create (&ref, repo, "refs/heads/master", &parent, 1, NULL));
+	git_reference_free (ref);
+
+	/* Branches pointing at commits spread over the history */
+	for (i = 0; i < (guint)n_branches; i++)
+	{
+		git_oid *id;
+		gchar *name;
+
+		id = &g_array_index (bench->commit_ids, git_oid,
+		                     (guint64)bench->commit_ids->len * i / n_branches);
+
+		name = g_strdup_printf ("refs/heads/branch-%05u", i);
+		check (git_reference_create (&ref, repo, name, id, 1, NULL));
+		git_reference_free (ref);
+		g_free (name);
+
+		g_array_append_val (bench->branch_ids, *id);
+	}
+
+	check (git_repository_set_head (repo, "refs/heads/master"));
+
+	g_string_free (blame, TRUE);
+	git_tree_free (base);
+}
+
+static void
+checkout_head (git_repository *repo)
+{
+	git_checkout_options checkout = GIT_CHECKOUT_OPTIONS_INIT;
+	git_status_options status = GIT_STATUS_OPTIONS_INIT;
+	git_status_list *list;
+
+	checkout.checkout_strategy = GIT_CHECKOUT_FORCE;
+	check (git_checkout_head (repo, &checkout));
+
+	/* Files written in the same second as the index are racily clean and
+	 * would be hashed by every status, refresh the index once they are
+	 * not anymore */
+	g_usleep (1100 * G_TIME_SPAN_MILLISECOND);
+
+	status.flags = GIT_STATUS_OPT_UPDATE_INDEX;
+	check (git_status_list_new (&list, repo, &status));
+	git_status_list_free (list);
+}
+
+/* Status reports these, next to the files the tree has */
+static void
+create_untracked_files (const gchar *workdir)
+{
+	guint i;
+
+	for (i = 0; i < (guint)n_files; i += MODIFIED_EVERY)
+	{
+		GError *error = NULL;
+		gchar *path;
+		gchar *filename;
+
+		path = g_strdup_printf ("d%04u/u%07u.txt", i / FILES_PER_DIR, i);
+		filename = g_build_filename (workdir, path, NULL);
+
+		g_file_set_contents (filename, path, -1, &error);
+		check_error (error);
+
+		g_free (filename);
+		g_free (path);
+	}
+}
+
+static void
+generate_repository (Bench *bench)
+{
+	git_repository *repo;
+	git_index *index;
+	git_oid base_ids[N_CONTENTS];
+	git_oid modified_ids[N_CONTENTS];
+	gint64 start;
+
+	start = g_get_monotonic_time ();
+
+	check (git_repository_init (&repo, bench->path, 0));
+
+	create_contents (repo, base_ids, FALSE);
+	create_contents (repo, modified_ids, TRUE);
+
+	check (git_index_new (&index));
+	add_files (index, base_ids, NULL);
+	check (git_index_write_tree_to (&bench->base_tree, index, repo));
+	git_index_free (index);
+
+	check (git_index_new (&index));
+	add_files (index, base_ids, modified_ids);
+	check (git_index_write_tree_to (&bench->modified_tree, index, repo));
+	git_index_free (index);
+
+	create_large_blob (bench, repo);
+	create_history (bench, repo);
+	checkout_head (repo);
+	create_untracked_files (bench->path);
+
+	git_repository_free (repo);
+
+	g_printerr ("Generated repository in %s (%.1f s)\n",
+	            bench->path,
+	            (g_get_monotonic_time () - start) / (gdouble)G_USEC_PER_SEC);
+}
+
+static void
+bench_init (Bench *bench)
+{
+	GFile *location;
+	GFile *workdir;
+	GError *error = NULL;
+	guint i;
+
+	bench->path = g_dir_make_tmp ("ggit-benchmark-XXXXXX", &error);
+	check_error (error);
+
+	bench->commit_ids = g_array_new (FALSE, FALSE, sizeof (git_oid));
+	bench->branch_ids = g_array_new (FALSE, FALSE, sizeof (git_oid));
+
+	generate_repository (bench);
+
+	location = g_file_new_for_path (bench->path);
+	bench->repo = ggit_repository_open (location, &error);
+	check_error (error);
+	g_object_unref (location);
+
+	check (git_repository_open (&bench->raw, bench->path));
+
+	bench->commit_oids = g_ptr_array_new_with_free_func ((GDestroyNotify)ggit_oid_free);
+
+	for (i = 0; i < bench->commit_ids->len; i++)
+	{
+		git_oid *id = &g_array_index (bench->commit_ids, git_oid, i);
+
+		g_ptr_array_add (bench->commit_oids, ggit_oid_new_from_raw (id->id));
+	}
+
+	bench->branch_oids = g_ptr_array_new_with_free_func ((GDestroyNotify)ggit_oid_free);
+
+	for (i = 0; i < bench->branch_ids->len; i++)
+	{
+		git_oid *id = &g_array_index (bench->branch_ids, git_oid, i);
+
+		g_ptr_array_add (bench->branch_oids, ggit_oid_new_from_raw (id->id));
+	}
+
+	workdir = ggit_repository_get_workdir (bench->repo);
+
+	bench->index_paths = g_ptr_array_new_with_free_func (g_free);
+	bench->index_files = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (i = 0; i < (guint)n_files; i += INDEX_SAMPLE_EVERY)
+	{
+		gchar *path = file_path (i);
+
+		g_ptr_array_add (bench->index_files, g_file_resolve_relative_path (workdir, path));
+		g_ptr_array_add (bench->index_paths, path);
+	}
+
+	bench->blame_file = g_file_get_child (workdir, "blame.txt");
+	g_object_unref (workdir);
+
+	/* Also writes the commit-graph */
+	ggit_repository_write_reachability_index (bench->repo, NULL, &error);
+	check_error (error);
+}
+
+static void
+remove_recursive (const gchar *path)
+{
+	GDir *dir;
+
+	dir = g_dir_open (path, 0, NULL);
+
+	if (dir != NULL)
+	{
+		const gchar *name;
+
+		while ((name = g_dir_read_name (dir)) != NULL)
+		{
+			gchar *child;
+
+			child = g_build_filename (path, name, NULL);
+
+			if (g_file_test (child, G_FILE_TEST_IS_DIR) &&
+			    !g_file_test (child, G_FILE_TEST_IS_SYMLINK))
+			{
+				remove_recursive (child);
+			}
+			else if (g_remove (child) != 0)
+			{
+				g_warning ("Could not remove %s: %s", child, g_strerror (errno));
+			}
+
+			g_free (child);
+		}
+
+		g_dir_close (dir);
+	}
+
+	if (g_remove (path) != 0)
+	{
+		g_warning ("Could not remove %s: %s", path, g_strerror (errno));
+	}
+}
+
+static void
+bench_clear (Bench *bench)
+{
+	g_clear_object (&bench->repo);
+	g_clear_pointer (&bench->raw, git_repository_free);
+
+	g_array_unref (bench->commit_ids);
+	g_ptr_array_unref (bench->commit_oids);
+	g_array_unref (bench->branch_ids);
+	g_ptr_array_unref (bench->branch_oids);
+	g_ptr_array_unref (bench->index_paths);
+	g_ptr_array_unref (bench->index_files);
+	g_object_unref (bench->blame_file);
+
+	if (!keep)
+	{
+		remove_recursive (bench->path);
+	}
+
+	g_free (bench->path);
+}
+
+/* Revision walking */
+
+static guint
+revwalk_ggit (Bench *bench)
+{
+	GgitRevisionWalker *walker;
+	GgitOId *oid;
+	GError *error = NULL;
+	guint n = 0;
+
+	walker = ggit_revision_walker_new (bench->repo, &error);
+	check_error (error);
+
+	ggit_revision_walker_push_head (walker, &error);
+	check_error (error);
+
+	while ((oid = ggit_revision_walker_next (walker, NULL)) != NULL)
+	{
+		ggit_oid_free (oid);
+		n++;
+	}
+
+	g_object_unref (walker);
+
+	return n;
+}
+
+static guint
+revwalk_collect_ggit (Bench *bench)
+{
+	GgitRevisionWalker *walker;
+	guint8 ids[256 * GIT_OID_RAWSZ];
+	GError *error = NULL;
+	gsize got;
+	guint n = 0;
+
+	walker = ggit_revision_walker_new (bench->repo, &error);
+	check_error (error);
+
+	ggit_revision_walker_push_head (walker, &error);
+	check_error (error);
+
+	while ((got = ggit_revision_walker_next_n (walker, ids, 256, &error)) > 0)
+	{
+		n += got;
+	}
+
+	check_error (error);
+	g_object_unref (walker);
+
+	return n;
+}
+
+static guint
+revwalk_libgit2 (Bench *bench)
+{
+	git_revwalk *walker;
+	git_oid id;
+	guint n = 0;
+
+	check (git_revwalk_new (&walker, bench->raw));
+	check (git_revwalk_push_head (walker));
+
+	while (git_revwalk_next (&id, walker) == 0)
+	{
+		n++;
+	}
+
+	git_revwalk_free (walker);
+
+	return n;
+}
+
+/* Object lookup */
+
+static guint
+lookup_ggit (Bench *bench)
+{
+	guint i;
+
+	for (i = 0; i < bench->commit_oids->len; i++)
+	{
+		GgitCommit *commit;
+		GError *error = NULL;
+
+		commit = ggit_repository_lookup_commit (bench->repo,
+		                                        g_ptr_array_index (bench->commit_oids, i),
+		                                        &error);
+		check_error (error);
+		g_object_unref (commit);
+	}
+
+	return bench->commit_oids->len;
+}
+
+static guint
+lookup_libgit2 (Bench *bench)
+{
+	guint i;
+
+	for (i = 0; i < bench->commit_ids->len; i++)
+	{
+		git_commit *commit;
+
+		check (git_commit_lookup (&commit,
+		                          bench->raw,
+		                          &g_array_index (bench->commit_ids, git_oid, i)));
+		git_commit_free (commit);
+	}
+
+	return bench->commit_ids->len;
+}
+
+/* Tree walking */
+
+static gint
+count_tree_entry_ggit (const gchar         *root,
+                       const GgitTreeEntry *entry,
+                       gpointer             user_data)
+{
+	guint *n = user_data;
+
+	(*n)++;
+	return 0;
+}
+
+static guint
+tree_walk_ggit (Bench *bench)
+{
+	GgitOId *oid;
+	GgitTree *tree;
+	GError *error = NULL;
+	guint n = 0;
+
+	oid = ggit_oid_new_from_raw (bench->base_tree.id);
+	tree = ggit_repository_lookup_tree (bench->repo, oid, &error);
+	check_error (error);
+	ggit_oid_free (oid);
+
+	ggit_tree_walk (tree, GGIT_TREE_WALK_MODE_PRE, count_tree_entry_ggit, &n, &error);
+	check_error (error);
+
+	g_object_unref (tree);
+
+	return n;
+}
+
+static gint
+count_tree_entry_libgit2 (const char           *root,
+                          const git_tree_entry *entry,
+                          void                 *payload)
+{
+	guint *n = payload;
+
+	(*n)++;
+	return 0;
+}
+
+static guint
+tree_walk_libgit2 (Bench *bench)
+{
+	git_tree *tree;
+	guint n = 0;
+
+	check (git_tree_lookup (&tree, bench->raw, &bench->base_tree));
+	check (git_tree_walk (tree, GIT_TREEWALK_PRE, count_tree_entry_libgit2, &n));
+	git_tree_free (tree);
+
+	return n;
+}
+
+/* Diff with line callbacks */
+
+static gint
+count_line_ggit (GgitDiffDelta *delta,
+                 GgitDiffHunk  *hunk,
+                 GgitDiffLine  *line,
+                 gpointer       user_data)
+{
+	guint *n = user_data;
+
+	(*n)++;
+	return 0;
+}
+
+static guint
+diff_lines_ggit (Bench *bench)
+{
+	GgitOId *oid;
+	GgitTree *old_tree;
+	GgitTree *new_tree;
+	GgitDiff *diff;
+	GError *error = NULL;
+	guint n = 0;
+
+	oid = ggit_oid_new_from_raw (bench->base_tree.id);
+	old_tree = ggit_repository_lookup_tree (bench->repo, oid, &error);
+	check_error (error);
+	ggit_oid_free (oid);
+
+	oid = ggit_oid_new_from_raw (bench->modified_tree.id);
+	new_tree = ggit_repository_lookup_tree (bench->repo, oid, &error);
+	check_error (error);
+	ggit_oid_free (oid);
+
+	diff = ggit_diff_new_tree_to_tree (bench->repo, old_tree, new_tree, NULL, &error);
+	check_error (error);
+
+	ggit_diff_foreach (diff, NULL, NULL, NULL, count_line_ggit, &n, &error);
+	check_error (error);
+
+	g_object_unref (diff);
+	g_object_unref (new_tree);
+	g_object_unref (old_tree);
+
+	return n;
+}
+
+static gint
+count_line_libgit2 (const git_diff_delta *delta,
+                    const git_diff_hunk  *hunk,
+                    const git_diff_line  *line,
+                    void                 *payload)
+{
+	guint *n = payload;
+
+	(*n)++;
+	return 0;
+}
+
+static guint
+diff_lines_libgit2 (Bench *bench)
+{
+	git_tree *old_tree;
+	git_tree *new_tree;
+	git_diff *diff;
+	guint n = 0;
+
+	check (git_tree_lookup (&old_tree, bench->raw, &bench->base_tree));
+	check (git_tree_lookup (&new_tree, bench->raw, &bench->modified_tree));
+	check (git_diff_tree_to_tree (&diff, bench->raw, old_tree, new_tree, NULL));
+
+	check (git_diff_foreach (diff, NULL, NULL, NULL, count_line_libgit2, &n));
+
+	git_diff_free (diff);
+	git_tree_free (new_tree);
+	git_tree_free (old_tree);
+
+	return n;
+}
+
+/* Diff of a single large file, about 1M lines with the default blob size */
+
+static guint
+diff_blob_lines_ggit (Bench *bench)
+{
+	GgitOId *oid;
+	GgitBlob *blob;
+	GError *error = NULL;
+	guint n = 0;
+
+	oid = ggit_oid_new_from_raw (bench->large_blob.id);
+	blob = ggit_repository_lookup_blob (bench->repo, oid, &error);
+	check_error (error);
+	ggit_oid_free (oid);
+
+	ggit_diff_blobs (NULL, NULL, blob, "large.txt", NULL,
+	                 NULL, NULL, NULL, count_line_ggit, &n, &error);
+	check_error (error);
+
+	g_object_unref (blob);
+
+	return n;
+}
+
+static guint
+diff_blob_lines_libgit2 (Bench *bench)
+{
+	git_blob *blob;
+	guint n = 0;
+
+	check (git_blob_lookup (&blob, bench->raw, &bench->large_blob));
+	check (git_diff_blobs (NULL, NULL, blob, "large.txt", NULL,
+	                       NULL, NULL, NULL, count_line_libgit2, &n));
+	git_blob_free (blob);
+
+	return n;
+}
+
+/* Index lookups by path */
+
+static guint
+index_by_path_ggit (Bench *bench)
+{
+	GgitIndex *index;
+	GgitIndexEntries *entries;
+	GError *error = NULL;
+	guint i;
+
+	index = ggit_repository_get_index (bench->repo, &error);
+	check_error (error);
+
+	entries = ggit_index_get_entries (index);
+
+	for (i = 0; i < bench->index_files->len; i++)
+	{
+		GgitIndexEntry *entry;
+
+		entry = ggit_index_entries_get_by_path (entries,
+		                                        g_ptr_array_index (bench->index_files, i),
+		                                        0);
+		g_assert (entry != NULL);
+		ggit_index_entry_unref (entry);
+	}
+
+	ggit_index_entries_unref (entries);
+	g_object_unref (index);
+
+	return bench->index_files->len;
+}
+
+static guint
+index_by_path_libgit2 (Bench *bench)
+{
+	git_index *index;
+	guint i;
+
+	check (git_repository_index (&index, bench->raw));
+
+	for (i = 0; i < bench->index_paths->len; i++)
+	{
+		const git_index_entry *entry;
+
+		entry = git_index_get_bypath (index, g_ptr_array_index (bench->index_paths, i), 0);
+		g_assert (entry != NULL);
+	}
+
+	git_index_free (index);
+
+	return bench->index_paths->len;
+}
+
+/* Blame */
+
+static guint
+blame_ggit (Bench *bench)
+{
+	GgitBlame *blame;
+	GError *error = NULL;
+	guint n;
+
+	blame = ggit_repository_blame_file (bench->repo, bench->blame_file, NULL, &error);
+	check_error (error);
+
+	n = ggit_blame_get_hunk_count (blame);
+	g_object_unref (blame);
+
+	return n;
+}
+
+static guint
+blame_libgit2 (Bench *bench)
+{
+	git_blame *blame;
+	guint n;
+
+	check (git_blame_file (&blame, bench->raw, "blame.txt", NULL));
+
+	n = git_blame_get_hunk_count (blame);
+	git_blame_free (blame);
+
+	return n;
+}
+
+/* Status */
+
+static gint
+count_status_ggit (const gchar     *path,
+                   GgitStatusFlags  status_flags,
+                   gpointer         user_data)
+{
+	guint *n = user_data;
+
+	(*n)++;
+	return 0;
+}
+
+static guint
+status_ggit (Bench *bench)
+{
+	GError *error = NULL;
+	guint n = 0;
+
+	ggit_repository_file_status_foreach (bench->repo, NULL, count_status_ggit, &n, &error);
+	check_error (error);
+
+	return n;
+}
+
+static gint
+count_status_libgit2 (const char *path,
+                      unsigned    status_flags,
+                      void       *payload)
+{
+	guint *n = payload;
+
+	(*n)++;
+	return 0;
+}
+
+static guint
+status_libgit2 (Bench *bench)
+{
+	guint n = 0;
+
+	check (git_status_foreach (bench->raw, count_status_libgit2, &n));
+
+	return n;
+}
+
+/* Large blobs */
+
+static guint
+blob_read_ggit (Bench *bench)
+{
+	GgitOId *oid;
+	GgitBlob *blob;
+	GError *error = NULL;
+	gsize size;
+
+	oid = ggit_oid_new_from_raw (bench->large_blob.id);
+	blob = ggit_repository_lookup_blob (bench->repo, oid, &error);
+	check_error (error);
+	ggit_oid_free (oid);
+
+	ggit_blob_get_raw_content (blob, &size);
+	g_object_unref (blob);
+
+	return (guint)(size >> 20);
+}
+
+static guint
+blob_read_libgit2 (Bench *bench)
+{
+	git_blob *blob;
+	gsize size;
+
+	check (git_blob_lookup (&blob, bench->raw, &bench->large_blob));
+
+	git_blob_rawcontent (blob);
+	size = (gsize)git_blob_rawsize (blob);
+	git_blob_free (blob);
+
+	return (guint)(size >> 20);
+}
+
+/* Commit graph queries, between HEAD and commits spread over the history.
+ * The commit-graph and the reachability index are written by bench_init,
+ * libgit2 parses the commits.
+ */
+
+#define N_GRAPH_QUERIES 16
+
+static guint
+graph_query_index (Bench *bench,
+                   guint  i)
+{
+	return (guint)((guint64)bench->commit_ids->len * i / N_GRAPH_QUERIES);
+}
+
+static guint
+commit_graph_write_ggit (Bench *bench)
+{
+	GError *error = NULL;
+
+	ggit_repository_write_commit_graph (bench->repo, NULL, &error);
+	check_error (error);
+
+	return bench->commit_ids->len;
+}
+
+static guint
+ahead_behind_ggit (Bench *bench)
+{
+	GgitOId *head = g_ptr_array_index (bench->commit_oids, bench->commit_oids->len - 1);
+	guint i;
+
+	for (i = 0; i < N_GRAPH_QUERIES; i++)
+	{
+		GError *error = NULL;
+		gsize ahead;
+		gsize behind;
+
+		ggit_repository_get_ahead_behind (bench->repo,
+		                                  head,
+		                                  g_ptr_array_index (bench->commit_oids,
+		                                                     graph_query_index (bench, i)),
+		                                  &ahead,
+		                                  &behind,
+		                                  &error);
+		check_error (error);
+	}
+
+	return N_GRAPH_QUERIES;
+}
+
+static guint
+ahead_behind_libgit2 (Bench *bench)
+{
+	git_oid *head = &g_array_index (bench->commit_ids, git_oid, bench->commit_ids->len - 1);
+	guint i;
+
+	for (i = 0; i < N_GRAPH_QUERIES; i++)
+	{
+		size_t ahead;
+		size_t behind;
+
+		check (git_graph_ahead_behind (&ahead, &behind, bench->raw, head,
+		                               &g_array_index (bench->commit_ids, git_oid,
+		                                               graph_query_index (bench, i))));
+	}
+
+	return N_GRAPH_QUERIES;
+}
+
+static guint
+descendant_of_ggit (Bench *bench)
+{
+	GgitOId *head = g_ptr_array_index (bench->commit_oids, bench->commit_oids->len - 1);
+	guint i;
+
+	for (i = 0; i < N_GRAPH_QUERIES; i++)
+	{
+		GError *error = NULL;
+
+		ggit_repository_get_descendant_of (bench->repo,
+		                                   head,
+		                                   g_ptr_array_index (bench->commit_oids,
+		                                                      graph_query_index (bench, i)),
+		                                   &error);
+		check_error (error);
+	}
+
+	return N_GRAPH_QUERIES;
+}
+
+static guint
+descendant_of_libgit2 (Bench *bench)
+{
+	git_oid *head = &g_array_index (bench->commit_ids, git_oid, bench->commit_ids->len - 1);
+	guint i;
+
+	for (i = 0; i < N_GRAPH_QUERIES; i++)
+	{
+		check (git_graph_descendant_of (bench->raw, head,
+		                                &g_array_index (bench->commit_ids, git_oid,
+		                                                graph_query_index (bench, i))));
+	}
+
+	return N_GRAPH_QUERIES;
+}
+
+static guint
+merge_base_ggit (Bench *bench)
+{
+	GgitOId *head = g_ptr_array_index (bench->commit_oids, bench->commit_oids->len - 1);
+	guint i;
+
+	for (i = 0; i < N_GRAPH_QUERIES; i++)
+	{
+		GError *error = NULL;
+		GgitOId *base;
+
+		base = ggit_repository_merge_base (bench->repo,
+		                                   head,
+		                                   g_ptr_array_index (bench->commit_oids,
+		                                                      graph_query_index (bench, i)),
+		                                   &error);
+		check_error (error);
+		ggit_oid_free (base);
+	}
+
+	return N_GRAPH_QUERIES;
+}
+
+static guint
+merge_base_libgit2 (Bench *bench)
+{
+	git_oid *head = &g_array_index (bench->commit_ids, git_oid, bench->commit_ids->len - 1);
+	guint i;
+
+	for (i = 0; i < N_GRAPH_QUERIES; i++)
+	{
+		git_oid base;
+
+		check (git_merge_base (&base, bench->raw, head,
+		                       &g_array_index (bench->commit_ids, git_oid,
+		                                       graph_query_index (bench, i))));
+	}
+
+	return N_GRAPH_QUERIES;
+}
+
+/* Which branches contain a commit, and every branch against master */
+
+static guint
+reachability_index_write_ggit (Bench *bench)
+{
+	GError *error = NULL;
+
+	ggit_repository_write_reachability_index (bench->repo, NULL, &error);
+	check_error (error);
+
+	return bench->commit_ids->len;
+}
+
+static guint
+contains_many_ggit (Bench *bench)
+{
+	GgitOId *commit = g_ptr_array_index (bench->commit_oids, bench->commit_oids->len / 2);
+	GError *error = NULL;
+	gboolean *results;
+
+	results = g_new (gboolean, bench->branch_oids->len);
+
+	ggit_repository_get_descendant_of_many (bench->repo,
+	                                        (GgitOId **)bench->branch_oids->pdata,
+	                                        bench->branch_oids->len,
+	                                        commit,
+	                                        results,
+	                                        &error);
+	check_error (error);
+
+	g_free (results);
+
+	return bench->branch_oids->len;
+}
+
+static guint
+contains_many_libgit2 (Bench *bench)
+{
+	git_oid *commit = &g_array_index (bench->commit_ids, git_oid, bench->commit_ids->len / 2);
+	guint i;
+
+	for (i = 0; i < bench->branch_ids->len; i++)
+	{
+		check (git_graph_descendant_of (bench->raw,
+		                                &g_array_index (bench->branch_ids, git_oid, i),
+		                                commit));
+	}
+
+	return bench->branch_ids->len;
+}
+
+static guint
+ahead_behind_many_ggit (Bench *bench)
+{
+	GgitOId *head = g_ptr_array_index (bench->commit_oids, bench->commit_oids->len - 1);
+	GError *error = NULL;
+	gsize *ahead;
+	gsize *behind;
+
+	ahead = g_new (gsize, bench->branch_oids->len);
+	behind = g_new (gsize, bench->branch_oids->len);
+
+	ggit_repository_get_ahead_behind_many (bench->repo,
+	                                       (GgitOId **)bench->branch_oids->pdata,
+	                                       bench->branch_oids->len,
+	                                       head,
+	                                       ahead,
+	                                       behind,
+	                                       &error);
+	check_error (error);
+
+	g_free (ahead);
+	g_free (behind);
+
+	return bench->branch_oids->len;
+}
+
+static guint
+ahead_behind_many_libgit2 (Bench *bench)
+{
+	git_oid *head = &g_array_index (bench->commit_ids, git_oid, bench->commit_ids->len - 1);
+	guint i;
+
+	for (i = 0; i < bench->branch_ids->len; i++)
+	{
+		size_t ahead;
+		size_t behind;
+
+		check (git_graph_ahead_behind (&ahead, &behind, bench->raw,
+		                               &g_array_index (bench->branch_ids, git_oid, i),
+		                               head));
+	}
+
+	return bench->branch_ids->len;
+}
+
+static const struct
+{
+	const gchar *name;
+	const gchar *impl;
+	const gchar *unit;
+	BenchFunc func;
+} benchmarks[] =
+{
+	{ "revwalk", "ggit", "commit", revwalk_ggit },
+	{ "revwalk", "ggit-next-n", "commit", revwalk_collect_ggit },
+	{ "revwalk", "libgit2", "commit", revwalk_libgit2 },
+	{ "lookup-commit", "ggit", "commit", lookup_ggit },
+	{ "lookup-commit", "libgit2", "commit", lookup_libgit2 },
+	{ "tree-walk", "ggit", "entry", tree_walk_ggit },
+	{ "tree-walk", "libgit2", "entry", tree_walk_libgit2 },
+	{ "diff-lines", "ggit", "line", diff_lines_ggit },
+	{ "diff-lines", "libgit2", "line", diff_lines_libgit2 },
+	{ "diff-blob-lines", "ggit", "line", diff_blob_lines_ggit },
+	{ "diff-blob-lines", "libgit2", "line", diff_blob_lines_libgit2 },
+	{ "index-by-path", "ggit", "lookup", index_by_path_ggit },
+	{ "index-by-path", "libgit2", "lookup", index_by_path_libgit2 },
+	{ "blame", "ggit", "hunk", blame_ggit },
+	{ "blame", "libgit2", "hunk", blame_libgit2 },
+	{ "status", "ggit", "entry", status_ggit },
+	{ "status", "libgit2", "entry", status_libgit2 },
+	{ "blob-read", "ggit", "MiB", blob_read_ggit },
+	{ "blob-read", "libgit2", "MiB", blob_read_libgit2 },
+	{ "commit-graph-write", "ggit", "commit", commit_graph_write_ggit },
+	{ "ahead-behind", "ggit", "query", ahead_behind_ggit },
+	{ "ahead-behind", "libgit2", "query", ahead_behind_libgit2 },
+	{ "descendant-of", "ggit", "query", descendant_of_ggit },
+	{ "descendant-of", "libgit2", "query", descendant_of_libgit2 },
+	{ "merge-base", "ggit", "query", merge_base_ggit },
+	{ "merge-base", "libgit2", "query", merge_base_libgit2 },
+	{ "reachability-index-write", "ggit", "commit", reachability_index_write_ggit },
+	{ "contains-many", "ggit", "branch", contains_many_ggit },
+	{ "contains-many", "libgit2", "branch", contains_many_libgit2 },
+	{ "ahead-behind-many", "ggit", "branch", ahead_behind_many_ggit },
+	{ "ahead-behind-many", "libgit2", "branch", ahead_behind_many_libgit2 },
+};
+
+static gint
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+	gint64 ta = *(const gint64 *)a;
+	gint64 tb = *(const gint64 *)b;
+
+	return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static void
+run_benchmark (Bench     *bench,
+               guint      i)
+{
+	gint64 *times;
+	guint items = 0;
+	gint64 total = 0;
+	gint j;
+
+	times = g_new (gint64, n_iterations);
+
+	/* Warm up the caches of libgit2 and of the OS once */
+	benchmarks[i].func (bench);
+
+	for (j = 0; j < n_iterations; j++)
+	{
+		gint64 start;
+
+		start = g_get_monotonic_time ();
+		items = benchmarks[i].func (bench);
+		times[j] = g_get_monotonic_time () - start;
+		total += times[j];
+	}
+
+	qsort (times, n_iterations, sizeof (gint64), compare_times);
+
+	fprintf (bench->out,
+	         "{\"benchmark\": \"%s\", \"impl\": \"%s\", \"unit\": \"%s\", "
+	         "\"items\": %u, \"iterations\": %d, "
+	         "\"min_us\": %" G_GINT64_FORMAT ", \"median_us\": %" G_GINT64_FORMAT ", "
+	         "\"mean_us\": %" G_GINT64_FORMAT ", \"ns_per_item\": %.1f}\n",
+	         benchmarks[i].name,
+	         benchmarks[i].impl,
+	         benchmarks[i].unit,
+	         items,
+	         n_iterations,
+	         times[0],
+	         times[n_iterations / 2],
+	         total / n_iterations,
+	         items > 0 ? times[n_iterations / 2] * 1000.0 / items : 0.0);
+	fflush (bench->out);
+
+	g_free (times);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	Bench bench = { 0 };
+	gint major, minor, rev;
+	guint i;
+
+	context = g_option_context_new ("- benchmark libgit2-glib");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+	{
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		g_option_context_free (context);
+		return EXIT_FAILURE;
+	}
+
+	g_option_context_free (context);
+
+	if (n_commits < 1 || n_files < 1 || n_iterations < 1 ||
+	    n_blame_commits < 1 || blob_size_mb < 1 || n_branches < 1)
+	{
+		g_printerr ("All sizes must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	ggit_init ();
+
+	if (output != NULL)
+	{
+		bench.out = fopen (output, "w");
+
+		if (bench.out == NULL)
+		{
+			g_printerr ("Could not open %s: %s\n", output, g_strerror (errno));
+			return EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		bench.out = stdout;
+	}
+
+	bench_init (&bench);
+
+	git_libgit2_version (&major, &minor, &rev);
+
+	fprintf (bench.out,
+	         "{\"libgit2\": \"%d.%d.%d\", \"libgit2-glib\": \"%s\", "
+	         "\"commits\": %d, \"files\": %d, \"blame_commits\": %d, "
+	         "\"blob_size_mb\": %d, \"branches\": %d}\n",
+	         major, minor, rev, GGIT_VERSION_S,
+	         n_commits, n_files, n_blame_commits, blob_size_mb, n_branches);
+
+	for (i = 0; i < G_N_ELEMENTS (benchmarks); i++)
+	{
+		if (only == NULL || g_str_has_prefix (benchmarks[i].name, only))
+		{
+			run_benchmark (&bench, i);
+		}
+	}
+
+	bench_clear (&bench);
+
+	if (bench.out != stdout)
+	{
+		fclose (bench.out);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/* ex:set ts=8 noet: */
@@ -22,6 +22,7 @@
 #include <config.h>
 #endif
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -32,6 +33,7 @@
 #include <glib/gstdio.h>
 
 #include "libgit2-glib/ggit.h"
+#include "libgit2-glib/ggit-reachability-index.h"
 
 #define TESTREPO_NAME "testrepo.git"
 
@@ -360,6 +362,3358 @@ test_repository_encoding (const gchar *git_dir)
 	g_object_unref (repo);
 }
 
+static GgitOId *
+create_linear_history (GgitRepository *repo,
+                       guint           n_commits)
+{
+	GError *err = NULL;
+	GgitTreeBuilder *builder;
+	GgitSignature *author;
+	GgitOId *toid;
+	GgitTree *tree;
+	GgitCommit *parent = NULL;
+	GgitOId *cid = NULL;
+	guint i;
+
+	builder = ggit_repository_create_tree_builder (repo, &err);
+	g_assert_no_error (err);
+
+	toid = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+	g_object_unref (builder);
+
+	tree = GGIT_TREE (ggit_repository_lookup (repo, toid, GGIT_TYPE_TREE, &err));
+	g_assert_no_error (err);
+	ggit_oid_free (toid);
+
+	author = ggit_signature_new_now ("Jesse van den Kieboom",
+	                                 "jessevdk@gnome.org",
+	                                 &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < n_commits; ++i)
+	{
+		gchar *message;
+
+		message = g_strdup_printf ("commit %u", i);
+
+		g_clear_pointer (&cid, ggit_oid_free);
+		cid = ggit_repository_create_commit (repo,
+		                                     "HEAD",
+		                                     author,
+		                                     author,
+		                                     NULL,
+		                                     message,
+		                                     tree,
+		                                     parent ? &parent : NULL,
+		                                     parent ? 1 : 0,
+		                                     &err);
+		g_assert_no_error (err);
+		g_free (message);
+
+		g_clear_object (&parent);
+		parent = GGIT_COMMIT (ggit_repository_lookup (repo, cid, GGIT_TYPE_COMMIT, &err));
+		g_assert_no_error (err);
+	}
+
+	g_clear_object (&parent);
+	g_object_unref (author);
+	g_object_unref (tree);
+
+	return cid;
+}
+
+static void
+test_repository_revision_walker_collect (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitOId *head;
+	GgitOId *oid;
+	GBytes *ids;
+	guint8 raw[3 * 20];
+	gsize n;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 10);
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	n = ggit_revision_walker_next_n (walker, raw, 3, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (n, ==, 3);
+
+	oid = ggit_oid_new_from_raw (raw);
+	g_assert (ggit_oid_equal (oid, head));
+	ggit_oid_free (oid);
+
+	ids = ggit_revision_walker_collect (walker, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (g_bytes_get_size (ids), ==, 7 * 20);
+	g_bytes_unref (ids);
+
+	ggit_oid_free (head);
+	g_object_unref (walker);
+	g_object_unref (repo);
+}
+
+static void
+test_repository_oid_set (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitOIdSet *set;
+	GgitOIdMap *map;
+	GgitOId *head;
+	GgitOId *zero;
+	gsize n;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 300);
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	set = ggit_oid_set_new ();
+
+	n = ggit_oid_set_add_from_revision_walker (set, walker, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (n, ==, 300);
+	g_assert_cmpuint (ggit_oid_set_get_size (set), ==, 300);
+
+	zero = ggit_oid_new_from_string ("0000000000000000000000000000000000000000");
+
+	g_assert (ggit_oid_set_contains (set, head));
+	g_assert (!ggit_oid_set_contains (set, zero));
+	g_assert (!ggit_oid_set_add (set, head));
+	g_assert (ggit_oid_set_remove (set, head));
+	g_assert (!ggit_oid_set_contains (set, head));
+	g_assert_cmpuint (ggit_oid_set_get_size (set), ==, 299);
+
+	map = ggit_oid_map_new (g_free);
+
+	g_assert (ggit_oid_map_insert (map, head, g_strdup ("head")));
+	g_assert (!ggit_oid_map_insert (map, head, g_strdup ("HEAD")));
+	g_assert_cmpstr (ggit_oid_map_lookup (map, head), ==, "HEAD");
+	g_assert (ggit_oid_map_lookup (map, zero) == NULL);
+	g_assert (ggit_oid_map_remove (map, head));
+	g_assert_cmpuint (ggit_oid_map_get_size (map), ==, 0);
+
+	ggit_oid_map_unref (map);
+	ggit_oid_set_unref (set);
+	ggit_oid_free (zero);
+	ggit_oid_free (head);
+	g_object_unref (walker);
+	g_object_unref (repo);
+}
+
+static void
+test_repository_object_cache (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitOId *head;
+	GgitCommit *a;
+	GgitCommit *b;
+	GgitObject *c;
+	guint64 hits;
+	guint64 misses;
+	guint n_objects;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 2);
+
+	ggit_repository_set_object_cache_size (repo, 4);
+
+	a = ggit_repository_lookup_commit (repo, head, &err);
+	g_assert_no_error (err);
+
+	b = ggit_repository_lookup_commit (repo, head, &err);
+	g_assert_no_error (err);
+	g_assert (a == b);
+	g_object_unref (b);
+
+	c = ggit_repository_revparse (repo, "HEAD", &err);
+	g_assert_no_error (err);
+	g_assert (c == GGIT_OBJECT (a));
+	g_object_unref (c);
+
+	/* Asking for another type does not return the commit */
+	c = ggit_repository_lookup (repo, head, GGIT_TYPE_TREE, &err);
+	g_assert (c == NULL);
+	g_clear_error (&err);
+
+	ggit_repository_get_object_cache_stats (repo, &hits, &misses, &n_objects);
+	g_assert_cmpuint (hits, ==, 2);
+	g_assert_cmpuint (misses, ==, 2);
+	g_assert_cmpuint (n_objects, ==, 1);
+
+	/* Disabling the cache drops the wrappers it tracks */
+	ggit_repository_set_object_cache_size (repo, 0);
+
+	b = ggit_repository_lookup_commit (repo, head, &err);
+	g_assert_no_error (err);
+	g_assert (a != b);
+	g_object_unref (b);
+
+	g_object_unref (a);
+	ggit_oid_free (head);
+	g_object_unref (repo);
+}
+
+typedef struct
+{
+	GgitCommit parent_instance;
+} TestCommit;
+
+typedef struct
+{
+	GgitCommitClass parent_class;
+} TestCommitClass;
+
+GType test_commit_get_type (void);
+
+G_DEFINE_TYPE (TestCommit, test_commit, GGIT_TYPE_COMMIT)
+
+static void
+test_commit_class_init (TestCommitClass *klass)
+{
+}
+
+static void
+test_commit_init (TestCommit *commit)
+{
+}
+
+static gdouble
+time_commit_lookups (GgitRepository *repo,
+                     GgitOId        *oid,
+                     GType           expected_type,
+                     guint           n)
+{
+	GTimer *timer;
+	gdouble elapsed;
+	guint i;
+
+	timer = g_timer_new ();
+
+	for (i = 0; i < n; i++)
+	{
+		GgitCommit *commit;
+
+		commit = ggit_repository_lookup_commit (repo, oid, NULL);
+		g_assert (G_OBJECT_TYPE (commit) == expected_type);
+		g_object_unref (commit);
+	}
+
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_timer_destroy (timer);
+
+	return elapsed;
+}
+
+static void
+test_repository_object_factory (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitObjectFactory *factory;
+	GgitOId *head;
+	gdouble plain;
+	gdouble overridden;
+	guint n;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 1);
+	factory = ggit_object_factory_get_default ();
+
+	/* Only measure with -m perf, otherwise just check the type routing */
+	n = g_test_perf () ? 200000 : 10;
+
+	plain = time_commit_lookups (repo, head, GGIT_TYPE_COMMIT, n);
+
+	ggit_object_factory_register (factory, GGIT_TYPE_COMMIT, test_commit_get_type ());
+	overridden = time_commit_lookups (repo, head, test_commit_get_type (), n);
+
+	ggit_object_factory_unregister (factory, GGIT_TYPE_COMMIT, test_commit_get_type ());
+	time_commit_lookups (repo, head, GGIT_TYPE_COMMIT, n);
+
+	if (g_test_perf ())
+	{
+		g_test_message ("commit wrap: %.0f ns without override, %.0f ns with override",
+		                plain * 1e9 / n,
+		                overridden * 1e9 / n);
+		g_test_minimized_result (plain * 1e9 / n, "commit wrap %.0f ns", plain * 1e9 / n);
+	}
+
+	ggit_oid_free (head);
+	g_object_unref (repo);
+}
+
+#define STRESS_THREADS 8
+#define STRESS_OPENS 250
+
+static gpointer
+open_close_repositories (gpointer data)
+{
+	GFile *f = data;
+	guint i;
+
+	for (i = 0; i < STRESS_OPENS; i++)
+	{
+		GgitRepository *repo;
+		GgitRepository *owner;
+		GgitObject *head;
+		GError *err = NULL;
+
+		repo = ggit_repository_open (f, &err);
+		g_assert_no_error (err);
+
+		head = ggit_repository_revparse (repo, "HEAD", &err);
+		g_assert_no_error (err);
+
+		/* Goes through the repository registry */
+		owner = ggit_object_get_owner (head);
+		g_assert (owner == repo);
+
+		g_object_unref (owner);
+		g_object_unref (head);
+		g_object_unref (repo);
+	}
+
+	return NULL;
+}
+
+static void
+test_repository_threads (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitOId *head;
+	GThread *threads[STRESS_THREADS];
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 1);
+	ggit_oid_free (head);
+	g_object_unref (repo);
+
+	for (i = 0; i < STRESS_THREADS; i++)
+	{
+		threads[i] = g_thread_new ("open-close", open_close_repositories, f);
+	}
+
+	for (i = 0; i < STRESS_THREADS; i++)
+	{
+		g_thread_join (threads[i]);
+	}
+
+	g_object_unref (f);
+}
+
+static void
+on_async_ready (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+	GAsyncResult **ret = user_data;
+
+	*ret = g_object_ref (result);
+}
+
+static GgitDiff *
+diff_tree_to_workdir_sync (GgitRepository  *repo,
+                           GCancellable    *cancellable,
+                           GError         **error)
+{
+	GAsyncResult *result = NULL;
+	GgitDiff *diff;
+
+	ggit_diff_new_tree_to_workdir_async (repo,
+	                                     NULL,
+	                                     NULL,
+	                                     cancellable,
+	                                     on_async_ready,
+	                                     &result);
+
+	while (result == NULL)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	diff = ggit_diff_new_tree_to_workdir_finish (result, error);
+	g_object_unref (result);
+
+	return diff;
+}
+
+static void
+test_repository_diff_async (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GCancellable *cancellable;
+	GgitDiff *diff;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	diff = diff_tree_to_workdir_sync (repo, NULL, &err);
+	g_assert_no_error (err);
+	g_assert (GGIT_IS_DIFF (diff));
+	g_assert_cmpuint (ggit_diff_get_num_deltas (diff), ==, 0);
+	g_object_unref (diff);
+
+	cancellable = g_cancellable_new ();
+	g_cancellable_cancel (cancellable);
+
+	diff = diff_tree_to_workdir_sync (repo, cancellable, &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert (diff == NULL);
+	g_clear_error (&err);
+
+	g_object_unref (cancellable);
+	g_object_unref (repo);
+}
+
+static void
+write_file (GFile       *dir,
+            const gchar *path,
+            const gchar *contents)
+{
+	GFile *file;
+	GFile *parent;
+	GError *err = NULL;
+
+	file = g_file_resolve_relative_path (dir, path);
+	parent = g_file_get_parent (file);
+
+	g_file_make_directory_with_parents (parent, NULL, NULL);
+	g_object_unref (parent);
+
+	g_file_replace_contents (file,
+	                         contents,
+	                         strlen (contents),
+	                         NULL,
+	                         FALSE,
+	                         G_FILE_CREATE_NONE,
+	                         NULL,
+	                         NULL,
+	                         &err);
+
+	g_assert_no_error (err);
+	g_object_unref (file);
+}
+
+/* Unlike write_file(), keeps the inode */
+static void
+overwrite_file (GFile       *dir,
+                const gchar *path,
+                const gchar *contents)
+{
+	GFile *file;
+	gchar *filename;
+	FILE *fp;
+
+	file = g_file_resolve_relative_path (dir, path);
+	filename = g_file_get_path (file);
+
+	fp = g_fopen (filename, "r+");
+	g_assert (fp != NULL);
+
+	g_assert_cmpuint (fwrite (contents, 1, strlen (contents), fp), ==, strlen (contents));
+	fclose (fp);
+
+	g_free (filename);
+	g_object_unref (file);
+}
+
+static void
+test_repository_attribute_cache (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GError *err = NULL;
+	const gchar *value;
+	guint64 hits;
+	guint64 misses;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	write_file (f, ".gitattributes", "*.txt encoding=latin1\n");
+
+	value = ggit_repository_get_attribute (repo, "a.txt", "encoding",
+	                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+	                                       &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (value, ==, "latin1");
+
+	value = ggit_repository_get_attribute (repo, "a.txt", "encoding",
+	                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+	                                       &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (value, ==, "latin1");
+
+	ggit_repository_get_attribute_cache_stats (repo, &hits, &misses);
+	g_assert_cmpuint (hits, ==, 1);
+	g_assert_cmpuint (misses, ==, 1);
+
+	/* A new attribute file only invalidates the paths below it */
+	write_file (f, "sub/.gitattributes", "*.txt encoding=utf-16\n");
+
+	value = ggit_repository_get_attribute (repo, "sub/b.txt", "encoding",
+	                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+	                                       &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (value, ==, "utf-16");
+
+	value = ggit_repository_get_attribute (repo, "a.txt", "encoding",
+	                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+	                                       &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (value, ==, "latin1");
+
+	ggit_repository_get_attribute_cache_stats (repo, &hits, &misses);
+	g_assert_cmpuint (hits, ==, 2);
+	g_assert_cmpuint (misses, ==, 2);
+
+	write_file (f, ".gitattributes", "*.txt encoding=iso-8859-15\n");
+
+	value = ggit_repository_get_attribute (repo, "a.txt", "encoding",
+	                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+	                                       &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (value, ==, "iso-8859-15");
+
+	/* Rewritten in the same second, in place and at the same size */
+	overwrite_file (f, ".gitattributes", "*.txt encoding=iso-8859-16\n");
+
+	value = ggit_repository_get_attribute (repo, "a.txt", "encoding",
+	                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
+	                                       &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (value, ==, "iso-8859-16");
+
+	ggit_repository_clear_attribute_cache (repo);
+	ggit_repository_get_attribute_cache_stats (repo, &hits, &misses);
+	g_assert_cmpuint (hits, ==, 0);
+	g_assert_cmpuint (misses, ==, 0);
+
+	g_object_unref (f);
+	g_object_unref (repo);
+}
+
+static gint
+on_diff_line_keep_odd (GgitDiffDelta *delta,
+                       GgitDiffHunk  *hunk,
+                       GgitDiffLine  *line,
+                       gpointer       user_data)
+{
+	GPtrArray *lines = user_data;
+
+	if (ggit_diff_line_get_new_lineno (line) % 2 == 1)
+	{
+		g_ptr_array_add (lines, ggit_diff_line_ref (line));
+	}
+
+	return 0;
+}
+
+static void
+test_repository_diff_line_ref (const gchar *git_dir)
+{
+	const gchar *buffer = "one\ntwo\nthree\nfour\nfive\n";
+	const gchar *expected[] = { "one\n", "three\n", "five\n" };
+	GPtrArray *lines;
+	GError *err = NULL;
+	guint i;
+
+	lines = g_ptr_array_new_with_free_func ((GDestroyNotify)ggit_diff_line_unref);
+
+	ggit_diff_blob_to_buffer (NULL, "a", (const guint8 *)buffer, -1, "a",
+	                          NULL, NULL, NULL, NULL,
+	                          on_diff_line_keep_odd, lines, &err);
+	g_assert_no_error (err);
+
+	/* Referenced lines keep their content after the diff is done */
+	g_assert_cmpuint (lines->len, ==, G_N_ELEMENTS (expected));
+
+	for (i = 0; i < lines->len; i++)
+	{
+		GgitDiffLine *line = g_ptr_array_index (lines, i);
+		const guint8 *content;
+		gsize len;
+
+		content = ggit_diff_line_get_content (line, &len);
+
+		g_assert_cmpuint (len, ==, strlen (expected[i]));
+		g_assert_cmpint (memcmp (content, expected[i], len), ==, 0);
+		g_assert_cmpstr (ggit_diff_line_get_text (line), ==, expected[i]);
+	}
+
+	g_ptr_array_unref (lines);
+}
+
+static GgitRepositoryScanResult *
+find_scan_result (GListModel *results,
+                  GFile      *location)
+{
+	guint i;
+
+	for (i = 0; i < g_list_model_get_n_items (results); i++)
+	{
+		GgitRepositoryScanResult *result = g_list_model_get_item (results, i);
+
+		g_object_unref (result);
+
+		if (g_file_equal (ggit_repository_scan_result_get_location (result), location))
+		{
+			return result;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+test_repository_scanner (const gchar *git_dir)
+{
+	GFile *root;
+	GFile *locations[3];
+	GgitRepository *repo;
+	GgitRepositoryScanner *scanner;
+	GgitRepositoryScanResult *result;
+	GAsyncResult *async_result = NULL;
+	GgitIndex *index;
+	GListModel *results;
+	GError *err = NULL;
+	guint staged;
+	guint unstaged;
+	guint untracked;
+	guint conflicted;
+
+	root = g_file_new_for_path (git_dir);
+
+	locations[0] = g_file_get_child (root, "clean");
+	locations[1] = g_file_get_child (root, "dirty");
+	locations[2] = g_file_get_child (root, "none");
+
+	repo = ggit_repository_init_repository (locations[0], FALSE, &err);
+	g_assert_no_error (err);
+	g_object_unref (repo);
+
+	repo = ggit_repository_init_repository (locations[1], FALSE, &err);
+	g_assert_no_error (err);
+
+	write_file (locations[1], "staged.txt", "staged\n");
+	write_file (locations[1], "untracked.txt", "untracked\n");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+	ggit_index_add_path (index, "staged.txt", &err);
+	g_assert_no_error (err);
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+	g_object_unref (index);
+	g_object_unref (repo);
+
+	g_file_make_directory (locations[2], NULL, &err);
+	g_assert_no_error (err);
+
+	scanner = ggit_repository_scanner_new (GGIT_REPOSITORY_SCAN_HEAD |
+	                                       GGIT_REPOSITORY_SCAN_STATUS);
+	ggit_repository_scanner_set_max_threads (scanner, 2);
+
+	ggit_repository_scanner_scan_async (scanner, locations, 3, NULL,
+	                                    on_async_ready, &async_result);
+
+	while (async_result == NULL)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	g_assert_true (ggit_repository_scanner_scan_finish (scanner, async_result, &err));
+	g_assert_no_error (err);
+	g_object_unref (async_result);
+
+	results = ggit_repository_scanner_get_results (scanner);
+	g_assert_cmpuint (g_list_model_get_n_items (results), ==, 3);
+
+	result = find_scan_result (results, locations[0]);
+	g_assert_nonnull (result);
+	g_assert_null (ggit_repository_scan_result_get_error (result));
+	g_assert_false (ggit_repository_scan_result_get_is_dirty (result));
+
+	result = find_scan_result (results, locations[1]);
+	g_assert_nonnull (result);
+	g_assert_null (ggit_repository_scan_result_get_error (result));
+	g_assert_true (ggit_repository_scan_result_get_is_dirty (result));
+
+	ggit_repository_scan_result_get_status_counts (result, &staged, &unstaged,
+	                                               &untracked, &conflicted);
+	g_assert_cmpuint (staged, ==, 1);
+	g_assert_cmpuint (unstaged, ==, 0);
+	g_assert_cmpuint (untracked, ==, 1);
+	g_assert_cmpuint (conflicted, ==, 0);
+
+	result = find_scan_result (results, locations[2]);
+	g_assert_nonnull (result);
+	g_assert_nonnull (ggit_repository_scan_result_get_error (result));
+
+	g_object_unref (scanner);
+	g_object_unref (locations[0]);
+	g_object_unref (locations[1]);
+	g_object_unref (locations[2]);
+	g_object_unref (root);
+}
+
+static GgitBlob *
+create_blob (GgitRepository *repo,
+             const gchar    *contents)
+{
+	GgitOId *oid;
+	GgitBlob *blob;
+	GError *err = NULL;
+
+	oid = ggit_repository_create_blob_from_buffer (repo, contents, strlen (contents), &err);
+	g_assert_no_error (err);
+
+	blob = ggit_repository_lookup_blob (repo, oid, &err);
+	g_assert_no_error (err);
+
+	ggit_oid_free (oid);
+
+	return blob;
+}
+
+static gchar *
+steal_memory_string (GOutputStream *stream)
+{
+	GError *err = NULL;
+	gchar *data;
+
+	/* NUL terminate */
+	g_output_stream_write (stream, "", 1, NULL, &err);
+	g_assert_no_error (err);
+
+	g_output_stream_close (stream, NULL, &err);
+	g_assert_no_error (err);
+
+	data = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (stream));
+	g_object_unref (stream);
+
+	return data;
+}
+
+static gchar *
+patch_to_memory (GgitPatch *patch,
+                 gsize      buffer_size,
+                 gboolean   async)
+{
+	GOutputStream *stream;
+	GError *err = NULL;
+
+	stream = g_memory_output_stream_new_resizable ();
+
+	if (async)
+	{
+		GAsyncResult *result = NULL;
+
+		ggit_patch_to_stream_async (patch, stream, buffer_size, NULL,
+		                            on_async_ready, &result);
+
+		while (result == NULL)
+		{
+			g_main_context_iteration (NULL, TRUE);
+		}
+
+		g_assert_true (ggit_patch_to_stream_finish (result, &err));
+		g_object_unref (result);
+	}
+	else
+	{
+		g_assert_true (ggit_patch_to_stream_full (patch, stream, buffer_size, NULL, &err));
+	}
+
+	g_assert_no_error (err);
+
+	return steal_memory_string (stream);
+}
+
+static void
+test_repository_patch_to_stream (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitBlob *old_blob;
+	GgitBlob *new_blob;
+	GgitPatch *patch;
+	GError *err = NULL;
+	GString *old_contents;
+	GString *new_contents;
+	gchar *expected;
+	gchar *data;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	old_contents = g_string_new (NULL);
+	new_contents = g_string_new (NULL);
+
+	for (i = 0; i < 2000; i++)
+	{
+		g_string_append_printf (old_contents, "line %u\n", i);
+		g_string_append_printf (new_contents, i % 7 == 0 ? "changed %u\n" : "line %u\n", i);
+	}
+
+	old_blob = create_blob (repo, old_contents->str);
+	new_blob = create_blob (repo, new_contents->str);
+
+	patch = ggit_patch_new_from_blobs (old_blob, "a.txt", new_blob, "a.txt", NULL, &err);
+	g_assert_no_error (err);
+
+	expected = ggit_patch_to_string (patch, &err);
+	g_assert_no_error (err);
+
+	/* Default, tiny (every line overflows the buffer) and async */
+	data = patch_to_memory (patch, 0, FALSE);
+	g_assert_cmpstr (data, ==, expected);
+	g_free (data);
+
+	data = patch_to_memory (patch, 4, FALSE);
+	g_assert_cmpstr (data, ==, expected);
+	g_free (data);
+
+	data = patch_to_memory (patch, 1024, TRUE);
+	g_assert_cmpstr (data, ==, expected);
+	g_free (data);
+
+	g_free (expected);
+	ggit_patch_unref (patch);
+	g_object_unref (new_blob);
+	g_object_unref (old_blob);
+	g_string_free (new_contents, TRUE);
+	g_string_free (old_contents, TRUE);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static GgitTree *
+create_tree (GgitRepository *repo,
+             const gchar    *first,
+             const gchar    *second)
+{
+	GgitTreeBuilder *builder;
+	GgitTreeEntry *entry;
+	GgitBlob *blob;
+	GgitOId *oid;
+	GgitTree *tree;
+	GError *err = NULL;
+
+	builder = ggit_repository_create_tree_builder (repo, &err);
+	g_assert_no_error (err);
+
+	blob = create_blob (repo, first);
+	oid = ggit_object_get_id (GGIT_OBJECT (blob));
+	entry = ggit_tree_builder_insert (builder, "first.txt", oid, GGIT_FILE_MODE_BLOB, &err);
+	g_assert_no_error (err);
+	ggit_tree_entry_unref (entry);
+	ggit_oid_free (oid);
+	g_object_unref (blob);
+
+	blob = create_blob (repo, second);
+	oid = ggit_object_get_id (GGIT_OBJECT (blob));
+	entry = ggit_tree_builder_insert (builder, "second.txt", oid, GGIT_FILE_MODE_BLOB, &err);
+	g_assert_no_error (err);
+	ggit_tree_entry_unref (entry);
+	ggit_oid_free (oid);
+	g_object_unref (blob);
+
+	oid = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+	g_object_unref (builder);
+
+	tree = ggit_repository_lookup_tree (repo, oid, &err);
+	g_assert_no_error (err);
+	ggit_oid_free (oid);
+
+	return tree;
+}
+
+static void
+check_email_to_stream (GgitDiff                   *diff,
+                       GgitDiffFormatEmailOptions *options)
+{
+	GOutputStream *stream;
+	GError *err = NULL;
+	gchar *expected;
+	gchar *data;
+
+	expected = ggit_diff_format_email (diff, options, &err);
+	g_assert_no_error (err);
+
+	stream = g_memory_output_stream_new_resizable ();
+	g_assert_true (ggit_diff_format_email_to_stream (diff, options, stream, NULL, &err));
+	g_assert_no_error (err);
+
+	data = steal_memory_string (stream);
+	g_assert_cmpstr (data, ==, expected);
+
+	g_free (data);
+	g_free (expected);
+}
+
+static void
+test_repository_diff_to_stream (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitTree *old_tree;
+	GgitTree *new_tree;
+	GgitDiff *diff;
+	GgitDiffFormatEmailOptions *options;
+	GgitSignature *author;
+	GDateTime *when;
+	GgitOId *oid;
+	GOutputStream *stream;
+	GAsyncResult *result = NULL;
+	GString *expected;
+	GError *err = NULL;
+	gchar *data;
+	gsize i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	old_tree = create_tree (repo, "a\nb\nc\n", "one\n");
+	new_tree = create_tree (repo, "a\nB\nc\n", "one\ntwo\n");
+
+	diff = ggit_diff_new_tree_to_tree (repo, old_tree, new_tree, NULL, &err);
+	g_assert_no_error (err);
+
+	/* The concatenated patches of all the deltas */
+	expected = g_string_new (NULL);
+
+	for (i = 0; i < ggit_diff_get_num_deltas (diff); i++)
+	{
+		GgitPatch *patch;
+		gchar *text;
+
+		patch = ggit_patch_new_from_diff (diff, i, &err);
+		g_assert_no_error (err);
+
+		text = ggit_patch_to_string (patch, &err);
+		g_assert_no_error (err);
+
+		g_string_append (expected, text);
+		g_free (text);
+		ggit_patch_unref (patch);
+	}
+
+	stream = g_memory_output_stream_new_resizable ();
+	g_assert_true (ggit_diff_to_stream (diff, GGIT_DIFF_FORMAT_PATCH, stream, NULL, &err));
+	g_assert_no_error (err);
+
+	data = steal_memory_string (stream);
+	g_assert_cmpstr (data, ==, expected->str);
+	g_free (data);
+
+	stream = g_memory_output_stream_new_resizable ();
+	ggit_diff_to_stream_async (diff, GGIT_DIFF_FORMAT_PATCH, stream, NULL,
+	                           on_async_ready, &result);
+
+	while (result == NULL)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	g_assert_true (ggit_diff_to_stream_finish (diff, result, &err));
+	g_assert_no_error (err);
+	g_object_unref (result);
+
+	data = steal_memory_string (stream);
+	g_assert_cmpstr (data, ==, expected->str);
+	g_free (data);
+
+	when = g_date_time_new_from_unix_utc (0);
+	author = ggit_signature_new ("Jesse van den Kieboom", "jessevdk@gnome.org", when, &err);
+	g_assert_no_error (err);
+	g_date_time_unref (when);
+
+	oid = ggit_object_get_id (GGIT_OBJECT (new_tree));
+
+	options = ggit_diff_format_email_options_new ();
+	ggit_diff_format_email_options_set_id (options, oid);
+	ggit_diff_format_email_options_set_summary (options, "Change things");
+	ggit_diff_format_email_options_set_author (options, author);
+
+	check_email_to_stream (diff, options);
+
+	/* The separator of the diffstat must not be confused with the body */
+	ggit_diff_format_email_options_set_body (options, "Details\n---\nMore details\n");
+	check_email_to_stream (diff, options);
+
+	g_object_unref (options);
+	g_object_unref (author);
+	ggit_oid_free (oid);
+	g_string_free (expected, TRUE);
+	g_object_unref (diff);
+	g_object_unref (new_tree);
+	g_object_unref (old_tree);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+typedef struct
+{
+	GPtrArray *texts;
+	GArray *order;
+	gsize stop_at;
+} ForeachPatchData;
+
+static gint
+on_foreach_patch (gsize      index,
+                  GgitPatch *patch,
+                  gpointer   user_data)
+{
+	ForeachPatchData *data = user_data;
+	GError *err = NULL;
+
+	g_assert_cmpuint (index, <, data->texts->len);
+	g_assert_null (g_ptr_array_index (data->texts, index));
+
+	g_ptr_array_index (data->texts, index) = ggit_patch_to_string (patch, &err);
+	g_assert_no_error (err);
+
+	g_array_append_val (data->order, index);
+
+	return index == data->stop_at ? -1 : 0;
+}
+
+static void
+check_foreach_patch (GgitDiff *diff)
+{
+	ForeachPatchData data;
+	GError *err = NULL;
+	gsize n_deltas;
+	guint i;
+	guint j;
+
+	n_deltas = ggit_diff_get_num_deltas (diff);
+
+	/* Ordered, unordered and serial all see every patch once */
+	for (i = 0; i < 3; i++)
+	{
+		data.texts = g_ptr_array_new_with_free_func (g_free);
+		g_ptr_array_set_size (data.texts, n_deltas);
+		data.order = g_array_new (FALSE, FALSE, sizeof (gsize));
+		data.stop_at = G_MAXSIZE;
+
+		g_assert_true (ggit_diff_foreach_patch (diff,
+		                                        i == 2 ? 1 : 4,
+		                                        i == 0 ? GGIT_DIFF_FOREACH_PATCH_ORDERED : GGIT_DIFF_FOREACH_PATCH_NONE,
+		                                        on_foreach_patch,
+		                                        &data,
+		                                        NULL,
+		                                        &err));
+		g_assert_no_error (err);
+		g_assert_cmpuint (data.order->len, ==, n_deltas);
+
+		for (j = 0; j < n_deltas; j++)
+		{
+			GgitPatch *patch;
+			gchar *expected;
+
+			if (i != 1)
+			{
+				g_assert_cmpuint (g_array_index (data.order, gsize, j), ==, j);
+			}
+
+			patch = ggit_patch_new_from_diff (diff, j, &err);
+			g_assert_no_error (err);
+
+			expected = ggit_patch_to_string (patch, &err);
+			g_assert_no_error (err);
+
+			g_assert_cmpstr (g_ptr_array_index (data.texts, j), ==, expected);
+
+			g_free (expected);
+			ggit_patch_unref (patch);
+		}
+
+		g_ptr_array_unref (data.texts);
+		g_array_unref (data.order);
+	}
+}
+
+static void
+test_repository_diff_foreach_patch (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitTreeBuilder *builders[2];
+	GgitTree *trees[2];
+	GgitDiff *diff;
+	GgitDiff *other;
+	ForeachPatchData data;
+	GError *err = NULL;
+	gsize n_deltas;
+	guint i;
+	guint j;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < 2; i++)
+	{
+		builders[i] = ggit_repository_create_tree_builder (repo, &err);
+		g_assert_no_error (err);
+	}
+
+	for (i = 0; i < 40; i++)
+	{
+		gchar *name = g_strdup_printf ("file%02u.txt", i);
+
+		for (j = 0; j < 2; j++)
+		{
+			gchar *contents;
+			GgitBlob *blob;
+			GgitOId *oid;
+			GgitTreeEntry *entry;
+
+			contents = g_strdup_printf ("file %u\nrevision %u\n", i, j);
+			blob = create_blob (repo, contents);
+			oid = ggit_object_get_id (GGIT_OBJECT (blob));
+
+			entry = ggit_tree_builder_insert (builders[j], name, oid, GGIT_FILE_MODE_BLOB, &err);
+			g_assert_no_error (err);
+
+			ggit_tree_entry_unref (entry);
+			ggit_oid_free (oid);
+			g_object_unref (blob);
+			g_free (contents);
+		}
+
+		g_free (name);
+	}
+
+	for (i = 0; i < 2; i++)
+	{
+		GgitOId *oid;
+
+		oid = ggit_tree_builder_write (builders[i], &err);
+		g_assert_no_error (err);
+
+		trees[i] = ggit_repository_lookup_tree (repo, oid, &err);
+		g_assert_no_error (err);
+
+		ggit_oid_free (oid);
+		g_object_unref (builders[i]);
+	}
+
+	diff = ggit_diff_new_tree_to_tree (repo, trees[0], trees[1], NULL, &err);
+	g_assert_no_error (err);
+
+	n_deltas = ggit_diff_get_num_deltas (diff);
+	g_assert_cmpuint (n_deltas, ==, 40);
+
+	check_foreach_patch (diff);
+
+	/* Built again by every worker, also with rename detection */
+	g_assert_true (ggit_diff_find_similar (diff, NULL, &err));
+	g_assert_no_error (err);
+	check_foreach_patch (diff);
+
+	/* Merged diffs cannot be built again, the calling thread does it all */
+	other = ggit_diff_new_tree_to_tree (repo, trees[1], trees[1], NULL, &err);
+	g_assert_no_error (err);
+
+	ggit_diff_merge (diff, other, &err);
+	g_assert_no_error (err);
+	g_object_unref (other);
+
+	check_foreach_patch (diff);
+
+	/* The callback stops the iteration */
+	data.texts = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_set_size (data.texts, n_deltas);
+	data.order = g_array_new (FALSE, FALSE, sizeof (gsize));
+	data.stop_at = 3;
+
+	g_assert_false (ggit_diff_foreach_patch (diff, 4, GGIT_DIFF_FOREACH_PATCH_ORDERED,
+	                                         on_foreach_patch, &data, NULL, &err));
+	g_assert_nonnull (err);
+	g_clear_error (&err);
+	g_assert_cmpuint (data.order->len, ==, 4);
+
+	g_ptr_array_unref (data.texts);
+	g_array_unref (data.order);
+
+	g_object_unref (diff);
+	g_object_unref (trees[0]);
+	g_object_unref (trees[1]);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static gint
+on_index_matched_path (const gchar *path,
+                       const gchar *matched_pathspec,
+                       gpointer     user_data)
+{
+	GPtrArray *seen = user_data;
+
+	g_ptr_array_add (seen, g_strdup (path));
+
+	return g_strcmp0 (path, "b.txt") == 0 ? 1 : 0;
+}
+
+static void
+assert_index_entry (GgitIndex      *index,
+                    GgitRepository *repo,
+                    GFile          *dir,
+                    const gchar    *path,
+                    const gchar    *contents)
+{
+	GgitIndexEntries *entries;
+	GgitIndexEntry *entry;
+	GFile *file;
+
+	entries = ggit_index_get_entries (index);
+	file = g_file_resolve_relative_path (dir, path);
+	entry = ggit_index_entries_get_by_path (entries, file, 0);
+
+	if (contents == NULL)
+	{
+		g_assert_null (entry);
+	}
+	else
+	{
+		GgitBlob *blob;
+		GgitOId *expected;
+		GgitOId *id;
+
+		g_assert_nonnull (entry);
+
+		blob = create_blob (repo, contents);
+		expected = ggit_object_get_id (GGIT_OBJECT (blob));
+		id = ggit_index_entry_get_id (entry);
+
+		g_assert_true (ggit_oid_equal (id, expected));
+
+		ggit_oid_free (id);
+		ggit_oid_free (expected);
+		g_object_unref (blob);
+		ggit_index_entry_unref (entry);
+	}
+
+	g_object_unref (file);
+	ggit_index_entries_unref (entries);
+}
+
+static void
+test_repository_index_paths (const gchar *git_dir)
+{
+	GFile *f;
+	GFile *file;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitIndexEntries *entries;
+	GPtrArray *seen;
+	GgitStatusFlags status;
+	GError *err = NULL;
+	const gchar *txt[] = { "*.txt", NULL };
+	const gchar *sub[] = { "sub", NULL };
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	write_file (f, "a.txt", "a\n");
+	write_file (f, "b.txt", "b\n");
+	write_file (f, "sub/c.txt", "c\n");
+	write_file (f, "d.bin", "d\n");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	/* The callback sees every match and can skip files */
+	seen = g_ptr_array_new_with_free_func (g_free);
+
+	g_assert_true (ggit_index_add_paths (index, txt, GGIT_INDEX_ADD_DEFAULT,
+	                                     on_index_matched_path, seen, &err));
+	g_assert_no_error (err);
+	g_assert_cmpuint (seen->len, ==, 3);
+
+	g_ptr_array_unref (seen);
+
+	entries = ggit_index_get_entries (index);
+	g_assert_cmpuint (ggit_index_entries_size (entries), ==, 2);
+	ggit_index_entries_unref (entries);
+
+	assert_index_entry (index, repo, f, "a.txt", "a\n");
+	assert_index_entry (index, repo, f, "b.txt", NULL);
+	assert_index_entry (index, repo, f, "sub/c.txt", "c\n");
+
+	/* Hashing on worker threads gives the same entries */
+	write_file (f, "a.txt", "a2\n");
+
+	g_assert_true (ggit_index_add_paths (index, NULL, GGIT_INDEX_ADD_HASH_IN_PARALLEL,
+	                                     NULL, NULL, &err));
+	g_assert_no_error (err);
+
+	entries = ggit_index_get_entries (index);
+	g_assert_cmpuint (ggit_index_entries_size (entries), ==, 4);
+	ggit_index_entries_unref (entries);
+
+	assert_index_entry (index, repo, f, "a.txt", "a2\n");
+	assert_index_entry (index, repo, f, "b.txt", "b\n");
+	assert_index_entry (index, repo, f, "d.bin", "d\n");
+
+	/* The stat data is filled in, so the file is not reported modified */
+	g_assert_true (ggit_index_write (index, &err));
+	g_assert_no_error (err);
+
+	file = g_file_get_child (f, "b.txt");
+	status = ggit_repository_file_status (repo, file, &err);
+	g_assert_no_error (err);
+	g_assert_cmpint (status, ==, GGIT_STATUS_INDEX_NEW);
+	g_object_unref (file);
+
+	/* Updating only touches tracked files and drops deleted ones */
+	write_file (f, "b.txt", "b2\n");
+	write_file (f, "e.txt", "e\n");
+
+	file = g_file_get_child (f, "d.bin");
+	g_assert_true (g_file_delete (file, NULL, &err));
+	g_assert_no_error (err);
+	g_object_unref (file);
+
+	g_assert_true (ggit_index_update_paths (index, NULL, NULL, NULL, &err));
+	g_assert_no_error (err);
+
+	assert_index_entry (index, repo, f, "b.txt", "b2\n");
+	assert_index_entry (index, repo, f, "d.bin", NULL);
+	assert_index_entry (index, repo, f, "e.txt", NULL);
+
+	g_assert_true (ggit_index_remove_paths (index, sub, NULL, NULL, &err));
+	g_assert_no_error (err);
+
+	assert_index_entry (index, repo, f, "sub/c.txt", NULL);
+
+	entries = ggit_index_get_entries (index);
+	g_assert_cmpuint (ggit_index_entries_size (entries), ==, 2);
+	ggit_index_entries_unref (entries);
+
+	g_object_unref (index);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_index_snapshot (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitIndexSnapshot *snapshot;
+	GError *err = NULL;
+	const gchar *paths[] = { "a.txt", "src/b.c", "src/sub/c.c", "src2/d.c", "z.txt" };
+	const guint32 *modes;
+	guint n_entries;
+	guint start;
+	guint end;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	for (i = G_N_ELEMENTS (paths); i > 0; i--)
+	{
+		write_file (f, paths[i - 1], paths[i - 1]);
+	}
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	g_assert_true (ggit_index_add_paths (index, NULL, GGIT_INDEX_ADD_DEFAULT,
+	                                     NULL, NULL, &err));
+	g_assert_no_error (err);
+
+	snapshot = ggit_index_snapshot_new (index);
+	g_assert_cmpuint (ggit_index_snapshot_get_size (snapshot), ==, G_N_ELEMENTS (paths));
+
+	modes = ggit_index_snapshot_get_modes (snapshot, &n_entries);
+	g_assert_cmpuint (n_entries, ==, G_N_ELEMENTS (paths));
+
+	for (i = 0; i < n_entries; i++)
+	{
+		GgitBlob *blob;
+		GgitOId *expected;
+		GgitOId *id;
+
+		g_assert_cmpstr (ggit_index_snapshot_get_path (snapshot, i), ==, paths[i]);
+		g_assert_cmpuint (modes[i], ==, GGIT_FILE_MODE_BLOB);
+		g_assert_cmpint (ggit_index_snapshot_get_stage (snapshot, i), ==, 0);
+		g_assert_cmpuint (ggit_index_snapshot_get_file_size (snapshot, i), ==, strlen (paths[i]));
+		g_assert_cmpint (ggit_index_snapshot_get_mtime (snapshot, i), >, 0);
+
+		blob = create_blob (repo, paths[i]);
+		expected = ggit_object_get_id (GGIT_OBJECT (blob));
+		id = ggit_oid_new_from_raw (ggit_index_snapshot_get_raw_id (snapshot, i));
+
+		g_assert_true (ggit_oid_equal (id, expected));
+
+		ggit_oid_free (id);
+		ggit_oid_free (expected);
+		g_object_unref (blob);
+	}
+
+	g_assert_true (ggit_index_snapshot_find (snapshot, "src/sub/c.c", &i));
+	g_assert_cmpuint (i, ==, 2);
+	g_assert_false (ggit_index_snapshot_find (snapshot, "src", NULL));
+
+	g_assert_true (ggit_index_snapshot_find_prefix (snapshot, "src/", &start, &end));
+	g_assert_cmpuint (start, ==, 1);
+	g_assert_cmpuint (end, ==, 3);
+
+	g_assert_true (ggit_index_snapshot_find_prefix (snapshot, "src", &start, &end));
+	g_assert_cmpuint (start, ==, 1);
+	g_assert_cmpuint (end, ==, 4);
+
+	g_assert_false (ggit_index_snapshot_find_prefix (snapshot, "doc/", &start, &end));
+	g_assert_cmpuint (start, ==, end);
+
+	ggit_index_snapshot_get_range (snapshot, "b", "z", &start, &end);
+	g_assert_cmpuint (start, ==, 1);
+	g_assert_cmpuint (end, ==, 4);
+
+	/* The snapshot does not follow later changes to the index */
+	write_file (f, "new.txt", "new");
+
+	g_assert_true (ggit_index_add_path (index, "new.txt", &err));
+	g_assert_no_error (err);
+
+	g_assert_cmpuint (ggit_index_snapshot_get_size (snapshot), ==, G_N_ELEMENTS (paths));
+	g_assert_false (ggit_index_snapshot_find (snapshot, "new.txt", NULL));
+
+	ggit_index_snapshot_unref (snapshot);
+	g_object_unref (index);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+on_status_changed (GgitStatusMonitor  *monitor,
+                   gchar             **paths,
+                   GPtrArray          *seen)
+{
+	for (; *paths != NULL; paths++)
+	{
+		g_ptr_array_add (seen, g_strdup (*paths));
+	}
+}
+
+static gboolean
+wait_for_status (GgitStatusMonitor *monitor,
+                 const gchar       *path,
+                 GgitStatusFlags    expected)
+{
+	gint64 deadline;
+
+	deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+
+	while (!ggit_status_monitor_get_ready (monitor) ||
+	       ggit_status_monitor_get_status (monitor, path) != expected)
+	{
+		if (g_get_monotonic_time () > deadline)
+		{
+			return FALSE;
+		}
+
+		if (!g_main_context_iteration (NULL, FALSE))
+		{
+			g_usleep (1000);
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean
+str_array_contains (GPtrArray   *array,
+                    const gchar *str)
+{
+	guint i;
+
+	for (i = 0; i < array->len; i++)
+	{
+		if (g_strcmp0 (g_ptr_array_index (array, i), str) == 0)
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static void
+test_repository_status_monitor (const gchar *git_dir)
+{
+	GFile *f;
+	GFile *file;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitStatusMonitor *monitor;
+	GPtrArray *seen;
+	GError *err = NULL;
+	gchar **paths;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	write_file (f, "a.txt", "a\n");
+	write_file (f, "ignored/x.txt", "x\n");
+	write_file (f, ".gitignore", "ignored/\n");
+
+	monitor = ggit_status_monitor_new (repo, NULL, &err);
+	g_assert_no_error (err);
+
+	ggit_status_monitor_set_latency (monitor, 10);
+
+	seen = g_ptr_array_new_with_free_func (g_free);
+	g_signal_connect (monitor, "changed", G_CALLBACK (on_status_changed), seen);
+
+	/* The initial scan reports everything that is not current */
+	g_assert_true (wait_for_status (monitor, "a.txt", GGIT_STATUS_WORKING_TREE_NEW));
+	g_assert_true (str_array_contains (seen, "a.txt"));
+	g_assert_true (str_array_contains (seen, ".gitignore"));
+	g_assert_cmpint (ggit_status_monitor_get_status (monitor, "ignored/x.txt"), ==, GGIT_STATUS_CURRENT);
+
+	paths = ggit_status_monitor_get_paths (monitor);
+	g_assert_cmpuint (g_strv_length (paths), ==, 2);
+	g_assert_cmpstr (paths[0], ==, ".gitignore");
+	g_assert_cmpstr (paths[1], ==, "a.txt");
+	g_strfreev (paths);
+
+	/* New files, also in new directories */
+	g_ptr_array_set_size (seen, 0);
+	write_file (f, "b.txt", "b\n");
+	write_file (f, "sub/dir/c.txt", "c\n");
+
+	g_assert_true (wait_for_status (monitor, "b.txt", GGIT_STATUS_WORKING_TREE_NEW));
+	g_assert_true (wait_for_status (monitor, "sub/dir/c.txt", GGIT_STATUS_WORKING_TREE_NEW));
+	g_assert_false (str_array_contains (seen, "a.txt"));
+
+	/* Staging only refreshes the entries that changed in the index */
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	g_assert_true (ggit_index_add_path (index, "a.txt", &err));
+	g_assert_no_error (err);
+
+	g_assert_true (ggit_index_write (index, &err));
+	g_assert_no_error (err);
+
+	g_assert_true (wait_for_status (monitor, "a.txt", GGIT_STATUS_INDEX_NEW));
+
+	/* Deleting a file or a whole directory */
+	file = g_file_get_child (f, "b.txt");
+	g_assert_true (g_file_delete (file, NULL, &err));
+	g_assert_no_error (err);
+	g_object_unref (file);
+
+	g_assert_true (wait_for_status (monitor, "b.txt", GGIT_STATUS_CURRENT));
+
+	file = g_file_resolve_relative_path (f, "sub/dir/c.txt");
+	g_assert_true (g_file_delete (file, NULL, &err));
+	g_assert_no_error (err);
+	g_object_unref (file);
+
+	file = g_file_resolve_relative_path (f, "sub/dir");
+	g_assert_true (g_file_delete (file, NULL, &err));
+	g_assert_no_error (err);
+	g_object_unref (file);
+
+	g_assert_true (wait_for_status (monitor, "sub/dir/c.txt", GGIT_STATUS_CURRENT));
+
+	/* The exclude file is not watched, only a rescan notices that it
+	 * now ignores e.txt.
+	 */
+	write_file (f, "e.txt", "e\n");
+	g_assert_true (wait_for_status (monitor, "e.txt", GGIT_STATUS_WORKING_TREE_NEW));
+
+	write_file (f, ".git/info/exclude", "e.txt\n");
+
+	g_ptr_array_set_size (seen, 0);
+	ggit_status_monitor_rescan (monitor);
+	g_assert_true (wait_for_status (monitor, "e.txt", GGIT_STATUS_CURRENT));
+	g_assert_true (str_array_contains (seen, "e.txt"));
+
+	/* And agrees with the incremental updates */
+	g_assert_cmpint (ggit_status_monitor_get_status (monitor, "a.txt"), ==, GGIT_STATUS_INDEX_NEW);
+
+	paths = ggit_status_monitor_get_paths (monitor);
+	g_assert_cmpuint (g_strv_length (paths), ==, 2);
+	g_strfreev (paths);
+
+	g_object_unref (monitor);
+	g_ptr_array_unref (seen);
+	g_object_unref (index);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static gint
+on_status_collect (const gchar     *path,
+                   GgitStatusFlags  status_flags,
+                   gpointer         user_data)
+{
+	g_string_append_printf (user_data, "%s:%u\n", path, status_flags);
+	return 0;
+}
+
+static gchar *
+collect_status (GgitRepository    *repo,
+                GgitStatusOptions *options)
+{
+	GString *str;
+	GError *err = NULL;
+
+	str = g_string_new (NULL);
+
+	g_assert_true (ggit_repository_file_status_foreach (repo, options, on_status_collect, str, &err));
+	g_assert_no_error (err);
+
+	return g_string_free (str, FALSE);
+}
+
+static void
+test_repository_untracked_cache (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitUntrackedCache *cache;
+	GgitUntrackedCache *loaded;
+	GgitStatusOptions *options;
+	GError *err = NULL;
+	const gchar *changed[] = { "sub/new.txt", NULL };
+	const gchar *unchanged[] = { NULL };
+	gchar *expected;
+	gchar *status;
+	guint64 hits;
+	guint64 misses;
+	guint64 misses_after;
+	gint recurse;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	write_file (f, "tracked.txt", "a\n");
+	write_file (f, "untracked.txt", "b\n");
+	write_file (f, "sub/tracked.txt", "c\n");
+	write_file (f, "sub/deep/untracked.txt", "d\n");
+	write_file (f, "other/x.txt", "e\n");
+	write_file (f, "other/y/z.txt", "f\n");
+	write_file (f, "ignored/x.txt", "g\n");
+	write_file (f, "sub/skip.log", "h\n");
+	write_file (f, ".gitignore", "ignored/\n");
+	write_file (f, "sub/.gitignore", "*.log\n");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	g_assert_true (ggit_index_add_path (index, "tracked.txt", &err));
+	g_assert_true (ggit_index_add_path (index, "sub/tracked.txt", &err));
+	g_assert_true (ggit_index_write (index, &err));
+	g_assert_no_error (err);
+
+	/* The cache gives the same answer as libgit2, recursive or not */
+	for (recurse = 0; recurse <= 1; recurse++)
+	{
+		GgitStatusOption flags = GGIT_STATUS_OPTION_INCLUDE_UNTRACKED;
+
+		if (recurse)
+		{
+			flags |= GGIT_STATUS_OPTION_RECURSE_UNTRACKED_DIRS;
+		}
+
+		options = ggit_status_options_new (flags, GGIT_STATUS_SHOW_INDEX_AND_WORKDIR, NULL);
+		expected = collect_status (repo, options);
+
+		cache = ggit_untracked_cache_new ();
+		ggit_status_options_set_untracked_cache (options, cache);
+
+		status = collect_status (repo, options);
+		g_assert_cmpstr (status, ==, expected);
+		g_free (status);
+
+		ggit_untracked_cache_get_stats (cache, &hits, &misses);
+		g_assert_cmpuint (hits, ==, 0);
+		g_assert_cmpuint (misses, >, 0);
+
+		status = collect_status (repo, options);
+		g_assert_cmpstr (status, ==, expected);
+		g_free (status);
+
+		ggit_untracked_cache_unref (cache);
+		ggit_status_options_free (options);
+		g_free (expected);
+	}
+
+	options = ggit_status_options_new (GGIT_STATUS_OPTION_INCLUDE_UNTRACKED |
+	                                   GGIT_STATUS_OPTION_RECURSE_UNTRACKED_DIRS,
+	                                   GGIT_STATUS_SHOW_INDEX_AND_WORKDIR,
+	                                   NULL);
+
+	cache = ggit_untracked_cache_new ();
+	ggit_status_options_set_untracked_cache (options, cache);
+
+	expected = collect_status (repo, options);
+	g_assert_nonnull (g_strrstr (expected, "other/y/z.txt:"));
+	g_assert_null (g_strrstr (expected, "skip.log"));
+	g_assert_null (g_strrstr (expected, "ignored/"));
+
+	/* Saved and loaded again */
+	g_assert_true (ggit_untracked_cache_save (cache, repo, &err));
+	g_assert_no_error (err);
+
+	loaded = ggit_untracked_cache_load (repo, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_untracked_cache_get_size (loaded), ==, ggit_untracked_cache_get_size (cache));
+
+	ggit_status_options_set_untracked_cache (options, loaded);
+
+	status = collect_status (repo, options);
+	g_assert_cmpstr (status, ==, expected);
+	g_free (status);
+
+	ggit_status_options_set_untracked_cache (options, cache);
+	ggit_untracked_cache_unref (loaded);
+
+	/* Nothing changed, so no directory needs to be read */
+	ggit_status_options_set_changed_paths (options, unchanged);
+	ggit_untracked_cache_get_stats (cache, NULL, &misses);
+
+	status = collect_status (repo, options);
+	g_assert_cmpstr (status, ==, expected);
+	g_free (status);
+	g_free (expected);
+
+	ggit_untracked_cache_get_stats (cache, &hits, &misses_after);
+	g_assert_cmpuint (misses_after, ==, misses);
+	g_assert_cmpuint (hits, >, 0);
+
+	/* A hinted change is picked up by reading just its directory */
+	write_file (f, "sub/new.txt", "i\n");
+	ggit_status_options_set_changed_paths (options, changed);
+
+	status = collect_status (repo, options);
+	g_assert_nonnull (g_strrstr (status, "sub/new.txt:"));
+	g_free (status);
+
+	ggit_untracked_cache_get_stats (cache, NULL, &misses);
+	g_assert_cmpuint (misses, ==, misses_after + 1);
+
+	ggit_untracked_cache_unref (cache);
+	ggit_status_options_free (options);
+	g_object_unref (index);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_status_monitor_untracked_cache (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitStatusOptions *options;
+	GgitUntrackedCache *cache;
+	GgitStatusMonitor *monitor;
+	GgitOId *head;
+	GError *err = NULL;
+	guint64 hits;
+	guint64 misses;
+	guint64 total;
+	gint64 deadline;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	write_file (f, "a.txt", "a\n");
+	write_file (f, "sub/b.txt", "b\n");
+	write_file (f, "other/c.txt", "c\n");
+
+	options = ggit_status_options_new (GGIT_STATUS_OPTION_INCLUDE_UNTRACKED,
+	                                   GGIT_STATUS_SHOW_INDEX_AND_WORKDIR,
+	                                   NULL);
+
+	cache = ggit_untracked_cache_new ();
+	ggit_status_options_set_untracked_cache (options, cache);
+
+	monitor = ggit_status_monitor_new (repo, options, &err);
+	g_assert_no_error (err);
+
+	ggit_status_monitor_set_latency (monitor, 10);
+
+	/* The initial scan fills the cache of the options */
+	g_assert_true (wait_for_status (monitor, "other/c.txt", GGIT_STATUS_WORKING_TREE_NEW));
+	g_assert_cmpuint (ggit_untracked_cache_get_size (cache), >=, 3);
+
+	write_file (f, "sub/d.txt", "d\n");
+	g_assert_true (wait_for_status (monitor, "sub/d.txt", GGIT_STATUS_WORKING_TREE_NEW));
+
+	ggit_untracked_cache_get_stats (cache, &hits, &misses);
+	total = hits + misses;
+
+	/* A new HEAD rescans, but the directories were only just written and
+	 * would all be read again, unless the monitor passes on that only sub/
+	 * changed since the initial scan.
+	 */
+	head = create_linear_history (repo, 1);
+
+	deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+
+	while (hits + misses == total)
+	{
+		g_assert_cmpint (g_get_monotonic_time (), <, deadline);
+
+		if (!g_main_context_iteration (NULL, FALSE))
+		{
+			g_usleep (1000);
+		}
+
+		ggit_untracked_cache_get_stats (cache, &hits, &misses);
+	}
+
+	g_assert_cmpuint (hits, >, 0);
+
+	g_assert_true (wait_for_status (monitor, "sub/d.txt", GGIT_STATUS_WORKING_TREE_NEW));
+	g_assert_cmpint (ggit_status_monitor_get_status (monitor, "other/c.txt"), ==, GGIT_STATUS_WORKING_TREE_NEW);
+	g_assert_cmpint (ggit_status_monitor_get_status (monitor, "sub/b.txt"), ==, GGIT_STATUS_WORKING_TREE_NEW);
+
+	ggit_oid_free (head);
+	g_object_unref (monitor);
+	ggit_untracked_cache_unref (cache);
+	ggit_status_options_free (options);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_blob_content (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitBlob *blob;
+	GgitBlobInputStream *stream;
+	GgitOId *oid;
+	GBytes *bytes;
+	GString *contents;
+	GError *err = NULL;
+	gchar buffer[16];
+	gchar *data;
+	gsize read;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	contents = g_string_new (NULL);
+
+	for (i = 0; i < 10000; i++)
+	{
+		g_string_append_printf (contents, "line %u\n", i);
+	}
+
+	oid = ggit_repository_create_blob_from_buffer (repo, contents->str, contents->len, &err);
+	g_assert_no_error (err);
+
+	/* The bytes outlive the blob they come from */
+	blob = ggit_repository_lookup_blob (repo, oid, &err);
+	g_assert_no_error (err);
+
+	bytes = ggit_blob_get_content_bytes (blob);
+	g_object_unref (blob);
+
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, contents->len);
+	g_assert_cmpint (memcmp (g_bytes_get_data (bytes, NULL), contents->str, contents->len), ==, 0);
+	g_bytes_unref (bytes);
+
+	/* Reading only a prefix and a range */
+	stream = ggit_repository_open_blob (repo, oid, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_blob_input_stream_get_size (stream), ==, contents->len);
+
+	g_assert_true (g_input_stream_read_all (G_INPUT_STREAM (stream), buffer, 7, &read, NULL, &err));
+	g_assert_no_error (err);
+	g_assert_cmpuint (read, ==, 7);
+	g_assert_cmpint (memcmp (buffer, "line 0\n", 7), ==, 0);
+
+	g_assert_cmpint (g_input_stream_skip (G_INPUT_STREAM (stream), 7 * 9, NULL, &err), ==, 7 * 9);
+	g_assert_no_error (err);
+
+	g_assert_true (g_input_stream_read_all (G_INPUT_STREAM (stream), buffer, 8, &read, NULL, &err));
+	g_assert_no_error (err);
+	g_assert_cmpuint (read, ==, 8);
+	g_assert_cmpint (memcmp (buffer, "line 10\n", 8), ==, 0);
+
+	g_assert_true (g_input_stream_close (G_INPUT_STREAM (stream), NULL, &err));
+	g_assert_no_error (err);
+	g_object_unref (stream);
+
+	/* The whole blob, read to the end */
+	stream = ggit_repository_open_blob (repo, oid, &err);
+	g_assert_no_error (err);
+
+	data = g_malloc (contents->len + 1);
+	g_assert_true (g_input_stream_read_all (G_INPUT_STREAM (stream), data, contents->len + 1, &read, NULL, &err));
+	g_assert_no_error (err);
+	g_assert_cmpuint (read, ==, contents->len);
+	g_assert_cmpint (memcmp (data, contents->str, contents->len), ==, 0);
+	g_free (data);
+	g_object_unref (stream);
+
+	g_string_free (contents, TRUE);
+	ggit_oid_free (oid);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+on_blob_progress (GgitBlobOutputStream *stream,
+                  guint64               bytes_written,
+                  gpointer              user_data)
+{
+	guint64 *last = user_data;
+
+	g_assert_cmpuint (bytes_written, >=, *last);
+	*last = bytes_written;
+}
+
+static void
+test_repository_blob_splice (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitBlobOutputStream *stream;
+	GInputStream *source;
+	GAsyncResult *result = NULL;
+	GgitOId *expected;
+	GgitOId *oid;
+	GString *contents;
+	GError *err = NULL;
+	guint64 progress = 0;
+	gssize spliced;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	contents = g_string_new (NULL);
+
+	for (i = 0; i < 100000; i++)
+	{
+		g_string_append_printf (contents, "line %u\n", i);
+	}
+
+	expected = ggit_repository_create_blob_from_buffer (repo, contents->str, contents->len, &err);
+	g_assert_no_error (err);
+
+	/* Piped in without blocking, hashed while it is written */
+	stream = ggit_repository_create_blob_with_size (repo, contents->len);
+	g_signal_connect (stream, "progress", G_CALLBACK (on_blob_progress), &progress);
+
+	source = g_memory_input_stream_new_from_data (contents->str, contents->len, NULL);
+
+	g_output_stream_splice_async (G_OUTPUT_STREAM (stream),
+	                              source,
+	                              G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+	                              G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+	                              G_PRIORITY_DEFAULT,
+	                              NULL,
+	                              on_async_ready, &result);
+
+	while (result == NULL)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	spliced = g_output_stream_splice_finish (G_OUTPUT_STREAM (stream), result, &err);
+	g_assert_no_error (err);
+	g_assert_cmpint (spliced, ==, contents->len);
+	g_object_unref (result);
+
+	while (g_main_context_pending (NULL))
+	{
+		g_main_context_iteration (NULL, FALSE);
+	}
+
+	g_assert_cmpuint (progress, ==, contents->len);
+	g_assert_cmpuint (ggit_blob_output_stream_get_bytes_written (stream), ==, contents->len);
+
+	oid = ggit_blob_output_stream_get_id (stream, &err);
+	g_assert_no_error (err);
+	g_assert_true (ggit_oid_equal (oid, expected));
+
+	ggit_oid_free (oid);
+	g_object_unref (source);
+	g_object_unref (stream);
+
+	/* The declared size is enforced */
+	stream = ggit_repository_create_blob_with_size (repo, 4);
+
+	g_assert_cmpint (g_output_stream_write (G_OUTPUT_STREAM (stream), "abcdef", 6, NULL, &err), ==, -1);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_NO_SPACE);
+	g_clear_error (&err);
+
+	g_object_unref (stream);
+
+	ggit_oid_free (expected);
+	g_string_free (contents, TRUE);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static gboolean
+has_loose_object (GFile   *dotgit,
+                  GgitOId *oid)
+{
+	GFile *object;
+	gchar *hex;
+	gchar *path;
+	gboolean exists;
+
+	hex = ggit_oid_to_string (oid);
+	path = g_strdup_printf ("objects/%.2s/%s", hex, hex + 2);
+
+	object = g_file_resolve_relative_path (dotgit, path);
+	exists = g_file_query_exists (object, NULL);
+
+	g_object_unref (object);
+	g_free (path);
+	g_free (hex);
+
+	return exists;
+}
+
+static void
+test_repository_create_blobs (const gchar *git_dir)
+{
+	GFile *f;
+	GFile *dotgit;
+	GgitRepository *repo;
+	GgitBlob *blob;
+	GFile *files[4];
+	GgitOId **ids;
+	GgitOId *oid;
+	GFile *pack_dir;
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	GString *large;
+	GError *err = NULL;
+	const guchar *content;
+	gsize len;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	dotgit = ggit_repository_get_location (repo);
+
+	write_file (f, "a.txt", "same\n");
+	write_file (f, "b.txt", "same\n");
+	write_file (f, "c.txt", "other\n");
+
+	files[0] = g_file_get_child (f, "a.txt");
+	files[1] = g_file_get_child (f, "b.txt");
+	files[2] = g_file_get_child (f, "c.txt");
+	files[3] = g_object_ref (files[0]);
+
+	/* Loose objects, in the order of the files */
+	ids = ggit_repository_create_blobs_from_files (repo, files, 4, GGIT_CREATE_BLOBS_DEFAULT, NULL, &err);
+	g_assert_no_error (err);
+	g_assert_nonnull (ids);
+	g_assert_null (ids[4]);
+
+	/* Before the single file API writes the same objects again */
+	for (i = 0; i < 4; i++)
+	{
+		g_assert_true (has_loose_object (dotgit, ids[i]));
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		oid = ggit_repository_create_blob_from_file (repo, files[i], &err);
+		g_assert_no_error (err);
+		g_assert_true (ggit_oid_equal (ids[i], oid));
+		ggit_oid_free (oid);
+	}
+
+	g_assert_true (ggit_oid_equal (ids[0], ids[1]));
+
+	for (i = 0; i < 4; i++)
+	{
+		ggit_oid_free (ids[i]);
+	}
+
+	g_free (ids);
+
+	/* A single pack file, with a blob that is larger than the chunks it
+	 * is streamed in and one that is already loose.
+	 */
+	large = g_string_new (NULL);
+
+	for (i = 0; i < 20000; i++)
+	{
+		gchar *line;
+
+		line = g_compute_checksum_for_data (G_CHECKSUM_SHA1, (const guchar *)&i, sizeof (i));
+		g_string_append_printf (large, "%s\n", line);
+		g_free (line);
+	}
+
+	write_file (f, "d.txt", "packed\n");
+	write_file (f, "e.txt", large->str);
+
+	g_object_unref (files[0]);
+	g_object_unref (files[1]);
+	files[0] = g_file_get_child (f, "d.txt");
+	files[1] = g_file_get_child (f, "e.txt");
+
+	ids = ggit_repository_create_blobs_from_files (repo, files, 3, GGIT_CREATE_BLOBS_PACK, NULL, &err);
+	g_assert_no_error (err);
+	g_assert_nonnull (ids);
+	g_assert_false (has_loose_object (dotgit, ids[0]));
+	g_assert_false (has_loose_object (dotgit, ids[1]));
+	g_assert_true (has_loose_object (dotgit, ids[2]));
+
+	blob = ggit_repository_lookup_blob (repo, ids[0], &err);
+	g_assert_no_error (err);
+
+	content = ggit_blob_get_raw_content (blob, &len);
+	g_assert_cmpuint (len, ==, 7);
+	g_assert_cmpint (memcmp (content, "packed\n", 7), ==, 0);
+	g_object_unref (blob);
+
+	blob = ggit_repository_lookup_blob (repo, ids[1], &err);
+	g_assert_no_error (err);
+
+	content = ggit_blob_get_raw_content (blob, &len);
+	g_assert_cmpuint (len, ==, large->len);
+	g_assert_cmpint (memcmp (content, large->str, len), ==, 0);
+	g_object_unref (blob);
+
+	for (i = 0; i < 3; i++)
+	{
+		ggit_oid_free (ids[i]);
+	}
+
+	g_free (ids);
+	g_string_free (large, TRUE);
+
+	/* The collected entries are removed again */
+	pack_dir = g_file_resolve_relative_path (dotgit, "objects/pack");
+	enumerator = g_file_enumerate_children (pack_dir, G_FILE_ATTRIBUTE_STANDARD_NAME,
+	                                        G_FILE_QUERY_INFO_NONE, NULL, &err);
+	g_assert_no_error (err);
+
+	while ((info = g_file_enumerator_next_file (enumerator, NULL, &err)) != NULL)
+	{
+		g_assert_false (g_str_has_prefix (g_file_info_get_name (info), "tmp_ggit_pack_"));
+		g_object_unref (info);
+	}
+
+	g_assert_no_error (err);
+	g_object_unref (enumerator);
+	g_object_unref (pack_dir);
+
+	for (i = 0; i < 4; i++)
+	{
+		g_object_unref (files[i]);
+	}
+
+	g_object_unref (dotgit);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+/* A tree with file-NNN.txt for every non-%NULL entry of @contents */
+static GgitTree *
+create_numbered_tree (GgitRepository  *repo,
+                      gchar          **contents,
+                      guint            n)
+{
+	GgitTreeBuilder *builder;
+	GgitTree *tree;
+	GgitOId *oid;
+	GError *err = NULL;
+	guint i;
+
+	builder = ggit_repository_create_tree_builder (repo, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < n; i++)
+	{
+		GgitTreeEntry *entry;
+		GgitBlob *blob;
+		gchar *name;
+
+		if (contents[i] == NULL)
+		{
+			continue;
+		}
+
+		name = g_strdup_printf ("file-%03u.txt", i);
+		blob = create_blob (repo, contents[i]);
+		oid = ggit_object_get_id (GGIT_OBJECT (blob));
+
+		entry = ggit_tree_builder_insert (builder, name, oid, GGIT_FILE_MODE_BLOB, &err);
+		g_assert_no_error (err);
+
+		ggit_tree_entry_unref (entry);
+		ggit_oid_free (oid);
+		g_object_unref (blob);
+		g_free (name);
+	}
+
+	oid = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+	g_object_unref (builder);
+
+	tree = ggit_repository_lookup_tree (repo, oid, &err);
+	g_assert_no_error (err);
+	ggit_oid_free (oid);
+
+	return tree;
+}
+
+/* Checks that serial and parallel counting agree with libgit2 and with
+ * each other, returns the serial stats */
+static GgitDiffStats *
+check_diff_stats (GgitDiff *diff,
+                  gsize     min_size)
+{
+	GgitDiffStats *stats;
+	GgitDiffStats *serial;
+	git_diff_stats *expected;
+	GError *err = NULL;
+	guint n_threads[] = { 1, 4, 0 };
+	guint i;
+
+	g_assert_cmpint (git_diff_get_stats (&expected, _ggit_native_get (diff)), ==, GIT_OK);
+
+	serial = ggit_diff_get_stats (diff, 1, NULL, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_diff_stats_get_size (serial), >=, min_size);
+
+	for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+	{
+		guint j;
+
+		stats = ggit_diff_get_stats (diff, n_threads[i], NULL, &err);
+		g_assert_no_error (err);
+
+		g_assert_cmpuint (ggit_diff_stats_get_files_changed (stats), ==, git_diff_stats_files_changed (expected));
+		g_assert_cmpuint (ggit_diff_stats_get_insertions (stats), ==, git_diff_stats_insertions (expected));
+		g_assert_cmpuint (ggit_diff_stats_get_deletions (stats), ==, git_diff_stats_deletions (expected));
+
+		/* Every shard counted the same files */
+		g_assert_cmpuint (ggit_diff_stats_get_size (stats), ==, ggit_diff_stats_get_size (serial));
+
+		for (j = 0; j < ggit_diff_stats_get_size (stats); j++)
+		{
+			g_assert_cmpstr (ggit_diff_stats_get_file_path (stats, j), ==, ggit_diff_stats_get_file_path (serial, j));
+			g_assert_cmpuint (ggit_diff_stats_get_file_insertions (stats, j), ==, ggit_diff_stats_get_file_insertions (serial, j));
+			g_assert_cmpuint (ggit_diff_stats_get_file_deletions (stats, j), ==, ggit_diff_stats_get_file_deletions (serial, j));
+		}
+
+		ggit_diff_stats_unref (stats);
+	}
+
+	git_diff_stats_free (expected);
+
+	return serial;
+}
+
+#define SUBMODULE_A "@1111111111111111111111111111111111111111"
+#define SUBMODULE_B "@2222222222222222222222222222222222222222"
+
+/* Pairs of names and contents, a leading @ makes the entry a submodule
+ * commit */
+static const gchar *old_gitlinks[] = {
+	"blob-to-sub", "one\ntwo\n",
+	"sub", SUBMODULE_A,
+	"sub-to-blob", SUBMODULE_A,
+	NULL
+};
+
+static const gchar *new_gitlinks[] = {
+	"added-sub", SUBMODULE_B,
+	"blob-to-sub", SUBMODULE_B,
+	"sub", SUBMODULE_B,
+	"sub-to-blob", "x\ny\nz\n",
+	NULL
+};
+
+static GgitTree *
+create_gitlink_tree (GgitRepository  *repo,
+                     const gchar    **entries)
+{
+	GgitTreeBuilder *builder;
+	GgitTree *tree;
+	GgitOId *oid;
+	GError *err = NULL;
+	guint i;
+
+	builder = ggit_repository_create_tree_builder (repo, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; entries[i] != NULL; i += 2)
+	{
+		GgitTreeEntry *entry;
+		GgitFileMode mode;
+
+		if (entries[i + 1][0] == '@')
+		{
+			oid = ggit_oid_new_from_string (entries[i + 1] + 1);
+			mode = GGIT_FILE_MODE_COMMIT;
+		}
+		else
+		{
+			GgitBlob *blob;
+
+			blob = create_blob (repo, entries[i + 1]);
+			oid = ggit_object_get_id (GGIT_OBJECT (blob));
+			mode = GGIT_FILE_MODE_BLOB;
+			g_object_unref (blob);
+		}
+
+		entry = ggit_tree_builder_insert (builder, entries[i], oid, mode, &err);
+		g_assert_no_error (err);
+
+		ggit_tree_entry_unref (entry);
+		ggit_oid_free (oid);
+	}
+
+	oid = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+	g_object_unref (builder);
+
+	tree = ggit_repository_lookup_tree (repo, oid, &err);
+	g_assert_no_error (err);
+	ggit_oid_free (oid);
+
+	return tree;
+}
+
+static void
+test_repository_diff_stats (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitTree *old_tree;
+	GgitTree *new_tree;
+	GgitDiff *diff;
+	GgitDiffStats *stats;
+	gchar *old_contents[100];
+	gchar *new_contents[100];
+	GError *err = NULL;
+	guint n_threads[] = { 1, 4, 0 };
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	old_tree = create_tree (repo, "a\nb\nc\n", "x\n");
+	new_tree = create_tree (repo, "a\nB\nc\nd\n", "y\nz\n");
+
+	diff = ggit_diff_new_tree_to_tree (repo, old_tree, new_tree, NULL, &err);
+	g_assert_no_error (err);
+
+	/* Serial and parallel counting agree */
+	for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+	{
+		stats = ggit_diff_get_stats (diff, n_threads[i], NULL, &err);
+		g_assert_no_error (err);
+		g_assert_nonnull (stats);
+
+		g_assert_cmpuint (ggit_diff_stats_get_size (stats), ==, 2);
+		g_assert_cmpuint (ggit_diff_stats_get_files_changed (stats), ==, 2);
+		g_assert_cmpuint (ggit_diff_stats_get_insertions (stats), ==, 4);
+		g_assert_cmpuint (ggit_diff_stats_get_deletions (stats), ==, 2);
+
+		g_assert_cmpstr (ggit_diff_stats_get_file_path (stats, 0), ==, "first.txt");
+		g_assert_cmpint (ggit_diff_stats_get_file_status (stats, 0), ==, GGIT_DELTA_MODIFIED);
+		g_assert_false (ggit_diff_stats_get_file_is_binary (stats, 0));
+		g_assert_cmpuint (ggit_diff_stats_get_file_insertions (stats, 0), ==, 2);
+		g_assert_cmpuint (ggit_diff_stats_get_file_deletions (stats, 0), ==, 1);
+
+		g_assert_cmpstr (ggit_diff_stats_get_file_path (stats, 1), ==, "second.txt");
+		g_assert_cmpuint (ggit_diff_stats_get_file_insertions (stats, 1), ==, 2);
+		g_assert_cmpuint (ggit_diff_stats_get_file_deletions (stats, 1), ==, 1);
+
+		ggit_diff_stats_unref (stats);
+	}
+
+	g_object_unref (diff);
+	g_object_unref (new_tree);
+	g_object_unref (old_tree);
+
+	/* Enough files for many shards, added, deleted, unchanged and
+	 * modified ones, counted like libgit2 does.
+	 */
+	for (i = 0; i < G_N_ELEMENTS (old_contents); i++)
+	{
+		GString *old_str;
+		GString *new_str;
+		guint j;
+
+		old_str = g_string_new (NULL);
+		new_str = g_string_new (NULL);
+
+		for (j = 0; j < i % 7 + 3; j++)
+		{
+			g_string_append_printf (old_str, "line %u\n", j);
+
+			if (j % (i % 3 + 2) == 0)
+			{
+				g_string_append_printf (new_str, "changed %u\n", j);
+			}
+			else
+			{
+				g_string_append_printf (new_str, "line %u\n", j);
+			}
+		}
+
+		g_string_append_printf (new_str, "file %u\n", i);
+
+		old_contents[i] = i % 5 == 1 ? NULL : g_strdup (old_str->str);
+
+		switch (i % 5)
+		{
+			case 0:
+				new_contents[i] = NULL;
+				break;
+			case 2:
+				new_contents[i] = g_strdup (old_str->str);
+				break;
+			default:
+				new_contents[i] = g_strdup (new_str->str);
+				break;
+		}
+
+		g_string_free (old_str, TRUE);
+		g_string_free (new_str, TRUE);
+	}
+
+	old_tree = create_numbered_tree (repo, old_contents, G_N_ELEMENTS (old_contents));
+	new_tree = create_numbered_tree (repo, new_contents, G_N_ELEMENTS (new_contents));
+
+	diff = ggit_diff_new_tree_to_tree (repo, old_tree, new_tree, NULL, &err);
+	g_assert_no_error (err);
+
+	stats = check_diff_stats (diff, 4 * 16 + 1);
+	ggit_diff_stats_unref (stats);
+
+	for (i = 0; i < G_N_ELEMENTS (old_contents); i++)
+	{
+		g_free (old_contents[i]);
+		g_free (new_contents[i]);
+	}
+
+	g_object_unref (diff);
+	g_object_unref (new_tree);
+	g_object_unref (old_tree);
+
+	/* Submodule commits are not in the repository, their sides are
+	 * counted as a "Subproject commit" line like libgit2 does. This
+	 * covers a moved submodule, typechanges to and from a submodule
+	 * and an added one, with and without typechange deltas.
+	 */
+	old_tree = create_gitlink_tree (repo, old_gitlinks);
+	new_tree = create_gitlink_tree (repo, new_gitlinks);
+
+	for (i = 0; i < 2; i++)
+	{
+		GgitDiffOptions *options;
+
+		options = ggit_diff_options_new ();
+
+		if (i == 1)
+		{
+			ggit_diff_options_set_flags (options, GGIT_DIFF_INCLUDE_TYPECHANGE);
+		}
+
+		diff = ggit_diff_new_tree_to_tree (repo, old_tree, new_tree, options, &err);
+		g_assert_no_error (err);
+
+		stats = check_diff_stats (diff, i == 0 ? 6 : 4);
+		g_assert_cmpuint (ggit_diff_stats_get_insertions (stats), ==, 6);
+		g_assert_cmpuint (ggit_diff_stats_get_deletions (stats), ==, 4);
+
+		ggit_diff_stats_unref (stats);
+		g_object_unref (diff);
+		g_object_unref (options);
+	}
+
+	g_object_unref (new_tree);
+	g_object_unref (old_tree);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_commit_table (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitCommitTable *table;
+	GgitOId *head;
+	GgitOId *oid;
+	const gint32 *parents;
+	const guint32 *offsets;
+	const gchar *strings;
+	gsize size;
+	guint n;
+	guint index;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 10);
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	table = ggit_commit_table_new_from_revision_walker (walker, 0, &err);
+	g_assert_no_error (err);
+	g_assert_nonnull (table);
+	g_assert_cmpuint (ggit_commit_table_get_size (table), ==, 10);
+
+	oid = ggit_commit_table_get_id (table, 0);
+	g_assert (ggit_oid_equal (oid, head));
+	ggit_oid_free (oid);
+
+	g_assert (ggit_commit_table_find (table, head, &index));
+	g_assert_cmpuint (index, ==, 0);
+
+	g_assert_cmpstr (ggit_commit_table_get_subject (table, 0), ==, "commit 9");
+	g_assert_cmpstr (ggit_commit_table_get_subject (table, 9), ==, "commit 0");
+	g_assert_cmpstr (ggit_commit_table_get_author_name (table, 3), ==, "Jesse van den Kieboom");
+	g_assert_cmpstr (ggit_commit_table_get_committer_email (table, 3), ==, "jessevdk@gnome.org");
+	g_assert_cmpint (ggit_commit_table_get_author_time (table, 3), >, 0);
+
+	/* Each commit has the next one as parent, except the root */
+	parents = ggit_commit_table_get_parents (table, 0, &n);
+	g_assert_cmpuint (n, ==, 1);
+	g_assert_cmpint (parents[0], ==, 1);
+
+	ggit_commit_table_get_parents (table, 9, &n);
+	g_assert_cmpuint (n, ==, 0);
+	g_assert_null (ggit_commit_table_get_parent_raw_id (table, 9, 0));
+
+	offsets = ggit_commit_table_get_subject_offsets (table, &n);
+	strings = ggit_commit_table_get_strings (table, &size);
+	g_assert_cmpuint (n, ==, 10);
+	g_assert_cmpuint (offsets[5], <, size);
+	g_assert_cmpstr (strings + offsets[5], ==, "commit 4");
+
+	ggit_commit_table_unref (table);
+
+	/* Parents outside of a partial table have no index */
+	ggit_revision_walker_reset (walker);
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	table = ggit_commit_table_new_from_revision_walker (walker, 3, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_commit_table_get_size (table), ==, 3);
+
+	parents = ggit_commit_table_get_parents (table, 2, &n);
+	g_assert_cmpuint (n, ==, 1);
+	g_assert_cmpint (parents[0], ==, -1);
+	g_assert_nonnull (ggit_commit_table_get_parent_raw_id (table, 2, 0));
+
+	ggit_commit_table_unref (table);
+
+	ggit_oid_free (head);
+	g_object_unref (walker);
+	g_object_unref (repo);
+}
+
+static void
+check_graph_queries (GgitRepository *repo,
+                     GgitOId        *head,
+                     GgitOId        *octopus,
+                     GgitOId        *base)
+{
+	GError *err = NULL;
+	GgitOId *oid;
+	gsize ahead;
+	gsize behind;
+
+	ggit_repository_get_ahead_behind (repo, octopus, head, &ahead, &behind, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ahead, ==, 1);
+	g_assert_cmpuint (behind, ==, 2);
+
+	g_assert (ggit_repository_get_descendant_of (repo, octopus, base, &err));
+	g_assert_no_error (err);
+	g_assert (!ggit_repository_get_descendant_of (repo, base, octopus, &err));
+	g_assert_no_error (err);
+	g_assert (!ggit_repository_get_descendant_of (repo, head, head, &err));
+	g_assert_no_error (err);
+
+	oid = ggit_repository_merge_base (repo, octopus, head, &err);
+	g_assert_no_error (err);
+	g_assert (ggit_oid_equal (oid, base));
+	ggit_oid_free (oid);
+}
+
+static void
+check_graph_walkers (GgitCommitGraph *graph,
+                     GgitOId         *head,
+                     GgitOId         *octopus,
+                     GgitOId         *base)
+{
+	gboolean result;
+	gboolean found;
+	git_oid merge_base;
+	gsize ahead;
+	gsize behind;
+
+	/* Answered by the graph itself, not by falling back to libgit2 */
+	g_assert (_ggit_commit_graph_ahead_behind (graph,
+	                                           _ggit_oid_get_oid (octopus),
+	                                           _ggit_oid_get_oid (head),
+	                                           &ahead,
+	                                           &behind));
+	g_assert_cmpuint (ahead, ==, 1);
+	g_assert_cmpuint (behind, ==, 2);
+
+	g_assert (_ggit_commit_graph_descendant_of (graph,
+	                                            _ggit_oid_get_oid (octopus),
+	                                            _ggit_oid_get_oid (base),
+	                                            &result));
+	g_assert (result);
+
+	g_assert (_ggit_commit_graph_descendant_of (graph,
+	                                            _ggit_oid_get_oid (base),
+	                                            _ggit_oid_get_oid (octopus),
+	                                            &result));
+	g_assert (!result);
+
+	g_assert (_ggit_commit_graph_descendant_of (graph,
+	                                            _ggit_oid_get_oid (head),
+	                                            _ggit_oid_get_oid (head),
+	                                            &result));
+	g_assert (!result);
+
+	g_assert (_ggit_commit_graph_merge_base (graph,
+	                                         _ggit_oid_get_oid (octopus),
+	                                         _ggit_oid_get_oid (head),
+	                                         &merge_base,
+	                                         &found));
+	g_assert (found);
+	g_assert (git_oid_equal (&merge_base, _ggit_oid_get_oid (base)));
+}
+
+static GBytes *
+collect_walk (GgitRepository *repo,
+              GgitSortMode    sort_mode,
+              GgitOId        *push,
+              GgitOId        *push2,
+              GgitOId        *hide)
+{
+	GError *err = NULL;
+	GgitRevisionWalker *walker;
+	GBytes *ids;
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_set_sort_mode (walker, sort_mode);
+
+	ggit_revision_walker_push (walker, push, &err);
+	g_assert_no_error (err);
+
+	if (push2 != NULL)
+	{
+		ggit_revision_walker_push (walker, push2, &err);
+		g_assert_no_error (err);
+	}
+
+	if (hide != NULL)
+	{
+		ggit_revision_walker_hide (walker, hide, &err);
+		g_assert_no_error (err);
+	}
+
+	ids = ggit_revision_walker_collect (walker, 0, &err);
+	g_assert_no_error (err);
+
+	g_object_unref (walker);
+
+	return ids;
+}
+
+static void
+check_topo_walk (GgitRepository  *repo,
+                 GgitCommitGraph *graph,
+                 GgitOId         *head,
+                 GgitOId         *octopus)
+{
+	GArray *expected;
+	GBytes *ids;
+	GError *err = NULL;
+	GgitRevisionWalker *walker;
+	GBytes *by_time;
+	GHashTable *index;
+	git_oid tips[2];
+	const guint8 *raw;
+	gsize size;
+	guint i;
+	guint pass;
+
+	git_oid_cpy (&tips[0], _ggit_oid_get_oid (head));
+	git_oid_cpy (&tips[1], _ggit_oid_get_oid (octopus));
+
+	expected = g_array_new (FALSE, FALSE, sizeof (git_oid));
+	g_assert (_ggit_commit_graph_topo_walk (graph, tips, 2, NULL, 0, expected));
+	g_assert_cmpuint (expected->len, ==, 11);
+
+	/* The walker serves the walk of the graph */
+	ids = collect_walk (repo, GGIT_SORT_TOPOLOGICAL, head, octopus, NULL);
+	raw = g_bytes_get_data (ids, &size);
+	g_assert_cmpuint (size, ==, expected->len * 20);
+
+	for (i = 0; i < expected->len; i++)
+	{
+		g_assert (memcmp (raw + i * 20, g_array_index (expected, git_oid, i).id, 20) == 0);
+	}
+
+	/* Every commit comes before its parents */
+	index = g_hash_table_new_full ((GHashFunc)ggit_oid_hash,
+	                               (GEqualFunc)ggit_oid_equal,
+	                               (GDestroyNotify)ggit_oid_free,
+	                               NULL);
+
+	for (i = 0; i < expected->len; i++)
+	{
+		g_hash_table_insert (index, ggit_oid_new_from_raw (raw + i * 20), GUINT_TO_POINTER (i));
+	}
+
+	for (i = 0; i < expected->len; i++)
+	{
+		GgitOId *oid;
+		guint32 *parents;
+		guint n_parents;
+		guint position;
+		guint j;
+
+		oid = ggit_oid_new_from_raw (raw + i * 20);
+		g_assert (ggit_commit_graph_find (graph, oid, &position));
+		ggit_oid_free (oid);
+
+		parents = ggit_commit_graph_get_parents (graph, position, &n_parents);
+
+		for (j = 0; j < n_parents; j++)
+		{
+			gpointer parent_index;
+
+			oid = ggit_commit_graph_get_id (graph, parents[j]);
+			g_assert (g_hash_table_lookup_extended (index, oid, NULL, &parent_index));
+			g_assert_cmpuint (GPOINTER_TO_UINT (parent_index), >, i);
+			ggit_oid_free (oid);
+		}
+
+		g_free (parents);
+	}
+
+	/* The same commits as libgit2 walks */
+	by_time = collect_walk (repo, GGIT_SORT_TIME, head, octopus, NULL);
+	raw = g_bytes_get_data (by_time, &size);
+	g_assert_cmpuint (size, ==, expected->len * 20);
+
+	for (i = 0; i < expected->len; i++)
+	{
+		GgitOId *oid;
+
+		oid = ggit_oid_new_from_raw (raw + i * 20);
+		g_assert (g_hash_table_contains (index, oid));
+		ggit_oid_free (oid);
+	}
+
+	/* Tips pushed before changing the sort mode are kept, whether
+	 * recorded by id or only known to libgit2 through a glob */
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		GBytes *sorted;
+
+		if (pass == 0)
+		{
+			ggit_revision_walker_push (walker, octopus, &err);
+		}
+		else
+		{
+			ggit_revision_walker_push_glob (walker, "heads/octopus", &err);
+		}
+
+		g_assert_no_error (err);
+
+		ggit_revision_walker_set_sort_mode (walker, GGIT_SORT_TOPOLOGICAL);
+
+		ggit_revision_walker_push (walker, head, &err);
+		g_assert_no_error (err);
+
+		sorted = ggit_revision_walker_collect (walker, 0, &err);
+		g_assert_no_error (err);
+
+		raw = g_bytes_get_data (sorted, &size);
+		g_assert_cmpuint (size, ==, g_bytes_get_size (by_time));
+
+		for (i = 0; i < expected->len; i++)
+		{
+			GgitOId *oid;
+
+			oid = ggit_oid_new_from_raw (raw + i * 20);
+			g_assert (g_hash_table_contains (index, oid));
+			ggit_oid_free (oid);
+		}
+
+		g_bytes_unref (sorted);
+		ggit_revision_walker_set_sort_mode (walker, GGIT_SORT_NONE);
+	}
+
+	g_object_unref (walker);
+	g_bytes_unref (by_time);
+	g_bytes_unref (ids);
+
+	/* Reversed */
+	ids = collect_walk (repo, GGIT_SORT_TOPOLOGICAL | GGIT_SORT_REVERSE, head, octopus, NULL);
+	raw = g_bytes_get_data (ids, &size);
+	g_assert_cmpuint (size, ==, expected->len * 20);
+
+	for (i = 0; i < expected->len; i++)
+	{
+		g_assert (memcmp (raw + i * 20, g_array_index (expected, git_oid, expected->len - 1 - i).id, 20) == 0);
+	}
+
+	g_bytes_unref (ids);
+
+	/* Hiding the octopus merge leaves the two newest commits */
+	g_array_set_size (expected, 0);
+	g_assert (_ggit_commit_graph_topo_walk (graph, tips, 1, tips + 1, 1, expected));
+	g_assert_cmpuint (expected->len, ==, 2);
+	g_assert (git_oid_equal (&g_array_index (expected, git_oid, 0), &tips[0]));
+
+	ids = collect_walk (repo, GGIT_SORT_TOPOLOGICAL, head, NULL, octopus);
+	raw = g_bytes_get_data (ids, &size);
+	g_assert_cmpuint (size, ==, 2 * 20);
+	g_assert (memcmp (raw, tips[0].id, 20) == 0);
+	g_assert (memcmp (raw + 20, g_array_index (expected, git_oid, 1).id, 20) == 0);
+
+	g_bytes_unref (ids);
+	g_hash_table_unref (index);
+	g_array_unref (expected);
+}
+
+static void
+test_repository_commit_graph (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitCommitGraph *graph;
+	GgitSignature *author;
+	GgitCommit *parents[3];
+	GgitCommit *head_commit;
+	GgitTree *tree;
+	GgitOId *head;
+	GgitOId *base;
+	GgitOId *octopus;
+	GgitOId *newer;
+	GgitOId *oid;
+	GgitOId *expected;
+	GBytes *ids;
+	GArray *walked;
+	const guint8 *raw;
+	guint32 *parent_positions;
+	guint n_parents;
+	guint position;
+	gboolean result;
+	gsize size;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	head = create_linear_history (repo, 10);
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	ids = ggit_revision_walker_collect (walker, 0, &err);
+	g_assert_no_error (err);
+	raw = g_bytes_get_data (ids, NULL);
+
+	/* An octopus merge of the third, fifth and eighth newest commits */
+	for (i = 0; i < 3; i++)
+	{
+		oid = ggit_oid_new_from_raw (raw + (2 + i * 5 / 2) * 20);
+		parents[i] = ggit_repository_lookup_commit (repo, oid, &err);
+		g_assert_no_error (err);
+		ggit_oid_free (oid);
+	}
+
+	base = ggit_oid_new_from_raw (raw + 2 * 20);
+
+	head_commit = ggit_repository_lookup_commit (repo, head, &err);
+	g_assert_no_error (err);
+	tree = ggit_commit_get_tree (head_commit);
+
+	author = ggit_signature_new_now ("Jesse van den Kieboom",
+	                                 "jessevdk@gnome.org",
+	                                 &err);
+	g_assert_no_error (err);
+
+	octopus = ggit_repository_create_commit (repo,
+	                                         "refs/heads/octopus",
+	                                         author,
+	                                         author,
+	                                         NULL,
+	                                         "octopus",
+	                                         tree,
+	                                         parents,
+	                                         3,
+	                                         &err);
+	g_assert_no_error (err);
+
+	/* Walking the commits and the graph give the same answers */
+	g_assert_null (ggit_repository_get_commit_graph (repo));
+	check_graph_queries (repo, head, octopus, base);
+
+	ggit_repository_write_commit_graph (repo, NULL, &err);
+	g_assert_no_error (err);
+
+	graph = ggit_repository_get_commit_graph (repo);
+	g_assert_nonnull (graph);
+	g_assert_cmpuint (ggit_commit_graph_get_size (graph), ==, 11);
+
+	g_assert (ggit_commit_graph_find (graph, head, &position));
+	g_assert_cmpuint (ggit_commit_graph_get_generation (graph, position), ==, 10);
+
+	oid = ggit_commit_graph_get_tree_id (graph, position);
+	expected = ggit_object_get_id (GGIT_OBJECT (tree));
+	g_assert (ggit_oid_equal (oid, expected));
+	ggit_oid_free (expected);
+	ggit_oid_free (oid);
+
+	g_assert (ggit_commit_graph_find (graph, octopus, &position));
+	g_assert_cmpuint (ggit_commit_graph_get_generation (graph, position), ==, 9);
+
+	parent_positions = ggit_commit_graph_get_parents (graph, position, &n_parents);
+	g_assert_cmpuint (n_parents, ==, 3);
+
+	for (i = 0; i < 3; i++)
+	{
+		oid = ggit_commit_graph_get_id (graph, parent_positions[i]);
+		expected = ggit_object_get_id (GGIT_OBJECT (parents[i]));
+		g_assert (ggit_oid_equal (oid, expected));
+		ggit_oid_free (expected);
+		ggit_oid_free (oid);
+	}
+
+	g_free (parent_positions);
+
+	check_graph_walkers (graph, head, octopus, base);
+	check_graph_queries (repo, head, octopus, base);
+	check_topo_walk (repo, graph, head, octopus);
+
+	/* A commit made after the graph was written is not in it, so the
+	 * graph cannot answer and libgit2 walks the commits instead */
+	newer = ggit_repository_create_commit (repo,
+	                                       "refs/heads/newer",
+	                                       author,
+	                                       author,
+	                                       NULL,
+	                                       "newer",
+	                                       tree,
+	                                       &head_commit,
+	                                       1,
+	                                       &err);
+	g_assert_no_error (err);
+
+	g_assert (!_ggit_commit_graph_descendant_of (graph,
+	                                             _ggit_oid_get_oid (newer),
+	                                             _ggit_oid_get_oid (base),
+	                                             &result));
+	g_assert (ggit_repository_get_descendant_of (repo, newer, base, &err));
+	g_assert_no_error (err);
+
+	walked = g_array_new (FALSE, FALSE, sizeof (git_oid));
+	g_assert (!_ggit_commit_graph_topo_walk (graph, _ggit_oid_get_oid (newer), 1, NULL, 0, walked));
+	g_array_unref (walked);
+
+	g_bytes_unref (ids);
+	ids = collect_walk (repo, GGIT_SORT_TOPOLOGICAL, newer, NULL, NULL);
+	raw = g_bytes_get_data (ids, &size);
+	g_assert_cmpuint (size, ==, 11 * 20);
+	g_assert (memcmp (raw, _ggit_oid_get_oid (newer)->id, 20) == 0);
+	g_assert (memcmp (raw + 20, _ggit_oid_get_oid (head)->id, 20) == 0);
+
+	ggit_commit_graph_unref (graph);
+
+	for (i = 0; i < 3; i++)
+	{
+		g_object_unref (parents[i]);
+	}
+
+	g_bytes_unref (ids);
+	ggit_oid_free (newer);
+	ggit_oid_free (octopus);
+	ggit_oid_free (base);
+	ggit_oid_free (head);
+	g_object_unref (author);
+	g_object_unref (tree);
+	g_object_unref (head_commit);
+	g_object_unref (walker);
+	g_object_unref (repo);
+}
+
+static GgitOId *
+create_child_commit (GgitRepository  *repo,
+                     const gchar     *ref,
+                     GgitOId        **parent_ids,
+                     guint            n_parents)
+{
+	GError *err = NULL;
+	GgitSignature *author;
+	GgitCommit *parents[2];
+	GgitTree *tree;
+	GgitOId *oid;
+	guint i;
+
+	g_assert_cmpuint (n_parents, <=, 2);
+
+	for (i = 0; i < n_parents; i++)
+	{
+		parents[i] = ggit_repository_lookup_commit (repo, parent_ids[i], &err);
+		g_assert_no_error (err);
+	}
+
+	tree = ggit_commit_get_tree (parents[0]);
+
+	author = ggit_signature_new_now ("Jesse van den Kieboom",
+	                                 "jessevdk@gnome.org",
+	                                 &err);
+	g_assert_no_error (err);
+
+	oid = ggit_repository_create_commit (repo,
+	                                     ref,
+	                                     author,
+	                                     author,
+	                                     NULL,
+	                                     ref,
+	                                     tree,
+	                                     parents,
+	                                     n_parents,
+	                                     &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < n_parents; i++)
+	{
+		g_object_unref (parents[i]);
+	}
+
+	g_object_unref (author);
+	g_object_unref (tree);
+
+	return oid;
+}
+
+enum
+{
+	COMMIT_MERGE,
+	COMMIT_MAIN_9,
+	COMMIT_SIDE_3,
+	COMMIT_SIDE_2,
+	COMMIT_SIDE_1,
+	COMMIT_TOPIC,
+	COMMIT_MAIN_6,
+	COMMIT_MAIN_3,
+	COMMIT_MAIN_0,
+	N_COMMITS
+};
+
+/* The main line has ten commits, main_0 to main_9. The side branch forks
+ * at main_3 and is merged into main_9, the topic branch forks at main_6
+ * and is not merged. */
+static const gboolean descends_from_side_1[N_COMMITS] = {
+	TRUE, FALSE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE, FALSE
+};
+
+static const gboolean descends_from_main_3[N_COMMITS] = {
+	TRUE, TRUE, TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE
+};
+
+/* Against the merge, which reaches the 14 commits of main and side */
+static const gsize ahead_of_merge[N_COMMITS] = {
+	0, 0, 0, 0, 0, 1, 0, 0, 0
+};
+
+static const gsize behind_merge[N_COMMITS] = {
+	0, 4, 7, 8, 9, 7, 7, 10, 13
+};
+
+static void
+check_many_queries (GgitRepository  *repo,
+                    GgitOId        **oids)
+{
+	GError *err = NULL;
+	gboolean results[N_COMMITS];
+	gsize ahead[N_COMMITS];
+	gsize behind[N_COMMITS];
+	guint i;
+
+	ggit_repository_get_descendant_of_many (repo, oids, N_COMMITS, oids[COMMIT_SIDE_1], results, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		g_assert_cmpint (results[i], ==, descends_from_side_1[i]);
+	}
+
+	ggit_repository_get_descendant_of_many (repo, oids, N_COMMITS, oids[COMMIT_MAIN_3], results, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		g_assert_cmpint (results[i], ==, descends_from_main_3[i]);
+	}
+
+	ggit_repository_get_ahead_behind_many (repo, oids, N_COMMITS, oids[COMMIT_MERGE], ahead, behind, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		g_assert_cmpuint (ahead[i], ==, ahead_of_merge[i]);
+		g_assert_cmpuint (behind[i], ==, behind_merge[i]);
+	}
+}
+
+static void
+check_index_queries (GgitReachabilityIndex  *index,
+                     GgitOId               **oids)
+{
+	gboolean results[N_COMMITS];
+	gboolean answered[N_COMMITS];
+	gsize ahead[N_COMMITS];
+	gsize behind[N_COMMITS];
+	guint i;
+
+	/* Every commit is answered by the index, not by walking commits */
+	memset (answered, 0, sizeof (answered));
+	_ggit_reachability_index_descendant_of_many (index, oids, N_COMMITS, oids[COMMIT_SIDE_1], results, answered);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		g_assert (answered[i]);
+		g_assert_cmpint (results[i], ==, descends_from_side_1[i]);
+	}
+
+	memset (answered, 0, sizeof (answered));
+	_ggit_reachability_index_descendant_of_many (index, oids, N_COMMITS, oids[COMMIT_MAIN_3], results, answered);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		g_assert (answered[i]);
+		g_assert_cmpint (results[i], ==, descends_from_main_3[i]);
+	}
+
+	memset (answered, 0, sizeof (answered));
+	_ggit_reachability_index_ahead_behind_many (index, oids, N_COMMITS, oids[COMMIT_MERGE], ahead, behind, answered);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		g_assert (answered[i]);
+		g_assert_cmpuint (ahead[i], ==, ahead_of_merge[i]);
+		g_assert_cmpuint (behind[i], ==, behind_merge[i]);
+	}
+}
+
+static void
+test_repository_reachability_index (const gchar *git_dir)
+{
+	GFile *f;
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitCommitGraph *graph;
+	GgitReachabilityIndex *index;
+	GgitOId *oids[N_COMMITS];
+	GgitOId *main_line[10];
+	GgitOId *parents[2];
+	GgitOId *newer;
+	GBytes *ids;
+	const guint8 *raw;
+	gboolean results[N_COMMITS];
+	gboolean answered[N_COMMITS];
+	gchar *path;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+	g_assert_no_error (err);
+
+	oids[COMMIT_MAIN_9] = create_linear_history (repo, 10);
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_push (walker, oids[COMMIT_MAIN_9], &err);
+	g_assert_no_error (err);
+
+	ids = ggit_revision_walker_collect (walker, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (g_bytes_get_size (ids), ==, 10 * 20);
+	raw = g_bytes_get_data (ids, NULL);
+
+	/* Newest first */
+	for (i = 0; i < 10; i++)
+	{
+		main_line[9 - i] = ggit_oid_new_from_raw (raw + i * 20);
+	}
+
+	oids[COMMIT_MAIN_6] = ggit_oid_copy (main_line[6]);
+	oids[COMMIT_MAIN_3] = ggit_oid_copy (main_line[3]);
+	oids[COMMIT_MAIN_0] = ggit_oid_copy (main_line[0]);
+
+	oids[COMMIT_SIDE_1] = create_child_commit (repo, "refs/heads/side", &main_line[3], 1);
+	oids[COMMIT_SIDE_2] = create_child_commit (repo, "refs/heads/side", &oids[COMMIT_SIDE_1], 1);
+	oids[COMMIT_SIDE_3] = create_child_commit (repo, "refs/heads/side", &oids[COMMIT_SIDE_2], 1);
+	oids[COMMIT_TOPIC] = create_child_commit (repo, "refs/heads/topic", &main_line[6], 1);
+
+	parents[0] = oids[COMMIT_MAIN_9];
+	parents[1] = oids[COMMIT_SIDE_3];
+	oids[COMMIT_MERGE] = create_child_commit (repo, "HEAD", parents, 2);
+
+	check_many_queries (repo, oids);
+
+	ggit_repository_write_reachability_index (repo, NULL, &err);
+	g_assert_no_error (err);
+
+	graph = ggit_repository_get_commit_graph (repo);
+	g_assert_nonnull (graph);
+	g_assert_cmpuint (ggit_commit_graph_get_size (graph), ==, 15);
+
+	path = _ggit_reachability_index_get_path (_ggit_native_get (repo));
+	index = _ggit_reachability_index_open (path, graph, &err);
+	g_assert_no_error (err);
+	g_assert_nonnull (index);
+
+	check_index_queries (index, oids);
+	check_many_queries (repo, oids);
+
+	/* A commit made after the index was written is left to the walk */
+	newer = create_child_commit (repo, "refs/heads/newer", &oids[COMMIT_MERGE], 1);
+
+	memset (answered, 0, sizeof (answered));
+	_ggit_reachability_index_descendant_of_many (index, &newer, 1, oids[COMMIT_SIDE_1], results, answered);
+	g_assert (!answered[0]);
+
+	ggit_repository_get_descendant_of_many (repo, &newer, 1, oids[COMMIT_SIDE_1], results, &err);
+	g_assert_no_error (err);
+	g_assert (results[0]);
+
+	for (i = 0; i < N_COMMITS; i++)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	for (i = 0; i < 10; i++)
+	{
+		ggit_oid_free (main_line[i]);
+	}
+
+	_ggit_reachability_index_unref (index);
+	ggit_commit_graph_unref (graph);
+	ggit_oid_free (newer);
+	g_free (path);
+	g_bytes_unref (ids);
+	g_object_unref (walker);
+	g_object_unref (repo);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -377,6 +3731,30 @@ main (int    argc,
 	TEST ("init-bare", init_bare);
 	TEST ("blob-stream", blob_stream);
 	TEST ("encoding", encoding);
+	TEST ("revision-walker-collect", revision_walker_collect);
+	TEST ("diff-async", diff_async);
+	TEST ("attribute-cache", attribute_cache);
+	TEST ("diff-line-ref", diff_line_ref);
+	TEST ("oid-set", oid_set);
+	TEST ("object-cache", object_cache);
+	TEST ("object-factory", object_factory);
+	TEST ("threads", threads);
+	TEST ("scanner", scanner);
+	TEST ("patch-to-stream", patch_to_stream);
+	TEST ("diff-to-stream", diff_to_stream);
+	TEST ("diff-foreach-patch", diff_foreach_patch);
+	TEST ("index-paths", index_paths);
+	TEST ("index-snapshot", index_snapshot);
+	TEST ("status-monitor", status_monitor);
+	TEST ("untracked-cache", untracked_cache);
+	TEST ("status-monitor-untracked-cache", status_monitor_untracked_cache);
+	TEST ("blob-content", blob_content);
+	TEST ("blob-splice", blob_splice);
+	TEST ("create-blobs", create_blobs);
+	TEST ("diff-stats", diff_stats);
+	TEST ("commit-table", commit_table);
+	TEST ("commit-graph", commit_graph);
+	TEST ("reachability-index", reachability_index);
 
 	return g_test_run ();
 }